@@ -0,0 +1,87 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import ctypes
+import time
+import argparse
+
+import mxnet as mx
+from mxnet.base import check_call, _LIB
+
+parser = argparse.ArgumentParser(description="Benchmark int8 operators against float32",
+                                 formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+parser.add_argument('--num-omp-threads', type=int, default=1, help='number of omp threads to set in MXNet')
+parser.add_argument('--repeat', type=int, default=10, help='number of runs to average over')
+args = parser.parse_args()
+
+
+def measure_cost(repeat, f, *args, **kwargs):
+    # one warm up run
+    mx.nd.waitall()
+    f(*args, **kwargs)
+    mx.nd.waitall()
+    start = time.time()
+    for _ in range(repeat):
+        f(*args, **kwargs)
+    mx.nd.waitall()
+    return (time.time() - start) / repeat
+
+
+def quantize_int8(data):
+    return mx.nd.contrib.quantize(data=data, min_range=mx.nd.min(data),
+                                  max_range=mx.nd.max(data), out_type='int8')
+
+
+def run_benchmark(name, float_op, quantized_op, data_shape, weight_shape, params):
+    data = mx.nd.random.uniform(-1, 1, shape=data_shape)
+    weight = mx.nd.random.uniform(-1, 1, shape=weight_shape)
+    bias = mx.nd.random.uniform(-1, 1, shape=(weight_shape[0],))
+    qdata, min_data, max_data = quantize_int8(data)
+    qweight, min_weight, max_weight = quantize_int8(weight)
+    qbias, min_bias, max_bias = quantize_int8(bias)
+    float_cost = measure_cost(args.repeat, float_op, data, weight, bias, **params)
+    int8_cost = measure_cost(args.repeat, quantized_op, qdata, qweight, qbias, min_data, max_data,
+                             min_weight, max_weight, min_bias, max_bias, **params)
+    print('{:>5} {:>20} {:>16} {:10.2f} {:10.2f} {:8.2f}'.format(
+        name, str(data_shape), str(weight_shape), float_cost * 1000, int8_cost * 1000,
+        float_cost / int8_cost))
+
+
+def run_quantized_op_benchmark():
+    check_call(_LIB.MXSetNumOMPThreads(ctypes.c_int(args.num_omp_threads)))
+    print('{:>5} {:>20} {:>16} {:>10} {:>10} {:>8}'.format(
+        'op', 'data', 'weight', 'fp32(ms)', 'int8(ms)', 'speedup'))
+    # convolution layers of resnet-50 and vgg-16
+    for batch_size in [1, 32]:
+        for channels, size, num_filter, kernel in [(64, 56, 64, 3), (256, 56, 64, 1),
+                                                   (128, 28, 128, 3), (512, 14, 512, 3)]:
+            pad = kernel // 2
+            run_benchmark('conv', mx.nd.Convolution, mx.nd.contrib.quantized_conv,
+                          (batch_size, channels, size, size),
+                          (num_filter, channels, kernel, kernel),
+                          {'kernel': (kernel, kernel), 'pad': (pad, pad),
+                           'num_filter': num_filter})
+    # fully connected layers of vgg-16 and a classifier
+    for batch_size in [1, 32, 128]:
+        for num_input, num_hidden in [(25088, 4096), (4096, 4096), (2048, 1000)]:
+            run_benchmark('fc', mx.nd.FullyConnected, mx.nd.contrib.quantized_fully_connected,
+                          (batch_size, num_input), (num_hidden, num_input),
+                          {'num_hidden': num_hidden})
+
+
+if __name__ == '__main__':
+    run_quantized_op_benchmark()
@@ -0,0 +1,87 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Thread scaling of dense to csr and dense to row_sparse cast_storage on cpu
+for matrices of about 10^8 elements, reported as time and dense input bandwidth.
+"""
+
+import ctypes
+
+from mxnet.test_utils import *
+import time
+import argparse
+
+from mxnet.base import check_call, _LIB
+
+parser = argparse.ArgumentParser(description="Benchmark cast storage operators on large matrices",
+                                 formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+parser.add_argument('--num-omp-threads', type=str, default='1,2,4,8,16',
+                    help='comma separated numbers of omp threads to set in MXNet')
+parser.add_argument('--m', type=int, default=10000, help='number of rows')
+parser.add_argument('--n', type=int, default=10000, help='number of columns')
+parser.add_argument('--repeat', type=int, default=5, help='number of runs to average over')
+args = parser.parse_args()
+
+
+def measure_cost(repeat, f, *args, **kwargs):
+    start = time.time()
+    for i in range(repeat):
+        (f(*args, **kwargs)).wait_to_read()
+    end = time.time()
+    diff = end - start
+    return diff / repeat
+
+
+def run_cast_storage_large():
+    def dense_to_sparse(dns_data, density, stype, num_threads, repeat):
+        check_call(_LIB.MXSetNumOMPThreads(ctypes.c_int(num_threads)))
+        # do one warm up run
+        mx.nd.cast_storage(dns_data, stype).wait_to_read()
+        cost = measure_cost(repeat, mx.nd.cast_storage, dns_data, stype)
+        gbps = dns_data.size * 4 / cost / 1e9
+        return cost, '{:10.2f} {:>12} {:8d} {:12.2f} {:10.2f}'.format(
+            density * 100, stype, num_threads, cost * 1000, gbps)
+
+    # params
+    # density     density of the matrix, rows are zero with probability 1 - density
+    #             for row_sparse and elements are zero for csr
+    # threads     numbers of omp threads to compare
+    density = [1.00, 0.50, 0.10, 0.01, 0.001]
+    threads = [int(t) for t in args.num_omp_threads.split(',')]
+    set_default_context(mx.cpu())
+
+    print("==================================================")
+    print(" cast_storage benchmark: dense to sparse, size %d x %d " % (args.m, args.n))
+    print("==================================================")
+    headline = '{:>10} {:>12} {:>8} {:>12} {:>10} {:>10}'.format(
+        'density(%)', 'stype', 'threads', 'time(ms)', 'GB/s', 'speedup')
+    print(headline)
+    for stype in ['csr', 'row_sparse']:
+        for den in density:
+            dns_data = rand_ndarray((args.m, args.n), stype, den).tostype('default')
+            dns_data.wait_to_read()
+            assert same(mx.nd.cast_storage(dns_data, stype).asnumpy(), dns_data.asnumpy())
+            base = None
+            for num_threads in threads:
+                cost, results = dense_to_sparse(dns_data, den, stype, num_threads, args.repeat)
+                base = cost if base is None else base
+                print('{} {:10.2f}'.format(results, base / cost))
+        print("")
+
+
+if __name__ == "__main__":
+    run_cast_storage_large()
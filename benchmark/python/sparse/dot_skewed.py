@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Thread scaling of dot(csr, dns) and dot(csr.T, dns) on csr matrices whose
+row lengths follow a power law, where splitting the rows into blocks of the
+same length leaves most threads idle while one works through the long rows.
+"""
+
+import ctypes
+import time
+import argparse
+import scipy.sparse as sp
+
+import mxnet as mx
+import numpy as np
+from mxnet.base import check_call, _LIB
+
+PARSER = argparse.ArgumentParser(description="Benchmark thread scaling of sparse dot on skewed data",
+                                 formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+PARSER.add_argument('--num-omp-threads', type=str, default='1,2,4,8,16',
+                    help='comma separated numbers of omp threads to set in MXNet')
+PARSER.add_argument('--num-rows', type=int, default=16384, help='number of rows of the csr matrix')
+PARSER.add_argument('--feature-dim', type=int, default=100000, help='number of columns of the csr matrix')
+PARSER.add_argument('--output-dim', type=str, default='1,8,64,256',
+                    help='comma separated numbers of columns of the dense matrix')
+PARSER.add_argument('--avg-nnz', type=int, default=32, help='average number of nonzeros per row')
+PARSER.add_argument('--alpha', type=float, default=1.5,
+                    help='exponent of the zipf distribution of the row lengths, smaller is more skewed')
+PARSER.add_argument('--repeat', type=int, default=10, help='number of runs to average over')
+ARGS = PARSER.parse_args()
+
+
+def measure_cost(repeat, func_name, *args, **kwargs):
+    """Measure time cost of running a function
+    """
+    mx.nd.waitall()
+    start = time.time()
+    for _ in range(repeat):
+        func_name(*args, **kwargs)
+    mx.nd.waitall()
+    end = time.time()
+    diff = end - start
+    return diff / repeat
+
+
+def skewed_csr(num_rows, num_cols, avg_nnz, alpha):
+    """csr matrix with zipf distributed row lengths, rescaled to avg_nnz nonzeros per row"""
+    lengths = np.random.zipf(alpha, num_rows).astype(np.float64)
+    lengths = np.minimum(lengths * avg_nnz / lengths.mean(), num_cols).astype(np.int64)
+    np.random.shuffle(lengths)
+    indptr = np.zeros(num_rows + 1, dtype=np.int64)
+    indptr[1:] = np.cumsum(lengths)
+    indices = np.concatenate([np.sort(np.random.choice(num_cols, l, replace=False))
+                              for l in lengths if l > 0])
+    data = np.random.uniform(size=indptr[-1]).astype(np.float32)
+    return sp.csr_matrix((data, indices, indptr), shape=(num_rows, num_cols))
+
+
+def run_benchmark():
+    threads = [int(t) for t in ARGS.num_omp_threads.split(',')]
+    output_dims = [int(n) for n in ARGS.output_dim.split(',')]
+    scipy_lhs = skewed_csr(ARGS.num_rows, ARGS.feature_dim, ARGS.avg_nnz, ARGS.alpha)
+    lhs = mx.nd.sparse.csr_matrix((scipy_lhs.data, scipy_lhs.indices, scipy_lhs.indptr),
+                                  shape=scipy_lhs.shape)
+    lengths = np.diff(scipy_lhs.indptr)
+    print("csr matrix (%d x %d), %d nonzeros, row length max %d, median %d" %
+          (ARGS.num_rows, ARGS.feature_dim, scipy_lhs.nnz, lengths.max(), np.median(lengths)))
+    print('{:>10} {:>10} {:>10} {:>15} {:>10} {:>12}'.format(
+        'op', 'n', 'threads', 't_mxnet(ms)', 'speedup', 'efficiency'))
+    fmt = '{:>10} {:10d} {:10d} {:15.4f} {:10.2f} {:11.1f}%'
+    for trans_lhs in [False, True]:
+        op = 'csr.T*dns' if trans_lhs else 'csr*dns'
+        rhs_rows = ARGS.feature_dim if not trans_lhs else ARGS.num_rows
+        for n in output_dims:
+            rhs = mx.nd.random.uniform(shape=(rhs_rows, n))
+            base = None
+            for num_threads in threads:
+                check_call(_LIB.MXSetNumOMPThreads(ctypes.c_int(num_threads)))
+                # warm up, the first call allocates the output and temp space
+                mx.nd.dot(lhs, rhs, transpose_a=trans_lhs).wait_to_read()
+                cost = measure_cost(ARGS.repeat, mx.nd.dot, lhs, rhs, transpose_a=trans_lhs)
+                if base is None:
+                    base = cost * threads[0]
+                speedup = base / threads[0] / cost
+                efficiency = 100.0 * base / num_threads / cost
+                print(fmt.format(op, n, num_threads, cost * 1000, speedup, efficiency))
+
+
+if __name__ == "__main__":
+    run_benchmark()
@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * Load generator for BatchingPredictor: closed-loop clients send single
+ * samples to an MLP, once through per-client batch-1 predictors and once
+ * through the batching predictor, and the throughput and latency are compared.
+ *
+ * Usage: batching_predictor_bench [clients=16] [max_batch=32] [delay_us=2000]
+ *                                 [workers=1] [seconds=5] [hidden=1024]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "mxnet-cpp/MxNetCpp.h"
+#include "mxnet-cpp/batching_predictor.hpp"
+
+using namespace std;
+using namespace mxnet::cpp;
+
+Symbol mlp(int input_dim, int hidden, int num_classes) {
+  auto x = Symbol::Variable("data");
+  auto label = Symbol::Variable("softmax_label");
+  Symbol h = x;
+  for (int i = 0; i < 3; ++i) {
+    h = Activation(FullyConnected("fc" + to_string(i), h,
+                                  Symbol::Variable("fc" + to_string(i) + "_weight"),
+                                  Symbol::Variable("fc" + to_string(i) + "_bias"), hidden),
+                   ActivationActType::kRelu);
+  }
+  Symbol out = FullyConnected("fc_out", h, Symbol::Variable("fc_out_weight"),
+                              Symbol::Variable("fc_out_bias"), num_classes);
+  return SoftmaxOutput("softmax", out, label);
+}
+
+struct LoadResult {
+  double seconds;
+  vector<double> latency_ms;
+};
+
+/*! \brief run closed-loop clients calling request(client) for a fixed time */
+template<typename Fn>
+LoadResult RunLoad(int clients, double seconds, Fn request) {
+  vector<vector<double> > latencies(clients);
+  atomic<bool> stop(false);
+  vector<thread> threads;
+  auto tic = chrono::steady_clock::now();
+  for (int c = 0; c < clients; ++c) {
+    threads.emplace_back([&, c]() {
+      while (!stop.load()) {
+        auto start = chrono::steady_clock::now();
+        request(c);
+        auto end = chrono::steady_clock::now();
+        latencies[c].push_back(chrono::duration<double, milli>(end - start).count());
+      }
+    });
+  }
+  this_thread::sleep_for(chrono::milliseconds(static_cast<int>(seconds * 1000)));
+  stop = true;
+  for (auto &t : threads) t.join();
+  LoadResult ret;
+  ret.seconds = chrono::duration<double>(chrono::steady_clock::now() - tic).count();
+  for (auto &l : latencies) ret.latency_ms.insert(ret.latency_ms.end(), l.begin(), l.end());
+  sort(ret.latency_ms.begin(), ret.latency_ms.end());
+  return ret;
+}
+
+void Report(const string &name, const LoadResult &r) {
+  const vector<double> &l = r.latency_ms;
+  if (l.empty()) return;
+  auto pct = [&l](double p) { return l[min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+  LG << name << ": " << l.size() / r.seconds << " samples/sec, latency p50 "
+     << pct(0.5) << " ms, p99 " << pct(0.99) << " ms";
+}
+
+int main(int argc, char** argv) {
+  int clients = 16, max_batch = 32, delay_us = 2000, workers = 1, hidden = 1024;
+  double seconds = 5;
+  const int input_dim = 784, num_classes = 10;
+  for (int i = 1; i < argc; ++i) {
+    char key[128];
+    double val;
+    if (sscanf(argv[i], "%127[^=]=%lf", key, &val) != 2) continue;
+    if (!strcmp(key, "clients")) clients = static_cast<int>(val);
+    if (!strcmp(key, "max_batch")) max_batch = static_cast<int>(val);
+    if (!strcmp(key, "delay_us")) delay_us = static_cast<int>(val);
+    if (!strcmp(key, "workers")) workers = static_cast<int>(val);
+    if (!strcmp(key, "seconds")) seconds = val;
+    if (!strcmp(key, "hidden")) hidden = static_cast<int>(val);
+  }
+
+  // build and initialize the model, then serialize it as the predict API expects
+  Symbol net = mlp(input_dim, hidden, num_classes);
+  Context ctx = Context::cpu();
+  map<string, NDArray> args;
+  args["data"] = NDArray(Shape(1, input_dim), ctx);
+  net.InferArgsMap(ctx, &args, args);
+  Uniform initializer(0.01);
+  map<string, NDArray> params;
+  for (auto &arg : args) {
+    if (arg.first == "data" || arg.first == "softmax_label") continue;
+    initializer(arg.first, &arg.second);
+    params["arg:" + arg.first] = arg.second;
+  }
+  const string param_file = "batching_predictor_bench.params";
+  NDArray::Save(param_file, params);
+  stringstream buffer;
+  {
+    ifstream fin(param_file, ios::binary);
+    buffer << fin.rdbuf();
+  }
+  remove(param_file.c_str());
+  const string param_bytes = buffer.str();
+  const string json = net.ToJSON();
+  vector<mx_float> sample(input_dim, 0.5f);
+
+  LG << clients << " clients, " << hidden << " hidden units, "
+     << seconds << " sec per run";
+
+  // baseline: every client owns a batch-1 predictor, the weights are shared
+  {
+    const char *keys[] = {"data"};
+    const mx_uint indptr[] = {0, 2};
+    const mx_uint shape[] = {1, static_cast<mx_uint>(input_dim)};
+    vector<PredictorHandle> preds(clients);
+    CHECK_EQ(MXPredCreateMultiThread(json.c_str(), param_bytes.data(),
+                                     static_cast<int>(param_bytes.size()), 1, 0,
+                                     1, keys, indptr, shape, clients, preds.data()), 0)
+        << MXGetLastError();
+    LoadResult r = RunLoad(clients, seconds, [&](int c) {
+      vector<mx_float> out(num_classes);
+      MXPredSetInput(preds[c], "data", sample.data(), input_dim);
+      MXPredForward(preds[c]);
+      MXPredGetOutput(preds[c], 0, out.data(), num_classes);
+    });
+    Report("batch-1 predictors", r);
+    for (auto p : preds) MXPredFree(p);
+  }
+
+  // dynamic batching
+  {
+    BatchingPredictorConfig config;
+    config.max_batch_size = max_batch;
+    config.max_delay_us = delay_us;
+    config.num_workers = workers;
+    BatchingPredictor predictor(json, param_bytes, "data",
+                                {static_cast<mx_uint>(input_dim)}, config);
+    LoadResult r = RunLoad(clients, seconds, [&](int c) {
+      predictor.Predict(sample.data()).get();
+    });
+    Report("batching predictor", r);
+    LG << "average batch size "
+       << static_cast<double>(predictor.num_requests()) / max<size_t>(predictor.num_batches(), 1);
+  }
+  MXNotifyShutdown();
+  return 0;
+}
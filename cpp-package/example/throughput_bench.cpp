@@ -0,0 +1,538 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * End-to-end throughput of standard networks on synthetic data. Every model is
+ * run for every mode:
+ *   train     GraphExecutor forward, backward and sgd update
+ *   infer     GraphExecutor forward
+ *   cachedop  CachedOp forward
+ *   predict   C predict API, including the copy of the inputs
+ * and the samples/sec and the per-iteration latency percentiles are reported,
+ * optionally appended as tab-separated lines to a file.
+ *
+ * The engine and the thread counts are fixed for the whole process, so run the
+ * benchmark once per configuration and collect the results in the same file.
+ *
+ * Usage: throughput_bench [model=mlp,resnet18,resnet50,lstm,sparse]
+ *                         [mode=train,infer,cachedop,predict] [batch=32]
+ *                         [iters=50] [warmup=5] [engine=ThreadedEnginePerDevice]
+ *                         [omp_threads=0] [worker_threads=0] [image=224]
+ *                         [seq_len=35] [vocab=10000] [hidden=512]
+ *                         [features=100000] [density=0.001] [output=FILE]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include "mxnet-cpp/MxNetCpp.h"
+#include "nnvm/c_api.h"
+
+using namespace std;
+using namespace mxnet::cpp;
+
+struct BenchConfig {
+  string models = "mlp,resnet18,resnet50,lstm,sparse";
+  string modes = "train,infer,cachedop,predict";
+  string engine;
+  string output;
+  int batch = 32, iters = 50, warmup = 5;
+  int omp_threads = 0, worker_threads = 0;
+  int image = 224, seq_len = 35, vocab = 10000, hidden = 512, features = 100000;
+  double density = 0.001;
+};
+
+/*! \brief a data input of a network, fed with synthetic values */
+struct BenchInput {
+  string name;
+  vector<mx_uint> shape;
+  /*! \brief values are integers in [0, range) if range > 0, else uniform in [0, 1) */
+  int range;
+};
+
+struct BenchModel {
+  Symbol net;
+  vector<BenchInput> inputs;
+  BenchInput label;
+  /*! \brief whether the first input is fed as a csr array */
+  bool sparse;
+  /*! \brief parameters whose shapes cannot be inferred from the inputs */
+  map<string, vector<mx_uint> > param_shapes;
+};
+
+vector<string> Split(const string &s) {
+  vector<string> ret;
+  stringstream ss(s);
+  string item;
+  while (getline(ss, item, ',')) {
+    if (!item.empty()) ret.push_back(item);
+  }
+  return ret;
+}
+
+void SetEnv(const char *name, const string &value) {
+#ifdef _MSC_VER
+  _putenv_s(name, value.c_str());
+#else
+  setenv(name, value.c_str(), 1);
+#endif
+}
+
+Symbol ConvBN(const string &name, Symbol data, int num_filter, int kernel,
+              int stride, int pad, bool relu) {
+  Symbol conv = Operator("Convolution")
+      .SetParam("kernel", Shape(kernel, kernel))
+      .SetParam("stride", Shape(stride, stride))
+      .SetParam("pad", Shape(pad, pad))
+      .SetParam("num_filter", num_filter)
+      .SetParam("no_bias", true)
+      .SetInput("data", data)
+      .SetInput("weight", Symbol::Variable(name + "_weight"))
+      .CreateSymbol(name);
+  Symbol bn = Operator("BatchNorm")
+      .SetParam("fix_gamma", false)
+      .SetParam("eps", 2e-5)
+      .SetInput("data", conv)
+      .SetInput("gamma", Symbol::Variable(name + "_bn_gamma"))
+      .SetInput("beta", Symbol::Variable(name + "_bn_beta"))
+      .SetInput("moving_mean", Symbol::Variable(name + "_bn_moving_mean"))
+      .SetInput("moving_var", Symbol::Variable(name + "_bn_moving_var"))
+      .CreateSymbol(name + "_bn");
+  return relu ? Activation(name + "_relu", bn, ActivationActType::kRelu) : bn;
+}
+
+Symbol ResidualUnit(const string &name, Symbol data, int num_filter, int stride,
+                    bool dim_match, bool bottleneck) {
+  Symbol body;
+  if (bottleneck) {
+    body = ConvBN(name + "_conv1", data, num_filter / 4, 1, 1, 0, true);
+    body = ConvBN(name + "_conv2", body, num_filter / 4, 3, stride, 1, true);
+    body = ConvBN(name + "_conv3", body, num_filter, 1, 1, 0, false);
+  } else {
+    body = ConvBN(name + "_conv1", data, num_filter, 3, stride, 1, true);
+    body = ConvBN(name + "_conv2", body, num_filter, 3, 1, 1, false);
+  }
+  Symbol shortcut = dim_match ? data :
+      ConvBN(name + "_sc", data, num_filter, 1, stride, 0, false);
+  return Activation(name + "_relu", body + shortcut, ActivationActType::kRelu);
+}
+
+/*! \brief ImageNet ResNet-18 (basic units) or ResNet-50 (bottleneck units) */
+BenchModel ResNet(int depth, const BenchConfig &cfg) {
+  const bool bottleneck = depth >= 50;
+  const vector<int> units = bottleneck ? vector<int>{3, 4, 6, 3} : vector<int>{2, 2, 2, 2};
+  const vector<int> filters = bottleneck ? vector<int>{256, 512, 1024, 2048}
+                                         : vector<int>{64, 128, 256, 512};
+  const int num_classes = 1000;
+  Symbol body = ConvBN("conv0", Symbol::Variable("data"), 64, 7, 2, 3, true);
+  body = Operator("Pooling")
+      .SetParam("kernel", Shape(3, 3))
+      .SetParam("stride", Shape(2, 2))
+      .SetParam("pad", Shape(1, 1))
+      .SetParam("pool_type", "max")
+      .SetInput("data", body)
+      .CreateSymbol("pool0");
+  for (size_t stage = 0; stage < units.size(); ++stage) {
+    for (int unit = 0; unit < units[stage]; ++unit) {
+      const string name = "stage" + to_string(stage + 1) + "_unit" + to_string(unit + 1);
+      const int stride = (unit == 0 && stage != 0) ? 2 : 1;
+      // the first unit of the first stage only changes the width of bottlenecks
+      const bool dim_match = unit != 0 || (stage == 0 && !bottleneck);
+      body = ResidualUnit(name, body, filters[stage], stride, dim_match, bottleneck);
+    }
+  }
+  Symbol pool = Operator("Pooling")
+      .SetParam("kernel", Shape(7, 7))
+      .SetParam("global_pool", true)
+      .SetParam("pool_type", "avg")
+      .SetInput("data", body)
+      .CreateSymbol("pool1");
+  Symbol fc = FullyConnected("fc1", Flatten("flatten", pool), Symbol::Variable("fc1_weight"),
+                             Symbol::Variable("fc1_bias"), num_classes);
+  BenchModel m;
+  m.net = SoftmaxOutput("softmax", fc, Symbol::Variable("softmax_label"));
+  m.inputs.push_back({"data", {static_cast<mx_uint>(cfg.batch), 3,
+                               static_cast<mx_uint>(cfg.image),
+                               static_cast<mx_uint>(cfg.image)}, 0});
+  m.label = {"softmax_label", {static_cast<mx_uint>(cfg.batch)}, num_classes};
+  m.sparse = false;
+  return m;
+}
+
+BenchModel MLP(const BenchConfig &cfg) {
+  const int input_dim = 784, num_classes = 10;
+  Symbol h = Symbol::Variable("data");
+  for (int i = 0; i < 3; ++i) {
+    const string name = "fc" + to_string(i);
+    h = Activation(name + "_relu",
+                   FullyConnected(name, h, Symbol::Variable(name + "_weight"),
+                                  Symbol::Variable(name + "_bias"), cfg.hidden),
+                   ActivationActType::kRelu);
+  }
+  Symbol out = FullyConnected("fc_out", h, Symbol::Variable("fc_out_weight"),
+                              Symbol::Variable("fc_out_bias"), num_classes);
+  BenchModel m;
+  m.net = SoftmaxOutput("softmax", out, Symbol::Variable("softmax_label"));
+  m.inputs.push_back({"data", {static_cast<mx_uint>(cfg.batch), input_dim}, 0});
+  m.label = {"softmax_label", {static_cast<mx_uint>(cfg.batch)}, num_classes};
+  m.sparse = false;
+  return m;
+}
+
+/*! \brief one-layer LSTM language model, unrolled over seq_len steps */
+BenchModel LSTMLM(const BenchConfig &cfg) {
+  const int hidden = cfg.hidden;
+  Symbol embed = Embedding("embed", Symbol::Variable("data"), Symbol::Variable("embed_weight"),
+                           cfg.vocab, hidden);
+  Symbol steps = SliceChannel(embed, cfg.seq_len, 1, true);
+  Symbol i2h_weight = Symbol::Variable("i2h_weight"), i2h_bias = Symbol::Variable("i2h_bias");
+  Symbol h2h_weight = Symbol::Variable("h2h_weight"), h2h_bias = Symbol::Variable("h2h_bias");
+  Symbol h = Symbol::Variable("init_h"), c = Symbol::Variable("init_c");
+  vector<Symbol> outputs;
+  for (int t = 0; t < cfg.seq_len; ++t) {
+    const string prefix = "t" + to_string(t);
+    Symbol gates = FullyConnected(prefix + "_i2h", steps[t], i2h_weight, i2h_bias, hidden * 4) +
+                   FullyConnected(prefix + "_h2h", h, h2h_weight, h2h_bias, hidden * 4);
+    Symbol slices = SliceChannel(prefix + "_slice", gates, 4);
+    Symbol in_gate = Activation(slices[0], ActivationActType::kSigmoid);
+    Symbol in_transform = Activation(slices[1], ActivationActType::kTanh);
+    Symbol forget_gate = Activation(slices[2], ActivationActType::kSigmoid);
+    Symbol out_gate = Activation(slices[3], ActivationActType::kSigmoid);
+    c = (forget_gate * c) + (in_gate * in_transform);
+    h = out_gate * Activation(c, ActivationActType::kTanh);
+    outputs.push_back(h);
+  }
+  Symbol pred = FullyConnected("pred", Concat(outputs, outputs.size(), 0),
+                               Symbol::Variable("pred_weight"), Symbol::Variable("pred_bias"),
+                               cfg.vocab);
+  BenchModel m;
+  m.net = SoftmaxOutput("softmax", pred, Symbol::Variable("softmax_label"));
+  const mx_uint batch = cfg.batch;
+  m.inputs.push_back({"data", {batch, static_cast<mx_uint>(cfg.seq_len)}, cfg.vocab});
+  m.inputs.push_back({"init_h", {batch, static_cast<mx_uint>(hidden)}, 0});
+  m.inputs.push_back({"init_c", {batch, static_cast<mx_uint>(hidden)}, 0});
+  m.label = {"softmax_label", {batch * cfg.seq_len}, cfg.vocab};
+  m.sparse = false;
+  return m;
+}
+
+/*! \brief logistic regression over csr features */
+BenchModel SparseLinear(const BenchConfig &cfg) {
+  const int num_classes = 2;
+  Symbol out = Operator("dot")
+      .SetInput("lhs", Symbol::Variable("data"))
+      .SetInput("rhs", Symbol::Variable("linear_weight"))
+      .CreateSymbol("linear");
+  BenchModel m;
+  m.net = SoftmaxOutput("softmax", out, Symbol::Variable("softmax_label"));
+  m.inputs.push_back({"data", {static_cast<mx_uint>(cfg.batch),
+                               static_cast<mx_uint>(cfg.features)}, 0});
+  m.label = {"softmax_label", {static_cast<mx_uint>(cfg.batch)}, num_classes};
+  m.sparse = true;
+  m.param_shapes["linear_weight"] = {static_cast<mx_uint>(cfg.features), num_classes};
+  return m;
+}
+
+BenchModel CreateModel(const string &name, const BenchConfig &cfg) {
+  if (name == "mlp") return MLP(cfg);
+  if (name == "resnet18") return ResNet(18, cfg);
+  if (name == "resnet50") return ResNet(50, cfg);
+  if (name == "lstm") return LSTMLM(cfg);
+  if (name == "sparse") return SparseLinear(cfg);
+  LOG(FATAL) << "unknown model " << name;
+  return BenchModel();
+}
+
+vector<mx_float> SyntheticValues(const BenchInput &input, double density, mt19937 *rnd) {
+  size_t size = 1;
+  for (mx_uint s : input.shape) size *= s;
+  vector<mx_float> values(size, 0.0f);
+  uniform_real_distribution<mx_float> uniform(0.0f, 1.0f);
+  for (auto &v : values) {
+    if (input.range > 0) {
+      v = static_cast<mx_float>((*rnd)() % input.range);
+    } else if (density >= 1.0 || uniform(*rnd) < density) {
+      v = uniform(*rnd);
+    }
+  }
+  return values;
+}
+
+/*! \brief inputs, label, parameters and auxiliary states of a model on cpu */
+struct BenchArrays {
+  map<string, NDArray> args;
+  map<string, NDArray> aux;
+  /*! \brief dense values of every input, fed to the predict API */
+  map<string, vector<mx_float> > input_values;
+
+  bool IsInput(const string &name, const BenchModel &m) const {
+    return input_values.count(name) != 0 || name == m.label.name;
+  }
+};
+
+BenchArrays CreateArrays(const BenchModel &m, const BenchConfig &cfg) {
+  Context ctx = Context::cpu();
+  mt19937 rnd(0);
+  BenchArrays ret;
+  for (size_t i = 0; i < m.inputs.size(); ++i) {
+    const BenchInput &input = m.inputs[i];
+    const bool csr = m.sparse && i == 0;
+    vector<mx_float> values = SyntheticValues(input, csr ? cfg.density : 1.0, &rnd);
+    NDArray arr(input.shape, ctx, false);
+    arr.SyncCopyFromCPU(values);
+    if (csr) {
+      arr = Operator("cast_storage").SetParam("stype", "csr")(arr).Invoke()[0];
+    }
+    ret.args[input.name] = arr;
+    ret.input_values[input.name] = values;
+  }
+  NDArray label(m.label.shape, ctx, false);
+  label.SyncCopyFromCPU(SyntheticValues(m.label, 1.0, &rnd));
+  ret.args[m.label.name] = label;
+  for (const auto &param : m.param_shapes) {
+    ret.args[param.first] = NDArray(param.second, ctx, false);
+  }
+
+  m.net.InferArgsMap(ctx, &ret.args, ret.args);
+  Xavier initializer(Xavier::gaussian, Xavier::in, 2.34);
+  for (auto &arg : ret.args) {
+    if (!ret.IsInput(arg.first, m)) initializer(arg.first, &arg.second);
+  }
+  map<string, vector<mx_uint> > arg_shapes;
+  for (const auto &arg : ret.args) arg_shapes[arg.first] = arg.second.GetShape();
+  vector<vector<mx_uint> > in_shapes, aux_shapes, out_shapes;
+  m.net.InferShape(arg_shapes, &in_shapes, &aux_shapes, &out_shapes);
+  const vector<string> aux_names = m.net.ListAuxiliaryStates();
+  for (size_t i = 0; i < aux_names.size(); ++i) {
+    NDArray arr(aux_shapes[i], ctx, false);
+    initializer(aux_names[i], &arr);
+    ret.aux[aux_names[i]] = arr;
+  }
+  NDArray::WaitAll();
+  return ret;
+}
+
+struct BenchResult {
+  double samples_per_sec;
+  vector<double> latency_ms;
+};
+
+/*! \brief time warmup + iters calls of step, each of which must block until done */
+template<typename Fn>
+BenchResult Measure(const BenchConfig &cfg, Fn step) {
+  for (int i = 0; i < cfg.warmup; ++i) step();
+  BenchResult ret;
+  double total = 0;
+  for (int i = 0; i < cfg.iters; ++i) {
+    auto start = chrono::steady_clock::now();
+    step();
+    auto end = chrono::steady_clock::now();
+    ret.latency_ms.push_back(chrono::duration<double, milli>(end - start).count());
+    total += ret.latency_ms.back();
+  }
+  sort(ret.latency_ms.begin(), ret.latency_ms.end());
+  ret.samples_per_sec = total > 0 ? cfg.batch * cfg.iters * 1000.0 / total : 0;
+  return ret;
+}
+
+BenchResult RunExecutor(const BenchModel &m, BenchArrays *arrays, const BenchConfig &cfg,
+                        bool train) {
+  Context ctx = Context::cpu();
+  map<string, OpReqType> grad_req;
+  for (const auto &arg : arrays->args) {
+    grad_req[arg.first] = (train && !arrays->IsInput(arg.first, m)) ? kWriteTo : kNullOp;
+  }
+  Symbol net = m.net;
+  unique_ptr<Executor> exec(net.SimpleBind(ctx, arrays->args, map<string, NDArray>(),
+                                           grad_req, arrays->aux));
+  unique_ptr<Optimizer> opt(OptimizerRegistry::Find("sgd"));
+  opt->SetParam("lr", 0.01)->SetParam("rescale_grad", 1.0 / cfg.batch);
+  const vector<string> arg_names = m.net.ListArguments();
+  return Measure(cfg, [&]() {
+    exec->Forward(train);
+    if (train) {
+      exec->Backward();
+      for (size_t i = 0; i < arg_names.size(); ++i) {
+        if (arrays->IsInput(arg_names[i], m)) continue;
+        opt->Update(i, exec->arg_arrays[i], exec->grad_arrays[i]);
+      }
+    }
+    NDArray::WaitAll();
+  });
+}
+
+BenchResult RunCachedOp(const BenchModel &m, BenchArrays *arrays, const BenchConfig &cfg) {
+  CachedOpHandle op;
+  CHECK_EQ(MXCreateCachedOp(m.net.GetHandle(), &op), 0) << MXGetLastError();
+  // the cached op takes the arguments and the auxiliary states in graph order
+  nn_uint num_inputs;
+  const char **input_names;
+  CHECK_EQ(NNSymbolListInputNames(m.net.GetHandle(), 0, &num_inputs, &input_names), 0)
+      << MXGetLastError();
+  vector<NDArrayHandle> inputs;
+  for (nn_uint i = 0; i < num_inputs; ++i) {
+    const string name = input_names[i];
+    map<string, NDArray> &src = arrays->args.count(name) ? arrays->args : arrays->aux;
+    CHECK(src.count(name)) << "no array for input " << name;
+    inputs.push_back(src[name].GetHandle());
+  }
+  // outputs are allocated by the first call and written in place afterwards
+  int num_outputs = 0;
+  vector<NDArrayHandle> outputs;
+  BenchResult ret = Measure(cfg, [&]() {
+    NDArrayHandle *outs = outputs.empty() ? nullptr : outputs.data();
+    CHECK_EQ(MXInvokeCachedOp(op, static_cast<int>(inputs.size()), inputs.data(),
+                              &num_outputs, &outs), 0) << MXGetLastError();
+    if (outputs.empty()) outputs.assign(outs, outs + num_outputs);
+    NDArray::WaitAll();
+  });
+  for (NDArrayHandle h : outputs) MXNDArrayFree(h);
+  MXFreeCachedOp(op);
+  return ret;
+}
+
+BenchResult RunPredictor(const BenchModel &m, BenchArrays *arrays, const BenchConfig &cfg) {
+  map<string, NDArray> params;
+  for (const auto &arg : arrays->args) {
+    if (!arrays->IsInput(arg.first, m)) params["arg:" + arg.first] = arg.second;
+  }
+  for (const auto &aux : arrays->aux) params["aux:" + aux.first] = aux.second;
+  const string param_file = "throughput_bench.params";
+  NDArray::Save(param_file, params);
+  ifstream fin(param_file, ios::binary);
+  stringstream buffer;
+  buffer << fin.rdbuf();
+  const string param_bytes = buffer.str();
+  remove(param_file.c_str());
+  const string json = m.net.ToJSON();
+
+  vector<const char*> keys;
+  vector<mx_uint> indptr{0}, shapes;
+  for (const BenchInput &input : m.inputs) {
+    keys.push_back(input.name.c_str());
+    shapes.insert(shapes.end(), input.shape.begin(), input.shape.end());
+    indptr.push_back(static_cast<mx_uint>(shapes.size()));
+  }
+  PredictorHandle pred;
+  CHECK_EQ(MXPredCreate(json.c_str(), param_bytes.data(), static_cast<int>(param_bytes.size()),
+                        1, 0, static_cast<mx_uint>(keys.size()), keys.data(), indptr.data(),
+                        shapes.data(), &pred), 0) << MXGetLastError();
+  mx_uint *out_shape;
+  mx_uint out_ndim;
+  CHECK_EQ(MXPredGetOutputShape(pred, 0, &out_shape, &out_ndim), 0) << MXGetLastError();
+  size_t out_size = 1;
+  for (mx_uint i = 0; i < out_ndim; ++i) out_size *= out_shape[i];
+  vector<mx_float> output(out_size);
+  BenchResult ret = Measure(cfg, [&]() {
+    for (const BenchInput &input : m.inputs) {
+      const vector<mx_float> &values = arrays->input_values[input.name];
+      CHECK_EQ(MXPredSetInput(pred, input.name.c_str(), values.data(),
+                              static_cast<mx_uint>(values.size())), 0) << MXGetLastError();
+    }
+    CHECK_EQ(MXPredForward(pred), 0) << MXGetLastError();
+    CHECK_EQ(MXPredGetOutput(pred, 0, output.data(), static_cast<mx_uint>(out_size)), 0)
+        << MXGetLastError();
+  });
+  MXPredFree(pred);
+  return ret;
+}
+
+void Report(const string &model, const string &mode, const BenchConfig &cfg,
+            const BenchResult &r) {
+  const vector<double> &l = r.latency_ms;
+  if (l.empty()) return;
+  auto pct = [&l](double p) { return l[min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+  LG << model << " " << mode << ": " << r.samples_per_sec << " samples/sec, latency p50 "
+     << pct(0.5) << " ms, p90 " << pct(0.9) << " ms, p99 " << pct(0.99) << " ms";
+  if (cfg.output.empty()) return;
+  const bool exists = ifstream(cfg.output).good();
+  ofstream fout(cfg.output, ios::app);
+  if (!exists) {
+    fout << "model\tmode\tengine\tomp_threads\tworker_threads\tbatch\t"
+         << "samples_per_sec\tp50_ms\tp90_ms\tp99_ms\n";
+  }
+  fout << model << '\t' << mode << '\t' << cfg.engine << '\t' << cfg.omp_threads << '\t'
+       << cfg.worker_threads << '\t' << cfg.batch << '\t' << r.samples_per_sec << '\t'
+       << pct(0.5) << '\t' << pct(0.9) << '\t' << pct(0.99) << '\n';
+}
+
+int main(int argc, char** argv) {
+  BenchConfig cfg;
+  for (int i = 1; i < argc; ++i) {
+    char key[128], val[1024];
+    if (sscanf(argv[i], "%127[^=]=%1023s", key, val) != 2) continue;
+    if (!strcmp(key, "model")) cfg.models = val;
+    if (!strcmp(key, "mode")) cfg.modes = val;
+    if (!strcmp(key, "engine")) cfg.engine = val;
+    if (!strcmp(key, "output")) cfg.output = val;
+    if (!strcmp(key, "batch")) cfg.batch = atoi(val);
+    if (!strcmp(key, "iters")) cfg.iters = atoi(val);
+    if (!strcmp(key, "warmup")) cfg.warmup = atoi(val);
+    if (!strcmp(key, "omp_threads")) cfg.omp_threads = atoi(val);
+    if (!strcmp(key, "worker_threads")) cfg.worker_threads = atoi(val);
+    if (!strcmp(key, "image")) cfg.image = atoi(val);
+    if (!strcmp(key, "seq_len")) cfg.seq_len = atoi(val);
+    if (!strcmp(key, "vocab")) cfg.vocab = atoi(val);
+    if (!strcmp(key, "hidden")) cfg.hidden = atoi(val);
+    if (!strcmp(key, "features")) cfg.features = atoi(val);
+    if (!strcmp(key, "density")) cfg.density = atof(val);
+  }
+  // the engine is created by the first call into the library, so the
+  // environment has to be set up before anything else
+  if (!cfg.engine.empty()) SetEnv("MXNET_ENGINE_TYPE", cfg.engine);
+  if (cfg.worker_threads > 0) {
+    SetEnv("MXNET_CPU_WORKER_NTHREADS", to_string(cfg.worker_threads));
+  }
+  if (cfg.omp_threads > 0) {
+    SetEnv("OMP_NUM_THREADS", to_string(cfg.omp_threads));
+    MXSetNumOMPThreads(cfg.omp_threads);
+  }
+  const char *engine = getenv("MXNET_ENGINE_TYPE");
+  cfg.engine = engine != nullptr ? engine : "ThreadedEnginePerDevice";
+  LG << "engine " << cfg.engine << ", omp_threads " << cfg.omp_threads
+     << ", worker_threads " << cfg.worker_threads << ", batch " << cfg.batch
+     << ", " << cfg.iters << " iterations after " << cfg.warmup << " warmup";
+
+  for (const string &name : Split(cfg.models)) {
+    BenchModel m = CreateModel(name, cfg);
+    BenchArrays arrays = CreateArrays(m, cfg);
+    for (const string &mode : Split(cfg.modes)) {
+      if (mode == "train" || mode == "infer") {
+        Report(name, mode, cfg, RunExecutor(m, &arrays, cfg, mode == "train"));
+      } else if (mode == "cachedop") {
+        Report(name, mode, cfg, RunCachedOp(m, &arrays, cfg));
+      } else if (mode == "predict") {
+        if (m.sparse) {
+          LG << name << " " << mode << ": skipped, the predict API takes dense inputs only";
+          continue;
+        }
+        Report(name, mode, cfg, RunPredictor(m, &arrays, cfg));
+      } else {
+        LOG(FATAL) << "unknown mode " << mode;
+      }
+    }
+  }
+  MXNotifyShutdown();
+  return 0;
+}
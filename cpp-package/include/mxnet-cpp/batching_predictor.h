@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+* \file batching_predictor.h
+* \brief dynamic request batching on top of the C predict API
+*
+*  Single-sample requests are queued and coalesced into one batch until either
+*  max_batch_size requests are waiting or the oldest one has waited max_delay_us.
+*  The batch is run by one of the worker predictors, which share one copy of the
+*  weights (MXPredCreateMultiThread), and the outputs are scattered back to the
+*  callers through futures.
+*/
+
+#ifndef MXNET_CPP_BATCHING_PREDICTOR_H_
+#define MXNET_CPP_BATCHING_PREDICTOR_H_
+
+#include <dmlc/logging.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mxnet/c_predict_api.h"
+
+namespace mxnet {
+namespace cpp {
+
+/*!
+* \brief options of BatchingPredictor
+*/
+struct BatchingPredictorConfig {
+  /*! \brief largest batch run by one forward */
+  mx_uint max_batch_size = 32;
+  /*! \brief longest time the oldest request waits for others to join its batch */
+  int max_delay_us = 2000;
+  /*! \brief number of predictors running batches concurrently */
+  int num_workers = 1;
+  /*!
+  * \brief batch sizes the predictors are reshaped to, a batch is padded to the
+  *  smallest one that fits. Empty means max_batch_size halved as many times as the
+  *  predictors cache executors. A predictor keeps its current executor plus
+  *  MXNET_PREDICTOR_EXEC_CACHE_SIZE others, so at most that many plus one sizes
+  *  are accepted, more would re-bind an executor on every switch.
+  */
+  std::vector<mx_uint> batch_sizes;
+  /*! \brief device type, 1: cpu, 2: gpu */
+  int dev_type = 1;
+  /*! \brief device id */
+  int dev_id = 0;
+};
+
+/*!
+* \brief outputs of one request, one vector per output of the network
+*/
+typedef std::vector<std::vector<mx_float> > BatchingPredictorResult;
+
+/*!
+* \brief predictor that batches concurrent single-sample requests
+*/
+class BatchingPredictor {
+ public:
+  /*!
+  * \brief create the worker predictors and start them
+  * \param symbol_json the JSON string of the network
+  * \param param_bytes the content of the parameter file
+  * \param input_name name of the single input of the network
+  * \param sample_shape shape of one sample, without the batch dimension
+  * \param config batching options
+  */
+  BatchingPredictor(const std::string &symbol_json,
+                    const std::string &param_bytes,
+                    const std::string &input_name,
+                    const std::vector<mx_uint> &sample_shape,
+                    const BatchingPredictorConfig &config = BatchingPredictorConfig());
+  /*!
+  * \brief run the queued requests and stop the workers
+  */
+  ~BatchingPredictor();
+  /*!
+  * \brief queue one sample, thread safe
+  * \param data sample_size() values, copied before returning
+  * \return the future outputs of this sample
+  */
+  std::future<BatchingPredictorResult> Predict(const mx_float *data);
+  /*!
+  * \return number of values in one sample
+  */
+  size_t sample_size() const { return sample_size_; }
+  /*!
+  * \return number of batches run so far
+  */
+  size_t num_batches() const;
+  /*!
+  * \return number of requests served so far
+  */
+  size_t num_requests() const;
+
+ private:
+  /*! \brief a queued request */
+  struct Request {
+    std::vector<mx_float> data;
+    std::promise<BatchingPredictorResult> result;
+    std::chrono::steady_clock::time_point arrival;
+  };
+  void WorkerLoop(int worker_id);
+  bool NextBatch(std::vector<Request> *batch);
+  void RunBatch(int worker_id, std::vector<Request> *batch);
+  mx_uint PaddedBatchSize(mx_uint n) const;
+  void Reshape(int worker_id, mx_uint batch_size);
+
+  BatchingPredictorConfig config_;
+  std::string input_name_;
+  std::vector<mx_uint> sample_shape_;
+  size_t sample_size_;
+  mx_uint num_outputs_;
+  std::vector<PredictorHandle> predictors_;
+  /*! \brief current batch size of every predictor */
+  std::vector<mx_uint> predictor_batch_;
+  std::vector<std::thread> workers_;
+  std::deque<Request> queue_;
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stop_ = false;
+  size_t num_batches_ = 0;
+  size_t num_requests_ = 0;
+};
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_BATCHING_PREDICTOR_H_
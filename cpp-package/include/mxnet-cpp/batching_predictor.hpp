@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+* \file batching_predictor.hpp
+* \brief implementation of the batching predictor
+*/
+
+#ifndef MXNET_CPP_BATCHING_PREDICTOR_HPP_
+#define MXNET_CPP_BATCHING_PREDICTOR_HPP_
+
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mxnet-cpp/batching_predictor.h"
+
+namespace mxnet {
+namespace cpp {
+
+inline BatchingPredictor::BatchingPredictor(const std::string &symbol_json,
+                                            const std::string &param_bytes,
+                                            const std::string &input_name,
+                                            const std::vector<mx_uint> &sample_shape,
+                                            const BatchingPredictorConfig &config)
+    : config_(config), input_name_(input_name), sample_shape_(sample_shape) {
+  CHECK_GT(config_.max_batch_size, 0U);
+  CHECK_GT(config_.num_workers, 0);
+  sample_size_ = 1;
+  for (mx_uint s : sample_shape_) sample_size_ *= s;
+  // the executors of the current and the cached batch sizes, as in MXPredReshape
+  const size_t max_num_sizes =
+      dmlc::GetEnv("MXNET_PREDICTOR_EXEC_CACHE_SIZE", static_cast<size_t>(4)) + 1;
+  std::vector<mx_uint> &sizes = config_.batch_sizes;
+  if (sizes.empty()) {
+    for (mx_uint b = config_.max_batch_size; b > 0 && sizes.size() < max_num_sizes; b /= 2) {
+      sizes.push_back(b);
+    }
+  }
+  sizes.push_back(config_.max_batch_size);
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  while (sizes.back() > config_.max_batch_size) sizes.pop_back();
+  CHECK_LE(sizes.size(), max_num_sizes)
+      << "BatchingPredictor: " << sizes.size() << " batch sizes but the predictors cache "
+      << max_num_sizes << " executors, raise MXNET_PREDICTOR_EXEC_CACHE_SIZE";
+
+  std::vector<mx_uint> shape{config_.max_batch_size};
+  shape.insert(shape.end(), sample_shape_.begin(), sample_shape_.end());
+  const char *keys[] = {input_name_.c_str()};
+  const mx_uint indptr[] = {0, static_cast<mx_uint>(shape.size())};
+  predictors_.resize(config_.num_workers);
+  CHECK_EQ(MXPredCreateMultiThread(symbol_json.c_str(), param_bytes.data(),
+                                   static_cast<int>(param_bytes.size()),
+                                   config_.dev_type, config_.dev_id,
+                                   1, keys, indptr, shape.data(),
+                                   config_.num_workers, predictors_.data()), 0)
+      << MXGetLastError();
+  predictor_batch_.assign(config_.num_workers, config_.max_batch_size);
+  CHECK_EQ(MXPredGetNumOutputs(predictors_[0], &num_outputs_), 0) << MXGetLastError();
+  for (int i = 0; i < config_.num_workers; ++i) {
+    workers_.emplace_back([this, i]() { WorkerLoop(i); });
+  }
+}
+
+inline BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  for (auto &worker : workers_) worker.join();
+  for (PredictorHandle handle : predictors_) MXPredFree(handle);
+}
+
+inline std::future<BatchingPredictorResult> BatchingPredictor::Predict(const mx_float *data) {
+  Request req;
+  req.data.assign(data, data + sample_size_);
+  req.arrival = std::chrono::steady_clock::now();
+  std::future<BatchingPredictorResult> ret = req.result.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(!stop_) << "BatchingPredictor is stopped";
+    queue_.push_back(std::move(req));
+  }
+  cond_.notify_all();
+  return ret;
+}
+
+inline size_t BatchingPredictor::num_batches() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_batches_;
+}
+
+inline size_t BatchingPredictor::num_requests() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_requests_;
+}
+
+inline void BatchingPredictor::WorkerLoop(int worker_id) {
+  std::vector<Request> batch;
+  while (NextBatch(&batch)) {
+    RunBatch(worker_id, &batch);
+  }
+}
+
+inline bool BatchingPredictor::NextBatch(std::vector<Request> *batch) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (queue_.empty()) {
+      if (stop_) return false;
+      cond_.wait(lock);
+      continue;
+    }
+    // wait for more requests until the batch is full or the oldest request is due
+    auto deadline = queue_.front().arrival + std::chrono::microseconds(config_.max_delay_us);
+    if (stop_ || queue_.size() >= config_.max_batch_size ||
+        std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    cond_.wait_until(lock, deadline);
+  }
+  size_t n = std::min(queue_.size(), static_cast<size_t>(config_.max_batch_size));
+  batch->clear();
+  for (size_t i = 0; i < n; ++i) {
+    batch->push_back(std::move(queue_.front()));
+    queue_.pop_front();
+  }
+  num_batches_ += 1;
+  num_requests_ += n;
+  if (!queue_.empty()) cond_.notify_all();
+  return true;
+}
+
+inline mx_uint BatchingPredictor::PaddedBatchSize(mx_uint n) const {
+  return *std::lower_bound(config_.batch_sizes.begin(), config_.batch_sizes.end(), n);
+}
+
+inline void BatchingPredictor::Reshape(int worker_id, mx_uint batch_size) {
+  if (predictor_batch_[worker_id] == batch_size) return;
+  std::vector<mx_uint> shape{batch_size};
+  shape.insert(shape.end(), sample_shape_.begin(), sample_shape_.end());
+  const char *keys[] = {input_name_.c_str()};
+  const mx_uint indptr[] = {0, static_cast<mx_uint>(shape.size())};
+  CHECK_EQ(MXPredReshape(predictors_[worker_id], 1, keys, indptr, shape.data()), 0)
+      << MXGetLastError();
+  predictor_batch_[worker_id] = batch_size;
+}
+
+inline void BatchingPredictor::RunBatch(int worker_id, std::vector<Request> *batch) {
+  const mx_uint n = static_cast<mx_uint>(batch->size());
+  PredictorHandle handle = predictors_[worker_id];
+  std::vector<BatchingPredictorResult> results(n, BatchingPredictorResult(num_outputs_));
+  try {
+    const mx_uint padded = PaddedBatchSize(n);
+    Reshape(worker_id, padded);
+    // gather, the padding rows stay zero
+    std::vector<mx_float> input(padded * sample_size_, 0.0f);
+    for (mx_uint i = 0; i < n; ++i) {
+      std::copy((*batch)[i].data.begin(), (*batch)[i].data.end(),
+                input.begin() + i * sample_size_);
+    }
+    CHECK_EQ(MXPredSetInput(handle, input_name_.c_str(), input.data(),
+                            static_cast<mx_uint>(input.size())), 0) << MXGetLastError();
+    CHECK_EQ(MXPredForward(handle), 0) << MXGetLastError();
+    // scatter
+    std::vector<mx_float> output;
+    for (mx_uint k = 0; k < num_outputs_; ++k) {
+      mx_uint *shape;
+      mx_uint ndim;
+      CHECK_EQ(MXPredGetOutputShape(handle, k, &shape, &ndim), 0) << MXGetLastError();
+      CHECK(ndim > 0 && shape[0] == padded)
+          << "BatchingPredictor: output " << k << " is not batched";
+      size_t size = 1;
+      for (mx_uint d = 0; d < ndim; ++d) size *= shape[d];
+      output.resize(size);
+      CHECK_EQ(MXPredGetOutput(handle, k, output.data(), static_cast<mx_uint>(size)), 0)
+          << MXGetLastError();
+      const size_t row = size / padded;
+      for (mx_uint i = 0; i < n; ++i) {
+        results[i][k].assign(output.begin() + i * row, output.begin() + (i + 1) * row);
+      }
+    }
+  } catch (...) {
+    for (auto &req : *batch) req.result.set_exception(std::current_exception());
+    return;
+  }
+  for (mx_uint i = 0; i < n; ++i) {
+    (*batch)[i].result.set_value(std::move(results[i]));
+  }
+}
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_BATCHING_PREDICTOR_HPP_
@@ -228,6 +228,30 @@ MXNET_DLL int MXSetProfilerState(int state);
 
 /*! \brief Save profile and stop profiler */
 MXNET_DLL int MXDumpProfile();
+/*!
+ * \brief Enable or disable the per-operator aggregate statistics,
+ *  which are collected while the profiler is running
+ * \param aggregate collect the statistics when aggregate != 0
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXSetProfilerAggregate(int aggregate);
+/*!
+ * \brief Get the aggregate statistics of every operator on every device
+ * \param out_str JSON object mapping device name to operator name to the
+ *  count, total, min, max, mean and p99 execution time in microseconds
+ * \param reset clear the statistics afterwards when reset != 0
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXAggregateProfileStats(const char **out_str, int reset);
+/*!
+ * \brief Get the memory statistics of every device used so far
+ * \param out_str JSON object mapping device name to the bytes in use, the peak
+ *  bytes in use, the number of allocations and frees, the memory pool hits
+ *  and misses and the bytes held by the memory pool
+ * \param reset_peak set the peaks to the current usage when reset_peak != 0
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXMemoryProfileStats(const char **out_str, int reset_peak);
 
 /*! \brief Set the number of OMP threads to use */
 MXNET_DLL int MXSetNumOMPThreads(int thread_num);
@@ -365,6 +389,57 @@ MXNET_DLL int MXNDArrayLoad(const char* fname,
                             NDArrayHandle** out_arr,
                             mx_uint *out_name_size,
                             const char*** out_names);
+/*!
+ * \brief Save list of narray into a file in the aligned format, which can be
+ *  memory-mapped by MXNDArrayLoadMapped and partially loaded by MXNDArrayLoadAligned.
+ * \param fname name of the file.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveAligned(const char* fname,
+                                   mx_uint num_args,
+                                   NDArrayHandle* args,
+                                   const char** keys);
+/*!
+ * \brief Load list of narray from a file. Files saved by MXNDArraySaveAligned
+ *  are memory-mapped copy-on-write and the returned cpu arrays point into the mapping,
+ *  other files are loaded as by MXNDArrayLoad.
+ * \param fname name of the file.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadMapped(const char* fname,
+                                  mx_uint *out_size,
+                                  NDArrayHandle** out_arr,
+                                  mx_uint *out_name_size,
+                                  const char*** out_names);
+/*!
+ * \brief Load all or some of the narrays of a file into new cpu arrays. Arrays of
+ *  files saved by MXNDArraySaveAligned are copied in parallel and can be checked
+ *  against their checksums, other files are loaded as by MXNDArrayLoad.
+ * \param fname name of the file.
+ * \param num_keys number of names to select, 0 to load all arrays.
+ * \param keys the names of the narrays to load.
+ * \param verify whether to check the checksums, 1 to check.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadAligned(const char* fname,
+                                   mx_uint num_keys,
+                                   const char** keys,
+                                   int verify,
+                                   mx_uint *out_size,
+                                   NDArrayHandle** out_arr,
+                                   mx_uint *out_name_size,
+                                   const char*** out_names);
 /*!
  * \brief Perform a synchronize copy from a continugous CPU memory region.
  *
@@ -1204,6 +1279,42 @@ MXNET_DLL int MXSymbolInferType(SymbolHandle sym,
                                 mx_uint *aux_type_size,
                                 const int **aux_type_data,
                                 int *complete);
+/*!
+ * \brief Convert a symbol into its quantized version, in which the quantizable
+ *  operators run on int8 data.
+ * \param sym_handle the symbol to convert.
+ * \param ret_sym_handle the returned quantized symbol.
+ * \param num_excluded_symbols number of nodes to keep in float.
+ * \param excluded_symbols names of the nodes to keep in float.
+ * \param num_offline number of parameters that are quantized offline.
+ * \param offline_params names of the parameters that are quantized offline, each
+ *  of them is replaced by the arguments <name>_quantize, <name>_quantize_min and
+ *  <name>_quantize_max.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXQuantizeSymbol(SymbolHandle sym_handle,
+                               SymbolHandle *ret_sym_handle,
+                               const mx_uint num_excluded_symbols,
+                               const char **excluded_symbols,
+                               const mx_uint num_offline,
+                               const char **offline_params);
+/*!
+ * \brief Set the ranges found by calibration to a quantized symbol.
+ * \param qsym_handle the quantized symbol.
+ * \param num_layers number of calibrated layers.
+ * \param layer_names names of the calibrated outputs of the float symbol,
+ *  as listed by its internals, e.g. conv0_output.
+ * \param low_quantiles minimum values of the calibrated outputs.
+ * \param high_quantiles maximum values of the calibrated outputs.
+ * \param ret_sym_handle the returned calibrated symbol.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSetCalibTableToQuantizedSymbol(SymbolHandle qsym_handle,
+                                               const mx_uint num_layers,
+                                               const char** layer_names,
+                                               const float* low_quantiles,
+                                               const float* high_quantiles,
+                                               SymbolHandle* ret_sym_handle);
 
 
 
@@ -1500,6 +1611,16 @@ MXNET_DLL int MXDataIterGetIndex(DataIterHandle handle,
 MXNET_DLL int MXDataIterGetPadNum(DataIterHandle handle,
                                   int *pad);
 
+/*!
+ * \brief Get the handle to the NDArray of per-sample augmentation parameters
+ *  in current data batch, e.g. from ImageRecordUInt8Iter with output_aug_params.
+ * \param handle the handle pointer to the data iterator
+ * \param out the handle to underlying NDArray, NULL if the iterator has none
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXDataIterGetAugParams(DataIterHandle handle,
+                                     NDArrayHandle *out);
+
 /*!
  * \brief Get the handle to the NDArray of underlying label
  * \param handle the handle pointer to the data iterator
@@ -1655,6 +1776,36 @@ MXNET_DLL int MXKVStorePullRowSparseEx(KVStoreHandle handle,
                                        NDArrayHandle* vals,
                                        const NDArrayHandle* row_ids,
                                        int priority);
+/*!
+ * \brief announce the row_ids of a coming row_sparse pull of a list of keys,
+ *        where each key is an integer, so that the rows can be prefetched.
+ * \param handle handle to the kvstore
+ * \param num the number of keys
+ * \param keys the list of keys
+ * \param row_ids the list of row_id NDArrays
+ * \param priority the priority of the action
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXKVStorePrefetchRowSparse(KVStoreHandle handle,
+                                         mx_uint num,
+                                         const int* keys,
+                                         const NDArrayHandle* row_ids,
+                                         int priority);
+/*!
+ * \brief announce the row_ids of a coming row_sparse pull of a list of keys,
+ *        where each key is a string, so that the rows can be prefetched.
+ * \param handle handle to the kvstore
+ * \param num the number of keys
+ * \param keys the list of keys
+ * \param row_ids the list of row_id NDArrays
+ * \param priority the priority of the action
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXKVStorePrefetchRowSparseEx(KVStoreHandle handle,
+                                           mx_uint num,
+                                           const char** keys,
+                                           const NDArrayHandle* row_ids,
+                                           int priority);
 
 /*!
  * \brief user-defined updater for the kvstore
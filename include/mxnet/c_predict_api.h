@@ -118,6 +118,109 @@ MXNET_DLL int MXPredCreatePartialOut(const char* symbol_json_str,
                                      mx_uint num_output_nodes,
                                      const char** output_keys,
                                      PredictorHandle* out);
+/*!
+ * \brief create a predictor with parameters loaded from a file.
+ *  A parameter file saved in the aligned format (mx.nd.save(..., aligned=True))
+ *  is memory-mapped and, on cpu, its arrays are bound without copying, so that
+ *  processes running the same model share the weights through the page cache.
+ *  Other parameter files are read as by MXPredCreate.
+ * \param symbol_json_str The JSON string of the symbol.
+ * \param param_file The path of the parameter file.
+ * \param dev_type The device type, 1: cpu, 2:gpu
+ * \param dev_id The device id of the predictor.
+ * \param num_input_nodes Number of input nodes to the net.
+ * \param input_keys The name of input argument.
+ * \param input_shape_indptr Index pointer of shapes of each input node.
+ *    The length of this array = num_input_nodes + 1.
+ * \param input_shape_data A flatted data of shapes of each input node.
+ * \param out The created predictor handle.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredCreateFromFile(const char* symbol_json_str,
+                                   const char* param_file,
+                                   int dev_type, int dev_id,
+                                   mx_uint num_input_nodes,
+                                   const char** input_keys,
+                                   const mx_uint* input_shape_indptr,
+                                   const mx_uint* input_shape_data,
+                                   PredictorHandle* out);
+/*!
+ * \brief create a predictor that shares the parameters of an existing one.
+ *  The new predictor binds its own executor with its own input arrays and
+ *  memory for intermediate results, while the weight and auxiliary state arrays
+ *  are shared with handle. Shared weights are read-only; it is safe to run the
+ *  predictors from different threads. handle can be freed before the predictors
+ *  created from it.
+ * \param handle The predictor whose parameters are shared.
+ * \param num_input_nodes Number of input nodes to the net.
+ * \param input_keys The name of input argument.
+ * \param input_shape_indptr Index pointer of shapes of each input node.
+ *    The length of this array = num_input_nodes + 1.
+ * \param input_shape_data A flatted data of shapes of each input node.
+ *    The shapes may differ from the ones of handle (e.g. in batch size)
+ *    as long as the parameter shapes stay the same.
+ * \param out The created predictor handle.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredCreateShared(PredictorHandle handle,
+                                 mx_uint num_input_nodes,
+                                 const char** input_keys,
+                                 const mx_uint* input_shape_indptr,
+                                 const mx_uint* input_shape_data,
+                                 PredictorHandle* out);
+/*!
+ * \brief create num_threads predictors sharing one copy of the parameters,
+ *  one for each inference thread. See MXPredCreateShared.
+ * \param symbol_json_str The JSON string of the symbol.
+ * \param param_bytes The in-memory raw bytes of parameter ndarray file.
+ * \param param_size The size of parameter ndarray file.
+ * \param dev_type The device type, 1: cpu, 2:gpu
+ * \param dev_id The device id of the predictor.
+ * \param num_input_nodes Number of input nodes to the net.
+ * \param input_keys The name of input argument.
+ * \param input_shape_indptr Index pointer of shapes of each input node.
+ * \param input_shape_data A flatted data of shapes of each input node.
+ * \param num_threads The number of predictors to create.
+ * \param out Array of num_threads handles to be filled, each has to be freed with MXPredFree.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredCreateMultiThread(const char* symbol_json_str,
+                                      const void* param_bytes,
+                                      int param_size,
+                                      int dev_type, int dev_id,
+                                      mx_uint num_input_nodes,
+                                      const char** input_keys,
+                                      const mx_uint* input_shape_indptr,
+                                      const mx_uint* input_shape_data,
+                                      int num_threads,
+                                      PredictorHandle* out);
+/*!
+ * \brief change the input shapes of a predictor, e.g. its batch size, keeping its weights.
+ *  Shapes are re-inferred and a new executor is bound that reuses the memory of the
+ *  previous one. Executors of recently used shapes are cached in the predictor
+ *  (see MXNET_PREDICTOR_EXEC_CACHE_SIZE), so switching back to them costs nothing.
+ *  Inputs have to be set again after reshaping.
+ * \param handle The predictor handle.
+ * \param num_input_nodes Number of input nodes to the net.
+ * \param input_keys The name of input argument.
+ * \param input_shape_indptr Index pointer of shapes of each input node.
+ *    The length of this array = num_input_nodes + 1.
+ * \param input_shape_data A flatted data of shapes of each input node.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredReshape(PredictorHandle handle,
+                            mx_uint num_input_nodes,
+                            const char** input_keys,
+                            const mx_uint* input_shape_indptr,
+                            const mx_uint* input_shape_data);
+/*!
+ * \brief Get the number of output nodes.
+ * \param handle The handle of the predictor.
+ * \param num_outputs Used to hold the number of output nodes.
+ * \return 0 when success, -1 when failure.
+ */
+MXNET_DLL int MXPredGetNumOutputs(PredictorHandle handle,
+                                  mx_uint* num_outputs);
 /*!
  * \brief Get the shape of output node.
  *  The returned shape_data and shape_ndim is only valid before next call to MXPred function.
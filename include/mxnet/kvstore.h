@@ -198,6 +198,30 @@ class KVStore {
                              const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
                              int priority = 0) = 0;
 
+  /*!
+   * \brief announce the row_ids of a coming PullRowSparse, so that the rows can be
+   *        fetched while the current batch is computing. A following PullRowSparse
+   *        of the same key with the same row_ids uses the prefetched rows, and the
+   *        prefetched rows a local Push updates are fetched again after the Push.
+   *        Stores with no pull latency ignore it.
+   * \param keys the list of keys
+   * \param row_ids the list of row_id NDArrays
+   * \param priority the priority of the action.
+   */
+  virtual void PrefetchRowSparse(const std::vector<int>& keys,
+                                 const std::vector<NDArray>& row_ids,
+                                 int priority = 0) { }
+
+  /*!
+   * \brief announce the row_ids of a coming PullRowSparse, where each key is a string.
+   * \param keys the list of keys in string format
+   * \param row_ids the list of row_id NDArrays
+   * \param priority the priority of the action.
+   */
+  virtual void PrefetchRowSparse(const std::vector<std::string>& str_keys,
+                                 const std::vector<NDArray>& row_ids,
+                                 int priority = 0) { }
+
   /**
    * \brief the prototype of user-defined updater
    */
@@ -172,6 +172,15 @@ class NDArray {
   }
 
 
+  /*!
+   * \brief keep `owner` alive as long as this NDArray, which must be constructed
+   *  from TBlobs pointing into memory held by `owner`, e.g. a file mapping
+   */
+  inline void KeepStaticDataAlive(const std::shared_ptr<void> &owner) {
+    CHECK(ptr_ != nullptr && ptr_->static_data)
+        << "KeepStaticDataAlive is only for NDArrays constructed from TBlobs";
+    ptr_->static_data_owner = owner;
+  }
   /*!
    * \return the shape of current NDArray.
    */
@@ -592,6 +601,51 @@ class NDArray {
   static void Load(dmlc::Stream* fi,
                    std::vector<NDArray>* data,
                    std::vector<std::string>* keys);
+  /*!
+   * \brief Save list of ndarray in the aligned format, in which the data of
+   *  every array starts at a multiple of 64 bytes so that it can be used in place
+   *  by LoadMapped, followed by an index with the offset and the checksum of every
+   *  array. The copies to cpu of all arrays are started at once and overlap with
+   *  writing the arrays before them; checksums are computed in parallel.
+   * \param fo The stream of output.
+   * \param data the NDArrays to be saved.
+   * \param names the name of the NDArray, optional, can be zero length.
+   */
+  static void SaveAligned(dmlc::Stream* fo,
+                          const std::vector<NDArray>& data,
+                          const std::vector<std::string>& names);
+  /*!
+   * \brief Load list of ndarray from a file. Files in the aligned format are
+   *  memory-mapped copy-on-write and the returned cpu NDArrays point into the mapping,
+   *  which is shared with other processes through the page cache and released
+   *  with the last of these arrays. Writing to an array copies the pages written
+   *  and leaves the file unchanged.
+   *  Files in the format of Save are loaded with Load.
+   * \param fname The name of the file.
+   * \param data the NDArrays to be loaded
+   * \param keys the name of the NDArray, if saved in the file.
+   * \return whether the arrays point into a mapping of the file
+   */
+  static bool LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys);
+  /*!
+   * \brief Load all or some of the ndarrays of a file into cpu memory owned by
+   *  the returned NDArrays. Files in the aligned format are memory-mapped and their
+   *  arrays copied, and optionally checked against the checksums, in parallel;
+   *  only the pages of the selected arrays are read from disk.
+   *  Files in the format of Save are loaded with Load.
+   * \param fname The name of the file.
+   * \param select names of the arrays to load, empty to load all of them.
+   * \param verify whether to check the checksums of the arrays of an aligned file.
+   * \param data the NDArrays to be loaded, in the order of select.
+   * \param keys the name of the NDArray, if saved in the file.
+   */
+  static void LoadAligned(const std::string& fname,
+                          const std::vector<std::string>& select,
+                          bool verify,
+                          std::vector<NDArray>* data,
+                          std::vector<std::string>* keys);
 
  private:
   friend class Imperative;
@@ -633,6 +687,8 @@ class NDArray {
     // The shape of aux data. The default value for the shape depends on the type of storage.
     // If aux_shapes[i].Size() is zero, aux data i is empty.
     std::vector<TShape> aux_shapes;
+    /*! \brief keeps the memory of static data alive, e.g. a file mapping */
+    std::shared_ptr<void> static_data_owner;
 
     /*! \brief default cosntructor */
     Chunk() : static_data(true), delay_alloc(false) {}
@@ -817,7 +873,8 @@ class NDArray {
       bool skip_free = static_data || delay_alloc;
       Storage::Handle h = this->shandle;
       std::vector<Storage::Handle> aux_h = this->aux_handles;
-      Engine::Get()->DeleteVariable([h, aux_h, skip_free](RunContext s) {
+      std::shared_ptr<void> owner = this->static_data_owner;
+      Engine::Get()->DeleteVariable([h, aux_h, skip_free, owner](RunContext s) {
         if (skip_free == false) {
           Storage::Get()->Free(h);
           for (size_t i = 0; i < aux_h.size(); i++) {
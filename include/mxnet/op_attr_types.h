@@ -262,6 +262,23 @@ using FInferStorageType = std::function<bool (const NodeAttrs& attrs,
                                               std::vector<int>* in_attrs,
                                               std::vector<int>* out_attrs)>;
 
+/*!
+ * \brief Create the node of the quantized version of an operator, which takes
+ *  int8 data, followed by the min and max ranges of every data input, and
+ *  produces its outputs followed by their min and max ranges. Returns nullptr
+ *  when the configuration given by attrs has no quantized version.
+ *
+ * \note Register under "FQuantizedOp"
+ */
+using FQuantizedOp = std::function<nnvm::NodePtr (const NodeAttrs& attrs)>;
+/*!
+ * \brief Whether the int32 output of a quantized operator has to be converted
+ *  back to int8 by requantize before being fed to another quantized operator.
+ *
+ * \note Register under "FNeedRequantize"
+ */
+using FNeedRequantize = std::function<bool (const NodeAttrs& attrs)>;
+
 }  // namespace mxnet
 
 #endif  // MXNET_OP_ATTR_TYPES_H_
@@ -26,3 +26,4 @@ from . import ndarray as nd
 
 from . import autograd
 from . import tensorboard
+from . import quantization
@@ -0,0 +1,192 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+
+# coding: utf-8
+"""Quantization of float models into models running int8 operators on cpu."""
+from __future__ import absolute_import
+
+import ctypes
+import logging
+from ..base import _LIB, check_call
+from ..base import c_array, c_str, mx_uint, SymbolHandle
+from ..context import cpu
+from ..symbol import Symbol, Group
+from .. import ndarray
+
+
+def _quantize_params(qsym, params):
+    """Quantizes the parameters that qsym takes in quantized form, i.e. the arguments
+    ``<name>_quantize``, ``<name>_quantize_min`` and ``<name>_quantize_max``, and
+    copies the other parameters that qsym takes."""
+    quantized_params = {}
+    for name in qsym.list_arguments():
+        if name.endswith('_quantize'):
+            param = params[name[:-len('_quantize')]]
+            val, vmin, vmax = ndarray.contrib.quantize(data=param,
+                                                       min_range=ndarray.min(param),
+                                                       max_range=ndarray.max(param),
+                                                       out_type='int8')
+            quantized_params[name] = val
+            quantized_params[name + '_min'] = vmin
+            quantized_params[name + '_max'] = vmax
+        elif name in params:
+            quantized_params[name] = params[name]
+    return quantized_params
+
+
+def quantize_symbol(sym, excluded_sym_names=None, offline_params=None):
+    """Converts a symbol into its quantized version, in which convolution, fully
+    connected and pooling layers run on int8 data.
+
+    Parameters
+    ----------
+    sym : Symbol
+        The float symbol.
+    excluded_sym_names : list of str
+        Names of the layers to keep in float.
+    offline_params : list of str
+        Names of the parameters to quantize offline, see ``quantize_model``.
+
+    Returns
+    -------
+    Symbol
+        The quantized symbol.
+    """
+    excluded_sym_names = excluded_sym_names or []
+    offline_params = offline_params or []
+    out = SymbolHandle()
+    check_call(_LIB.MXQuantizeSymbol(sym.handle,
+                                     ctypes.byref(out),
+                                     mx_uint(len(excluded_sym_names)),
+                                     c_array(ctypes.c_char_p,
+                                             [c_str(s) for s in excluded_sym_names]),
+                                     mx_uint(len(offline_params)),
+                                     c_array(ctypes.c_char_p,
+                                             [c_str(s) for s in offline_params])))
+    return Symbol(out)
+
+
+def _calibrate_quantized_sym(qsym, th_dict):
+    """Sets the ranges in th_dict, a dict from layer output names to (min, max),
+    to the requantize operators of qsym."""
+    if th_dict is None or len(th_dict) == 0:
+        return qsym
+    layer_names = list(th_dict.keys())
+    low = [float(th_dict[name][0]) for name in layer_names]
+    high = [float(th_dict[name][1]) for name in layer_names]
+    calibrated_sym = SymbolHandle()
+    check_call(_LIB.MXSetCalibTableToQuantizedSymbol(qsym.handle,
+                                                     mx_uint(len(layer_names)),
+                                                     c_array(ctypes.c_char_p,
+                                                             [c_str(s) for s in layer_names]),
+                                                     c_array(ctypes.c_float, low),
+                                                     c_array(ctypes.c_float, high),
+                                                     ctypes.byref(calibrated_sym)))
+    return Symbol(calibrated_sym)
+
+
+def _collect_layer_output_min_max(sym, layer_names, arg_params, aux_params, calib_data,
+                                  data_names, ctx, max_num_examples, logger):
+    """Runs the float symbol on calib_data and returns the min and max of the
+    outputs in layer_names."""
+    from ..module import Module
+    internals = sym.get_internals()
+    group = Group([internals[name] for name in layer_names])
+    mod = Module(symbol=group, data_names=data_names, label_names=None, context=ctx)
+    mod.bind(for_training=False, data_shapes=calib_data.provide_data)
+    mod.set_params(arg_params, aux_params, allow_extra=True)
+    th_dict = {}
+    num_examples = 0
+    calib_data.reset()
+    for batch in calib_data:
+        mod.forward(batch, is_train=False)
+        for name, out in zip(layer_names, mod.get_outputs()):
+            vmin = ndarray.min(out).asscalar()
+            vmax = ndarray.max(out).asscalar()
+            if name in th_dict:
+                vmin = min(vmin, th_dict[name][0])
+                vmax = max(vmax, th_dict[name][1])
+            th_dict[name] = (vmin, vmax)
+        num_examples += calib_data.batch_size
+        if max_num_examples is not None and num_examples >= max_num_examples:
+            break
+    logger.info('Collected the ranges of %d layer outputs from %d examples',
+                len(layer_names), num_examples)
+    return th_dict
+
+
+def quantize_model(sym, arg_params, aux_params, data_names=('data',), ctx=cpu(),
+                   excluded_sym_names=None, calib_mode='none', calib_data=None,
+                   num_calib_examples=None, logger=logging):
+    """Converts a float model into a model that runs its convolution, fully
+    connected and pooling layers on int8 data with int32 accumulation.
+
+    The weights and biases of the quantized layers are quantized offline. The
+    int32 outputs of convolution and fully connected layers are converted back to
+    int8 with the range of their float counterparts, which is either found at runtime
+    (``calib_mode='none'``) or collected beforehand by running the float model on
+    ``calib_data`` (``calib_mode='naive'``), which is faster and more accurate.
+
+    Parameters
+    ----------
+    sym : Symbol
+        The float symbol, whose label outputs are ignored.
+    arg_params : dict of str to NDArray
+        The float parameters.
+    aux_params : dict of str to NDArray
+        The auxiliary states.
+    data_names : tuple of str
+        Names of the data inputs.
+    ctx : Context
+        The context to run calibration on.
+    excluded_sym_names : list of str
+        Names of the layers to keep in float.
+    calib_mode : str
+        'none' or 'naive'.
+    calib_data : DataIter
+        Sample batches for calibration, required when calib_mode is 'naive'.
+    num_calib_examples : int
+        Maximum number of examples used for calibration, all of calib_data if None.
+    logger : Object
+        A logging object for printing information during the process of quantization.
+
+    Returns
+    -------
+    tuple
+        The quantized symbol, its arguments and its auxiliary states.
+    """
+    if calib_mode not in ('none', 'naive'):
+        raise ValueError('unknown calib_mode %s, expected none or naive' % calib_mode)
+    offline_params = [name for name in sym.list_arguments()
+                      if name in arg_params and name not in data_names]
+    qsym = quantize_symbol(sym, excluded_sym_names=excluded_sym_names,
+                           offline_params=offline_params)
+    if calib_mode == 'naive':
+        if calib_data is None:
+            raise ValueError('calib_data must be provided when calib_mode is naive')
+        # the requantize output of quantized_<layer> takes the range of <layer>_output
+        prefix, suffix = 'quantized_', '_requantize_output'
+        layer_names = [name[len(prefix):-len(suffix)] + '_output'
+                       for name in qsym.get_internals().list_outputs()
+                       if name.startswith(prefix) and name.endswith(suffix)]
+        th_dict = _collect_layer_output_min_max(sym, layer_names, arg_params, aux_params,
+                                                calib_data, list(data_names), ctx,
+                                                num_calib_examples, logger)
+        qsym = _calibrate_quantized_sym(qsym, th_dict)
+    qarg_params = _quantize_params(qsym, arg_params)
+    return qsym, qarg_params, aux_params
@@ -758,12 +758,17 @@ class MXDataIter(DataIter):
         Data name. Default to "data".
     label_name : str, optional
         Label name. Default to "softmax_label".
+    aug_params_name : str, optional
+        Name of the per-sample augmentation parameters, provided as a second
+        data entry by iterators that output them, e.g. `ImageRecordUInt8Iter`
+        with ``output_aug_params=True``. Default to "aug_params".
 
     See Also
     --------
     src/io : The underlying C++ data iterator implementation, e.g., `CSVIter`.
     """
-    def __init__(self, handle, data_name='data', label_name='softmax_label', **_):
+    def __init__(self, handle, data_name='data', label_name='softmax_label',
+                 aug_params_name='aug_params', **_):
         super(MXDataIter, self).__init__()
         self.handle = handle
         # debug option, used to test the speed with io effect eliminated
@@ -777,6 +782,10 @@ class MXDataIter(DataIter):
 
         # properties
         self.provide_data = [DataDesc(data_name, data.shape, data.dtype)]
+        if len(self.first_batch.data) > 1:
+            aug_params = self.first_batch.data[1]
+            self.provide_data.append(DataDesc(aug_params_name, aug_params.shape,
+                                              aug_params.dtype))
         self.provide_label = [DataDesc(label_name, label.shape, label.dtype)]
         self.batch_size = data.shape[0]
 
@@ -797,8 +806,8 @@ class MXDataIter(DataIter):
 
     def next(self):
         if self._debug_skip_load and not self._debug_at_begin:
-            return  DataBatch(data=[self.getdata()], label=[self.getlabel()], pad=self.getpad(),
-                              index=self.getindex())
+            return  DataBatch(data=self._getbatchdata(), label=[self.getlabel()],
+                              pad=self.getpad(), index=self.getindex())
         if self.first_batch is not None:
             batch = self.first_batch
             self.first_batch = None
@@ -807,8 +816,8 @@ class MXDataIter(DataIter):
         next_res = ctypes.c_int(0)
         check_call(_LIB.MXDataIterNext(self.handle, ctypes.byref(next_res)))
         if next_res.value:
-            return DataBatch(data=[self.getdata()], label=[self.getlabel()], pad=self.getpad(),
-                             index=self.getindex())
+            return DataBatch(data=self._getbatchdata(), label=[self.getlabel()],
+                             pad=self.getpad(), index=self.getindex())
         else:
             raise StopIteration
 
@@ -829,6 +838,28 @@ class MXDataIter(DataIter):
         check_call(_LIB.MXDataIterGetLabel(self.handle, ctypes.byref(hdl)))
         return _ndarray_cls(hdl, False)
 
+    def getaugparams(self):
+        """Get the per-sample augmentation parameters of the current batch.
+
+        Returns
+        -------
+        NDArray or None
+            Array of shape (batch_size, 3) holding (mirror, contrast, illumination),
+            or None if the underlying iterator does not output them.
+        """
+        hdl = NDArrayHandle()
+        check_call(_LIB.MXDataIterGetAugParams(self.handle, ctypes.byref(hdl)))
+        if not hdl.value:
+            return None
+        return _ndarray_cls(hdl, False)
+
+    def _getbatchdata(self):
+        data = [self.getdata()]
+        aug_params = self.getaugparams()
+        if aug_params is not None:
+            data.append(aug_params)
+        return data
+
     def getindex(self):
         index_size = ctypes.c_uint64(0)
         index_data = ctypes.POINTER(ctypes.c_uint64)()
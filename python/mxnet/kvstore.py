@@ -349,6 +349,44 @@ class KVStore(object):
             check_call(_LIB.MXKVStorePullRowSparse(
                 self.handle, mx_uint(len(ckeys)), ckeys, cvals, crow_ids, ctypes.c_int(priority)))
 
+    def row_sparse_prefetch(self, key, row_ids, priority=0):
+        """ Announces the row_ids of a coming `row_sparse_pull`, so that the rows can be \
+        fetched while the current batch is being computed.
+
+        With a distributed kvstore, the rows are fetched into a buffer once the last
+        `push` of the same key is finished. A following `row_sparse_pull` of the key
+        whose row_ids have the same unique values uses the fetched rows. Rows that a
+        `push` from this worker updates in between are fetched again after the push.
+        Rows updated only by other workers are not, so with ``dist_sync`` they may
+        miss the last update; prefetching is meant for ``dist_async`` training.
+        Other kvstores have no pull latency to hide and ignore the call.
+
+        Parameters
+        ----------
+        key : str, int, or sequence of str or int
+            Keys.
+
+        row_ids : NDArray or list of NDArray
+            The row_ids which will be pulled for each key.
+
+        priority : int, optional
+            The priority of the prefetch operation.
+
+        Examples
+        --------
+        >>> kv.row_sparse_pull('3', out=a, row_ids=row_ids)
+        >>> kv.row_sparse_prefetch('3', row_ids=next_row_ids)
+        >>> # compute on a and push the gradient
+        >>> kv.row_sparse_pull('3', out=a, row_ids=next_row_ids)
+        """
+        ckeys, crow_ids, use_str_keys = _ctype_key_value(key, row_ids)
+        if use_str_keys:
+            check_call(_LIB.MXKVStorePrefetchRowSparseEx(
+                self.handle, mx_uint(len(ckeys)), ckeys, crow_ids, ctypes.c_int(priority)))
+        else:
+            check_call(_LIB.MXKVStorePrefetchRowSparse(
+                self.handle, mx_uint(len(ckeys)), ckeys, crow_ids, ctypes.c_int(priority)))
+
 
     def set_optimizer(self, optimizer):
         """ Registers an optimizer with the kvstore.
@@ -395,6 +433,36 @@ class KVStore(object):
         else:
             self._set_updater(opt.get_updater(optimizer))
 
+    def set_sparse_optimizer(self, optimizer='sgd', **kwargs):
+        """ Updates the row_sparse keys with an optimizer that runs on the servers.
+
+        Only works for distributed kvstores and should be invoked from a worker node.
+        The servers keep each row_sparse key in hash partitions of rows, each row
+        next to its optimizer state, and apply the optimizer to the rows pushed to
+        them. Rows that were never initialized with non-zero values or pushed take
+        no memory and are pulled as zeros. Keys with default storage are still
+        updated by the optimizer registered with `set_optimizer`.
+
+        Parameters
+        ----------
+        optimizer : str
+            One of 'sgd', 'adam', 'ftrl' and 'adagrad'.
+        kwargs
+            Hyper-parameters of the optimizer, among lr, wd, rescale_grad,
+            clip_gradient, momentum, beta1, beta2, epsilon, lamda1 and beta,
+            and num_partitions, the number of hash partitions per key.
+
+        Examples
+        --------
+        >>> kv = mx.kv.create('dist_async')
+        >>> kv.set_sparse_optimizer('adam', lr=0.001, rescale_grad=1.0/128)
+        """
+        assert 'dist' in self.type, "set_sparse_optimizer requires a distributed kvstore"
+        kwargs['optimizer'] = optimizer
+        body = ','.join('%s=%s' % (k, v) for k, v in kwargs.items())
+        # kSetRowOptimizer in src/kvstore/kvstore_dist_server.h
+        self._send_command_to_servers(-3, body)
+
     @property
     def type(self):
         """ Returns the type of this kvstore.
@@ -529,7 +597,7 @@ class KVStore(object):
             the body of the command.
         """
         check_call(_LIB.MXKVStoreSendCommmandToServers(
-            self.handle, mx_uint(head), c_str(body)))
+            self.handle, ctypes.c_int(head), c_str(body)))
 
 def create(name='local'):
     """Creates a new KVStore.
@@ -145,7 +145,7 @@ def array(source_array, ctx=None, dtype=None):
         return _array(source_array, ctx=ctx, dtype=dtype)
 
 
-def load(fname):
+def load(fname, mmap=False, keys=None, verify=False):
     """Loads an array from file.
 
     See more details in ``save``.
@@ -154,6 +154,19 @@ def load(fname):
     ----------
     fname : str
         The filename.
+    mmap : bool, optional
+        If True and the file was saved with ``aligned=True``, the file is
+        memory-mapped and the returned cpu arrays point into the mapping
+        without copying. Their pages are shared with other processes mapping
+        the same file until they are written to, which copies the pages
+        written and leaves the file unchanged. Other files are loaded normally.
+    keys : list of str, optional
+        Load only the arrays with these names into new cpu arrays and return
+        them as a dict. Only the selected arrays of a file saved with
+        ``aligned=True`` are read from disk.
+    verify : bool, optional
+        Check the arrays of a file saved with ``aligned=True`` against the
+        checksums stored in it and raise an error if they do not match.
 
     Returns
     -------
@@ -167,11 +180,25 @@ def load(fname):
     out_name_size = mx_uint()
     handles = ctypes.POINTER(NDArrayHandle)()
     names = ctypes.POINTER(ctypes.c_char_p)()
-    check_call(_LIB.MXNDArrayLoad(c_str(fname),
-                                  ctypes.byref(out_size),
-                                  ctypes.byref(handles),
-                                  ctypes.byref(out_name_size),
-                                  ctypes.byref(names)))
+    if keys is not None or verify:
+        if mmap:
+            raise ValueError('keys and verify cannot be used with mmap')
+        keys = [] if keys is None else keys
+        check_call(_LIB.MXNDArrayLoadAligned(c_str(fname),
+                                             mx_uint(len(keys)),
+                                             c_array(ctypes.c_char_p, [c_str(k) for k in keys]),
+                                             ctypes.c_int(verify),
+                                             ctypes.byref(out_size),
+                                             ctypes.byref(handles),
+                                             ctypes.byref(out_name_size),
+                                             ctypes.byref(names)))
+    else:
+        load_fn = _LIB.MXNDArrayLoadMapped if mmap else _LIB.MXNDArrayLoad
+        check_call(load_fn(c_str(fname),
+                           ctypes.byref(out_size),
+                           ctypes.byref(handles),
+                           ctypes.byref(out_name_size),
+                           ctypes.byref(names)))
     if out_name_size.value == 0:
         return [_ndarray_cls(NDArrayHandle(handles[i])) for i in range(out_size.value)]
     else:
@@ -181,7 +208,7 @@ def load(fname):
             for i in range(out_size.value))
 
 
-def save(fname, data):
+def save(fname, data, aligned=False):
     """Saves a list of arrays or a dict of str->array to file.
 
     Examples of filenames:
@@ -198,6 +225,11 @@ def save(fname, data):
            or list of NDArray, RowSparseNDArray or CSRNDArray, \
            or dict of str to NDArray, RowSparseNDArray or CSRNDArray
         The data to save.
+    aligned : bool, optional
+        Save in the aligned format, in which the data of every array starts at
+        a multiple of 64 bytes, so that ``load(fname, mmap=True)`` can use it in
+        place. The file also stores the offset and the checksum of every array,
+        which allows ``load`` to read some arrays only and to verify them.
 
     Examples
     --------
@@ -232,7 +264,8 @@ def save(fname, data):
     else:
         raise ValueError("data needs to either be a NDArray, dict of str, NDArray pairs "
                          "or a list of NDarrays.")
-    check_call(_LIB.MXNDArraySave(c_str(fname),
-                                  mx_uint(len(handles)),
-                                  c_array(NDArrayHandle, handles),
-                                  keys))
+    save_fn = _LIB.MXNDArraySaveAligned if aligned else _LIB.MXNDArraySave
+    check_call(save_fn(c_str(fname),
+                       mx_uint(len(handles)),
+                       c_array(NDArrayHandle, handles),
+                       keys))
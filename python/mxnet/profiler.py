@@ -22,9 +22,10 @@
 from __future__ import absolute_import
 
 import ctypes
-from .base import _LIB, check_call, c_str
+import json
+from .base import _LIB, check_call, c_str, py_str
 
-def profiler_set_config(mode='symbolic', filename='profile.json'):
+def profiler_set_config(mode='symbolic', filename='profile.json', aggregate_stats=None):
     """Set up the configure of profiler.
 
     Parameters
@@ -34,11 +35,17 @@ def profiler_set_config(mode='symbolic', filename='profile.json'):
         be 'symbolic', or 'all'. Defaults to `symbolic`.
     filename : string, optional
         The name of output trace file. Defaults to 'profile.json'.
+    aggregate_stats : boolean, optional
+        Whether to collect per-operator statistics, see `aggregate_stats`.
+        Defaults to None, which keeps the current setting, initially the value
+        of MXNET_PROFILER_AGGREGATE.
     """
     mode2int = {'symbolic': 0, 'all': 1}
     check_call(_LIB.MXSetProfilerConfig(
         ctypes.c_int(mode2int[mode]),
         c_str(filename)))
+    if aggregate_stats is not None:
+        check_call(_LIB.MXSetProfilerAggregate(ctypes.c_int(int(aggregate_stats))))
 
 def profiler_set_state(state='stop'):
     """Set up the profiler state to record operator.
@@ -56,3 +63,44 @@ def dump_profile():
     """Dump profile and stop profiler. Use this to save profile
     in advance in case your program cannot exit normally."""
     check_call(_LIB.MXDumpProfile())
+
+def aggregate_stats(reset=False):
+    """Get the per-operator statistics collected while the profiler runs
+    with `aggregate_stats=True`.
+
+    Parameters
+    ----------
+    reset : boolean, optional
+        Whether to clear the statistics afterwards.
+
+    Returns
+    -------
+    dict
+        Maps device name, e.g. 'cpu/0', to operator name to a dict with
+        the 'count', 'total', 'min', 'max', 'mean' and 'p99' execution
+        time in microseconds, the number of temporary space requests
+        'temp_space_requests' and the largest one in bytes 'temp_space_max'.
+    """
+    out = ctypes.c_char_p()
+    check_call(_LIB.MXAggregateProfileStats(ctypes.byref(out), ctypes.c_int(int(reset))))
+    return json.loads(py_str(out.value))
+
+def memory_stats(reset_peak=False):
+    """Get the storage statistics of every device used so far.
+
+    Parameters
+    ----------
+    reset_peak : boolean, optional
+        Whether to set the peak usage to the current usage afterwards.
+
+    Returns
+    -------
+    dict
+        Maps device name, e.g. 'gpu/0', to a dict with the bytes in use 'used',
+        the peak bytes in use 'peak', the number of allocations 'num_alloc' and
+        frees 'num_free', the memory pool 'pool_hits' and 'pool_misses', and the
+        bytes held by the memory pool 'pool_reserved'.
+    """
+    out = ctypes.c_char_p()
+    check_call(_LIB.MXMemoryProfileStats(ctypes.byref(out), ctypes.c_int(int(reset_peak))))
+    return json.loads(py_str(out.value))
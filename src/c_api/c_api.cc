@@ -130,6 +130,40 @@ int MXSetProfilerState(int state) {
   API_END();
 }
 
+int MXSetProfilerAggregate(int aggregate) {
+  API_BEGIN();
+#if MXNET_USE_PROFILER
+  engine::Profiler::Get()->SetAggregate(aggregate != 0);
+#else
+  LOG(FATAL) << "Need to compile with USE_PROFILER=1 for MXNet Profiler";
+#endif
+  API_END();
+}
+
+int MXAggregateProfileStats(const char **out_str, int reset) {
+  MXAPIThreadLocalEntry *ret = MXAPIThreadLocalStore::Get();
+  API_BEGIN();
+#if MXNET_USE_PROFILER
+  ret->ret_str = engine::Profiler::Get()->AggregateStats(reset != 0);
+  *out_str = ret->ret_str.c_str();
+#else
+  LOG(FATAL) << "Need to compile with USE_PROFILER=1 for MXNet Profiler";
+#endif
+  API_END();
+}
+
+int MXMemoryProfileStats(const char **out_str, int reset_peak) {
+  MXAPIThreadLocalEntry *ret = MXAPIThreadLocalStore::Get();
+  API_BEGIN();
+#if MXNET_USE_PROFILER
+  ret->ret_str = engine::Profiler::Get()->MemoryStats(reset_peak != 0);
+  *out_str = ret->ret_str.c_str();
+#else
+  LOG(FATAL) << "Need to compile with USE_PROFILER=1 for MXNet Profiler";
+#endif
+  API_END();
+}
+
 int MXSetNumOMPThreads(int thread_num) {
   API_BEGIN();
   omp_set_num_threads(thread_num);
@@ -343,6 +377,89 @@ int MXNDArrayLoad(const char* fname,
   API_END();
 }
 
+int MXNDArraySaveAligned(const char* fname,
+                         mx_uint num_args,
+                         NDArrayHandle* args,
+                         const char** keys) {
+  API_BEGIN();
+  std::vector<NDArray> data(num_args);
+  std::vector<std::string> names;
+  for (mx_uint i = 0; i < num_args; ++i) {
+    data[i] = *static_cast<NDArray*>(args[i]);
+  }
+  if (keys != nullptr) {
+    names.resize(num_args);
+    for (mx_uint i = 0; i < num_args; ++i) {
+      names[i] = keys[i];
+    }
+  }
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname, "w"));
+    mxnet::NDArray::SaveAligned(fo.get(), data, names);
+  }
+  API_END();
+}
+
+int MXNDArrayLoadMapped(const char* fname,
+                        mx_uint *out_size,
+                        NDArrayHandle** out_arr,
+                        mx_uint *out_name_size,
+                        const char*** out_names) {
+  MXAPIThreadLocalEntry *ret = MXAPIThreadLocalStore::Get();
+  ret->ret_vec_str.clear();
+  API_BEGIN();
+  std::vector<NDArray> data;
+  std::vector<std::string> &names = ret->ret_vec_str;
+  mxnet::NDArray::LoadMapped(fname, &data, &names);
+  ret->ret_handles.resize(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    NDArray *ptr = new NDArray();
+    *ptr = data[i];
+    ret->ret_handles[i] = ptr;
+  }
+  ret->ret_vec_charp.resize(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    ret->ret_vec_charp[i] = names[i].c_str();
+  }
+  *out_size = static_cast<mx_uint>(data.size());
+  *out_arr = dmlc::BeginPtr(ret->ret_handles);
+  *out_name_size = static_cast<mx_uint>(names.size());
+  *out_names = dmlc::BeginPtr(ret->ret_vec_charp);
+  API_END();
+}
+
+int MXNDArrayLoadAligned(const char* fname,
+                         mx_uint num_keys,
+                         const char** keys,
+                         int verify,
+                         mx_uint *out_size,
+                         NDArrayHandle** out_arr,
+                         mx_uint *out_name_size,
+                         const char*** out_names) {
+  MXAPIThreadLocalEntry *ret = MXAPIThreadLocalStore::Get();
+  ret->ret_vec_str.clear();
+  API_BEGIN();
+  std::vector<NDArray> data;
+  std::vector<std::string> &names = ret->ret_vec_str;
+  std::vector<std::string> select(keys, keys + num_keys);
+  mxnet::NDArray::LoadAligned(fname, select, verify != 0, &data, &names);
+  ret->ret_handles.resize(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    NDArray *ptr = new NDArray();
+    *ptr = data[i];
+    ret->ret_handles[i] = ptr;
+  }
+  ret->ret_vec_charp.resize(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    ret->ret_vec_charp[i] = names[i].c_str();
+  }
+  *out_size = static_cast<mx_uint>(data.size());
+  *out_arr = dmlc::BeginPtr(ret->ret_handles);
+  *out_name_size = static_cast<mx_uint>(names.size());
+  *out_names = dmlc::BeginPtr(ret->ret_vec_charp);
+  API_END();
+}
+
 int MXNDArrayFree(NDArrayHandle handle) {
   API_BEGIN();
   delete static_cast<NDArray*>(handle);
@@ -726,6 +843,19 @@ int MXDataIterGetPadNum(DataIterHandle handle, int *pad) {
   API_END();
 }
 
+int MXDataIterGetAugParams(DataIterHandle handle, NDArrayHandle *out) {
+  API_BEGIN();
+  const DataBatch& db = static_cast<IIterator<DataBatch>* >(handle)->Value();
+  if (db.data.size() > 2) {
+    NDArray* pndarray = new NDArray();
+    *pndarray = db.data[2];
+    *out = pndarray;
+  } else {
+    *out = nullptr;
+  }
+  API_END();
+}
+
 int MXKVStoreCreate(const char *type,
                     KVStoreHandle *out) {
   API_BEGIN();
@@ -869,6 +999,38 @@ int MXKVStorePullRowSparseEx(KVStoreHandle handle,
   API_END();
 }
 
+int MXKVStorePrefetchRowSparse(KVStoreHandle handle,
+                               mx_uint num,
+                               const int* keys,
+                               const NDArrayHandle* row_ids,
+                               int priority) {
+  API_BEGIN();
+  std::vector<int> v_keys(num);
+  std::vector<NDArray> v_row_ids(num);
+  for (mx_uint i = 0; i < num; ++i) {
+    v_keys[i] = keys[i];
+    v_row_ids[i] = *static_cast<NDArray*>(row_ids[i]);
+  }
+  static_cast<KVStore*>(handle)->PrefetchRowSparse(v_keys, v_row_ids, priority);
+  API_END();
+}
+
+int MXKVStorePrefetchRowSparseEx(KVStoreHandle handle,
+                                 mx_uint num,
+                                 const char** keys,
+                                 const NDArrayHandle* row_ids,
+                                 int priority) {
+  API_BEGIN();
+  std::vector<std::string> v_keys(num);
+  std::vector<NDArray> v_row_ids(num);
+  for (mx_uint i = 0; i < num; ++i) {
+    v_keys[i] = keys[i];
+    v_row_ids[i] = *static_cast<NDArray*>(row_ids[i]);
+  }
+  static_cast<KVStore*>(handle)->PrefetchRowSparse(v_keys, v_row_ids, priority);
+  API_END();
+}
+
 void MXKVStoreSetUpdaterImpl(KVStoreHandle handle,
                              MXKVStoreUpdater updater,
                              void* updater_handle) {
@@ -565,3 +565,46 @@ int MXSymbolGrad(SymbolHandle sym, mx_uint num_wrt, const char** wrt, SymbolHand
   LOG(FATAL) << "not implemented";
   API_END();
 }
+
+int MXQuantizeSymbol(SymbolHandle sym_handle,
+                     SymbolHandle *ret_sym_handle,
+                     const mx_uint num_excluded_symbols,
+                     const char **excluded_symbols,
+                     const mx_uint num_offline,
+                     const char **offline_params) {
+  nnvm::Symbol *s = new nnvm::Symbol();
+  API_BEGIN();
+  nnvm::Symbol *sym = static_cast<nnvm::Symbol*>(sym_handle);
+  nnvm::Graph g = Symbol2Graph(*sym);
+  std::unordered_set<std::string> excluded_nodes(excluded_symbols,
+                                                 excluded_symbols + num_excluded_symbols);
+  std::unordered_set<std::string> offline(offline_params, offline_params + num_offline);
+  g.attrs["excluded_nodes"] = std::make_shared<nnvm::any>(std::move(excluded_nodes));
+  g.attrs["offline_params"] = std::make_shared<nnvm::any>(std::move(offline));
+  g = nnvm::ApplyPass(std::move(g), "QuantizeGraph");
+  s->outputs = g.outputs;
+  *ret_sym_handle = s;
+  API_END_HANDLE_ERROR(delete s);
+}
+
+int MXSetCalibTableToQuantizedSymbol(SymbolHandle qsym_handle,
+                                     const mx_uint num_layers,
+                                     const char** layer_names,
+                                     const float* low_quantiles,
+                                     const float* high_quantiles,
+                                     SymbolHandle* ret_qsym_handle) {
+  nnvm::Symbol *s = new nnvm::Symbol();
+  API_BEGIN();
+  nnvm::Symbol *sym = static_cast<nnvm::Symbol*>(qsym_handle);
+  // the pass changes the nodes in place, work on a copy
+  nnvm::Graph g = Symbol2Graph(sym->Copy());
+  std::unordered_map<std::string, std::pair<float, float> > calib_table;
+  for (mx_uint i = 0; i < num_layers; ++i) {
+    calib_table[layer_names[i]] = std::make_pair(low_quantiles[i], high_quantiles[i]);
+  }
+  g.attrs["calib_table"] = std::make_shared<nnvm::any>(std::move(calib_table));
+  g = nnvm::ApplyPass(std::move(g), "SetCalibTableToQuantizedGraph");
+  s->outputs = g.outputs;
+  *ret_qsym_handle = s;
+  API_END_HANDLE_ERROR(delete s);
+}
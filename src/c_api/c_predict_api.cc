@@ -27,7 +27,10 @@
 #include <mxnet/executor.h>
 #include <mxnet/ndarray.h>
 #include <nnvm/pass_functions.h>
+#include <list>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <unordered_set>
 #include <unordered_map>
 #include "./c_api_common.h"
@@ -36,6 +39,16 @@
 
 using namespace mxnet;
 
+// executor bound for one set of input shapes, cached by MXPredReshape
+struct MXAPIPredExecutor {
+  // key of the input shapes
+  std::string shape_key;
+  std::vector<NDArray> out_arrays;
+  std::vector<NDArray> arg_arrays;
+  std::vector<TShape> out_shapes;
+  std::unique_ptr<Executor> exec;
+};
+
 // predictor interface
 struct MXAPIPredictor {
   // output arrays
@@ -46,10 +59,23 @@ struct MXAPIPredictor {
   std::vector<TShape> out_shapes;
   // uint32_t buffer for output shapes
   std::vector<uint32_t> out_shapes_buffer;
+  // auxiliary state arrays
+  std::vector<NDArray> aux_arrays;
   // key to arguments
   std::unordered_map<std::string, size_t> key2arg;
+  // names of the arguments loaded from the parameter file,
+  // these are shared by predictors created with MXPredCreateShared
+  std::shared_ptr<std::unordered_set<std::string> > param_names;
+  // symbol of the network
+  nnvm::Symbol sym;
+  // context of the predictor
+  Context ctx;
   // executor
   std::unique_ptr<Executor> exec;
+  // key of the input shapes exec is bound for
+  std::string shape_key;
+  // executors of recently used input shapes, most recent first
+  std::list<MXAPIPredExecutor> exec_cache;
 };
 
 struct MXAPINDList {
@@ -84,24 +110,142 @@ int MXPredCreate(const char* symbol_json_str,
       out);
 }
 namespace mxnet {
+/*!
+ * \brief infer the shapes of arguments, outputs and auxiliary states
+ *  from the shapes of the input nodes
+ */
+void InferPredShapes(const nnvm::Symbol& sym,
+                     const std::unordered_map<std::string, TShape>& known_shape,
+                     std::vector<TShape>* arg_shapes,
+                     std::vector<TShape>* out_shapes,
+                     std::vector<TShape>* aux_shapes) {
+  try {
+    std::vector<TShape> in_shapes;
+    for (std::string key : sym.ListInputNames(Symbol::kAll)) {
+      auto it = known_shape.find(key);
+      if (it != known_shape.end()) {
+        in_shapes.push_back(it->second);
+      } else {
+        in_shapes.push_back(TShape());
+      }
+    }
+    nnvm::Graph g; g.outputs = sym.outputs;
+    g = mxnet::exec::InferShape(std::move(g), std::move(in_shapes), "__shape__");
+    bool infer_complete = (g.GetAttr<size_t>("shape_num_unknown_nodes") == 0);
+    CHECK(infer_complete)
+      << "The shape information of is not enough to get the shapes";
+    CopyAttr(g.indexed_graph(),
+             g.GetAttr<nnvm::ShapeVector>("shape"),
+             arg_shapes, out_shapes, aux_shapes);
+  } catch (const mxnet::op::InferShapeError &err) {
+    throw dmlc::Error(err.msg);
+  }
+}
 
-}  // namespace mxnet
+/*!
+ * \brief bind the executor of a predictor whose arg_arrays and aux_arrays are set,
+ *  the executor gets its own memory for the intermediate results
+ */
+void BindPred(MXAPIPredictor* p, Executor* shared_exec = nullptr) {
+  std::map<std::string, Context> ctx_map;
+  std::vector<NDArray> grad_store(p->arg_arrays.size());
+  std::vector<OpReqType> grad_req(p->arg_arrays.size(), kNullOp);
+  p->exec.reset(Executor::Bind(p->sym, p->ctx, ctx_map,
+                               p->arg_arrays,
+                               grad_store, grad_req,
+                               p->aux_arrays, shared_exec));
+  p->out_arrays = p->exec->outputs();
+}
 
-int MXPredCreatePartialOut(const char* symbol_json_str,
-                           const void* param_bytes,
-                           int param_size,
-                           int dev_type, int dev_id,
-                           mx_uint num_input_nodes,
-                           const char** input_keys,
-                           const mx_uint* input_shape_indptr,
-                           const mx_uint* input_shape_data,
-                           mx_uint num_output_nodes,
-                           const char** output_keys,
-                           PredictorHandle* out) {
+/*! \brief parse the input shapes passed to the C API */
+std::unordered_map<std::string, TShape> PredInputShapes(mx_uint num_input_nodes,
+                                                        const char** input_keys,
+                                                        const mx_uint* input_shape_indptr,
+                                                        const mx_uint* input_shape_data) {
+  std::unordered_map<std::string, TShape> known_shape;
+  for (mx_uint i = 0; i < num_input_nodes; ++i) {
+    known_shape[std::string(input_keys[i])] =
+        TShape(input_shape_data + input_shape_indptr[i],
+               input_shape_data + input_shape_indptr[i + 1]);
+  }
+  return known_shape;
+}
+
+/*! \brief key identifying a set of input shapes */
+std::string PredShapeKey(const std::unordered_map<std::string, TShape>& known_shape) {
+  std::map<std::string, TShape> sorted(known_shape.begin(), known_shape.end());
+  std::ostringstream os;
+  for (const auto& kv : sorted) {
+    os << kv.first << ':' << kv.second << ';';
+  }
+  return os.str();
+}
+
+/*!
+ * \brief create the argument arrays of a predictor for new input shapes,
+ *  sharing the weight arrays of src. The shapes of the weights and
+ *  the auxiliary states must not change.
+ */
+void SharePredArrays(const MXAPIPredictor& src,
+                     const std::unordered_map<std::string, TShape>& known_shape,
+                     const std::vector<TShape>& arg_shapes,
+                     const std::vector<TShape>& aux_shapes,
+                     std::vector<NDArray>* arg_arrays) {
   using nnvm::Symbol;
+  std::vector<std::string> arg_names = src.sym.ListInputNames(Symbol::kReadOnlyArgs);
+  std::vector<std::string> aux_names = src.sym.ListInputNames(Symbol::kAuxiliaryStates);
+  arg_arrays->clear();
+  // weights are shared, inputs and other arguments get their own arrays
+  for (size_t i = 0; i < arg_shapes.size(); ++i) {
+    if (src.param_names->count(arg_names[i]) != 0) {
+      CHECK_EQ(arg_shapes[i], src.arg_arrays[i].shape())
+          << "Parameter " << arg_names[i] << " cannot be shared: its shape changes to "
+          << arg_shapes[i] << " with the new input shapes";
+      arg_arrays->push_back(src.arg_arrays[i]);
+    } else if (known_shape.count(arg_names[i]) == 0 &&
+               arg_shapes[i] == src.arg_arrays[i].shape()) {
+      // keep the values of arguments that are neither inputs nor parameters
+      NDArray nd = NDArray(arg_shapes[i], src.ctx);
+      CopyFromTo(src.arg_arrays[i], &nd);
+      arg_arrays->push_back(nd);
+    } else {
+      arg_arrays->push_back(NDArray(arg_shapes[i], src.ctx));
+    }
+  }
+  for (size_t i = 0; i < aux_shapes.size(); ++i) {
+    CHECK_EQ(aux_shapes[i], src.aux_arrays[i].shape())
+        << "Auxiliary state " << aux_names[i] << " cannot be shared: its shape changes to "
+        << aux_shapes[i] << " with the new input shapes";
+  }
+}
 
-  MXAPIPredictor* ret = new MXAPIPredictor();
-  API_BEGIN();
+/*! \brief exchange the executor in use by a predictor with a cached one */
+void SwapPredExecutor(MXAPIPredictor* p, MXAPIPredExecutor* e) {
+  std::swap(p->shape_key, e->shape_key);
+  std::swap(p->out_arrays, e->out_arrays);
+  std::swap(p->arg_arrays, e->arg_arrays);
+  std::swap(p->out_shapes, e->out_shapes);
+  std::swap(p->exec, e->exec);
+}
+
+/*!
+ * \brief create a predictor from the symbol and the loaded parameters.
+ *  With params_in_place, cpu parameters are used without copying them, which
+ *  keeps parameters that point into a file mapping shared.
+ */
+void CreatePred(const char* symbol_json_str,
+                const std::vector<NDArray>& data,
+                const std::vector<std::string>& names,
+                bool params_in_place,
+                int dev_type, int dev_id,
+                mx_uint num_input_nodes,
+                const char** input_keys,
+                const mx_uint* input_shape_indptr,
+                const mx_uint* input_shape_data,
+                mx_uint num_output_nodes,
+                const char** output_keys,
+                MXAPIPredictor* ret) {
+  using nnvm::Symbol;
   Symbol sym;
   // make sure symbols are registered
   {
@@ -146,10 +290,6 @@ int MXPredCreatePartialOut(const char* symbol_json_str,
     for (size_t i = 0; i < aux_names_vec.size(); ++i) {
       aux_names.insert(aux_names_vec[i]);
     }
-    std::vector<NDArray> data;
-    std::vector<std::string> names;
-    dmlc::MemoryFixedSizeStream fi((void*)param_bytes, param_size);  // NOLINT(*)
-    NDArray::Load(&fi, &data, &names);
     CHECK_EQ(names.size(), data.size())
         << "Invalid param file format";
     for (size_t i = 0; i < names.size(); ++i) {
@@ -169,79 +309,219 @@ int MXPredCreatePartialOut(const char* symbol_json_str,
   }
 
   // shape inference and bind
-  std::unordered_map<std::string, TShape> known_shape;
-  for (mx_uint i = 0; i < num_input_nodes; ++i) {
-    known_shape[std::string(input_keys[i])] =
-        TShape(input_shape_data + input_shape_indptr[i],
-               input_shape_data + input_shape_indptr[i + 1]);
-  }
+  std::unordered_map<std::string, TShape> known_shape =
+      PredInputShapes(num_input_nodes, input_keys, input_shape_indptr, input_shape_data);
   std::vector<std::string> arg_names = sym.ListInputNames(Symbol::kReadOnlyArgs);
   std::vector<std::string> aux_names = sym.ListInputNames(Symbol::kAuxiliaryStates);
-  std::vector<TShape> out_shapes(sym.ListOutputNames().size());
-  std::vector<TShape> aux_shapes(aux_names.size());
-  std::vector<TShape> arg_shapes;
+  std::vector<TShape> out_shapes, aux_shapes, arg_shapes;
   for (size_t i = 0; i < arg_names.size(); ++i) {
     std::string key = arg_names[i];
     ret->key2arg[key] = i;
   }
-
-  try {
-    std::vector<TShape> in_shapes;
-    for (std::string key : sym.ListInputNames(Symbol::kAll)) {
-      if (known_shape.count(key) != 0) {
-        in_shapes.push_back(known_shape[key]);
-      } else {
-        in_shapes.push_back(TShape());
-      }
-    }
-    nnvm::Graph g; g.outputs = sym.outputs;
-    g = mxnet::exec::InferShape(std::move(g), std::move(in_shapes), "__shape__");
-    bool infer_complete = (g.GetAttr<size_t>("shape_num_unknown_nodes") == 0);
-    CHECK(infer_complete)
-      << "The shape information of is not enough to get the shapes";
-    CopyAttr(g.indexed_graph(),
-             g.GetAttr<nnvm::ShapeVector>("shape"),
-             &arg_shapes, &out_shapes, &aux_shapes);
-  } catch (const mxnet::op::InferShapeError &err) {
-    throw dmlc::Error(err.msg);
-  }
+  InferPredShapes(sym, known_shape, &arg_shapes, &out_shapes, &aux_shapes);
 
   Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
 
   std::vector<NDArray> arg_arrays, aux_arrays;
+  ret->param_names = std::make_shared<std::unordered_set<std::string> >();
+  // parameters that already sit on the cpu in the right shape and type
+  // are bound as they are when params_in_place is set
+  auto in_place = [&](const NDArray& param, const TShape& shape) {
+    return params_in_place && ctx.dev_mask() == cpu::kDevMask &&
+        param.ctx().dev_mask() == cpu::kDevMask && param.storage_type() == kDefaultStorage &&
+        param.shape() == shape &&
+        param.dtype() == mshadow::default_type_flag;
+  };
   for (size_t i = 0; i < arg_shapes.size(); ++i) {
+    auto it = arg_params.find(arg_names[i]);
+    const bool is_param = it != arg_params.end() && known_shape.count(arg_names[i]) == 0;
+    if (is_param) {
+      ret->param_names->insert(arg_names[i]);
+    }
+    if (is_param && in_place(it->second, arg_shapes[i])) {
+      arg_arrays.push_back(it->second);
+      continue;
+    }
     NDArray nd = NDArray(arg_shapes[i], ctx);
-    if (arg_params.count(arg_names[i]) != 0) {
-      CopyFromTo(arg_params[arg_names[i]], &nd);
+    if (it != arg_params.end()) {
+      CopyFromTo(it->second, &nd);
     }
     arg_arrays.push_back(nd);
   }
   for (size_t i = 0; i < aux_shapes.size(); ++i) {
+    auto it = aux_params.find(aux_names[i]);
+    if (it != aux_params.end() && in_place(it->second, aux_shapes[i])) {
+      aux_arrays.push_back(it->second);
+      continue;
+    }
     NDArray nd = NDArray(aux_shapes[i], ctx);
-    if (aux_params.count(aux_names[i]) != 0) {
-      CopyFromTo(aux_params[aux_names[i]], &nd);
+    if (it != aux_params.end()) {
+      CopyFromTo(it->second, &nd);
     }
     aux_arrays.push_back(nd);
   }
   ret->arg_arrays = arg_arrays;
+  ret->aux_arrays = aux_arrays;
+  ret->sym = sym;
+  ret->ctx = ctx;
+  ret->out_shapes = out_shapes;
+  ret->shape_key = PredShapeKey(known_shape);
   // bind
-  {
-    std::map<std::string, Context> ctx_map;
-    std::vector<NDArray> grad_store(arg_arrays.size());
-    std::vector<OpReqType> grad_req(arg_arrays.size(), kNullOp);
+  BindPred(ret);
+}
+}  // namespace mxnet
 
+int MXPredCreatePartialOut(const char* symbol_json_str,
+                           const void* param_bytes,
+                           int param_size,
+                           int dev_type, int dev_id,
+                           mx_uint num_input_nodes,
+                           const char** input_keys,
+                           const mx_uint* input_shape_indptr,
+                           const mx_uint* input_shape_data,
+                           mx_uint num_output_nodes,
+                           const char** output_keys,
+                           PredictorHandle* out) {
+  MXAPIPredictor* ret = new MXAPIPredictor();
+  API_BEGIN();
+  std::vector<NDArray> data;
+  std::vector<std::string> names;
+  dmlc::MemoryFixedSizeStream fi((void*)param_bytes, param_size);  // NOLINT(*)
+  NDArray::Load(&fi, &data, &names);
+  CreatePred(symbol_json_str, data, names, false, dev_type, dev_id,
+             num_input_nodes, input_keys, input_shape_indptr, input_shape_data,
+             num_output_nodes, output_keys, ret);
+  *out = ret;
+  API_END_HANDLE_ERROR(delete ret);
+}
 
-    ret->exec.reset(Executor::Bind(sym, ctx, ctx_map,
-                                   arg_arrays,
-                                   grad_store, grad_req,
-                                   aux_arrays));
-    ret->out_shapes = out_shapes;
-    ret->out_arrays = ret->exec->outputs();
-  }
+int MXPredCreateFromFile(const char* symbol_json_str,
+                         const char* param_file,
+                         int dev_type, int dev_id,
+                         mx_uint num_input_nodes,
+                         const char** input_keys,
+                         const mx_uint* input_shape_indptr,
+                         const mx_uint* input_shape_data,
+                         PredictorHandle* out) {
+  MXAPIPredictor* ret = new MXAPIPredictor();
+  API_BEGIN();
+  std::vector<NDArray> data;
+  std::vector<std::string> names;
+  bool mapped = NDArray::LoadMapped(param_file, &data, &names);
+  CreatePred(symbol_json_str, data, names, mapped, dev_type, dev_id,
+             num_input_nodes, input_keys, input_shape_indptr, input_shape_data,
+             0, NULL, ret);
   *out = ret;
   API_END_HANDLE_ERROR(delete ret);
 }
 
+int MXPredCreateShared(PredictorHandle handle,
+                       mx_uint num_input_nodes,
+                       const char** input_keys,
+                       const mx_uint* input_shape_indptr,
+                       const mx_uint* input_shape_data,
+                       PredictorHandle* out) {
+  MXAPIPredictor* p = static_cast<MXAPIPredictor*>(handle);
+  MXAPIPredictor* ret = new MXAPIPredictor();
+  API_BEGIN();
+  std::unordered_map<std::string, TShape> known_shape =
+      PredInputShapes(num_input_nodes, input_keys, input_shape_indptr, input_shape_data);
+  std::vector<TShape> out_shapes, aux_shapes, arg_shapes;
+  InferPredShapes(p->sym, known_shape, &arg_shapes, &out_shapes, &aux_shapes);
+  SharePredArrays(*p, known_shape, arg_shapes, aux_shapes, &(ret->arg_arrays));
+  ret->sym = p->sym;
+  ret->ctx = p->ctx;
+  ret->key2arg = p->key2arg;
+  ret->param_names = p->param_names;
+  ret->aux_arrays = p->aux_arrays;
+  ret->out_shapes = out_shapes;
+  ret->shape_key = PredShapeKey(known_shape);
+  BindPred(ret);
+  *out = ret;
+  API_END_HANDLE_ERROR(delete ret);
+}
+
+int MXPredCreateMultiThread(const char* symbol_json_str,
+                            const void* param_bytes,
+                            int param_size,
+                            int dev_type, int dev_id,
+                            mx_uint num_input_nodes,
+                            const char** input_keys,
+                            const mx_uint* input_shape_indptr,
+                            const mx_uint* input_shape_data,
+                            int num_threads,
+                            PredictorHandle* out) {
+  API_BEGIN();
+  CHECK_GE(num_threads, 1) << "num_threads must be at least 1";
+  for (int i = 0; i < num_threads; ++i) out[i] = nullptr;
+  int ret = MXPredCreate(symbol_json_str, param_bytes, param_size, dev_type, dev_id,
+                         num_input_nodes, input_keys, input_shape_indptr,
+                         input_shape_data, &out[0]);
+  for (int i = 1; i < num_threads && ret == 0; ++i) {
+    ret = MXPredCreateShared(out[0], num_input_nodes, input_keys, input_shape_indptr,
+                             input_shape_data, &out[i]);
+  }
+  if (ret != 0) {
+    for (int i = 0; i < num_threads; ++i) {
+      delete static_cast<MXAPIPredictor*>(out[i]);
+      out[i] = nullptr;
+    }
+    return ret;
+  }
+  API_END();
+}
+
+int MXPredReshape(PredictorHandle handle,
+                  mx_uint num_input_nodes,
+                  const char** input_keys,
+                  const mx_uint* input_shape_indptr,
+                  const mx_uint* input_shape_data) {
+  MXAPIPredictor* p = static_cast<MXAPIPredictor*>(handle);
+  API_BEGIN();
+  std::unordered_map<std::string, TShape> known_shape =
+      PredInputShapes(num_input_nodes, input_keys, input_shape_indptr, input_shape_data);
+  std::string shape_key = PredShapeKey(known_shape);
+  if (shape_key == p->shape_key) return 0;
+  static const size_t cache_size =
+      dmlc::GetEnv("MXNET_PREDICTOR_EXEC_CACHE_SIZE", static_cast<size_t>(4));
+  auto it = p->exec_cache.begin();
+  while (it != p->exec_cache.end() && it->shape_key != shape_key) ++it;
+  if (it != p->exec_cache.end()) {
+    // reuse the executor bound earlier for these shapes
+    MXAPIPredExecutor entry = std::move(*it);
+    p->exec_cache.erase(it);
+    SwapPredExecutor(p, &entry);
+    if (cache_size != 0) p->exec_cache.push_front(std::move(entry));
+  } else {
+    std::vector<TShape> out_shapes, aux_shapes, arg_shapes;
+    InferPredShapes(p->sym, known_shape, &arg_shapes, &out_shapes, &aux_shapes);
+    MXAPIPredExecutor entry;
+    SharePredArrays(*p, known_shape, arg_shapes, aux_shapes, &(entry.arg_arrays));
+    entry.shape_key = shape_key;
+    entry.out_shapes = out_shapes;
+    SwapPredExecutor(p, &entry);
+    // the new executor takes its memory from the pool of the previous one,
+    // cached executors are only run one at a time so they can share it
+    try {
+      BindPred(p, entry.exec.get());
+    } catch (const dmlc::Error&) {
+      SwapPredExecutor(p, &entry);
+      throw;
+    }
+    if (cache_size != 0) p->exec_cache.push_front(std::move(entry));
+  }
+  while (p->exec_cache.size() > cache_size) p->exec_cache.pop_back();
+  API_END();
+}
+
+int MXPredGetNumOutputs(PredictorHandle handle,
+                        mx_uint* num_outputs) {
+  MXAPIPredictor* p = static_cast<MXAPIPredictor*>(handle);
+  API_BEGIN();
+  *num_outputs = static_cast<mx_uint>(p->out_arrays.size());
+  API_END();
+}
+
 int MXPredGetOutputShape(PredictorHandle handle,
                          mx_uint out_index,
                          mx_uint** shape_data,
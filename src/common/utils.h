@@ -194,6 +194,35 @@ V ParallelAccumulate(const T* a, const int n, V start) {
   return sum;
 }
 
+/*!
+ * \brief In-place exclusive prefix sum of a[0, n), computed by blocks in parallel.
+ * a[n-1] is not included in the sum, so callers that need the total append a zero.
+ */
+template<typename DType>
+inline void ParallelExclusiveScan(DType* a, const nnvm::dim_t n) {
+  using nnvm::dim_t;
+  const int num_threads = std::max(1, std::min(omp_get_max_threads(),
+                                               static_cast<int>(n / 4096)));
+  const dim_t block = (n + num_threads - 1) / num_threads;
+  std::vector<DType> offsets(num_threads + 1, 0);
+  #pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    DType sum = 0;
+    for (dim_t i = t * block; i < std::min(n, (t + 1) * block); ++i) sum += a[i];
+    offsets[t + 1] = sum;
+  }
+  for (int t = 0; t < num_threads; ++t) offsets[t + 1] += offsets[t];
+  #pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    DType sum = offsets[t];
+    for (dim_t i = t * block; i < std::min(n, (t + 1) * block); ++i) {
+      const DType val = a[i];
+      a[i] = sum;
+      sum += val;
+    }
+  }
+}
+
 /*!
  * \brief
  * Helper function for ParallelSort.
@@ -245,6 +274,46 @@ void ParallelSort(RandomIt first, RandomIt last, size_t num_threads) {
                std::less<typename std::iterator_traits<RandomIt>::value_type>());
 }
 
+/*!
+ * \brief Sort a[0, n) into ascending order and move the unique values to the front.
+ * The values that start a new run are counted and compacted by blocks in parallel.
+ * \return the number of unique values
+ */
+template<typename DType>
+inline size_t ParallelSortUnique(DType* a, const size_t n, const int num_threads) {
+  if (n == 0) return 0;
+  ParallelSort(a, a + n, num_threads);
+  const int nblocks = std::max(1, std::min(num_threads, static_cast<int>(n / 4096)));
+  const size_t block = (n + nblocks - 1) / nblocks;
+  std::vector<size_t> offsets(nblocks + 1, 0);
+  #pragma omp parallel for num_threads(nblocks)
+  for (int t = 0; t < nblocks; ++t) {
+    size_t count = 0;
+    for (size_t i = t * block; i < std::min(n, (t + 1) * block); ++i) {
+      count += (i == 0 || a[i] != a[i - 1]);
+    }
+    offsets[t + 1] = count;
+  }
+  for (int t = 0; t < nblocks; ++t) offsets[t + 1] += offsets[t];
+  const size_t num_unique = offsets[nblocks];
+  if (num_unique == n) return n;
+  std::vector<DType> uniq(num_unique);
+  #pragma omp parallel for num_threads(nblocks)
+  for (int t = 0; t < nblocks; ++t) {
+    size_t pos = offsets[t];
+    for (size_t i = t * block; i < std::min(n, (t + 1) * block); ++i) {
+      if (i == 0 || a[i] != a[i - 1]) uniq[pos++] = a[i];
+    }
+  }
+  #pragma omp parallel for num_threads(nblocks)
+  for (int t = 0; t < nblocks; ++t) {
+    const size_t begin = std::min(num_unique, t * block);
+    const size_t end = std::min(num_unique, (t + 1) * block);
+    std::copy(uniq.begin() + begin, uniq.begin() + end, a + begin);
+  }
+  return num_unique;
+}
+
 /*!
  * \brief Random Engine
  */
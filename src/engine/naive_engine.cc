@@ -96,8 +96,6 @@ class NaiveEngine final : public Engine {
 #if MXNET_USE_PROFILER
         if (opr->profiling) {
           opr->opr_stat = Profiler::Get()->AddOprStat(exec_ctx.dev_type, exec_ctx.dev_id);
-          uint64_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
-          opr->opr_stat->thread_id = id;
           strncpy(opr->opr_stat->opr_name,
             opr->opr_name,
             sizeof(opr->opr_stat->opr_name) - 1);
@@ -106,6 +104,7 @@ class NaiveEngine final : public Engine {
         opr->fn(ctx, on_complete);
         if (opr->profiling) {
           SetOprEnd(opr->opr_stat);
+          Profiler::Get()->ClearCurrentOprStat();
         }
 #else
         opr->fn(ctx, on_complete);
@@ -140,8 +139,6 @@ class NaiveEngine final : public Engine {
                         prop, opr_name)->Cast<NaiveOpr>();
       opr->profiling = profiling;
       opr->opr_stat = Profiler::Get()->AddOprStat(exec_ctx.dev_type, exec_ctx.dev_id);
-      uint64_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
-      opr->opr_stat->thread_id = id;
       strncpy(opr->opr_stat->opr_name,
               opr->opr_name,
               sizeof(opr->opr_stat->opr_name) - 1);
@@ -170,6 +167,7 @@ class NaiveEngine final : public Engine {
 #if MXNET_USE_PROFILER
     if (profiling) {
       SetOprEnd(opr->opr_stat);
+      Profiler::Get()->ClearCurrentOprStat();
     }
 #endif
   }
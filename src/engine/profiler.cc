@@ -22,14 +22,22 @@
  * \brief implements profiler
  */
 #include <dmlc/base.h>
+#include <dmlc/json.h>
 #include <dmlc/logging.h>
+#include <dmlc/thread_local.h>
 #include <mxnet/base.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <set>
 #include <map>
 #include <mutex>
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
 #include "./profiler.h"
 
 #if defined(_MSC_VER) && _MSC_VER <= 1800
@@ -38,10 +46,68 @@
 
 namespace mxnet {
 namespace engine {
-const int INITIAL_SIZE = 1024;
+
+namespace {
+/*! \brief releases the buffer of a thread when the thread exits */
+struct ProfileThreadHandle {
+  ProfileThreadBuffer *buf = nullptr;
+  ~ProfileThreadHandle() {
+    if (buf != nullptr) buf->in_use.store(false, std::memory_order_release);
+  }
+};
+
+/*! \brief s quoted and escaped as a JSON string */
+inline std::string JSONString(const std::string& s) {
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.WriteString(s);
+  return os.str();
+}
+
+/*! \brief whether an execution recorded in buf may still be completed by another thread */
+inline bool HasRunningRecord(const ProfileThreadBuffer& buf) {
+  const uint64_t head = buf.head.load(std::memory_order_acquire);
+  const uint64_t size = buf.records.size();
+  for (uint64_t j = head > size ? head - size : 0; j < head; ++j) {
+    const OprExecStat &r = buf.records[j % size];
+    if (r.opr_end_rel_micros == 0 || r.opr_end_rel_micros < r.opr_start_rel_micros) return true;
+  }
+  return false;
+}
+
+/*!
+ * \brief histogram bucket of an execution time: exact below 8us, then
+ *  8 buckets per power of two, i.e. a relative error below 12.5%
+ */
+inline int OprTimeBucket(uint64_t t) {
+  if (t < 8) return static_cast<int>(t);
+  if (t >= (1ULL << 40)) return kOprTimeBuckets - 1;
+  int e = 3;
+  while ((t >> (e + 1)) != 0) ++e;
+  return (e - 2) * 8 + static_cast<int>((t >> (e - 3)) & 7);
+}
+
+/*! \brief largest execution time falling in a histogram bucket */
+inline uint64_t OprTimeBucketUpper(int bucket) {
+  if (bucket < 8) return bucket;
+  const int e = bucket / 8 + 2;
+  return ((static_cast<uint64_t>(8 + bucket % 8) + 1) << (e - 3)) - 1;
+}
+
+/*! \brief increment a counter that only the calling thread writes */
+inline void Bump(std::atomic<uint64_t> *v, uint64_t delta) {
+  v->store(v->load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+}  // namespace
+
+ProfileThreadBuffer::ProfileThreadBuffer(size_t num_records)
+  : thread_id(0), in_use(true), records(num_records), head(0), current(nullptr),
+    mem_records(num_records), mem_head(0),
+    agg(new OprAggStat[kOprAggTableSize]()), agg_epoch(0), agg_dropped(0) {}
 
 Profiler::Profiler()
-  : state_(kNotRunning), enable_output_(false), filename_("profile.json") {
+  : state_(kNotRunning), enable_output_(false), filename_("profile.json"),
+    retired_agg_dropped_(0), aggregate_(false), agg_epoch_(0) {
   this->init_time_ = NowInUsec();
 
   // TODO(ziheng) get device number during execution
@@ -54,16 +120,19 @@ Profiler::Profiler()
   this->gpu_num_ = 0;
 #endif
 
-  this->profile_stat = new DevStat[cpu_num_ + gpu_num_ + 1];
-  this->profile_stat->opr_exec_stats.reserve(INITIAL_SIZE);
   for (unsigned int i = 0; i < cpu_num_; ++i) {
-    profile_stat[i].dev_name = "cpu/" + std::to_string(i);
+    dev_names_.push_back("cpu/" + std::to_string(i));
   }
   for (unsigned int i = 0; i < gpu_num_; ++i) {
-    profile_stat[cpu_num_ + i].dev_name = "gpu/" + std::to_string(i);
+    dev_names_.push_back("gpu/" + std::to_string(i));
   }
-  profile_stat[cpu_num_ + gpu_num_].dev_name = "cpu pinned/";
+  dev_names_.push_back("cpu pinned/");
+  mem_stats_.reset(new DevMemStat[dev_names_.size()]());
 
+  int buffer_size = dmlc::GetEnv("MXNET_PROFILER_BUFFER_SIZE", 1 << 16);
+  CHECK_GT(buffer_size, 0) << "MXNET_PROFILER_BUFFER_SIZE must be positive";
+  buffer_size_ = buffer_size;
+  aggregate_ = dmlc::GetEnv("MXNET_PROFILER_AGGREGATE", false);
   mode_ = (ProfilerMode)dmlc::GetEnv("MXNET_PROFILER_MODE", static_cast<int>(kOnlySymbolic));
   if (dmlc::GetEnv("MXNET_PROFILER_AUTOSTART", 0)) {
     this->state_ = ProfilerState::kRunning;
@@ -73,8 +142,9 @@ Profiler::Profiler()
 
 Profiler* Profiler::Get() {
 #if MXNET_USE_PROFILER
-  static Profiler inst;
-  return &inst;
+  // never destroyed, storage may still be freed during static destruction
+  static Profiler *inst = new Profiler();
+  return inst;
 #else
   return nullptr;
 #endif
@@ -94,36 +164,286 @@ void Profiler::SetConfig(ProfilerMode mode, std::string output_filename) {
   this->filename_ = output_filename;
 }
 
-OprExecStat *Profiler::AddOprStat(int dev_type, uint32_t dev_id) {
-  OprExecStat* opr_stat = new OprExecStat;
-  opr_stat->dev_type = dev_type;
-  opr_stat->dev_id   = dev_id;
-  opr_stat->opr_name[sizeof(opr_stat->opr_name)-1] = '\0';
+void Profiler::SetAggregate(bool aggregate) {
+  std::lock_guard<std::mutex> lock{this->m_};
+  this->aggregate_ = aggregate;
+}
 
-  int idx;
+uint32_t Profiler::DevIndex(int dev_type, uint32_t dev_id) const {
   switch (dev_type) {
     case Context::kCPU:
-      idx = dev_id;
-      break;
+      return dev_id;
     case Context::kGPU:
-      idx = cpu_num_ + dev_id;
-      break;
+      return cpu_num_ + dev_id;
     case Context::kCPUPinned:
-      idx = cpu_num_ + gpu_num_;
-      break;
+      return cpu_num_ + gpu_num_;
     default:
       LOG(FATAL) << "Unkown dev_type";
-      return NULL;
+      return 0;
   }
+}
 
-  DevStat& dev_stat = profile_stat[idx];
-  {
-    std::lock_guard<std::mutex> lock{dev_stat.m_};
-    dev_stat.opr_exec_stats.push_back(opr_stat);
+ProfileThreadBuffer* Profiler::ThreadBuffer() {
+  ProfileThreadHandle *handle = dmlc::ThreadLocalStore<ProfileThreadHandle>::Get();
+  if (handle->buf == nullptr) {
+    handle->buf = this->AcquireThreadBuffer();
+  }
+  return handle->buf;
+}
+
+ProfileThreadBuffer* Profiler::AcquireThreadBuffer() {
+  uint32_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
+  std::lock_guard<std::mutex> lock{this->buffers_mutex_};
+  for (ProfileThreadBuffer *buf : buffers_) {
+    bool expected = false;
+    if (buf->in_use.compare_exchange_strong(expected, true)) {
+      buf->thread_id = id;
+      return buf;
+    }
   }
+  ProfileThreadBuffer *buf = new ProfileThreadBuffer(buffer_size_);
+  buf->thread_id = id;
+  buffers_.push_back(buf);
+  return buf;
+}
+
+OprExecStat *Profiler::AddOprStat(int dev_type, uint32_t dev_id) {
+  CHECK_LT(this->DevIndex(dev_type, dev_id), dev_names_.size())
+    << "Profiler: unknown device " << dev_type << "/" << dev_id;
+  ProfileThreadBuffer *buf = this->ThreadBuffer();
+  const uint64_t head = buf->head.load(std::memory_order_relaxed);
+  OprExecStat* opr_stat = &buf->records[head % buf->records.size()];
+  opr_stat->thread_id = buf->thread_id;
+  opr_stat->dev_type = dev_type;
+  opr_stat->dev_id   = dev_id;
+  opr_stat->opr_start_rel_micros = 0;
+  opr_stat->opr_end_rel_micros = 0;
+  opr_stat->temp_space_requests = 0;
+  opr_stat->temp_space_bytes = 0;
+  opr_stat->opr_name[sizeof(opr_stat->opr_name)-1] = '\0';
+  buf->head.store(head + 1, std::memory_order_release);
+  buf->current = opr_stat;
   return opr_stat;
 }
 
+void Profiler::FinishOprStat(OprExecStat* opr_stat) {
+  ProfileThreadBuffer *buf = this->ThreadBuffer();
+  if (buf->current == opr_stat) buf->current = nullptr;
+  if (aggregate_) this->AddAggregateStat(*opr_stat);
+}
+
+void Profiler::ClearCurrentOprStat() {
+  ProfileThreadHandle *handle = dmlc::ThreadLocalStore<ProfileThreadHandle>::Get();
+  if (handle->buf != nullptr) handle->buf->current = nullptr;
+}
+
+void Profiler::AddTempSpaceStat(size_t size) {
+  if (state_ != kRunning) return;
+  OprExecStat *opr_stat = this->ThreadBuffer()->current;
+  if (opr_stat == nullptr) return;
+  opr_stat->temp_space_requests += 1;
+  opr_stat->temp_space_bytes = std::max<uint64_t>(opr_stat->temp_space_bytes, size);
+}
+
+void Profiler::AddStorageStat(int dev_type, uint32_t dev_id, int64_t delta) {
+  const uint32_t idx = this->DevIndex(dev_type, dev_id);
+  if (idx >= dev_names_.size()) return;
+  DevMemStat &m = mem_stats_[idx];
+  (delta > 0 ? m.num_alloc : m.num_free).fetch_add(1, std::memory_order_relaxed);
+  const int64_t used = m.used.fetch_add(delta, std::memory_order_relaxed) + delta;
+  int64_t peak = m.peak.load(std::memory_order_relaxed);
+  while (used > peak && !m.peak.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {}
+  if (state_ != kRunning) return;
+  ProfileThreadBuffer *buf = this->ThreadBuffer();
+  const uint64_t head = buf->mem_head.load(std::memory_order_relaxed);
+  MemCounterStat &event = buf->mem_records[head % buf->mem_records.size()];
+  event.rel_micros = NowInUsec() - init_time_;
+  event.used_bytes = used;
+  event.dev_idx = idx;
+  buf->mem_head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::AddPoolStat(int dev_type, uint32_t dev_id, bool hit, size_t reserved) {
+  const uint32_t idx = this->DevIndex(dev_type, dev_id);
+  if (idx >= dev_names_.size()) return;
+  DevMemStat &m = mem_stats_[idx];
+  (hit ? m.pool_hits : m.pool_misses).fetch_add(1, std::memory_order_relaxed);
+  m.pool_reserved.store(reserved, std::memory_order_relaxed);
+}
+
+void Profiler::AddAggregateStat(const OprExecStat& opr_stat) {
+  ProfileThreadBuffer *buf = this->ThreadBuffer();
+  const uint64_t epoch = agg_epoch_.load(std::memory_order_acquire);
+  if (buf->agg_epoch.load(std::memory_order_relaxed) != epoch) {
+    // statistics were reset since this thread last wrote them
+    for (int i = 0; i < kOprAggTableSize; ++i) {
+      OprAggStat &s = buf->agg[i];
+      s.used.store(false, std::memory_order_relaxed);
+      s.count.store(0, std::memory_order_relaxed);
+      s.total.store(0, std::memory_order_relaxed);
+      s.temp_space_requests.store(0, std::memory_order_relaxed);
+      s.temp_space_max.store(0, std::memory_order_relaxed);
+      for (int j = 0; j < kOprTimeBuckets; ++j) {
+        s.hist[j].store(0, std::memory_order_relaxed);
+      }
+    }
+    buf->agg_dropped.store(0, std::memory_order_relaxed);
+    buf->agg_epoch.store(epoch, std::memory_order_release);
+  }
+  const uint32_t dev_idx = this->DevIndex(opr_stat.dev_type, opr_stat.dev_id);
+  size_t h = dev_idx;
+  for (const char *p = opr_stat.opr_name; *p != '\0'; ++p) {
+    h = h * 31 + static_cast<unsigned char>(*p);
+  }
+  const uint64_t t = opr_stat.opr_end_rel_micros - opr_stat.opr_start_rel_micros;
+  for (int i = 0; i < kOprAggTableSize; ++i) {
+    OprAggStat &s = buf->agg[(h + i) % kOprAggTableSize];
+    if (!s.used.load(std::memory_order_relaxed)) {
+      strncpy(s.opr_name, opr_stat.opr_name, sizeof(s.opr_name) - 1);
+      s.opr_name[sizeof(s.opr_name) - 1] = '\0';
+      s.dev_idx = dev_idx;
+      s.min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+      s.max.store(0, std::memory_order_relaxed);
+      s.used.store(true, std::memory_order_release);
+    } else if (s.dev_idx != dev_idx || strcmp(s.opr_name, opr_stat.opr_name) != 0) {
+      continue;
+    }
+    Bump(&s.count, 1);
+    Bump(&s.total, t);
+    if (t < s.min.load(std::memory_order_relaxed)) s.min.store(t, std::memory_order_relaxed);
+    if (t > s.max.load(std::memory_order_relaxed)) s.max.store(t, std::memory_order_relaxed);
+    Bump(&s.temp_space_requests, opr_stat.temp_space_requests);
+    if (opr_stat.temp_space_bytes > s.temp_space_max.load(std::memory_order_relaxed)) {
+      s.temp_space_max.store(opr_stat.temp_space_bytes, std::memory_order_relaxed);
+    }
+    std::atomic<uint32_t> &bucket = s.hist[OprTimeBucket(t)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return;
+  }
+  Bump(&buf->agg_dropped, 1);
+}
+
+uint64_t Profiler::MergeAggregateStats(const ProfileThreadBuffer& buf, uint64_t epoch,
+                                       OprAggTotals* totals) {
+  if (buf.agg_epoch.load(std::memory_order_acquire) != epoch) return 0;
+  for (int i = 0; i < kOprAggTableSize; ++i) {
+    const OprAggStat &s = buf.agg[i];
+    if (!s.used.load(std::memory_order_acquire)) continue;
+    OprAggTotal &m = (*totals)[std::make_pair(s.dev_idx, std::string(s.opr_name))];
+    m.count += s.count.load(std::memory_order_relaxed);
+    m.total += s.total.load(std::memory_order_relaxed);
+    m.min = std::min<uint64_t>(m.min, s.min.load(std::memory_order_relaxed));
+    m.max = std::max<uint64_t>(m.max, s.max.load(std::memory_order_relaxed));
+    m.temp_space_requests += s.temp_space_requests.load(std::memory_order_relaxed);
+    m.temp_space_max = std::max<uint64_t>(m.temp_space_max,
+                                          s.temp_space_max.load(std::memory_order_relaxed));
+    for (int j = 0; j < kOprTimeBuckets; ++j) {
+      m.hist[j] += s.hist[j].load(std::memory_order_relaxed);
+    }
+  }
+  return buf.agg_dropped.load(std::memory_order_relaxed);
+}
+
+void Profiler::ReleaseExitedBuffers() {
+  std::lock_guard<std::mutex> lock{this->buffers_mutex_};
+  const uint64_t epoch = agg_epoch_.load(std::memory_order_acquire);
+  std::vector<ProfileThreadBuffer*> kept;
+  for (ProfileThreadBuffer *buf : buffers_) {
+    // buffers are only acquired under the lock, so an unused one stays unused
+    if (buf->in_use.load(std::memory_order_acquire) || HasRunningRecord(*buf)) {
+      kept.push_back(buf);
+      continue;
+    }
+    retired_agg_dropped_ += this->MergeAggregateStats(*buf, epoch, &retired_agg_);
+    delete buf;
+  }
+  buffers_.swap(kept);
+}
+
+std::string Profiler::AggregateStats(bool reset) {
+  OprAggTotals merged;
+  uint64_t dropped;
+  {
+    // hold the lock while reading, buffers are freed under it
+    std::lock_guard<std::mutex> lock{this->buffers_mutex_};
+    merged = retired_agg_;
+    dropped = retired_agg_dropped_;
+    const uint64_t epoch = agg_epoch_.load(std::memory_order_acquire);
+    for (ProfileThreadBuffer *buf : buffers_) {
+      dropped += this->MergeAggregateStats(*buf, epoch, &merged);
+    }
+    if (reset) {
+      agg_epoch_.fetch_add(1, std::memory_order_release);
+      retired_agg_.clear();
+      retired_agg_dropped_ = 0;
+    }
+  }
+  LOG_IF(WARNING, dropped != 0) << dropped << " operator executions are missing in the "
+                                << "aggregate statistics, too many distinct operators";
+
+  std::ostringstream os;
+  os << "{";
+  uint32_t dev_idx = std::numeric_limits<uint32_t>::max();
+  for (const auto& kv : merged) {
+    const OprAggTotal &m = kv.second;
+    if (m.count == 0) continue;
+    if (kv.first.first != dev_idx) {
+      os << (dev_idx == std::numeric_limits<uint32_t>::max() ? "\n" : "\n    },\n");
+      dev_idx = kv.first.first;
+      os << "    \"" << dev_names_[dev_idx] << "\": {";
+    } else {
+      os << ",";
+    }
+    // the execution time below which 99% of the executions finished
+    const uint64_t target = (m.count * 99 + 99) / 100;
+    uint64_t seen = 0, p99 = m.max;
+    for (int j = 0; j < kOprTimeBuckets; ++j) {
+      seen += m.hist[j];
+      if (seen >= target) {
+        p99 = std::max(m.min, std::min(m.max, OprTimeBucketUpper(j)));
+        break;
+      }
+    }
+    os << "\n        " << JSONString(kv.first.second) << ": {"
+       << "\"count\": " << m.count
+       << ", \"total\": " << m.total
+       << ", \"min\": " << m.min
+       << ", \"max\": " << m.max
+       << ", \"mean\": " << static_cast<double>(m.total) / m.count
+       << ", \"p99\": " << p99
+       << ", \"temp_space_requests\": " << m.temp_space_requests
+       << ", \"temp_space_max\": " << m.temp_space_max << "}";
+  }
+  if (dev_idx != std::numeric_limits<uint32_t>::max()) os << "\n    }\n";
+  os << "}";
+  return os.str();
+}
+
+std::string Profiler::MemoryStats(bool reset_peak) {
+  std::ostringstream os;
+  os << "{";
+  bool first = true;
+  for (uint32_t i = 0; i < dev_names_.size(); ++i) {
+    DevMemStat &m = mem_stats_[i];
+    if (m.num_alloc.load(std::memory_order_relaxed) == 0 &&
+        m.pool_misses.load(std::memory_order_relaxed) == 0) continue;
+    const int64_t used = m.used.load(std::memory_order_relaxed);
+    os << (first ? "\n" : ",\n");
+    first = false;
+    os << "    \"" << dev_names_[i] << "\": {"
+       << "\"used\": " << used
+       << ", \"peak\": " << m.peak.load(std::memory_order_relaxed)
+       << ", \"num_alloc\": " << m.num_alloc.load(std::memory_order_relaxed)
+       << ", \"num_free\": " << m.num_free.load(std::memory_order_relaxed)
+       << ", \"pool_hits\": " << m.pool_hits.load(std::memory_order_relaxed)
+       << ", \"pool_misses\": " << m.pool_misses.load(std::memory_order_relaxed)
+       << ", \"pool_reserved\": " << m.pool_reserved.load(std::memory_order_relaxed) << "}";
+    if (reset_peak) m.peak.store(used, std::memory_order_relaxed);
+  }
+  os << (first ? "}" : "\n}");
+  return os.str();
+}
+
 void Profiler::EmitPid(std::ostream *os, const std::string& name, uint32_t pid) {
   (*os) << "        {\n"
         << "            \"ph\": \"M\",\n"
@@ -139,7 +459,7 @@ void Profiler::EmitEvent(std::ostream *os, const std::string& name,
                        const std::string& category, const std::string& ph,
                        uint64_t ts, uint32_t pid, uint32_t tid) {
   (*os) << "        {\n"
-        << "            \"name\": \""  << name << "\",\n"
+        << "            \"name\": "  << JSONString(name) << ",\n"
         << "            \"cat\": " << "\"" << category << "\",\n"
         << "            \"ph\": \""<< ph << "\",\n"
         << "            \"ts\": "  << ts << ",\n"
@@ -149,6 +469,20 @@ void Profiler::EmitEvent(std::ostream *os, const std::string& name,
 }
 
 
+void Profiler::EmitCounter(std::ostream *os, const std::string& name,
+                           const std::string& key, int64_t value,
+                           uint64_t ts, uint32_t pid) {
+  (*os) << "        {\n"
+        << "            \"name\": \""  << name << "\",\n"
+        << "            \"ph\": \"C\",\n"
+        << "            \"ts\": "  << ts << ",\n"
+        << "            \"pid\": " << pid << ",\n"
+        << "            \"args\": {\n"
+        << "                \"" << key << "\": " << value << "\n"
+        << "            }\n"
+        << "        }";
+}
+
 void Profiler::DumpProfile() {
   SetState(kNotRunning);
 
@@ -159,24 +493,33 @@ void Profiler::DumpProfile() {
   file << "{" << std::endl;
   file << "    \"traceEvents\": [" << std::endl;
 
-  uint32_t dev_num = cpu_num_ + gpu_num_ + 1;
+  uint32_t dev_num = dev_names_.size();
 
   for (uint32_t i = 0; i < dev_num; ++i) {
-    const DevStat &d = profile_stat[i];
-    this->EmitPid(&file, d.dev_name, i);
+    this->EmitPid(&file, dev_names_[i], i);
     file << ",\n";
   }
 
+  std::vector<ProfileThreadBuffer*> buffers;
+  {
+    std::lock_guard<std::mutex> lock{this->buffers_mutex_};
+    buffers = buffers_;
+  }
   bool first_flag = true;
-  for (uint32_t i = 0; i < dev_num; ++i) {
-    DevStat &d = profile_stat[i];
-    std::lock_guard<std::mutex> lock(d.m_);
-    uint32_t opr_num = d.opr_exec_stats.size();
-
-    for (uint32_t j = 0; j < opr_num; ++j) {
-      const OprExecStat* opr_stat = d.opr_exec_stats[j];
-
-      uint32_t pid = i;
+  uint64_t overwritten = 0;
+  for (const ProfileThreadBuffer *buf : buffers) {
+    const uint64_t head = buf->head.load(std::memory_order_acquire);
+    const uint64_t size = buf->records.size();
+    const uint64_t begin = head > size ? head - size : 0;
+    overwritten += begin;
+
+    for (uint64_t j = begin; j < head; ++j) {
+      const OprExecStat* opr_stat = &buf->records[j % size];
+      // still running
+      if (opr_stat->opr_end_rel_micros < opr_stat->opr_start_rel_micros ||
+          opr_stat->opr_end_rel_micros == 0) continue;
+
+      uint32_t pid = this->DevIndex(opr_stat->dev_type, opr_stat->dev_id);
       uint32_t tid = opr_stat->thread_id;
 
       if (first_flag) {
@@ -192,6 +535,26 @@ void Profiler::DumpProfile() {
             opr_stat->opr_end_rel_micros, pid, tid);
     }
   }
+  for (const ProfileThreadBuffer *buf : buffers) {
+    const uint64_t head = buf->mem_head.load(std::memory_order_acquire);
+    const uint64_t size = buf->mem_records.size();
+    const uint64_t begin = head > size ? head - size : 0;
+    overwritten += begin;
+    for (uint64_t j = begin; j < head; ++j) {
+      const MemCounterStat &event = buf->mem_records[j % size];
+      if (first_flag) {
+        first_flag = false;
+      } else {
+        file << ",";
+      }
+      file << std::endl;
+      this->EmitCounter(&file, "Memory", "used_bytes", event.used_bytes,
+                        event.rel_micros, event.dev_idx);
+    }
+  }
+  LOG_IF(WARNING, overwritten != 0) << "Profiler: the oldest " << overwritten
+                                    << " records were overwritten, increase "
+                                    << "MXNET_PROFILER_BUFFER_SIZE to keep them";
 
   file << "\n" << std::endl;
   file << "    ]," << std::endl;
@@ -199,6 +562,7 @@ void Profiler::DumpProfile() {
   file << "}" << std::endl;
 
   enable_output_ = false;
+  this->ReleaseExitedBuffers();
 }
 
 
@@ -227,7 +591,9 @@ void SetOprEnd(OprExecStat* opr_stat) {
     LOG(WARNING) << "SetOpEnd: nullptr";
     return;
   }
-  opr_stat->opr_end_rel_micros   = NowInUsec() - Profiler::Get()->GetInitTime();
+  Profiler *profiler = Profiler::Get();
+  opr_stat->opr_end_rel_micros   = NowInUsec() - profiler->GetInitTime();
+  profiler->FinishOprStat(opr_stat);
 }
 
 }  // namespace engine
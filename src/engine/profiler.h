@@ -24,10 +24,14 @@
 #ifndef MXNET_ENGINE_PROFILER_H_
 #define MXNET_ENGINE_PROFILER_H_
 
+#include <atomic>
+#include <limits>
+#include <map>
 #include <vector>
 #include <string>
 #include <mutex>
 #include <memory>
+#include <utility>
 
 namespace mxnet {
 namespace engine {
@@ -57,20 +61,108 @@ struct OprExecStat {
   uint32_t dev_type;
   /*! \brief device id */
   uint32_t dev_id;
+  /*! \brief number of temporary space requests during the execution */
+  uint32_t temp_space_requests;
+  /*! \brief largest temporary space requested during the execution, in bytes */
+  uint64_t temp_space_bytes;
 };
 
 /*!
- * \brief Device statistics
+ * \brief Memory usage of a device after one allocation or free,
+ *  emitted as a counter in the trace
  */
-struct DevStat {
-  /*! \brief device name */
-  std::string dev_name;
-  /*! \brief operation execution statistics on this device */
-  std::vector<OprExecStat*> opr_exec_stats;
-  /*! \brief internal mutex of the execution state */
-  std::mutex m_;
+struct MemCounterStat {
+  /*! \brief relative timestamp, time unit is microsecond */
+  uint64_t rel_micros;
+  /*! \brief bytes in use on the device */
+  int64_t used_bytes;
+  /*! \brief index of the device in the profiler */
+  uint32_t dev_idx;
+};
+
+/*!
+ * \brief Memory statistics of one device
+ */
+struct DevMemStat {
+  /*! \brief bytes handed out by the storage and not freed yet */
+  std::atomic<int64_t> used;
+  /*! \brief largest value of used */
+  std::atomic<int64_t> peak;
+  /*! \brief number of allocations and frees */
+  std::atomic<uint64_t> num_alloc, num_free;
+  /*! \brief allocations served from and missing the memory pool */
+  std::atomic<uint64_t> pool_hits, pool_misses;
+  /*! \brief bytes held by the memory pool, including the ones in use */
+  std::atomic<int64_t> pool_reserved;
+};
+
+/*! \brief number of buckets of the execution time histogram */
+const int kOprTimeBuckets = 304;
+/*! \brief number of (operator, device) slots in the statistics table of a thread */
+const int kOprAggTableSize = 512;
+
+/*!
+ * \brief Aggregate execution statistics of one operator on one device
+ */
+struct OprAggStat {
+  /*! \brief operation name */
+  char opr_name[32];
+  /*! \brief index of the device in the profiler */
+  uint32_t dev_idx;
+  /*! \brief set once opr_name and dev_idx are written */
+  std::atomic<bool> used;
+  /*! \brief number of executions */
+  std::atomic<uint64_t> count;
+  /*! \brief total, min and max execution time, time unit is microsecond */
+  std::atomic<uint64_t> total, min, max;
+  /*! \brief number of temporary space requests */
+  std::atomic<uint64_t> temp_space_requests;
+  /*! \brief largest temporary space requested by one execution, in bytes */
+  std::atomic<uint64_t> temp_space_max;
+  /*! \brief log-scale histogram of the execution time, used for percentiles */
+  std::atomic<uint32_t> hist[kOprTimeBuckets];
 };
 
+/*!
+ * \brief Aggregate execution statistics of one operator on one device, summed over threads
+ */
+struct OprAggTotal {
+  uint64_t count = 0, total = 0, temp_space_requests = 0, temp_space_max = 0;
+  uint64_t min = std::numeric_limits<uint64_t>::max(), max = 0;
+  std::vector<uint64_t> hist = std::vector<uint64_t>(kOprTimeBuckets, 0);
+};
+
+/*! \brief aggregate statistics keyed by (device index, operator name) */
+typedef std::map<std::pair<uint32_t, std::string>, OprAggTotal> OprAggTotals;
+
+/*!
+ * \brief Profiling buffers of one thread.
+ *  Records and statistics are only written by the owning thread, so the hot
+ *  path takes no lock and allocates nothing. Readers may see in-flight records.
+ */
+struct ProfileThreadBuffer {
+  explicit ProfileThreadBuffer(size_t num_records);
+  /*! \brief id of the owning thread */
+  uint32_t thread_id;
+  /*! \brief whether a live thread owns the buffer */
+  std::atomic<bool> in_use;
+  /*! \brief ring of execution records, the oldest ones are overwritten */
+  std::vector<OprExecStat> records;
+  /*! \brief number of records ever added, the next slot is head % records.size() */
+  std::atomic<uint64_t> head;
+  /*! \brief record of the operator running on this thread, if profiled */
+  OprExecStat* current;
+  /*! \brief ring of memory counter events */
+  std::vector<MemCounterStat> mem_records;
+  /*! \brief number of memory counter events ever added */
+  std::atomic<uint64_t> mem_head;
+  /*! \brief open addressing table of aggregate statistics */
+  std::unique_ptr<OprAggStat[]> agg;
+  /*! \brief reset epoch the statistics in agg belong to */
+  std::atomic<uint64_t> agg_epoch;
+  /*! \brief number of executions not counted because agg is full */
+  std::atomic<uint64_t> agg_dropped;
+};
 
 /*!
  * \brief profiler that records the operation execution information
@@ -108,9 +200,49 @@ class Profiler {
   inline uint64_t GetInitTime() const {
     return init_time_;
   }
+  /*! \brief enable or disable the aggregate statistics */
+  void SetAggregate(bool aggregate);
+  /*! \return whether the aggregate statistics are collected */
+  inline bool IsAggregate() const {
+    return this->aggregate_;
+  }
   /*! \brief add one operation execution record in
-   *   corresponding device statistics */
+   *   the ring buffer of the calling thread */
   OprExecStat* AddOprStat(int dev_type, uint32_t dev_id);
+  /*! \brief finish a record, called on the thread that completes the operation */
+  void FinishOprStat(OprExecStat* opr_stat);
+  /*!
+   * \brief forget the operator running on this thread, called once its function
+   *   returned since an async operator completes on another thread
+   */
+  void ClearCurrentOprStat();
+  /*! \brief add a finished execution to the statistics of the calling thread */
+  void AddAggregateStat(const OprExecStat& opr_stat);
+  /*!
+   * \brief account storage handed out (delta > 0) or returned (delta < 0)
+   * \param dev_type device type of the storage
+   * \param dev_id device id of the storage
+   * \param delta number of bytes
+   */
+  void AddStorageStat(int dev_type, uint32_t dev_id, int64_t delta);
+  /*!
+   * \brief account one allocation from a memory pool
+   * \param hit whether it was served by memory already in the pool
+   * \param reserved bytes held by the pool afterwards
+   */
+  void AddPoolStat(int dev_type, uint32_t dev_id, bool hit, size_t reserved);
+  /*! \brief attribute a temporary space request to the operator running on this thread */
+  void AddTempSpaceStat(size_t size);
+  /*!
+   * \brief get the per-operator statistics of every device as a JSON string
+   * \param reset whether to clear the statistics afterwards
+   */
+  std::string AggregateStats(bool reset);
+  /*!
+   * \brief get the memory statistics of every used device as a JSON string
+   * \param reset_peak whether to set the peaks to the current usage afterwards
+   */
+  std::string MemoryStats(bool reset_peak);
   /*! \return Profiler singleton */
   static Profiler* Get();
 
@@ -125,20 +257,57 @@ class Profiler {
   void EmitEvent(std::ostream *os, const std::string& name,
           const std::string& category, const std::string& ph,
           uint64_t ts, uint32_t pid, uint32_t tid);
+  /*! \brief generate counter information following chrome profile file format */
+  void EmitCounter(std::ostream *os, const std::string& name,
+          const std::string& key, int64_t value, uint64_t ts, uint32_t pid);
+  /*! \return index of the device in the profiler */
+  uint32_t DevIndex(int dev_type, uint32_t dev_id) const;
+  /*! \return the buffer of the calling thread */
+  ProfileThreadBuffer* ThreadBuffer();
+  /*! \brief take a buffer released by an exited thread, or create one */
+  ProfileThreadBuffer* AcquireThreadBuffer();
+  /*!
+   * \brief add the statistics of buf to totals if they belong to epoch,
+   *   needs buffers_mutex_
+   * \return the number of executions buf could not count
+   */
+  uint64_t MergeAggregateStats(const ProfileThreadBuffer& buf, uint64_t epoch,
+                               OprAggTotals* totals);
+  /*!
+   * \brief free the buffers of exited threads once their records are dumped,
+   *   their statistics are kept in retired_agg_
+   */
+  void ReleaseExitedBuffers();
   /*! \brief Profiler instance */
   static Profiler* instance_;
   /*! \brief internal mutex of the profiler */
   std::mutex m_;
-  /*! \brief indicate whether the profiler is running */
-  ProfilerState state_;
+  /*! \brief indicate whether the profiler is running, read by all engine threads */
+  std::atomic<ProfilerState> state_;
   /*! \brief once running, enable profiler to output */
   bool enable_output_;
   /*! \brief indicate what operator the profiler will record */
   ProfilerMode mode_;
   /*! \brief filename to output profile file */
   std::string filename_;
-  /*! \brief profile statistics consist of multiple device statistics */
-  DevStat* profile_stat;
+  /*! \brief device names, indexed by DevIndex */
+  std::vector<std::string> dev_names_;
+  /*! \brief buffers of the threads that profiled, freed after a dump once the thread exits */
+  std::vector<ProfileThreadBuffer*> buffers_;
+  /*! \brief mutex of buffers_ and retired_agg_, freeing a buffer needs it */
+  std::mutex buffers_mutex_;
+  /*! \brief statistics of the buffers freed in the current reset epoch */
+  OprAggTotals retired_agg_;
+  /*! \brief executions the freed buffers could not count */
+  uint64_t retired_agg_dropped_;
+  /*! \brief number of records in the ring of one thread */
+  size_t buffer_size_;
+  /*! \brief whether the aggregate statistics are collected, read by all engine threads */
+  std::atomic<bool> aggregate_;
+  /*! \brief reset epoch of the aggregate statistics */
+  std::atomic<uint64_t> agg_epoch_;
+  /*! \brief memory statistics, indexed by DevIndex */
+  std::unique_ptr<DevMemStat[]> mem_stats_;
   /*! \brief cpu number on the machine */
   unsigned int cpu_num_;
   /*! \brief gpu number on the machine */
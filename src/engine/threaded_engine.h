@@ -335,11 +335,11 @@ class ThreadedEngine : public Engine {
   void ExecuteOprBlock(RunContext run_ctx, OprBlock *opr_block) {
     ThreadedOpr* threaded_opr = opr_block->opr;
 #if MXNET_USE_PROFILER
-    if (opr_block->profiling && threaded_opr->opr_name) {
+    // opr_block is deleted once the operator completes, possibly inside fn
+    const bool profiling = opr_block->profiling && threaded_opr->opr_name;
+    if (profiling) {
       const Context& ctx = opr_block->ctx;
       opr_block->opr_stat = Profiler::Get()->AddOprStat(ctx.dev_type, ctx.dev_id);
-      uint64_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
-      opr_block->opr_stat->thread_id = id;
       strncpy(opr_block->opr_stat->opr_name,
         threaded_opr->opr_name,
         sizeof(opr_block->opr_stat->opr_name) - 1);
@@ -360,6 +360,10 @@ class ThreadedEngine : public Engine {
           LOG(INFO) << "ExecuteOprFn ";
         }
         threaded_opr->fn(run_ctx, callback);
+#if MXNET_USE_PROFILER
+        // an async operator may still be running, but no longer on this thread
+        if (profiling) Profiler::Get()->ClearCurrentOprStat();
+#endif
         if (debug_info) {
           LOG(INFO) << "Fin ExecuteOprFn ";
         }
@@ -115,6 +115,21 @@ void GraphExecutor::Print(std::ostream &os) const {  // NOLINT(*)
   size_t total_bytes = graph_.GetAttr<size_t>("storage_allocated_bytes");
   os << "Total " << (total_bytes >> 20UL) <<" MB allocated\n";
   os << "Total " << 11 << " TempSpace resource requested\n";
+  // planned bytes ignore memory sharing, allocated bytes are the data pool
+  // memory first used by the node
+  const auto& idx = graph_.indexed_graph();
+  size_t total_planned = 0, total_allocated = 0;
+  os << "Memory per node (planned / allocated bytes):\n";
+  for (uint32_t nid = 0; nid < node_planned_bytes_.size(); ++nid) {
+    if (idx[nid].source->is_variable()) continue;
+    os << "\t" << idx[nid].source->attrs.name << "\t" << node_planned_bytes_[nid]
+       << "\t" << node_allocated_bytes_[nid] << "\n";
+    total_planned += node_planned_bytes_[nid];
+    total_allocated += node_allocated_bytes_[nid];
+  }
+  os << "Node memory: " << (total_planned >> 20UL) << " MB planned, "
+     << (total_allocated >> 20UL) << " MB allocated, "
+     << (shared_pool_bytes_ >> 20UL) << " MB reused from the shared pool\n";
 }
 
 void GraphExecutor::SetMonitorCallback(const MonitorCallback& callback) {
@@ -1132,6 +1147,8 @@ void GraphExecutor::InitDataEntryMemory(std::vector<NDArray>* shared_pool) {
     return pool_info[lhs].bytes > pool_info[rhs].bytes;
   };
   std::sort(sorted_pool_index.begin(), sorted_pool_index.end(), pool_comparator);
+  std::vector<bool> pool_new(pool_info.size(), false);
+  shared_pool_bytes_ = 0;
 
   for (size_t i : sorted_pool_index) {
     const Context& ctx = pool_info[i].ctx;
@@ -1140,12 +1157,14 @@ void GraphExecutor::InitDataEntryMemory(std::vector<NDArray>* shared_pool) {
     for (auto it = free_pool.lower_bound(bytes); it != free_pool.end(); ++it) {
       if (it->second.ctx() == ctx && it->first >= bytes) {
         data_pool_[i] = it->second;
+        shared_pool_bytes_ += it->first;
         free_pool.erase(it);
         allocated = true;
         break;
       }
     }
     if (!allocated) {
+      pool_new[i] = true;
       size_t nword = (bytes + 3) / 4;
       CHECK_LE(nword, std::numeric_limits<nnvm::dim_t>::max());
       // allocate float arrays
@@ -1179,6 +1198,23 @@ void GraphExecutor::InitDataEntryMemory(std::vector<NDArray>* shared_pool) {
       LOG(INFO) << "\tinit data entry\t" << i << "\tas " << common::stype_string(storage_type);
     }
   }
+  // planned versus allocated memory of every node, reported by Print
+  node_planned_bytes_.assign(idx.num_nodes(), 0);
+  node_allocated_bytes_.assign(idx.num_nodes(), 0);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (idx[nid].source->is_variable()) continue;
+    for (uint32_t i = 0; i < idx[nid].source->num_outputs(); ++i) {
+      const uint32_t eid = idx.entry_id(nid, i);
+      if (vstorage_type[eid] != kDefaultStorage) continue;
+      node_planned_bytes_[nid] += vshape[eid].Size() * mshadow::mshadow_sizeof(vdtype[eid]);
+      const int storage_id = vstorage[eid];
+      if (storage_id >= 0 && static_cast<size_t>(storage_id) < pool_new.size() &&
+          pool_new[storage_id]) {
+        node_allocated_bytes_[nid] += pool_info[storage_id].bytes;
+        pool_new[storage_id] = false;
+      }
+    }
+  }
 }
 
 
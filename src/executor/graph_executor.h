@@ -206,6 +206,12 @@ class GraphExecutor : public Executor {
   // internal data pool of allocated entries.
   // these allocated entries can be used for static memory sharing between executors.
   std::vector<NDArray> data_pool_;
+  // bytes of the outputs of every node, before memory planning
+  std::vector<size_t> node_planned_bytes_;
+  // bytes of the data pool allocated for the outputs of every node
+  std::vector<size_t> node_allocated_bytes_;
+  // bytes of the data pool taken from the shared pool
+  size_t shared_pool_bytes_{0};
   // output arrays
   std::vector<NDArray> output_arrays_;
   // input argument map, key is arg name, value is arg's NDArray
@@ -0,0 +1,297 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file csr_shard.h
+ * \brief binary CSR shard format, its writer and its memory-mapped reader
+ *
+ *  A shard is a sequence of blocks of rows, each block laid out so that
+ *  it can be handed out as a csr batch without copying:
+ *
+ *    header | block 0 | block 1 | ... | block index
+ *
+ *  block:  indptr[num_rows + 1] (int64, starting at 0) | indices[nnz] (int64)
+ *          | values[nnz] (float32) | labels[num_rows] (float32)
+ *
+ *  Every section starts at a multiple of kCSRShardAlign bytes.
+ */
+#ifndef MXNET_IO_CSR_SHARD_H_
+#define MXNET_IO_CSR_SHARD_H_
+
+#include <mxnet/base.h>
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mxnet {
+namespace io {
+/*! \brief magic number of a csr shard, "MXCSRBIN" */
+const uint64_t kCSRShardMagic = 0x4e4942525343584dULL;
+/*! \brief version of the format */
+const uint64_t kCSRShardVersion = 1;
+/*! \brief alignment of every section in bytes */
+const uint64_t kCSRShardAlign = 64;
+
+inline uint64_t CSRShardAlignUp(uint64_t offset) {
+  return (offset + kCSRShardAlign - 1) / kCSRShardAlign * kCSRShardAlign;
+}
+
+/*! \brief header at the beginning of a shard */
+struct CSRShardHeader {
+  uint64_t magic;
+  uint64_t version;
+  /*! \brief total number of rows */
+  uint64_t num_rows;
+  /*! \brief number of columns, i.e. the feature dimension */
+  uint64_t num_cols;
+  /*! \brief total number of stored entries */
+  uint64_t nnz;
+  /*! \brief number of rows of every block but the last one */
+  uint64_t block_size;
+  /*! \brief number of blocks */
+  uint64_t num_blocks;
+  /*! \brief byte offset of the block index */
+  uint64_t index_offset;
+};
+
+/*! \brief entry of the block index */
+struct CSRShardBlock {
+  /*! \brief byte offset of the block */
+  uint64_t offset;
+  /*! \brief index of the first row in the shard */
+  uint64_t row_begin;
+  /*! \brief number of rows */
+  uint64_t num_rows;
+  /*! \brief number of entries */
+  uint64_t nnz;
+  /*! \brief byte offsets of the sections, relative to the block */
+  inline uint64_t indices_offset() const {
+    return CSRShardAlignUp((num_rows + 1) * sizeof(int64_t));
+  }
+  inline uint64_t values_offset() const {
+    return CSRShardAlignUp(indices_offset() + nnz * sizeof(int64_t));
+  }
+  inline uint64_t labels_offset() const {
+    return CSRShardAlignUp(values_offset() + nnz * sizeof(real_t));
+  }
+  inline uint64_t bytes() const {
+    return CSRShardAlignUp(labels_offset() + num_rows * sizeof(real_t));
+  }
+};
+
+/*! \brief writes rows block by block into a shard */
+class CSRShardWriter {
+ public:
+  CSRShardWriter(const std::string &path, uint64_t block_size)
+      : path_(path), fp_(std::fopen(path.c_str(), "wb")) {
+    CHECK(fp_ != nullptr) << "CSRShardWriter: cannot open " << path;
+    std::memset(&header_, 0, sizeof(header_));
+    header_.magic = kCSRShardMagic;
+    header_.version = kCSRShardVersion;
+    header_.block_size = block_size;
+    // placeholder for the header, which is written again by Close
+    Write(&header_, sizeof(header_));
+    Pad(CSRShardAlignUp(sizeof(header_)));
+  }
+  ~CSRShardWriter() {
+    if (fp_ != nullptr) Close();
+  }
+  /*!
+   * \brief append a block of rows
+   * \param indptr row pointers, num_rows + 1 entries starting at 0
+   * \param indices column indices, indptr[num_rows] entries
+   * \param values values, indptr[num_rows] entries
+   * \param labels label of each row
+   */
+  inline void WriteBlock(const int64_t *indptr, const int64_t *indices, const real_t *values,
+                         const real_t *labels, uint64_t num_rows) {
+    CHECK_EQ(indptr[0], 0);
+    CSRShardBlock blk;
+    blk.offset = offset_;
+    blk.row_begin = header_.num_rows;
+    blk.num_rows = num_rows;
+    blk.nnz = indptr[num_rows];
+    Write(indptr, (num_rows + 1) * sizeof(int64_t));
+    Pad(blk.offset + blk.indices_offset());
+    Write(indices, blk.nnz * sizeof(int64_t));
+    Pad(blk.offset + blk.values_offset());
+    Write(values, blk.nnz * sizeof(real_t));
+    Pad(blk.offset + blk.labels_offset());
+    Write(labels, num_rows * sizeof(real_t));
+    Pad(blk.offset + blk.bytes());
+    for (uint64_t i = 0; i < blk.nnz; ++i) {
+      header_.num_cols = std::max<uint64_t>(header_.num_cols, indices[i] + 1);
+    }
+    header_.num_rows += num_rows;
+    header_.nnz += blk.nnz;
+    blocks_.push_back(blk);
+  }
+  /*! \brief set the number of columns, if larger than the largest index seen */
+  inline void SetNumCols(uint64_t num_cols) {
+    num_cols_ = num_cols;
+  }
+  /*! \brief one plus the largest column index written so far */
+  inline uint64_t max_num_cols() const {
+    return header_.num_cols;
+  }
+  /*! \brief write the block index and the header */
+  inline void Close() {
+    header_.num_blocks = blocks_.size();
+    header_.index_offset = offset_;
+    if (num_cols_ != 0) {
+      CHECK_LE(header_.num_cols, num_cols_)
+          << "CSRShardWriter: " << path_ << " has column index out of num_cols " << num_cols_;
+      header_.num_cols = num_cols_;
+    }
+    Write(dmlc::BeginPtr(blocks_), blocks_.size() * sizeof(CSRShardBlock));
+    CHECK_EQ(std::fseek(fp_, 0, SEEK_SET), 0);
+    CHECK_EQ(std::fwrite(&header_, sizeof(header_), 1, fp_), 1U);
+    std::fclose(fp_);
+    fp_ = nullptr;
+  }
+
+ private:
+  inline void Write(const void *ptr, size_t size) {
+    if (size == 0) return;
+    CHECK_EQ(std::fwrite(ptr, 1, size, fp_), size) << "CSRShardWriter: fail to write " << path_;
+    offset_ += size;
+  }
+  // pad with zeros up to the byte offset pos
+  inline void Pad(uint64_t pos) {
+    static const char zeros[kCSRShardAlign] = {0};
+    CHECK_LE(offset_, pos);
+    CHECK_LT(pos - offset_, kCSRShardAlign);
+    Write(zeros, pos - offset_);
+  }
+
+  std::string path_;
+  std::FILE *fp_;
+  CSRShardHeader header_;
+  std::vector<CSRShardBlock> blocks_;
+  uint64_t offset_{0};
+  uint64_t num_cols_{0};
+};
+
+/*! \brief read-only view of a shard, memory-mapped */
+class CSRShardReader {
+ public:
+  explicit CSRShardReader(const std::string &path) : path_(path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK_NE(fd, -1) << "CSRShardReader: cannot open " << path;
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "CSRShardReader: cannot stat " << path;
+    size_ = st.st_size;
+    CHECK_GE(size_, sizeof(CSRShardHeader)) << "CSRShardReader: " << path << " is truncated";
+    // private mapping: pages are shared through the page cache until someone writes to them
+    void *ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(ptr != MAP_FAILED) << "CSRShardReader: fail to mmap " << path;
+    base_ = static_cast<char*>(ptr);
+#else
+    LOG(FATAL) << "CSRShardReader is not supported on Windows";
+#endif
+    std::memcpy(&header_, base_, sizeof(header_));
+    CHECK_EQ(header_.magic, kCSRShardMagic) << "CSRShardReader: " << path << " is not a csr shard";
+    CHECK_EQ(header_.version, kCSRShardVersion)
+        << "CSRShardReader: unsupported version " << header_.version << " of " << path;
+    CHECK(header_.index_offset <= size_ &&
+          header_.num_blocks <= (size_ - header_.index_offset) / sizeof(CSRShardBlock))
+        << "CSRShardReader: " << path << " is truncated";
+    // the blocks must lie between the header and the index, one after another
+    const uint64_t data_begin = CSRShardAlignUp(sizeof(header_));
+    uint64_t row_begin = 0, nnz = 0;
+    for (size_t i = 0; i < header_.num_blocks; ++i) {
+      const CSRShardBlock &blk = block(i);
+      CHECK(blk.num_rows > 0 && blk.num_rows <= header_.block_size &&
+            blk.row_begin == row_begin && blk.nnz <= size_ &&
+            blk.offset % kCSRShardAlign == 0 && blk.offset >= data_begin &&
+            blk.offset <= header_.index_offset &&
+            blk.bytes() <= header_.index_offset - blk.offset)
+          << "CSRShardReader: " << path << " has an invalid block " << i;
+      row_begin += blk.num_rows;
+      nnz += blk.nnz;
+    }
+    CHECK(row_begin == header_.num_rows && nnz == header_.nnz)
+        << "CSRShardReader: " << path << " has an invalid block index";
+  }
+  ~CSRShardReader() {
+#ifndef _WIN32
+    if (base_ != nullptr) munmap(base_, size_);
+#endif
+  }
+  inline const CSRShardHeader &header() const {
+    return header_;
+  }
+  inline const CSRShardBlock &block(size_t i) const {
+    CHECK_LT(i, header_.num_blocks);
+    return reinterpret_cast<const CSRShardBlock*>(base_ + header_.index_offset)[i];
+  }
+  /*! \brief check that the row pointers of block i stay within the block */
+  inline void CheckBlock(size_t i) const {
+    const CSRShardBlock &blk = block(i);
+    const int64_t *ptr = indptr(i);
+    for (uint64_t r = 0; r < blk.num_rows; ++r) {
+      CHECK_LE(ptr[r], ptr[r + 1]) << "CSRShardReader: " << path_ << " has an invalid block " << i;
+    }
+    CHECK(ptr[0] == 0 && static_cast<uint64_t>(ptr[blk.num_rows]) == blk.nnz)
+        << "CSRShardReader: " << path_ << " has an invalid block " << i;
+  }
+  /*! \brief pointers to the sections of block i */
+  inline int64_t *indptr(size_t i) const {
+    return reinterpret_cast<int64_t*>(base_ + block(i).offset);
+  }
+  inline int64_t *indices(size_t i) const {
+    return reinterpret_cast<int64_t*>(base_ + block(i).offset + block(i).indices_offset());
+  }
+  inline real_t *values(size_t i) const {
+    return reinterpret_cast<real_t*>(base_ + block(i).offset + block(i).values_offset());
+  }
+  inline real_t *labels(size_t i) const {
+    return reinterpret_cast<real_t*>(base_ + block(i).offset + block(i).labels_offset());
+  }
+  /*! \brief hint the kernel that block i will be read soon */
+  inline void WillNeed(size_t i) const {
+#ifndef _WIN32
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t begin = block(i).offset / page * page;
+    madvise(base_ + begin, block(i).offset + block(i).bytes() - begin, MADV_WILLNEED);
+#endif
+  }
+
+ private:
+  std::string path_;
+  CSRShardHeader header_;
+  char *base_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_CSR_SHARD_H_
@@ -122,6 +122,8 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
   size_t shuffle_chunk_size;
   /*! \brief the seed for chunk shuffling*/
   int shuffle_chunk_seed;
+  /*! \brief whether to read single records in a global random order through the index */
+  bool random_access;
 
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageRecParserParam) {
@@ -156,6 +158,11 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
         .describe("The data shuffle buffer size in MB. Only valid if shuffle is true.");
     DMLC_DECLARE_FIELD(shuffle_chunk_seed).set_default(0)
         .describe("The random seed for shuffling");
+    DMLC_DECLARE_FIELD(random_access).set_default(false)
+        .describe("Read the records of path_imgidx with sorted preads. path_imgidx "\
+                  "alone already shuffles single records, reading a batch record by "\
+                  "record in shuffled order. With random_access the reads of a batch "\
+                  "are sorted by file offset and readahead is disabled when shuffling.");
   }
 };
 
@@ -269,6 +276,28 @@ struct ImageNormalizeParam :  public dmlc::Parameter<ImageNormalizeParam> {
   }
 };
 
+// parameters of the uint8 output mode whose normalization is done on the device
+struct ImageDeviceNormalizeParam : public dmlc::Parameter<ImageDeviceNormalizeParam> {
+  /*! \brief layout of the output image batch */
+  int layout;
+  /*! \brief whether to output per-sample augmentation parameters */
+  bool output_aug_params;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ImageDeviceNormalizeParam) {
+    DMLC_DECLARE_FIELD(layout)
+        .add_enum("NCHW", mshadow::kNCHW)
+        .add_enum("NHWC", mshadow::kNHWC)
+        .set_default(mshadow::kNCHW)
+        .describe("Layout of the output image batch. ``data_shape`` is always "
+                  "given in (channels, height, width) format.");
+    DMLC_DECLARE_FIELD(output_aug_params).set_default(false)
+        .describe("If true, mirroring, contrast and illumination are not applied to "
+                  "the pixels. Instead a third output of shape (batch_size, 3) holds "
+                  "(mirror, contrast, illumination) of each sample, to be applied "
+                  "on the device by ``contrib.normalize_and_cast``.");
+  }
+};
+
 // normalize det parameters
 struct ImageDetNormalizeParam :  public dmlc::Parameter<ImageDetNormalizeParam> {
   /*! \brief random seed */
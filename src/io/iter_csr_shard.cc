@@ -0,0 +1,221 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_csr_shard.cc
+ * \brief iterator over memory-mapped binary csr shards
+ */
+#include <mxnet/io.h>
+#include <mxnet/ndarray.h>
+#include <dmlc/base.h>
+#include <dmlc/common.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./csr_shard.h"
+
+namespace mxnet {
+namespace io {
+// CSRShard parameters
+struct CSRShardIterParam : public dmlc::Parameter<CSRShardIterParam> {
+  /*! \brief comma separated paths of the shards */
+  std::string data_shard;
+  /*! \brief whether to shuffle the blocks */
+  bool shuffle;
+  /*! \brief random seed */
+  int seed;
+  /*! \brief partition the shards into multiple parts */
+  int num_parts;
+  /*! \brief the index of the part will read*/
+  int part_index;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(CSRShardIterParam) {
+    DMLC_DECLARE_FIELD(data_shard)
+        .describe("Comma separated paths of the csr shard files, created with tools/libsvm2csr.");
+    DMLC_DECLARE_FIELD(shuffle).set_default(false)
+        .describe("Whether to shuffle the order of the blocks every epoch.");
+    DMLC_DECLARE_FIELD(seed).set_default(0)
+        .describe("The random seed.");
+    DMLC_DECLARE_FIELD(num_parts).set_default(1)
+        .describe("partition the shards into multiple parts");
+    DMLC_DECLARE_FIELD(part_index).set_default(0)
+        .describe("the index of the part will read");
+  }
+};
+
+class CSRShardIter : public IIterator<DataBatch> {
+ public:
+  CSRShardIter() {}
+  virtual ~CSRShardIter() {}
+
+  virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) {
+    param_.InitAllowUnknown(kwargs);
+    CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
+    CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
+    std::vector<std::string> paths = dmlc::Split(param_.data_shard, ',');
+    // shards are assigned to the parts round-robin
+    for (size_t i = param_.part_index; i < paths.size(); i += param_.num_parts) {
+      shards_.push_back(std::make_shared<CSRShardReader>(paths[i]));
+    }
+    CHECK_GT(shards_.size(), 0) << "CSRShardIter: no shard for part " << param_.part_index;
+    batch_size_ = shards_[0]->header().block_size;
+    num_cols_ = 0;
+    uint64_t row_base = 0;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      const CSRShardHeader &header = shards_[s]->header();
+      CHECK_EQ(header.block_size, batch_size_)
+          << "CSRShardIter: all the shards must have the same block size";
+      num_cols_ = std::max(num_cols_, header.num_cols);
+      row_base_.push_back(row_base);
+      row_base += header.num_rows;
+      for (size_t b = 0; b < header.num_blocks; ++b) {
+        order_.emplace_back(s, b);
+      }
+    }
+    rnd_.seed(param_.seed);
+    out_.data.resize(2);
+    out_.index.resize(batch_size_);
+    this->BeforeFirst();
+  }
+
+  virtual void BeforeFirst(void) {
+    cursor_ = 0;
+    if (param_.shuffle) {
+      std::shuffle(order_.begin(), order_.end(), rnd_);
+    }
+    if (order_.size() != 0) {
+      shards_[order_[0].first]->WillNeed(order_[0].second);
+    }
+  }
+
+  virtual bool Next(void) {
+    if (cursor_ >= order_.size()) return false;
+    const size_t s = order_[cursor_].first;
+    const size_t b = order_[cursor_].second;
+    ++cursor_;
+    // let the kernel read the next block while this one is being used
+    if (cursor_ < order_.size()) {
+      shards_[order_[cursor_].first]->WillNeed(order_[cursor_].second);
+    }
+    const std::shared_ptr<CSRShardReader> &shard = shards_[s];
+    const CSRShardBlock &blk = shard->block(b);
+    shard->CheckBlock(b);
+    int64_t *indptr = shard->indptr(b);
+    real_t *labels = shard->labels(b);
+    // the batch keeps the shard mapped, and the padding of a short block, alive
+    std::shared_ptr<void> owner = shard;
+    if (blk.num_rows < batch_size_) {
+      // the last block of a shard is padded with empty rows
+      auto pad = std::make_shared<PaddedBlock>();
+      pad->shard = shard;
+      pad->indptr.assign(batch_size_ + 1, blk.nnz);
+      std::copy(indptr, indptr + blk.num_rows + 1, pad->indptr.begin());
+      pad->labels.assign(batch_size_, 0.0f);
+      std::copy(labels, labels + blk.num_rows, pad->labels.begin());
+      indptr = dmlc::BeginPtr(pad->indptr);
+      labels = dmlc::BeginPtr(pad->labels);
+      owner = pad;
+    }
+    // the arrays point into the mapped file, no copy is made
+    TBlob values(shard->values(b), mshadow::Shape1(blk.nnz), cpu::kDevMask);
+    TBlob indices(shard->indices(b), mshadow::Shape1(blk.nnz), cpu::kDevMask, mshadow::kInt64);
+    TBlob indptr_blob(indptr, mshadow::Shape1(batch_size_ + 1), cpu::kDevMask, mshadow::kInt64);
+    out_.data[0] = NDArray(kCSRStorage, mshadow::Shape2(batch_size_, num_cols_), values,
+                           {indptr_blob, indices}, 0);
+    out_.data[0].KeepStaticDataAlive(owner);
+    out_.data[1] = NDArray(TBlob(labels, mshadow::Shape1(batch_size_), cpu::kDevMask), 0);
+    out_.data[1].KeepStaticDataAlive(owner);
+    for (size_t i = 0; i < batch_size_; ++i) {
+      out_.index[i] = row_base_[s] + blk.row_begin + std::min<uint64_t>(i, blk.num_rows - 1);
+    }
+    out_.num_batch_padd = batch_size_ - blk.num_rows;
+    return true;
+  }
+
+  virtual const DataBatch &Value(void) const {
+    return out_;
+  }
+
+ private:
+  /*! \brief indptr and labels of the last block of a shard, padded to the batch size */
+  struct PaddedBlock {
+    std::shared_ptr<CSRShardReader> shard;
+    std::vector<int64_t> indptr;
+    std::vector<real_t> labels;
+  };
+
+  CSRShardIterParam param_;
+  /*! \brief mapped shards of this part, shared with the batches pointing into them */
+  std::vector<std::shared_ptr<CSRShardReader> > shards_;
+  /*! \brief index of the first row of each shard */
+  std::vector<uint64_t> row_base_;
+  /*! \brief (shard, block) of each batch in the epoch */
+  std::vector<std::pair<size_t, size_t> > order_;
+  /*! \brief position in order_ */
+  size_t cursor_{0};
+  /*! \brief batch size, the block size of the shards */
+  size_t batch_size_{0};
+  /*! \brief number of columns */
+  uint64_t num_cols_{0};
+  /*! \brief random engine for shuffling */
+  std::mt19937 rnd_;
+  /*! \brief output batch */
+  DataBatch out_;
+};
+
+DMLC_REGISTER_PARAMETER(CSRShardIterParam);
+
+MXNET_REGISTER_IO_ITER(CSRShardIter)
+.describe(R"code(Returns the iterator over binary csr shards, with data of `csr`
+storage type. This iterator is experimental and should be used with care.
+
+The shards are created from LibSVM files with ``tools/libsvm2csr``. Each shard
+is a sequence of blocks of rows, and every block is returned as one batch: the
+batch size is the ``block_size`` chosen at conversion. The files are memory-mapped
+and the returned arrays point directly into the mapped pages, so that no parsing
+and no copy happens, and after the first epoch the data is served from the page
+cache. The last block of each shard is padded with empty rows.
+
+The returned arrays keep their shard mapped after the iterator is destroyed,
+and writes to them are private to the process.
+
+With ``shuffle=True``, the order of the blocks is shuffled every epoch.
+
+Example::
+
+  $ bin/libsvm2csr data.t data block_size=256 num_shards=4
+  >>> data_iter = mx.io.CSRShardIter(data_shard='data_0.csr,data_1.csr,data_2.csr,data_3.csr',
+  ...                                shuffle=True)
+  >>> batch = data_iter.next()
+  >>> batch.data[0]
+  <CSRNDArray 256x62061 @cpu(0)>
+
+)code" ADD_FILELINE)
+.add_arguments(CSRShardIterParam::__FIELDS__())
+.set_body([]() {
+    return new CSRShardIter();
+  });
+
+}  // namespace io
+}  // namespace mxnet
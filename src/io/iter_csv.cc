@@ -25,9 +25,8 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
-#include <dmlc/data.h>
 #include "./iter_prefetcher.h"
-#include "./iter_batchloader.h"
+#include "./iter_text_block.h"
 
 namespace mxnet {
 namespace io {
@@ -41,6 +40,8 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
   std::string label_csv;
   /*! \brief label shape */
   TShape label_shape;
+  /*! \brief number of parsing threads */
+  int preprocess_threads;
   // declare parameters
   DMLC_DECLARE_PARAMETER(CSVIterParam) {
     DMLC_DECLARE_FIELD(data_csv)
@@ -53,95 +54,90 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
     index_t shape1[] = {1};
     DMLC_DECLARE_FIELD(label_shape).set_default(TShape(shape1, shape1 + 1))
         .describe("The shape of one label.");
+    DMLC_DECLARE_FIELD(preprocess_threads).set_lower_bound(1).set_default(4)
+        .describe("The number of threads to parse the CSV files and assemble batches.");
   }
 };
 
-class CSVIter: public IIterator<DataInst> {
+/*!
+ * \brief CSV iterator producing whole batches.
+ *  The files are parsed by several threads into blocks of rows,
+ *  which are copied into the batch without per-instance round trip.
+ */
+class CSVIter: public IIterator<TBlobBatch> {
  public:
-  CSVIter() {
-    out_.data.resize(2);
-  }
+  CSVIter() {}
   virtual ~CSVIter() {}
 
   // intialize iterator loads data in
   virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) {
     param_.InitAllowUnknown(kwargs);
-    data_parser_.reset(dmlc::Parser<uint32_t>::Create(param_.data_csv.c_str(), 0, 1, "csv"));
+    batch_param_.InitAllowUnknown(kwargs);
+    TextBlockReader *label_reader = nullptr;
     if (param_.label_csv != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint32_t>::Create(param_.label_csv.c_str(), 0, 1, "csv"));
-    } else {
-      dummy_label.set_pad(false);
-      dummy_label.Resize(mshadow::Shape1(1));
-      dummy_label = 0.0f;
+      label_reader = new TextBlockReader(param_.label_csv, 0, 1,
+                                         param_.preprocess_threads, ParseCSVBlock);
+    }
+    reader_.Init(new TextBlockReader(param_.data_csv, 0, 1,
+                                     param_.preprocess_threads, ParseCSVBlock),
+                 label_reader, batch_param_);
+    // Init space for out
+    const index_t batch_size = batch_param_.batch_size;
+    out_.inst_index = new unsigned[batch_size];
+    out_.batch_size = batch_size;
+    out_.data.clear();
+    data_.resize(2);
+    const TShape shapes[] = {param_.data_shape, param_.label_shape};
+    for (size_t i = 0; i < 2; ++i) {
+      std::vector<index_t> shape_vec;
+      shape_vec.push_back(batch_size);
+      for (index_t dim = 0; dim < shapes[i].ndim(); ++dim) {
+        shape_vec.push_back(shapes[i][dim]);
+      }
+      TShape dst_shape(shape_vec.begin(), shape_vec.end());
+      data_[i].resize(mshadow::Shape1(dst_shape.Size()), mshadow::DataType<real_t>::kFlag);
+      out_.data.push_back(TBlob(data_[i].dptr_, dst_shape, cpu::kDevMask,
+                                mshadow::DataType<real_t>::kFlag, 0));
+    }
+    if (param_.label_csv == "NULL") {
+      // all labels are returned as 0
+      std::fill(data_[1].dptr<real_t>(), data_[1].dptr<real_t>() + data_[1].Size(), 0.0f);
     }
   }
 
   virtual void BeforeFirst() {
-    data_parser_->BeforeFirst();
-    if (label_parser_.get() != nullptr) {
-      label_parser_->BeforeFirst();
-    }
-    data_ptr_ = label_ptr_ = 0;
-    data_size_ = label_size_ = 0;
-    inst_counter_ = 0;
-    end_ = false;
+    reader_.BeforeFirst();
   }
 
   virtual bool Next() {
-    if (end_) return false;
-    while (data_ptr_ >= data_size_) {
-      if (!data_parser_->Next()) {
-        end_ = true; return false;
-      }
-      data_ptr_ = 0;
-      data_size_ = data_parser_->Value().size;
+    if (!reader_.NextBatch(&data_segs_, &label_segs_, &out_.num_batch_padd)) {
+      return false;
     }
-    out_.index = inst_counter_++;
-    CHECK_LT(data_ptr_, data_size_);
-    out_.data[0] = AsTBlob(data_parser_->Value()[data_ptr_++], param_.data_shape);
-
-    if (label_parser_.get() != nullptr) {
-      while (label_ptr_ >= label_size_) {
-        CHECK(label_parser_->Next())
-            << "Data CSV's row is smaller than the number of rows in label_csv";
-        label_ptr_ = 0;
-        label_size_ = label_parser_->Value().size;
-      }
-      CHECK_LT(label_ptr_, label_size_);
-      out_.data[1] = AsTBlob(label_parser_->Value()[label_ptr_++], param_.label_shape);
-    } else {
-      out_.data[1] = dummy_label;
+    CopyRowIndex(data_segs_, out_.inst_index);
+    CopyDenseRows(data_segs_, param_.data_shape.Size(), data_[0].dptr<real_t>(),
+                  param_.preprocess_threads);
+    if (param_.label_csv != "NULL") {
+      CopyDenseRows(label_segs_, param_.label_shape.Size(), data_[1].dptr<real_t>(),
+                    param_.preprocess_threads);
     }
     return true;
   }
 
-  virtual const DataInst &Value(void) const {
+  virtual const TBlobBatch &Value(void) const {
     return out_;
   }
 
  private:
-  inline TBlob AsTBlob(const dmlc::Row<uint32_t>& row, const TShape& shape) {
-    CHECK_EQ(row.length, shape.Size())
-        << "The data size in CSV do not match size of shape: "
-        << "specified shape=" << shape << ", the csv row-length=" << row.length;
-    const real_t* ptr = row.value;
-    return TBlob((real_t*)ptr, shape, cpu::kDevMask, 0);  // NOLINT(*)
-  }
-
   CSVIterParam param_;
-  // output instance
-  DataInst out_;
-  // internal instance counter
-  unsigned inst_counter_{0};
-  // at end
-  bool end_{false};
-  // dummy label
-  mshadow::TensorContainer<cpu, 1, real_t> dummy_label;
-  // label parser
-  size_t label_ptr_{0}, label_size_{0};
-  size_t data_ptr_{0}, data_size_{0};
-  std::unique_ptr<dmlc::Parser<uint32_t> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint32_t> > data_parser_;
+  BatchParam batch_param_;
+  // output batch
+  TBlobBatch out_;
+  // batch memory of data and label
+  std::vector<TBlobContainer> data_;
+  // splits the files into batches
+  TextBatchReader reader_;
+  // row ranges of the current batch
+  std::vector<TextBlockSegment> data_segs_, label_segs_;
 };
 
 
@@ -225,8 +221,7 @@ Examples::
 .add_arguments(PrefetcherParam::__FIELDS__())
 .set_body([]() {
     return new PrefetcherIter(
-        new BatchLoader(
-            new CSVIter()));
+        new CSVIter());
   });
 
 }  // namespace io
@@ -32,6 +32,7 @@
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
 #include <dmlc/timer.h>
+#include <algorithm>
 #include <type_traits>
 #if MXNET_USE_LIBJPEG_TURBO
 #include <turbojpeg.h>
@@ -40,6 +41,7 @@
 #include "./image_augmenter.h"
 #include "./image_iter_common.h"
 #include "./inst_vector.h"
+#include "./random_access_recordio.h"
 #include "../common/utils.h"
 
 namespace mxnet {
@@ -74,19 +76,29 @@ class ImageRecordIOParser2 {
   cv::Mat TJimdecode(cv::Mat buf, int color);
 #endif
 #endif
-  inline unsigned ParseChunk(DType* data_dptr, real_t* label_dptr, const unsigned current_size,
-    dmlc::InputSplit::Blob * chunk);
+  inline unsigned ParseChunk(DType* data_dptr, real_t* label_dptr, real_t* aug_dptr,
+    const unsigned current_size, dmlc::InputSplit::Blob * chunk);
+  /*! \brief shape of one output image in the output layout */
+  inline mshadow::Shape<3> ImageShape(int n_channels, int rows, int cols) const {
+    if (device_norm_param_.layout == mshadow::kNHWC) {
+      return mshadow::Shape3(rows, cols, n_channels);
+    }
+    return mshadow::Shape3(n_channels, rows, cols);
+  }
   inline void CreateMeanImg(void);
 
   // magic number to seed prng
   static const int kRandMagic = 111;
   static const int kRandMagicNormalize = 0;
+  // number of augmentation parameters per sample: mirror, contrast, illumination
+  static const int kAugParamWidth = 3;
   /*! \brief parameters */
   ImageRecParserParam param_;
   ImageRecordParam record_param_;
   BatchParam batch_param_;
   ImageNormalizeParam normalize_param_;
   PrefetcherParam prefetch_param_;
+  ImageDeviceNormalizeParam device_norm_param_;
   #if MXNET_USE_OPENCV
   /*! \brief augmenters */
   std::vector<std::vector<std::unique_ptr<ImageAugmenter> > > augmenters_;
@@ -100,6 +112,8 @@ class ImageRecordIOParser2 {
   std::unique_ptr<ImageLabelMap> label_map_;
   /*! \brief temporary results */
   std::vector<InstVector<DType>> temp_;
+  /*! \brief augmentation parameters of the temporary results */
+  std::vector<std::vector<real_t>> temp_aug_;
   /*! \brief temp space */
   mshadow::TensorContainer<cpu, 3> img_;
   /*! \brief internal instance order */
@@ -131,6 +145,25 @@ inline void ImageRecordIOParser2<DType>::Init(
   batch_param_.InitAllowUnknown(kwargs);
   normalize_param_.InitAllowUnknown(kwargs);
   prefetch_param_.InitAllowUnknown(kwargs);
+  device_norm_param_.InitAllowUnknown(kwargs);
+  CHECK(std::is_same<DType, uint8_t>::value ||
+        (device_norm_param_.layout == mshadow::kNCHW && !device_norm_param_.output_aug_params))
+      << "ImageRecordIter2: layout and output_aug_params are only supported "
+         "by ImageRecordUInt8Iter";
+  if (std::is_same<DType, uint8_t>::value) {
+    // uint8 pixels are not normalized on the host, only mirrored
+    const ImageNormalizeParam& p = normalize_param_;
+    CHECK(p.mean_img.empty() && p.mean_r == 0.0f && p.mean_g == 0.0f &&
+          p.mean_b == 0.0f && p.mean_a == 0.0f && p.std_r == 1.0f && p.std_g == 1.0f &&
+          p.std_b == 1.0f && p.std_a == 1.0f)
+      << "ImageRecordUInt8Iter does not subtract a mean or divide by a std, pass them "
+         "to contrib.normalize_and_cast instead";
+    CHECK(device_norm_param_.output_aug_params ||
+          (p.scale == 1.0f && p.max_random_contrast == 0.0f &&
+           p.max_random_illumination == 0.0f))
+      << "ImageRecordUInt8Iter only outputs scale, max_random_contrast and "
+         "max_random_illumination with output_aug_params=True";
+  }
   n_parsed_ = 0;
   overflow = false;
   rnd_.seed(kRandMagic + record_param_.seed);
@@ -170,7 +203,15 @@ inline void ImageRecordIOParser2<DType>::Init(
               << ", use " << threadget << " threads for decoding..";
   }
   legacy_shuffle_ = false;
-  if (param_.path_imgidx.length() != 0) {
+  if (param_.random_access) {
+    CHECK(param_.path_imgidx.length() != 0)
+        << "ImageRecordIter2: random_access requires path_imgidx";
+    source_.reset(new RandomAccessRecordIOSplit(
+        param_.path_imgrec, param_.path_imgidx,
+        param_.part_index, param_.num_parts,
+        record_param_.shuffle, kRandMagic + record_param_.seed,
+        batch_param_.batch_size));
+  } else if (param_.path_imgidx.length() != 0) {
     source_.reset(dmlc::InputSplit::Create(
         param_.path_imgrec.c_str(),
         param_.path_imgidx.c_str(),
@@ -266,14 +307,18 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch *out) {
   if (out->data.size() == 0) {
     // This assumes that DataInst given by
     // InstVector contains only 2 elements in
-    // data vector (operator[] implementation)
-    out->data.resize(2);
-    unit_size_.resize(2);
-
+    // data vector (operator[] implementation),
+    // augmentation parameters are kept aside in temp_aug_
+    const size_t num_out = device_norm_param_.output_aug_params ? 3 : 2;
+    out->data.resize(num_out);
+    unit_size_.resize(num_out);
+
+    mshadow::Shape<3> img_shape = ImageShape(param_.data_shape[0], param_.data_shape[1],
+                                             param_.data_shape[2]);
     std::vector<index_t> shape_vec;
     shape_vec.push_back(batch_param_.batch_size);
-    for (index_t dim = 0; dim < param_.data_shape.ndim(); ++dim) {
-      shape_vec.push_back(param_.data_shape[dim]);
+    for (index_t dim = 0; dim < 3; ++dim) {
+      shape_vec.push_back(img_shape[dim]);
     }
     TShape data_shape(shape_vec.begin(), shape_vec.end());
 
@@ -288,6 +333,11 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch *out) {
       mshadow::DataType<real_t>::kFlag);
     unit_size_[0] = param_.data_shape.Size();
     unit_size_[1] = param_.label_width;
+    if (device_norm_param_.output_aug_params) {
+      out->data.at(2) = NDArray(mshadow::Shape2(batch_param_.batch_size, kAugParamWidth),
+        Context::CPUPinned(0), false, mshadow::DataType<real_t>::kFlag);
+      unit_size_[2] = kAugParamWidth;
+    }
   }
 
   while (current_size < batch_param_.batch_size) {
@@ -299,10 +349,12 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch *out) {
         inst_index_ = 0;
         DType* data_dptr = static_cast<DType*>(out->data[0].data().dptr_);
         real_t* label_dptr = static_cast<real_t*>(out->data[1].data().dptr_);
+        real_t* aug_dptr = device_norm_param_.output_aug_params ?
+                           static_cast<real_t*>(out->data[2].data().dptr_) : NULL;
         if (!legacy_shuffle_) {
-          n_to_out = ParseChunk(data_dptr, label_dptr, current_size, &chunk);
+          n_to_out = ParseChunk(data_dptr, label_dptr, aug_dptr, current_size, &chunk);
         } else {
-          n_to_out = ParseChunk(NULL, NULL, batch_param_.batch_size, &chunk);
+          n_to_out = ParseChunk(NULL, NULL, NULL, batch_param_.batch_size, &chunk);
         }
         // Count number of parsed images that do not fit into current out
         n_parsed_ = inst_order_.size();
@@ -341,6 +393,13 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch *out) {
               batch.data[j].get_with_shape<cpu, 1, dtype>(mshadow::Shape1(unit_size_[j])));
           });
         }
+        if (device_norm_param_.output_aug_params) {
+          const real_t* aug = dmlc::BeginPtr(temp_aug_[place.first]) +
+                              place.second * kAugParamWidth;
+          std::copy(aug, aug + kAugParamWidth,
+                    static_cast<real_t*>(out->data[2].data().dptr_) +
+                    (current_size + i) * kAugParamWidth);
+        }
       }
       n_to_out = n_to_copy;
       inst_index_ += n_to_copy;
@@ -392,6 +451,7 @@ void ImageRecordIOParser2<DType>::ProcessImage(const cv::Mat& res,
     swap_indices[3] = 3;
   }
 
+  const bool nhwc = device_norm_param_.layout == mshadow::kNHWC;
   DType RGBA[n_channels] = {};
   for (int i = 0; i < res.rows; ++i) {
     const uchar* im_data = res.ptr<uchar>(i);
@@ -410,13 +470,16 @@ void ImageRecordIOParser2<DType>::ProcessImage(const cv::Mat& res,
           }
         }
       }
-      for (int k = 0; k < n_channels; ++k) {
-        // mirror here to avoid memory copies
-        // logic from iter_normalize.h, function SetOutImg
-        if (is_mirrored) {
-          data[k][i][res.cols - j - 1] = RGBA[k];
-        } else {
-          data[k][i][j] = RGBA[k];
+      // mirror here to avoid memory copies
+      // logic from iter_normalize.h, function SetOutImg
+      const int col = is_mirrored ? res.cols - j - 1 : j;
+      if (nhwc) {
+        for (int k = 0; k < n_channels; ++k) {
+          data[i][col][k] = RGBA[k];
+        }
+      } else {
+        for (int k = 0; k < n_channels; ++k) {
+          data[k][i][col] = RGBA[k];
         }
       }
       im_data += n_channels;
@@ -477,8 +540,9 @@ cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
 // Returns the number of images that are put into output
 template<typename DType>
 inline unsigned ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr, real_t* label_dptr,
-  const unsigned current_size, dmlc::InputSplit::Blob * chunk) {
+  real_t* aug_dptr, const unsigned current_size, dmlc::InputSplit::Blob * chunk) {
   temp_.resize(param_.preprocess_threads);
+  temp_aug_.resize(param_.preprocess_threads);
 #if MXNET_USE_OPENCV
   // save opencv out
   dmlc::RecordIOChunkReader reader(*chunk, 0, 1);
@@ -493,6 +557,8 @@ inline unsigned ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr, real_t
     // image data
     InstVector<DType> &out_tmp = temp_[tid];
     out_tmp.Clear();
+    std::vector<real_t> &aug_tmp = temp_aug_[tid];
+    aug_tmp.clear();
     while (true) {
       bool reader_has_data;
       unsigned idx;
@@ -543,10 +609,10 @@ inline unsigned ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr, real_t
       mshadow::Tensor<cpu, 3, DType> data;
       if (idx < batch_param_.batch_size) {
         data = mshadow::Tensor<cpu, 3, DType>(data_dptr + idx*unit_size_[0],
-          mshadow::Shape3(n_channels, res.rows, res.cols));
+          ImageShape(n_channels, res.rows, res.cols));
       } else {
         out_tmp.Push(static_cast<unsigned>(rec.image_index()),
-                 mshadow::Shape3(n_channels, res.rows, res.cols),
+                 ImageShape(n_channels, res.rows, res.cols),
                  mshadow::Shape1(param_.label_width));
         data = out_tmp.data().Back();
       }
@@ -557,7 +623,7 @@ inline unsigned ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr, real_t
                          || normalize_param_.mirror;
       float contrast_scaled;
       float illumination_scaled;
-      if (!std::is_same<DType, uint8_t>::value) {
+      if (!std::is_same<DType, uint8_t>::value || device_norm_param_.output_aug_params) {
         contrast_scaled =
           (rand_uniform(*(prnds_[tid])) * normalize_param_.max_random_contrast * 2
           - normalize_param_.max_random_contrast + 1)*normalize_param_.scale;
@@ -565,6 +631,20 @@ inline unsigned ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr, real_t
           (rand_uniform(*(prnds_[tid])) * normalize_param_.max_random_illumination * 2
           - normalize_param_.max_random_illumination) * normalize_param_.scale;
       }
+      if (device_norm_param_.output_aug_params) {
+        // leave the pixels untouched and let normalize_and_cast apply them on the device
+        real_t* aug;
+        if (idx < batch_param_.batch_size) {
+          aug = aug_dptr + idx * kAugParamWidth;
+        } else {
+          aug_tmp.resize(aug_tmp.size() + kAugParamWidth);
+          aug = dmlc::BeginPtr(aug_tmp) + aug_tmp.size() - kAugParamWidth;
+        }
+        aug[0] = is_mirrored ? 1.0f : 0.0f;
+        aug[1] = contrast_scaled;
+        aug[2] = illumination_scaled;
+        is_mirrored = false;
+      }
       // For RGB or RGBA data, swap the B and R channel:
       // OpenCV store as BGR (or BGRA) and we want RGB (or RGBA)
       if (n_channels == 1) {
@@ -620,7 +700,7 @@ inline void ImageRecordIOParser2<DType>::CreateMeanImg(void) {
     while (source_->NextChunk(&chunk)) {
       inst_order_.clear();
       // Parse chunk w/o putting anything in out
-      ParseChunk(NULL, NULL, batch_param_.batch_size, &chunk);
+      ParseChunk(NULL, NULL, NULL, batch_param_.batch_size, &chunk);
       for (unsigned i = 0; i < inst_order_.size(); ++i) {
         std::pair<unsigned, unsigned> place = inst_order_[i];
         mshadow::Tensor<cpu, 3> outimg =
@@ -761,12 +841,38 @@ MXNET_REGISTER_IO_ITER(ImageRecordUInt8Iter)
 This iterator is identical to ``ImageRecordIter`` except for using ``uint8`` as
 the data type instead of ``float``.
 
+The batch can be produced in ``NHWC`` layout with ``layout='NHWC'``. With
+``output_aug_params=True`` the random mirroring, contrast and illumination
+(``rand_mirror``, ``mirror``, ``max_random_contrast``, ``max_random_illumination``
+and ``scale``) are not applied to the pixels; the iterator instead outputs them
+per sample as ``aug_params`` of shape ``(batch_size, 3)``, so that mean
+subtraction, scaling and mirroring run on the compute device through
+``contrib.normalize_and_cast``. This keeps host-to-device traffic at one byte
+per pixel.
+
+The pixels are never normalized on the host: setting a mean or a std is an
+error, and so is setting ``scale``, ``max_random_contrast`` or
+``max_random_illumination`` without ``output_aug_params=True``.
+
+Example::
+
+  data_iter = mx.io.ImageRecordUInt8Iter(
+    path_imgrec="./sample.rec", data_shape=(3, 224, 224), batch_size=32,
+    layout='NHWC', rand_mirror=True, output_aug_params=True)
+  batch = data_iter.next()
+  images, aug_params = batch.data  # uint8 (32, 224, 224, 3), float32 (32, 3)
+  x = mx.nd.contrib.normalize_and_cast(images.as_in_context(mx.gpu(0)),
+                                       aug_params.as_in_context(mx.gpu(0)),
+                                       layout='NHWC', mean=(123.68, 116.28, 103.53))
+
 )code" ADD_FILELINE)
 .add_arguments(ImageRecParserParam::__FIELDS__())
 .add_arguments(ImageRecordParam::__FIELDS__())
 .add_arguments(BatchParam::__FIELDS__())
 .add_arguments(PrefetcherParam::__FIELDS__())
+.add_arguments(ImageDeviceNormalizeParam::__FIELDS__())
 .add_arguments(ListDefaultAugParams())
+.add_arguments(ImageNormalizeParam::__FIELDS__())
 .set_body([]() {
     return new ImageRecordIter2<uint8_t>();
   });
@@ -25,9 +25,8 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
-#include <dmlc/data.h>
 #include "./iter_sparse_prefetcher.h"
-#include "./iter_sparse_batchloader.h"
+#include "./iter_text_block.h"
 
 namespace mxnet {
 namespace io {
@@ -45,6 +44,8 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
   int num_parts;
   /*! \brief the index of the part will read*/
   int part_index;
+  /*! \brief number of parsing threads */
+  int preprocess_threads;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LibSVMIterParam) {
     DMLC_DECLARE_FIELD(data_libsvm)
@@ -61,10 +62,17 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
         .describe("partition the data into multiple parts");
     DMLC_DECLARE_FIELD(part_index).set_default(0)
         .describe("the index of the part will read");
+    DMLC_DECLARE_FIELD(preprocess_threads).set_lower_bound(1).set_default(4)
+        .describe("The number of threads to parse the LibSVM files and assemble batches.");
   }
 };
 
-class LibSVMIter: public SparseIIterator<DataInst> {
+/*!
+ * \brief LibSVM iterator producing whole CSR batches.
+ *  The files are parsed by several threads into CSR blocks of rows,
+ *  whose indices and values are copied into the batch block by block.
+ */
+class LibSVMIter: public SparseIIterator<TBlobBatch> {
  public:
   LibSVMIter() {}
   virtual ~LibSVMIter() {}
@@ -72,79 +80,67 @@ class LibSVMIter: public SparseIIterator<DataInst> {
   // intialize iterator loads data in
   virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) {
     param_.InitAllowUnknown(kwargs);
+    batch_param_.InitAllowUnknown(kwargs);
     CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
     CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
     CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
-    data_parser_.reset(dmlc::Parser<uint64_t>::Create(param_.data_libsvm.c_str(),
-                                                      param_.part_index,
-                                                      param_.num_parts, "libsvm"));
+    if (batch_param_.round_batch == 0) {
+      LOG(FATAL) << "LibSVMIter doesn't support round_batch == false yet";
+    }
+    TextBlockReader *label_reader = nullptr;
     if (param_.label_libsvm != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint64_t>::Create(param_.label_libsvm.c_str(),
-                                                         param_.part_index,
-                                                         param_.num_parts, "libsvm"));
+      label_reader = new TextBlockReader(param_.label_libsvm, param_.part_index,
+                                         param_.num_parts, param_.preprocess_threads,
+                                         ParseLibSVMBlock);
       CHECK_GT(param_.label_shape.Size(), 1)
         << "label_shape is not expected to be (1,) when param_.label_libsvm is set.";
     } else {
       CHECK_EQ(param_.label_shape.Size(), 1)
         << "label_shape is expected to be (1,) when param_.label_libsvm is NULL";
     }
+    reader_.Init(new TextBlockReader(param_.data_libsvm, param_.part_index,
+                                     param_.num_parts, param_.preprocess_threads,
+                                     ParseLibSVMBlock),
+                 label_reader, batch_param_);
+    out_.inst_index = new unsigned[batch_param_.batch_size];
+    out_.batch_size = batch_param_.batch_size;
     // both data and label are of CSRStorage in libsvm format
     if (param_.label_shape.Size() > 1) {
+      data_.resize(6);
       out_.data.resize(6);
     } else {
       // only data is of CSRStorage in libsvm format.
+      data_.resize(4);
       out_.data.resize(4);
+      ResizeBlob(3, batch_param_.batch_size, mshadow::DataType<real_t>::kFlag);
+    }
+    ResizeBlob(2, batch_param_.batch_size + 1, mshadow::kInt64);
+    if (param_.label_shape.Size() > 1) {
+      ResizeBlob(5, batch_param_.batch_size + 1, mshadow::kInt64);
     }
   }
 
   virtual void BeforeFirst() {
-    data_parser_->BeforeFirst();
-    if (label_parser_.get() != nullptr) {
-      label_parser_->BeforeFirst();
-    }
-    data_ptr_ = label_ptr_ = 0;
-    data_size_ = label_size_ = 0;
-    inst_counter_ = 0;
-    end_ = false;
+    reader_.BeforeFirst();
   }
 
   virtual bool Next() {
-    if (end_) return false;
-    while (data_ptr_ >= data_size_) {
-      if (!data_parser_->Next()) {
-        end_ = true; return false;
-      }
-      data_ptr_ = 0;
-      data_size_ = data_parser_->Value().size;
+    out_.batch_size = batch_param_.batch_size;
+    if (!reader_.NextBatch(&data_segs_, &label_segs_, &out_.num_batch_padd)) {
+      return false;
     }
-    out_.index = inst_counter_++;
-    CHECK_LT(data_ptr_, data_size_);
-    const auto data_row = data_parser_->Value()[data_ptr_++];
+    CopyRowIndex(data_segs_, out_.inst_index);
     // data, indices and indptr
-    out_.data[0] = AsDataBlob(data_row);
-    out_.data[1] = AsIdxBlob(data_row);
-    out_.data[2] = AsIndPtrPlaceholder(data_row);
-
-    if (label_parser_.get() != nullptr) {
-      while (label_ptr_ >= label_size_) {
-        CHECK(label_parser_->Next())
-            << "Data LibSVM's row is smaller than the number of rows in label_libsvm";
-        label_ptr_ = 0;
-        label_size_ = label_parser_->Value().size;
-      }
-      CHECK_LT(label_ptr_, label_size_);
-      const auto label_row = label_parser_->Value()[label_ptr_++];
-      // data, indices and indptr
-      out_.data[3] = AsDataBlob(label_row);
-      out_.data[4] = AsIdxBlob(label_row);
-      out_.data[5] = AsIndPtrPlaceholder(label_row);
+    CopyCSR(data_segs_, 0);
+    if (param_.label_shape.Size() > 1) {
+      CopyCSR(label_segs_, 3);
     } else {
-      out_.data[3] = AsScalarLabelBlob(data_row);
+      CopyRowLabels(data_segs_, data_[3].dptr<real_t>());
     }
     return true;
   }
 
-  virtual const DataInst &Value(void) const {
+  virtual const TBlobBatch &Value(void) const {
     return out_;
   }
 
@@ -154,44 +150,41 @@ class LibSVMIter: public SparseIIterator<DataInst> {
   }
 
   virtual const TShape GetShape(bool is_data) const {
-    if (is_data) return param_.data_shape;
-    return param_.label_shape;
+    TShape inst_shape = is_data ? param_.data_shape : param_.label_shape;
+    std::vector<index_t> shape_vec;
+    shape_vec.push_back(batch_param_.batch_size);
+    for (index_t dim = 0; dim < inst_shape.ndim(); ++dim) {
+      shape_vec.push_back(inst_shape[dim]);
+    }
+    return TShape(shape_vec.begin(), shape_vec.end());
   }
 
  private:
-  inline TBlob AsDataBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.value;
-    TShape shape(mshadow::Shape1(row.length));
-    return TBlob((real_t*) ptr, shape, cpu::kDevMask);  // NOLINT(*)
-  }
-
-  inline TBlob AsIdxBlob(const dmlc::Row<uint64_t>& row) {
-    const uint64_t* ptr = row.index;
-    TShape shape(mshadow::Shape1(row.length));
-    return TBlob((int64_t*) ptr, shape, cpu::kDevMask, mshadow::kInt64);  // NOLINT(*)
-  }
-
-  inline TBlob AsIndPtrPlaceholder(const dmlc::Row<uint64_t>& row) {
-    return TBlob(nullptr, mshadow::Shape1(0), cpu::kDevMask, mshadow::kInt64);
+  // (re)allocate the i-th output blob with size elements
+  inline void ResizeBlob(size_t i, size_t size, int type_flag) {
+    data_[i].resize(mshadow::Shape1(size), type_flag);
+    out_.data[i] = TBlob(data_[i].dptr_, mshadow::Shape1(size), cpu::kDevMask, type_flag);
   }
 
-  inline TBlob AsScalarLabelBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.label;
-    return TBlob((real_t*) ptr, mshadow::Shape1(1), cpu::kDevMask);  // NOLINT(*)
+  // copy the rows into the values, indices and indptr blobs starting at position i
+  inline void CopyCSR(const std::vector<TextBlockSegment> &segs, size_t i) {
+    const size_t nnz = NumEntries(segs);
+    ResizeBlob(i, nnz, mshadow::DataType<real_t>::kFlag);
+    ResizeBlob(i + 1, nnz, mshadow::kInt64);
+    CopyCSRRows(segs, data_[i + 2].dptr<int64_t>(), data_[i + 1].dptr<int64_t>(),
+                data_[i].dptr<real_t>(), param_.preprocess_threads);
   }
 
   LibSVMIterParam param_;
-  // output instance
-  DataInst out_;
-  // internal instance counter
-  unsigned inst_counter_{0};
-  // at end
-  bool end_{false};
-  // label parser
-  size_t label_ptr_{0}, label_size_{0};
-  size_t data_ptr_{0}, data_size_{0};
-  std::unique_ptr<dmlc::Parser<uint64_t> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint64_t> > data_parser_;
+  BatchParam batch_param_;
+  // output batch
+  TBlobBatch out_;
+  // batch memory of each output blob
+  std::vector<TBlobContainer> data_;
+  // splits the files into batches
+  TextBatchReader reader_;
+  // row ranges of the current batch
+  std::vector<TextBlockSegment> data_segs_, label_segs_;
 };
 
 
@@ -301,8 +294,7 @@ Example::
 .add_arguments(PrefetcherParam::__FIELDS__())
 .set_body([]() {
     return new SparsePrefetcherIter(
-        new SparseBatchLoader(
-            new LibSVMIter()));
+        new LibSVMIter());
   });
 
 }  // namespace io
@@ -0,0 +1,430 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_text_block.h
+ * \brief parallel parsing of text data files (csv, libsvm) into blocks,
+ *  and assembly of whole batches from the parsed blocks
+ */
+#ifndef MXNET_IO_ITER_TEXT_BLOCK_H_
+#define MXNET_IO_ITER_TEXT_BLOCK_H_
+
+#include <mxnet/base.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "./image_iter_common.h"
+
+namespace mxnet {
+namespace io {
+/*!
+ * \brief a block of rows parsed from text, in CSR layout.
+ *  Dense formats leave index empty and store every column in value.
+ */
+struct TextBlock {
+  /*! \brief entries of row i are [offset[i], offset[i + 1]) */
+  std::vector<size_t> offset;
+  /*! \brief label of each row, if the format has one */
+  std::vector<real_t> label;
+  /*! \brief column index of each entry */
+  std::vector<int64_t> index;
+  /*! \brief value of each entry */
+  std::vector<real_t> value;
+  /*! \brief number of rows */
+  inline size_t Size() const {
+    return offset.size() - 1;
+  }
+  inline void Clear() {
+    offset.assign(1, 0);
+    label.clear();
+    index.clear();
+    value.clear();
+  }
+};
+
+/*! \brief a range of rows in a parsed block */
+struct TextBlockSegment {
+  /*! \brief the block, kept alive until the batch is assembled */
+  std::shared_ptr<TextBlock> block;
+  /*! \brief row range [begin, end) in the block */
+  size_t begin, end;
+  /*! \brief index of the first row since the last BeforeFirst */
+  size_t row_index;
+};
+
+/*!
+ * \brief parses the whole lines in [begin, end) and appends them to the block
+ */
+typedef std::function<void(const char *begin, const char *end, TextBlock *out)> TextLineParser;
+
+/*!
+ * \brief parse one real number token from [*p, end), advancing *p past it.
+ *  Input chunks are not null terminated, so the token is copied before strtof.
+ * \return false if there is no token at *p
+ */
+inline bool ParseRealToken(const char **p, const char *end, real_t *out) {
+  const char *q = *p;
+  while (q != end && *q != ',' && *q != ' ' && *q != '\t' &&
+         *q != ':' && *q != '\n' && *q != '\r') ++q;
+  if (q == *p) return false;
+  char buf[64];
+  const size_t len = std::min(static_cast<size_t>(q - *p), sizeof(buf) - 1);
+  std::memcpy(buf, *p, len);
+  buf[len] = '\0';
+  *out = static_cast<real_t>(std::strtof(buf, nullptr));
+  *p = q;
+  return true;
+}
+
+/*!
+ * \brief parse one non-negative integer token from [*p, end), advancing *p past it.
+ * \return false if there is no digit at *p
+ */
+inline bool ParseIndexToken(const char **p, const char *end, int64_t *out) {
+  const char *q = *p;
+  int64_t v = 0;
+  while (q != end && *q >= '0' && *q <= '9') {
+    v = v * 10 + (*q - '0');
+    ++q;
+  }
+  if (q == *p) return false;
+  *out = v;
+  *p = q;
+  return true;
+}
+
+/*! \brief skip spaces and tabs */
+inline const char *SkipBlank(const char *p, const char *end) {
+  while (p != end && (*p == ' ' || *p == '\t')) ++p;
+  return p;
+}
+
+/*! \brief end of the line starting at p */
+inline const char *FindLineEnd(const char *p, const char *end) {
+  while (p != end && *p != '\n' && *p != '\r') ++p;
+  return p;
+}
+
+// parse comma separated rows of real numbers
+inline void ParseCSVBlock(const char *begin, const char *end, TextBlock *out) {
+  const char *p = begin;
+  while (p != end) {
+    const char *lend = FindLineEnd(p, end);
+    const size_t row_begin = out->value.size();
+    p = SkipBlank(p, lend);
+    while (p != lend) {
+      p = SkipBlank(p, lend);
+      real_t v;
+      if (!ParseRealToken(&p, lend, &v)) {
+        // an empty field is read as 0
+        CHECK(p == lend || *p == ',') << "Invalid CSV format";
+        v = 0.0f;
+      }
+      out->value.push_back(v);
+      p = SkipBlank(p, lend);
+      if (p != lend) {
+        CHECK_EQ(*p, ',') << "Invalid CSV format";
+        ++p;
+      }
+    }
+    if (out->value.size() != row_begin) {
+      out->offset.push_back(out->value.size());
+    }
+    // skip the line break
+    while (p != end && (*p == '\n' || *p == '\r')) ++p;
+  }
+}
+
+// parse rows of ``label index:value index:value ...``
+inline void ParseLibSVMBlock(const char *begin, const char *end, TextBlock *out) {
+  const char *p = begin;
+  while (p != end) {
+    const char *lend = FindLineEnd(p, end);
+    p = SkipBlank(p, lend);
+    real_t label;
+    if (ParseRealToken(&p, lend, &label)) {
+      // optional instance weight, ``label:weight``, is ignored
+      if (p != lend && *p == ':') {
+        ++p;
+        real_t weight;
+        ParseRealToken(&p, lend, &weight);
+      }
+      out->label.push_back(label);
+      while (true) {
+        p = SkipBlank(p, lend);
+        if (p == lend) break;
+        int64_t idx;
+        real_t value;
+        CHECK(ParseIndexToken(&p, lend, &idx) && p != lend && *p == ':')
+            << "Invalid LibSVM format, expect index:value";
+        ++p;
+        CHECK(ParseRealToken(&p, lend, &value))
+            << "Invalid LibSVM format, expect index:value";
+        out->index.push_back(idx);
+        out->value.push_back(value);
+      }
+      out->offset.push_back(out->index.size());
+    }
+    // skip the line break
+    p = lend;
+    while (p != end && (*p == '\n' || *p == '\r')) ++p;
+  }
+}
+
+/*!
+ * \brief reads a text file chunk by chunk, and parses each chunk
+ *  with several threads, each of them producing a block of whole lines.
+ */
+class TextBlockReader {
+ public:
+  TextBlockReader(const std::string &uri, unsigned part_index, unsigned num_parts,
+                  int nthread, TextLineParser parser)
+      : nthread_(std::max(nthread, 1)), parser_(parser),
+        source_(dmlc::InputSplit::Create(uri.c_str(), part_index, num_parts, "text")) {}
+
+  inline void BeforeFirst() {
+    source_->BeforeFirst();
+    blocks_.clear();
+    cursor_ = 0;
+    row_counter_ = 0;
+  }
+  /*!
+   * \brief take the next n rows, appending the row ranges to out
+   * \return the number of rows taken, smaller than n at the end of the data
+   */
+  inline size_t Take(size_t n, std::vector<TextBlockSegment> *out) {
+    size_t taken = 0;
+    while (taken < n) {
+      if (blocks_.empty()) {
+        if (!ParseNextChunk()) break;
+        continue;
+      }
+      const std::shared_ptr<TextBlock> &blk = blocks_.front();
+      const size_t cnt = std::min(n - taken, blk->Size() - cursor_);
+      out->push_back(TextBlockSegment{blk, cursor_, cursor_ + cnt, row_counter_});
+      cursor_ += cnt;
+      row_counter_ += cnt;
+      taken += cnt;
+      if (cursor_ == blk->Size()) {
+        blocks_.pop_front();
+        cursor_ = 0;
+      }
+    }
+    return taken;
+  }
+
+ private:
+  // beginning of the line containing head[pos], or tail if pos is past the chunk
+  static inline const char *LineBegin(const char *head, const char *tail, size_t pos) {
+    if (head + pos >= tail) return tail;
+    const char *p = head + pos;
+    while (p != head && *(p - 1) != '\n' && *(p - 1) != '\r') --p;
+    return p;
+  }
+
+  inline bool ParseNextChunk() {
+    dmlc::InputSplit::Blob chunk;
+    if (!source_->NextChunk(&chunk)) return false;
+    const char *head = static_cast<const char*>(chunk.dptr);
+    const char *tail = head + chunk.size;
+    const size_t nstep = (chunk.size + nthread_ - 1) / nthread_;
+    std::vector<std::shared_ptr<TextBlock> > parsed(nthread_);
+    #pragma omp parallel for num_threads(nthread_)
+    for (int i = 0; i < nthread_; ++i) {
+      const char *begin = LineBegin(head, tail, i * nstep);
+      const char *end = LineBegin(head, tail, (i + 1) * nstep);
+      parsed[i] = std::make_shared<TextBlock>();
+      parsed[i]->Clear();
+      parser_(begin, end, parsed[i].get());
+    }
+    for (auto &blk : parsed) {
+      if (blk->Size() != 0) blocks_.push_back(blk);
+    }
+    return true;
+  }
+
+  /*! \brief number of parsing threads */
+  int nthread_;
+  /*! \brief line parser of the format */
+  TextLineParser parser_;
+  /*! \brief text source */
+  std::unique_ptr<dmlc::InputSplit> source_;
+  /*! \brief parsed blocks not yet fully consumed */
+  std::deque<std::shared_ptr<TextBlock> > blocks_;
+  /*! \brief next row in blocks_.front() */
+  size_t cursor_{0};
+  /*! \brief number of rows taken since BeforeFirst */
+  size_t row_counter_{0};
+};
+
+/*!
+ * \brief splits data (and optional label) files into batches,
+ *  with the same round_batch semantic as BatchLoader.
+ */
+class TextBatchReader {
+ public:
+  inline void Init(TextBlockReader *data, TextBlockReader *label, const BatchParam &param) {
+    data_.reset(data);
+    label_.reset(label);
+    param_ = param;
+  }
+
+  inline void BeforeFirst() {
+    if (param_.round_batch == 0 || num_overflow_ == 0) {
+      // otherwise, we already called before first
+      data_->BeforeFirst();
+      if (label_ != nullptr) label_->BeforeFirst();
+    } else {
+      num_overflow_ = 0;
+    }
+  }
+  /*!
+   * \brief get the row ranges of the next batch
+   * \return false at the end of the data
+   */
+  inline bool NextBatch(std::vector<TextBlockSegment> *data,
+                        std::vector<TextBlockSegment> *label,
+                        index_t *num_batch_padd) {
+    data->clear();
+    label->clear();
+    *num_batch_padd = 0;
+    // if overflow from previous round, directly return false, until before first is called
+    if (num_overflow_ != 0) return false;
+    const size_t top = Take(param_.batch_size, data, label);
+    if (top == 0) return false;
+    if (top < param_.batch_size) {
+      if (param_.round_batch != 0) {
+        this->BeforeFirst();
+        num_overflow_ = Take(param_.batch_size - top, data, label);
+        CHECK_EQ(num_overflow_, param_.batch_size - top)
+            << "number of input must be bigger than batch size";
+        *num_batch_padd = num_overflow_;
+      } else {
+        *num_batch_padd = param_.batch_size - top;
+      }
+    }
+    return true;
+  }
+
+ private:
+  inline size_t Take(size_t n, std::vector<TextBlockSegment> *data,
+                     std::vector<TextBlockSegment> *label) {
+    const size_t taken = data_->Take(n, data);
+    if (label_ != nullptr) {
+      CHECK_EQ(label_->Take(taken, label), taken)
+          << "Data file has more rows than the label file";
+    }
+    return taken;
+  }
+
+  BatchParam param_;
+  std::unique_ptr<TextBlockReader> data_;
+  std::unique_ptr<TextBlockReader> label_;
+  size_t num_overflow_{0};
+};
+
+/*! \brief number of rows in the segments */
+inline size_t NumRows(const std::vector<TextBlockSegment> &segs) {
+  size_t n = 0;
+  for (const auto &seg : segs) n += seg.end - seg.begin;
+  return n;
+}
+
+/*! \brief number of entries in the segments */
+inline size_t NumEntries(const std::vector<TextBlockSegment> &segs) {
+  size_t n = 0;
+  for (const auto &seg : segs) n += seg.block->offset[seg.end] - seg.block->offset[seg.begin];
+  return n;
+}
+
+/*! \brief write the index of each row */
+inline void CopyRowIndex(const std::vector<TextBlockSegment> &segs, unsigned *dst) {
+  for (const auto &seg : segs) {
+    for (size_t r = seg.begin; r < seg.end; ++r) {
+      *dst++ = static_cast<unsigned>(seg.row_index + r - seg.begin);
+    }
+  }
+}
+
+/*! \brief copy rows of row_size values each into the dense row-major dst */
+inline void CopyDenseRows(const std::vector<TextBlockSegment> &segs, size_t row_size,
+                          real_t *dst, int nthread) {
+  for (const auto &seg : segs) {
+    const TextBlock &blk = *seg.block;
+    const int64_t nrow = seg.end - seg.begin;
+    for (size_t r = seg.begin; r < seg.end; ++r) {
+      CHECK_EQ(blk.offset[r + 1] - blk.offset[r], row_size)
+          << "The row size in the data file does not match the size of the shape: "
+          << "specified size=" << row_size << ", row-length=" << blk.offset[r + 1] - blk.offset[r];
+    }
+    #pragma omp parallel for num_threads(nthread)
+    for (int64_t i = 0; i < nrow; ++i) {
+      const size_t r = seg.begin + i;
+      std::memcpy(dst + i * row_size, dmlc::BeginPtr(blk.value) + blk.offset[r],
+                  row_size * sizeof(real_t));
+    }
+    dst += nrow * row_size;
+  }
+}
+
+/*! \brief copy the label of each row into dst */
+inline void CopyRowLabels(const std::vector<TextBlockSegment> &segs, real_t *dst) {
+  for (const auto &seg : segs) {
+    std::copy(seg.block->label.begin() + seg.begin, seg.block->label.begin() + seg.end, dst);
+    dst += seg.end - seg.begin;
+  }
+}
+
+/*!
+ * \brief copy rows into CSR arrays. indptr must hold NumRows(segs) + 1 entries,
+ *  idx and val NumEntries(segs) entries.
+ */
+inline void CopyCSRRows(const std::vector<TextBlockSegment> &segs, int64_t *indptr,
+                        int64_t *idx, real_t *val, int nthread) {
+  indptr[0] = 0;
+  int64_t row_base = 0, nnz_base = 0;
+  for (const auto &seg : segs) {
+    const TextBlock &blk = *seg.block;
+    const int64_t nrow = seg.end - seg.begin;
+    const size_t seg_offset = blk.offset[seg.begin];
+    #pragma omp parallel for num_threads(nthread)
+    for (int64_t i = 0; i < nrow; ++i) {
+      const size_t r = seg.begin + i;
+      const size_t len = blk.offset[r + 1] - blk.offset[r];
+      const int64_t pos = nnz_base + blk.offset[r] - seg_offset;
+      indptr[row_base + i + 1] = pos + len;
+      std::memcpy(idx + pos, dmlc::BeginPtr(blk.index) + blk.offset[r], len * sizeof(int64_t));
+      std::memcpy(val + pos, dmlc::BeginPtr(blk.value) + blk.offset[r], len * sizeof(real_t));
+    }
+    row_base += nrow;
+    nnz_base += blk.offset[seg.end] - seg_offset;
+  }
+}
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_ITER_TEXT_BLOCK_H_
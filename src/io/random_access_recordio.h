@@ -0,0 +1,226 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file random_access_recordio.h
+ * \brief input split that reads single records of an indexed recordio file
+ *  in a global random order
+ *
+ *  The whole .idx file is loaded at construction. Every epoch draws a new
+ *  permutation of the records of this part; each batch of records is then
+ *  fetched with preads issued in file order and assembled, in permuted
+ *  order, into one recordio chunk.
+ *
+ *  The "indexed_recordio" split of dmlc-core shuffles single records as well.
+ *  It reads a shuffled batch record by record in permuted order, with a seek
+ *  and a read of its buffered stream each, and keeps the readahead of the file.
+ *  This split differs only in how a batch is read: the reads are sorted by file
+ *  offset so the disk moves one way per batch, they go straight into the chunk
+ *  with pread, and readahead is disabled when shuffling since the data read
+ *  ahead belongs to other records.
+ */
+#ifndef MXNET_IO_RANDOM_ACCESS_RECORDIO_H_
+#define MXNET_IO_RANDOM_ACCESS_RECORDIO_H_
+
+#include <dmlc/base.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/recordio.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mxnet {
+namespace io {
+/*! \brief per-sample random access over a recordio file and its index */
+class RandomAccessRecordIOSplit : public dmlc::InputSplit {
+ public:
+  RandomAccessRecordIOSplit(const std::string &path_rec, const std::string &path_idx,
+                            unsigned part_index, unsigned num_parts,
+                            bool shuffle, int seed, size_t batch_size)
+      : path_(path_rec), shuffle_(shuffle), rnd_(seed),
+        batch_size_(std::max(batch_size, static_cast<size_t>(1))) {
+    CHECK(path_rec.find(',') == std::string::npos && path_rec.find(';') == std::string::npos)
+        << "RandomAccessRecordIOSplit: only a single .rec file is supported";
+#ifndef _WIN32
+    fd_ = open(path_rec.c_str(), O_RDONLY);
+    CHECK_NE(fd_, -1) << "RandomAccessRecordIOSplit: cannot open " << path_rec;
+    struct stat st;
+    CHECK_EQ(fstat(fd_, &st), 0) << "RandomAccessRecordIOSplit: cannot stat " << path_rec;
+    const size_t file_size = st.st_size;
+#ifdef POSIX_FADV_RANDOM
+    // readahead only wastes bandwidth when records are read out of order
+    if (shuffle_) posix_fadvise(fd_, 0, 0, POSIX_FADV_RANDOM);
+#endif
+#else
+    const size_t file_size = 0;
+    LOG(FATAL) << "RandomAccessRecordIOSplit is not supported on Windows";
+#endif
+    this->LoadIndex(path_idx, file_size);
+    this->ResetPartition(part_index, num_parts);
+  }
+  virtual ~RandomAccessRecordIOSplit(void) {
+#ifndef _WIN32
+    if (fd_ != -1) close(fd_);
+#endif
+  }
+  virtual void HintChunkSize(size_t chunk_size) {}
+  virtual size_t GetTotalSize(void) {
+    size_t total = 0;
+    for (size_t i = begin_; i < end_; ++i) total += records_[i].second;
+    return total;
+  }
+  virtual void ResetPartition(unsigned part_index, unsigned num_parts) {
+    CHECK_LT(part_index, num_parts);
+    const size_t n = records_.size();
+    begin_ = n * part_index / num_parts;
+    end_ = n * (part_index + 1) / num_parts;
+    order_.resize(end_ - begin_);
+    for (size_t i = 0; i < order_.size(); ++i) order_[i] = begin_ + i;
+    this->BeforeFirst();
+  }
+  virtual void BeforeFirst(void) {
+    if (shuffle_) std::shuffle(order_.begin(), order_.end(), rnd_);
+    pos_ = 0;
+    reader_.reset(nullptr);
+  }
+  virtual bool NextRecord(Blob *out_rec) {
+    while (reader_ == nullptr || !reader_->NextRecord(out_rec)) {
+      Blob chunk;
+      if (!this->NextChunk(&chunk)) return false;
+      reader_.reset(new dmlc::RecordIOChunkReader(chunk, 0, 1));
+    }
+    return true;
+  }
+  virtual bool NextChunk(Blob *out_chunk) {
+    return this->NextBatch(out_chunk, batch_size_);
+  }
+  /*!
+   * \brief read the next n records of the permutation into one chunk
+   *  that can be parsed by dmlc::RecordIOChunkReader
+   */
+  virtual bool NextBatch(Blob *out_chunk, size_t n_records) {
+    if (pos_ >= order_.size()) return false;
+    const size_t n = std::min(n_records, order_.size() - pos_);
+    // place the records in permuted order, then read them in file order
+    reads_.resize(n);
+    size_t nbytes = 0;
+    for (size_t i = 0; i < n; ++i) {
+      const std::pair<size_t, size_t> &rec = records_[order_[pos_ + i]];
+      reads_[i] = ReadTask{rec.first, rec.second, nbytes};
+      nbytes += rec.second;
+    }
+    std::sort(reads_.begin(), reads_.end(),
+              [](const ReadTask &a, const ReadTask &b) { return a.offset < b.offset; });
+    // recordio headers are 4-byte words, keep the chunk aligned
+    buffer_.resize((nbytes + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    char *dptr = reinterpret_cast<char*>(dmlc::BeginPtr(buffer_));
+    for (const ReadTask &task : reads_) {
+      this->ReadAt(task.offset, task.size, dptr + task.dst);
+    }
+    pos_ += n;
+    reader_.reset(nullptr);
+    out_chunk->dptr = dptr;
+    out_chunk->size = nbytes;
+    return true;
+  }
+
+ private:
+  /*! \brief one pread: file offset, size and destination in the chunk */
+  struct ReadTask {
+    size_t offset;
+    size_t size;
+    size_t dst;
+  };
+  /*! \brief load "key\toffset" lines and derive the byte range of every record */
+  inline void LoadIndex(const std::string &path_idx, size_t file_size) {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(path_idx.c_str(), "r"));
+    std::string content;
+    const size_t kBufferSize = 1 << 20UL;
+    size_t nread;
+    do {
+      const size_t size = content.size();
+      content.resize(size + kBufferSize);
+      nread = fi->Read(&content[size], kBufferSize);
+      content.resize(size + nread);
+    } while (nread == kBufferSize);
+    std::istringstream is(content);
+    std::vector<size_t> offsets;
+    size_t key, offset;
+    while (is >> key >> offset) offsets.push_back(offset);
+    CHECK(offsets.size() != 0) << "RandomAccessRecordIOSplit: empty index " << path_idx;
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+    CHECK_LT(offsets.back(), file_size)
+        << "RandomAccessRecordIOSplit: " << path_idx << " does not match " << path_;
+    records_.resize(offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      const size_t next = i + 1 < offsets.size() ? offsets[i + 1] : file_size;
+      records_[i] = std::make_pair(offsets[i], next - offsets[i]);
+    }
+  }
+  inline void ReadAt(size_t offset, size_t size, char *dst) {
+#ifndef _WIN32
+    while (size != 0) {
+      ssize_t ret = pread(fd_, dst, size, offset);
+      CHECK_GT(ret, 0) << "RandomAccessRecordIOSplit: fail to read " << path_
+                       << " at offset " << offset;
+      dst += ret;
+      offset += ret;
+      size -= ret;
+    }
+#endif
+  }
+  /*! \brief path of the recordio file */
+  std::string path_;
+  /*! \brief file descriptor of the recordio file */
+  int fd_{-1};
+  /*! \brief whether to draw a new permutation every epoch */
+  bool shuffle_;
+  /*! \brief random engine of the permutation */
+  std::mt19937 rnd_;
+  /*! \brief number of records returned by NextChunk */
+  size_t batch_size_;
+  /*! \brief (offset, size) of every record in file order */
+  std::vector<std::pair<size_t, size_t> > records_;
+  /*! \brief range of records owned by this part */
+  size_t begin_, end_;
+  /*! \brief read order of the records of this epoch */
+  std::vector<size_t> order_;
+  /*! \brief position in order_ */
+  size_t pos_;
+  /*! \brief pending reads of the current batch */
+  std::vector<ReadTask> reads_;
+  /*! \brief chunk handed out by the last NextBatch */
+  std::vector<uint32_t> buffer_;
+  /*! \brief reader over the last chunk, used by NextRecord */
+  std::unique_ptr<dmlc::RecordIOChunkReader> reader_;
+};
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_RANDOM_ACCESS_RECORDIO_H_
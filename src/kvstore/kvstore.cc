@@ -31,6 +31,12 @@
 
 namespace mxnet {
 
+#if MXNET_USE_DIST_KVSTORE
+namespace kvstore {
+DMLC_REGISTER_PARAMETER(RowOptimizerParam);
+}  // namespace kvstore
+#endif  // MXNET_USE_DIST_KVSTORE
+
 KVStore* KVStore::Create(const char *type_name) {
   std::string tname = type_name;
   std::transform(tname.begin(), tname.end(), tname.begin(), ::tolower);
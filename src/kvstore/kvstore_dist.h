@@ -27,10 +27,16 @@
 #include <vector>
 #include <algorithm>
 #include <utility>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <memory>
+#include <functional>
 #include "./kvstore_local.h"
 #include "mxnet/engine.h"
 #include "ps/ps.h"
 #include "./kvstore_dist_server.h"
+#include "./kvstore_dist_row_cache.h"
 #if MKL_EXPERIMENTAL == 1
 #include <mkl_memory.h>
 #include "../operator/mkl/mkl_memory-inl.h"
@@ -59,11 +65,28 @@ class KVStoreDist : public KVStoreLocal {
     }
     bigarray_bound_ = dmlc::GetEnv("MXNET_KVSTORE_BIGARRAY_BOUND", 1000 * 1000);
     log_verbose_ = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
+    batch_small_keys_ = dmlc::GetEnv("MXNET_KVSTORE_BATCH_SMALL_KEYS", false);
+    row_cache_size_ = dmlc::GetEnv("MXNET_KVSTORE_ROW_CACHE_SIZE", 0);
+    row_cache_staleness_ = dmlc::GetEnv("MXNET_KVSTORE_ROW_CACHE_STALENESS", 1);
+    const std::string placement = dmlc::GetEnv("MXNET_KVSTORE_ROW_SPARSE_PLACEMENT",
+                                               std::string("range"));
+    if (placement == "range") {
+      row_placement_ = kRangeRowPlacement;
+    } else if (placement == "cyclic") {
+      row_placement_ = kCyclicRowPlacement;
+    } else {
+      LOG(FATAL) << "Unknown MXNET_KVSTORE_ROW_SPARSE_PLACEMENT " << placement
+                 << ", expected range or cyclic";
+    }
   }
 
   virtual ~KVStoreDist() {
     Engine::Get()->WaitForAll();
     if (IsWorkerNode()) {
+      for (const auto& kv : row_caches_) ReportRowCache(kv.first, *kv.second);
+      for (const auto& kv : row_cache_vars_) {
+        Engine::Get()->DeleteVariable([](RunContext s) {}, pinned_ctx_, kv.second);
+      }
       if (barrier_before_exit_) {
         Barrier();
         if (get_rank() == 0) {
@@ -136,6 +159,15 @@ class KVStoreDist : public KVStoreLocal {
     CheckUnique(keys);
     for (size_t i = 0; i < keys.size(); ++i) {
       comm_->Init(keys[i], values[i].storage_type(), values[i].shape(), values[i].dtype());
+      if (values[i].storage_type() == kRowSparseStorage) {
+        // two buffers, so that a prefetch doesn't wait for the previous one to be consumed
+        auto& bufs = prefetch_bufs_[keys[i]];
+        for (auto& buf : bufs.bufs) {
+          buf = NDArray(kRowSparseStorage, values[i].shape(), pinned_ctx_,
+                        true, values[i].dtype());
+        }
+        InitRowCache(keys[i], values[i].shape());
+      }
     }
     if (get_rank() == 0) {
       Push_(keys, values, 0, false);
@@ -163,6 +195,9 @@ class KVStoreDist : public KVStoreLocal {
     std::vector<int> uniq_keys;
     std::vector<std::vector<NDArray*> > grouped_vals;
     GroupKVPairsPull(keys, values, &uniq_keys, &grouped_vals);
+    // small keys pulled together in one request per server, and their positions
+    std::vector<std::pair<int, NDArray>> batch;
+    std::vector<size_t> batch_pos;
 
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
       int key = uniq_keys[i];
@@ -177,6 +212,11 @@ class KVStoreDist : public KVStoreLocal {
         recv_buf = NDArray(grouped_vals[i][0]->shape(), pinned_ctx_,
                            true, grouped_vals[i][0]->dtype());
       }
+      if (batch_small_keys_ && recv_buf.shape().Size() < bigarray_bound_) {
+        batch.emplace_back(key, recv_buf);
+        batch_pos.push_back(i);
+        continue;
+      }
       auto pull_from_servers = [this, key, recv_buf](
           RunContext rctx, Engine::CallbackOnComplete cb) {
         // convert to ps keys
@@ -204,6 +244,12 @@ class KVStoreDist : public KVStoreLocal {
 
       comm_->Broadcast(key, recv_buf, grouped_vals[i], priority);
     }
+    if (!batch.empty()) {
+      PullBatch(batch, priority);
+      for (size_t j = 0; j < batch.size(); ++j) {
+        comm_->Broadcast(batch[j].first, batch[j].second, grouped_vals[batch_pos[j]], priority);
+      }
+    }
   }
 
   void PullRowSparseImpl(const std::vector<int>& keys,
@@ -212,7 +258,7 @@ class KVStoreDist : public KVStoreLocal {
     std::vector<int> uniq_keys;
     std::vector<std::vector<std::pair<NDArray*, NDArray>>> grouped_val_rowids;
     GroupKVPairsPullRsp(keys, val_rowids, &uniq_keys, &grouped_val_rowids);
-
+    std::vector<std::pair<NDArray, NDArray>> uniq_rowids;
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
       int key = uniq_keys[i];
       // use the same array for merging to guarantee that pull always happens
@@ -233,9 +279,7 @@ class KVStoreDist : public KVStoreLocal {
       // TODO(haibin) refactor this for loop
       for (size_t i = 0; i < num_vals; i++) {
         auto &row_id = target_val_rowids[i].second;
-        NDArray indices(row_id.shape(), pinned_ctx_, false, mshadow::kInt64);
-        CopyFromTo(row_id, &indices, 0);
-        Unique(&indices, priority);
+        NDArray indices = UniqueRowIds(row_id, &uniq_rowids, priority);
         target_val_rowids[i].second = indices;
         num_rows += indices.shape().Size();
       }
@@ -244,12 +288,61 @@ class KVStoreDist : public KVStoreLocal {
         LOG(FATAL) << "RowSparsePull with multiple values is not implemented yet";
       } else {
         auto& indices = target_val_rowids[0].second;
-        PullRowSparse_(key, recv_buf, indices, priority);
-        comm_->BroadcastRowSparse(key, recv_buf, grouped_val_rowid, num_vals == 1, priority);
+        NDArray prefetched = TakePrefetched(key, indices);
+        if (!prefetched.is_none()) {
+          comm_->BroadcastRowSparse(key, prefetched, grouped_val_rowid, true, priority);
+        } else {
+          auto cache = row_caches_.find(key);
+          if (cache != row_caches_.end()) {
+            PullRowSparseCached(key, recv_buf, indices, cache->second, priority);
+          } else {
+            PullRowSparse_(key, recv_buf, indices, priority);
+          }
+          comm_->BroadcastRowSparse(key, recv_buf, grouped_val_rowid, num_vals == 1, priority);
+        }
       }
     }
   }
 
+  void PrefetchRowSparseImpl(const std::vector<int>& keys,
+                             const std::vector<NDArray>& row_ids,
+                             int priority = 0) override {
+    CHECK_EQ(keys.size(), row_ids.size());
+    std::vector<std::pair<NDArray, NDArray>> uniq_rowids;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const int key = keys[i];
+      auto it = prefetch_bufs_.find(key);
+      CHECK(it != prefetch_bufs_.end())
+        << "key " << key << " is not a row_sparse key. Did you init?";
+      NDArray indices = UniqueRowIds(row_ids[i], &uniq_rowids, priority);
+      auto& bufs = it->second;
+      NDArray buf = bufs.bufs[bufs.next];
+      bufs.next = 1 - bufs.next;
+      // the rows are fetched once the last push of this key is done
+      PullRowSparse_(key, buf, indices, priority, comm_buf_[key]);
+      prefetch_[key] = std::make_pair(indices, buf);
+    }
+  }
+
+  /**
+   * \brief return the prefetched rows of key if they are the rows of `indices`, or none.
+   * Either way the prefetched rows are dropped.
+   */
+  NDArray TakePrefetched(int key, const NDArray& indices) {
+    auto it = prefetch_.find(key);
+    if (it == prefetch_.end()) return NDArray();
+    const NDArray fetched = it->second.first;
+    const NDArray buf = it->second.second;
+    prefetch_.erase(it);
+    // both are sorted unique row ids computed by UniqueRowIds, which waits for them
+    const size_t num_rows = indices.shape().Size();
+    if (fetched.shape().Size() != num_rows) return NDArray();
+    const int64_t* a = fetched.data().dptr<int64_t>();
+    const int64_t* b = indices.data().dptr<int64_t>();
+    if (a != b && !std::equal(a, a + num_rows, b)) return NDArray();
+    return buf;
+  }
+
   void Push_(const std::vector<int>& keys,
              const std::vector<NDArray>& values,
              int priority,
@@ -258,6 +351,8 @@ class KVStoreDist : public KVStoreLocal {
     std::vector<int> uniq_keys;
     std::vector<std::vector<NDArray> > grouped_vals;
     GroupKVPairsPush(keys, values, &uniq_keys, &grouped_vals);
+    // small dense keys sent together in one request per server
+    std::vector<std::pair<int, NDArray>> batch;
 
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
       // merge over devcies
@@ -285,7 +380,10 @@ class KVStoreDist : public KVStoreLocal {
       }
 
       // push to servers
-      if (storage_type == kDefaultStorage) {
+      if (storage_type == kDefaultStorage && batch_small_keys_
+          && send_buf.shape().Size() < bigarray_bound_) {
+        batch.emplace_back(key, send_buf);
+      } else if (storage_type == kDefaultStorage) {
       auto push_to_servers =
           [this, key, send_buf](RunContext rctx, Engine::CallbackOnComplete cb) {
           // convert to ps keys
@@ -311,15 +409,134 @@ class KVStoreDist : public KVStoreLocal {
             PROFILER_MESSAGE("KVStoreDistDefaultPush"));
       } else if (storage_type == kRowSparseStorage) {
         PushRowSparse(key, send_buf, priority);
+        RefreshPrefetched(key, send_buf, priority);
+        RefreshRowCache(key, send_buf, priority);
       } else {
         LOG(FATAL) << "unknown storage type";
       }
     }
+    if (!batch.empty()) PushBatch(batch, priority);
+  }
+
+  /**
+   * \brief group small dense keys by the server they are kept on
+   */
+  std::map<int, std::vector<std::pair<int, NDArray>>> GroupBatchByServer(
+      const std::vector<std::pair<int, NDArray>>& batch) {
+    const int num_servers = ps::Postoffice::Get()->GetServerKeyRanges().size();
+    std::map<int, std::vector<std::pair<int, NDArray>>> groups;
+    for (const auto& kv : batch) {
+      groups[(kv.first * 9973) % num_servers].push_back(kv);
+    }
+    return groups;
+  }
+
+  /**
+   * \brief vars of the NDArrays in a batch, without duplicates
+   */
+  static std::vector<Engine::VarHandle> BatchVars(
+      const std::vector<std::pair<int, NDArray>>& batch) {
+    std::vector<Engine::VarHandle> vars;
+    for (const auto& kv : batch) vars.push_back(kv.second.var());
+    std::sort(vars.begin(), vars.end());
+    vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+    return vars;
+  }
+
+  /**
+   * \brief push small dense keys with one request per server.
+   * The keys were grouped by GroupKVPairs so they are in ascending order.
+   */
+  void PushBatch(const std::vector<std::pair<int, NDArray>>& batch, int priority) {
+    for (const auto& group : GroupBatchByServer(batch)) {
+      const auto& items = group.second;
+      auto push_to_servers = [this, items](RunContext rctx, Engine::CallbackOnComplete cb) {
+        ps::SArray<ps::Key> keys;
+        ps::SArray<int> lens;
+        size_t total_len = 0;
+        for (const auto& item : items) {
+          const size_t size = item.second.shape().Size();
+          PSKV& pskv = EncodeKey(item.first, size);
+          keys.push_back(pskv.keys[0]);
+          lens.push_back(size);
+          total_len += size;
+        }
+        ps::SArray<real_t> vals(total_len);
+        size_t offset = 0;
+        for (const auto& item : items) {
+#if MKL_EXPERIMENTAL == 1
+          mkl_set_tblob_eager_mode(item.second.data());
+#endif
+          const real_t* data = item.second.data().dptr<real_t>();
+          const size_t size = item.second.shape().Size();
+          std::copy(data, data + size, vals.data() + offset);
+          offset += size;
+        }
+        CHECK_NOTNULL(ps_worker_)->ZPush(keys, vals, lens, kDefaultPushPull, [cb]() { cb(); });
+      };
+      Engine::Get()->PushAsync(
+          push_to_servers,
+          pinned_ctx_,
+          BatchVars(items),
+          {},
+          FnProperty::kNormal,
+          priority,
+          PROFILER_MESSAGE("KVStoreDistDefaultBatchPush"));
+    }
   }
 
-  // pull row sparse weight into `recv_buf` based on indices given by `indices`
+  /**
+   * \brief pull small dense keys with one request per server
+   */
+  void PullBatch(const std::vector<std::pair<int, NDArray>>& batch, int priority) {
+    for (const auto& group : GroupBatchByServer(batch)) {
+      const auto& items = group.second;
+      auto pull_from_servers = [this, items](RunContext rctx, Engine::CallbackOnComplete cb) {
+        ps::SArray<ps::Key> keys;
+        std::vector<real_t*> dsts;
+        std::vector<size_t> sizes;
+        size_t total_len = 0;
+        for (const auto& item : items) {
+          const size_t size = item.second.shape().Size();
+          PSKV& pskv = EncodeKey(item.first, size);
+          keys.push_back(pskv.keys[0]);
+#if MKL_EXPERIMENTAL == 1
+          mkl_set_tblob_eager_mode(item.second.data());
+#endif
+          dsts.push_back(item.second.data().dptr<real_t>());
+          sizes.push_back(size);
+          total_len += size;
+        }
+        auto vals = new ps::SArray<real_t>(total_len);
+        auto lens = new ps::SArray<int>();
+        CHECK_NOTNULL(ps_worker_)->ZPull(keys, vals, lens, kDefaultPushPull,
+          [vals, lens, dsts, sizes, cb]() {
+            size_t offset = 0;
+            for (size_t i = 0; i < dsts.size(); ++i) {
+              std::copy(vals->data() + offset, vals->data() + offset + sizes[i], dsts[i]);
+              offset += sizes[i];
+            }
+            delete vals;
+            delete lens;
+            cb();
+          });
+      };
+      CHECK_NOTNULL(Engine::Get())->PushAsync(
+          pull_from_servers,
+          pinned_ctx_,
+          {},
+          BatchVars(items),
+          FnProperty::kNormal,
+          priority,
+          PROFILER_MESSAGE("KVStoreDistDefaultBatchPull"));
+    }
+  }
+
+  // pull row sparse weight into `recv_buf` based on indices given by `indices`.
+  // if `after` is given, the pull also waits for all operations on it to finish
   void PullRowSparse_(const int key, const NDArray& recv_buf,
-                      const NDArray& indices, int priority) {
+                      const NDArray& indices, int priority,
+                      const NDArray& after = NDArray()) {
     using namespace rowsparse;
     auto pull_from_servers = [this, key, recv_buf, indices]
                              (RunContext rctx, Engine::CallbackOnComplete cb) {
@@ -333,32 +550,243 @@ class KVStoreDist : public KVStoreLocal {
       const auto offsets = indices.data().dptr<int64_t>();
       const auto unit_len = recv_buf.shape().ProdShape(1, recv_buf.shape().ndim());
       const int64_t size = num_rows * unit_len;
-       // convert to ps keys in row sparse format
-      PSKV& pskv = EncodeRowSparseKey(key, size, num_rows, offsets,
-                                      unit_len, recv_buf.shape()[0]);
-      if (this->log_verbose_) {
-        LOG(INFO) << "worker " << get_rank() << " pull lens: " << pskv.lens << " keys: "
-                  << pskv.keys << " size: " << size;
-      }
-      auto vals = new ps::SArray<real_t>(data, size, false);
+      // convert to ps keys in row sparse format. pulls into different buffers
+      // of the same key may run at the same time, so each has its own keys
+      auto pskv = std::make_shared<PSKV>();
+      EncodeRowSparseKey(key, size, num_rows, offsets, unit_len,
+                         recv_buf.shape()[0], pskv.get());
       // copy indices to recv_buf. this needs to be done before ZPull
       // because after pull is done, the callback function returns and locks are released.
       // at this point, later functions may access the indices variable while copy happens
       mshadow::Copy(recv_buf.aux_data(kIdx).FlatTo1D<cpu, int64_t>(),
                     indices.data().FlatTo1D<cpu, int64_t>());
-      CHECK_NOTNULL(ps_worker_)->ZPull(pskv.keys, vals, &pskv.lens, kRowSparsePushPull,
-        [vals, cb]() { delete vals; cb(); });
+      ZPullRows(pskv, data, unit_len, [cb]() { cb(); });
     };
+    std::vector<Engine::VarHandle> mutate_vars = {recv_buf.var()};
+    if (!after.is_none()) mutate_vars.push_back(after.var());
     CHECK_NOTNULL(Engine::Get())->PushAsync(
         pull_from_servers,
         pinned_ctx_,
         {indices.var()},
-        {recv_buf.var()},
+        mutate_vars,
         FnProperty::kNormal,
         priority,
         PROFILER_MESSAGE("KVStoreDistRowSparsePull"));
   }
 
+  /**
+   * \brief create the row cache of a row_sparse key if MXNET_KVSTORE_ROW_CACHE_SIZE
+   * is set. Only asynchronous training accepts stale rows
+   */
+  void InitRowCache(int key, const TShape& shape) {
+    if (row_cache_size_ == 0 || !IsWorkerNode()) return;
+    if (type_.find("async") == std::string::npos) {
+      LOG(WARNING) << "MXNET_KVSTORE_ROW_CACHE_SIZE is ignored by kvstore " << type_
+                   << ", the row cache is only used in async mode";
+      row_cache_size_ = 0;
+      return;
+    }
+    CHECK_GT(row_cache_staleness_, 0) << "MXNET_KVSTORE_ROW_CACHE_STALENESS must be positive";
+    const size_t unit_len = shape.ProdShape(1, shape.ndim());
+    const size_t capacity = std::min(row_cache_size_, static_cast<size_t>(shape[0]));
+    row_caches_[key] = std::make_shared<RowCache>(capacity, unit_len, row_cache_staleness_);
+    row_cache_vars_[key] = Engine::Get()->NewVariable();
+  }
+
+  // pull row sparse weight into `recv_buf` based on indices given by `indices` like
+  // PullRowSparse_, serving the rows that are fresh in `cache` from it, and
+  // storing the rows pulled from the servers in it
+  void PullRowSparseCached(const int key, const NDArray& recv_buf, const NDArray& indices,
+                           const std::shared_ptr<RowCache>& cache, int priority) {
+    using namespace rowsparse;
+    auto pull_from_servers = [this, key, recv_buf, indices, cache]
+                             (RunContext rctx, Engine::CallbackOnComplete cb) {
+      size_t num_rows = indices.shape().Size();
+      recv_buf.CheckAndAlloc({mshadow::Shape1(num_rows)});
+#if MKL_EXPERIMENTAL == 1
+      mkl_set_tblob_eager_mode(recv_buf.data());
+#endif
+      real_t* data = recv_buf.data().dptr<real_t>();
+      const auto offsets = indices.data().dptr<int64_t>();
+      const auto unit_len = recv_buf.shape().ProdShape(1, recv_buf.shape().ndim());
+      mshadow::Copy(recv_buf.aux_data(kIdx).FlatTo1D<cpu, int64_t>(),
+                    indices.data().FlatTo1D<cpu, int64_t>());
+      auto miss_rows = std::make_shared<std::vector<int64_t>>();
+      std::vector<int64_t> miss_pos;
+      cache->Lookup(offsets, num_rows, data, miss_rows.get(), &miss_pos);
+      if (this->log_verbose_ && cache->num_steps() % 1000 == 0) ReportRowCache(key, *cache);
+      if (miss_rows->empty()) {
+        cb();
+        return;
+      }
+      const int64_t size = miss_rows->size() * unit_len;
+      auto pskv = std::make_shared<PSKV>();
+      EncodeRowSparseKey(key, size, miss_rows->size(), miss_rows->data(), unit_len,
+                         recv_buf.shape()[0], pskv.get());
+      auto vals = std::make_shared<std::vector<real_t>>(size);
+      ZPullRows(pskv, vals->data(), unit_len,
+        [cache, miss_rows, miss_pos, vals, data, unit_len, cb]() {
+          for (size_t j = 0; j < miss_pos.size(); ++j) {
+            const real_t* src = vals->data() + j * unit_len;
+            std::copy(src, src + unit_len, data + miss_pos[j] * unit_len);
+          }
+          cache->Insert(miss_rows->data(), miss_rows->size(), vals->data());
+          cb();
+        });
+    };
+    CHECK_NOTNULL(Engine::Get())->PushAsync(
+        pull_from_servers,
+        pinned_ctx_,
+        {indices.var()},
+        {recv_buf.var(), row_cache_vars_.at(key)},
+        FnProperty::kNormal,
+        priority,
+        PROFILER_MESSAGE("KVStoreDistRowSparseCachedPull"));
+  }
+
+  /**
+   * \brief fetch ahead the rows of the row cache of key that the next pull would
+   * find stale, once the push of `send_buf` is done: the cached rows `send_buf`
+   * updates, and the rows pulled in this step that expire in the next one. The
+   * next pull then serves them without waiting for the servers.
+   */
+  void RefreshRowCache(int key, const NDArray& send_buf, int priority) {
+    using namespace rowsparse;
+    auto it = row_caches_.find(key);
+    if (it == row_caches_.end()) return;
+    const std::shared_ptr<RowCache> cache = it->second;
+    auto refresh = [this, key, send_buf, cache]
+                   (RunContext rctx, Engine::CallbackOnComplete cb) {
+      // the pushed row ids are sorted
+      const int64_t num_pushed = send_buf.aux_shape(kIdx)[0];
+      const int64_t* pushed = send_buf.aux_data(kIdx).dptr<int64_t>();
+      auto rows = std::make_shared<std::vector<int64_t>>();
+      cache->RowsToRefresh(pushed, num_pushed, rows.get());
+      if (rows->empty()) {
+        cb();
+        return;
+      }
+      const auto unit_len = send_buf.shape().ProdShape(1, send_buf.shape().ndim());
+      const int64_t size = rows->size() * unit_len;
+      auto pskv = std::make_shared<PSKV>();
+      EncodeRowSparseKey(key, size, rows->size(), rows->data(), unit_len,
+                         send_buf.shape()[0], pskv.get());
+      auto vals = std::make_shared<std::vector<real_t>>(size);
+      ZPullRows(pskv, vals->data(), unit_len, [cache, rows, vals, cb]() {
+        cache->Refresh(rows->data(), rows->size(), vals->data());
+        cb();
+      });
+    };
+    // writing send_buf makes it wait for the push, which only reads it
+    CHECK_NOTNULL(Engine::Get())->PushAsync(
+        refresh,
+        pinned_ctx_,
+        {},
+        {send_buf.var(), row_cache_vars_.at(key)},
+        FnProperty::kNormal,
+        priority,
+        PROFILER_MESSAGE("KVStoreDistRowCacheRefresh"));
+  }
+
+  /**
+   * \brief log the hit rate of the row cache of key
+   */
+  void ReportRowCache(int key, const RowCache& cache) {
+    const int64_t lookups = cache.num_lookups();
+    LOG(INFO) << "worker " << get_rank() << " key " << key << " row cache: "
+              << cache.num_hits() << " hits of " << lookups << " rows in "
+              << cache.num_steps() << " pulls, hit rate "
+              << (lookups == 0 ? 0.0 : static_cast<double>(cache.num_hits()) / lookups)
+              << ", " << cache.size() << " rows cached";
+  }
+
+  // pull the rows encoded in `pskv` into `data`, in the order they were given to
+  // EncodeRowSparseKey, then call `on_complete`
+  void ZPullRows(const std::shared_ptr<PSKV>& pskv, real_t* data, const size_t unit_len,
+                 const std::function<void()>& on_complete) {
+    if (this->log_verbose_) {
+      LOG(INFO) << "worker " << get_rank() << " pull lens: " << pskv->lens << " keys: "
+                << pskv->keys << " size: " << pskv->size;
+    }
+    if (pskv->row_order.empty()) {
+      auto vals = new ps::SArray<real_t>(data, pskv->size, false);
+      CHECK_NOTNULL(ps_worker_)->ZPull(pskv->keys, vals, &pskv->lens, kRowSparsePushPull,
+        [vals, pskv, on_complete]() { delete vals; on_complete(); });
+    } else {
+      // rows arrive grouped by server, put them back in the order of indices
+      auto vals = new ps::SArray<real_t>(pskv->size);
+      CHECK_NOTNULL(ps_worker_)->ZPull(pskv->keys, vals, &pskv->lens, kRowSparsePushPull,
+        [vals, pskv, data, unit_len, on_complete]() {
+          const auto& row_order = pskv->row_order;
+          for (size_t j = 0; j < row_order.size(); ++j) {
+            const real_t* src = vals->data() + j * unit_len;
+            std::copy(src, src + unit_len, data + row_order[j] * unit_len);
+          }
+          delete vals;
+          on_complete();
+        });
+    }
+  }
+
+  /**
+   * \brief fetch again the prefetched rows of key that `send_buf` updates, once
+   * the push of `send_buf` is done. Rows only updated by other workers are not
+   * refetched, so in dist_sync mode they may miss the update of the last step.
+   */
+  void RefreshPrefetched(int key, const NDArray& send_buf, int priority) {
+    using namespace rowsparse;
+    auto it = prefetch_.find(key);
+    if (it == prefetch_.end()) return;
+    const NDArray indices = it->second.first;
+    const NDArray buf = it->second.second;
+    auto refresh = [this, key, send_buf, indices, buf]
+                   (RunContext rctx, Engine::CallbackOnComplete cb) {
+      // both the pushed and the prefetched row ids are sorted
+      const int64_t num_pushed = send_buf.aux_shape(kIdx)[0];
+      const int64_t* pushed = send_buf.aux_data(kIdx).dptr<int64_t>();
+      const int64_t num_fetched = indices.shape().Size();
+      const int64_t* fetched = indices.data().dptr<int64_t>();
+      std::vector<int64_t> rows, pos;
+      for (int64_t i = 0, j = 0; i < num_pushed && j < num_fetched;) {
+        if (pushed[i] < fetched[j]) {
+          ++i;
+        } else if (fetched[j] < pushed[i]) {
+          ++j;
+        } else {
+          rows.push_back(pushed[i++]);
+          pos.push_back(j++);
+        }
+      }
+      if (rows.empty()) {
+        cb();
+        return;
+      }
+      const auto unit_len = buf.shape().ProdShape(1, buf.shape().ndim());
+      const int64_t size = rows.size() * unit_len;
+      auto pskv = std::make_shared<PSKV>();
+      EncodeRowSparseKey(key, size, rows.size(), rows.data(), unit_len,
+                         buf.shape()[0], pskv.get());
+      auto vals = std::make_shared<std::vector<real_t>>(size);
+      real_t* data = buf.data().dptr<real_t>();
+      ZPullRows(pskv, vals->data(), unit_len, [vals, pos, data, unit_len, cb]() {
+        for (size_t j = 0; j < pos.size(); ++j) {
+          const real_t* src = vals->data() + j * unit_len;
+          std::copy(src, src + unit_len, data + pos[j] * unit_len);
+        }
+        cb();
+      });
+    };
+    // writing send_buf makes it wait for the push, which only reads it
+    CHECK_NOTNULL(Engine::Get())->PushAsync(
+        refresh,
+        pinned_ctx_,
+        {indices.var()},
+        {send_buf.var(), buf.var()},
+        FnProperty::kNormal,
+        priority,
+        PROFILER_MESSAGE("KVStoreDistRowSparseRefresh"));
+  }
+
   // push row sparse gradient
   void PushRowSparse(int key, const NDArray &send_buf, int priority) {
     using namespace rowsparse;
@@ -381,6 +809,14 @@ class KVStoreDist : public KVStoreLocal {
                   << pskv.keys << " size: " << size;
       }
       ps::SArray<real_t> vals(data, size, false);
+      if (!pskv.row_order.empty()) {
+        // send the rows grouped by server
+        vals = ps::SArray<real_t>(size);
+        for (size_t j = 0; j < pskv.row_order.size(); ++j) {
+          const real_t* src = data + pskv.row_order[j] * unit_len;
+          std::copy(src, src + unit_len, vals.data() + j * unit_len);
+        }
+      }
       CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, kRowSparsePushPull, [cb]() {
         cb();
       });
@@ -412,6 +848,20 @@ class KVStoreDist : public KVStoreLocal {
     ps::SArray<ps::Key> keys;  // n keys
     ps::SArray<int> lens;  // the length of the i-th value
     int size;
+    // for row sparse keys, the position in the input of the i-th row sent, or empty
+    // if the rows are sent in their input order
+    std::vector<int64_t> row_order;
+  };
+
+  /**
+   * \brief how the rows of a big row_sparse array are placed on the servers
+   */
+  enum RowPlacement {
+    // server i keeps the i-th of num_servers contiguous ranges of rows
+    kRangeRowPlacement,
+    // row r is kept on server r % num_servers, as its (r / num_servers)-th row,
+    // which spreads the hot rows at the front of frequency sorted vocabularies
+    kCyclicRowPlacement
   };
 
   /**
@@ -471,20 +921,61 @@ class KVStoreDist : public KVStoreLocal {
   inline PSKV& EncodeRowSparseKey(const int key, const int64_t size, const int64_t num_rows,
                                   const int64_t *offsets, const size_t unit_len,
                                   const int64_t total_num_rows) {
-    using namespace common;
     mu_.lock();
     PSKV& pskv = ps_kv_[key];
     mu_.unlock();
+    EncodeRowSparseKey(key, size, num_rows, offsets, unit_len, total_num_rows, &pskv);
+    return pskv;
+  }
+
+  // encode into `out` rather than the cached keys of `key`
+  inline void EncodeRowSparseKey(const int key, const int64_t size, const int64_t num_rows,
+                                 const int64_t *offsets, const size_t unit_len,
+                                 const int64_t total_num_rows, PSKV* out) {
+    using namespace common;
+    PSKV& pskv = *out;
     pskv.keys.clear();
     pskv.lens.clear();
+    pskv.row_order.clear();
     // TODO(haibin) cache this information
     auto krs = ps::Postoffice::Get()->GetServerKeyRanges();
     int num_servers = krs.size();
     CHECK_GT(num_servers, 0);
 
-    if (total_num_rows * unit_len >= bigarray_bound_) {
+    if (total_num_rows * unit_len >= bigarray_bound_
+        && row_placement_ == kCyclicRowPlacement) {
+      // group the rows by server, keeping them sorted within each server
+      std::vector<int64_t> bounds(num_servers + 1, 0);
+      if (offsets && size > 0) {
+        for (int64_t i = 0; i < num_rows; ++i) ++bounds[offsets[i] % num_servers + 1];
+        for (int i = 0; i < num_servers; ++i) bounds[i + 1] += bounds[i];
+        std::vector<int64_t> pos(bounds.begin(), bounds.end() - 1);
+        pskv.row_order.resize(num_rows);
+        for (int64_t i = 0; i < num_rows; ++i) {
+          pskv.row_order[pos[offsets[i] % num_servers]++] = i;
+        }
+      }
+      pskv.size = 0;
+      for (int i = 0; i < num_servers; ++i) {
+        ps::Key master_key = krs[i].begin() + key;
+        pskv.keys.push_back(master_key);
+        pskv.lens.push_back(0);
+        for (int64_t j = bounds[i]; j < bounds[i + 1]; ++j) {
+          ps::Key ps_key = master_key + offsets[pskv.row_order[j]] / num_servers;
+          CHECK_LT(ps_key, krs[i].end());
+          pskv.keys.push_back(ps_key);
+          pskv.lens.push_back(unit_len);
+          pskv.size += unit_len;
+        }
+      }
+      CHECK_EQ(static_cast<size_t>(pskv.size), size);
+      std::vector<int64_t> server_rows(num_servers);
+      for (int i = 0; i < num_servers; ++i) server_rows[i] = bounds[i + 1] - bounds[i];
+      CountServerRows(server_rows);
+    } else if (total_num_rows * unit_len >= bigarray_bound_) {
       pskv.size = 0;
       int64_t start_row = 0;
+      std::vector<int64_t> server_rows(num_servers, 0);
       // parition it to all servers
       for (int i = 0; i < num_servers; ++i) {
         ps::Key master_key = krs[i].begin() + key;
@@ -499,6 +990,7 @@ class KVStoreDist : public KVStoreLocal {
           // search for offsets in [start_row, end_row)
           auto lb = std::lower_bound(offsets, offsets + num_rows, start_row);
           auto ub = std::upper_bound(offsets, offsets + num_rows, end_row - 1);
+          server_rows[i] = ub - lb;
           for (auto offset = lb; offset < ub; offset++) {
             ps::Key ps_key = krs[i].begin() + key + (*offset - start_row);
             CHECK_LT(ps_key, krs[i].end());
@@ -510,6 +1002,7 @@ class KVStoreDist : public KVStoreLocal {
         }
       }
       CHECK_EQ(static_cast<size_t>(pskv.size), size);
+      CountServerRows(server_rows);
     } else {
       // send it to a single random picked server
       int server = (key * 9973) % num_servers;
@@ -524,10 +1017,33 @@ class KVStoreDist : public KVStoreLocal {
       }
       pskv.size = size;
     }
-    return pskv;
   }
 
 
+  /**
+   * \brief accumulate the number of rows of big row_sparse arrays sent to or
+   * requested from each server. With verbose logging on, the counts are reported
+   * every 1000 requests, so that an imbalanced range placement can be spotted.
+   */
+  void CountServerRows(const std::vector<int64_t>& server_rows) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (server_row_counts_.size() < server_rows.size()) {
+      server_row_counts_.resize(server_rows.size(), 0);
+    }
+    for (size_t i = 0; i < server_rows.size(); ++i) server_row_counts_[i] += server_rows[i];
+    if (log_verbose_ && ++num_row_sparse_requests_ % 1000 == 0) {
+      const int64_t total = std::accumulate(server_row_counts_.begin(),
+                                            server_row_counts_.end(), int64_t(0));
+      const int64_t max_count = *std::max_element(server_row_counts_.begin(),
+                                                  server_row_counts_.end());
+      std::ostringstream os;
+      for (const int64_t count : server_row_counts_) os << count << ' ';
+      LOG(INFO) << "worker " << get_rank() << " rows per server: " << os.str()
+                << "max / mean: " << (total == 0 ? 0.0 :
+                   static_cast<double>(max_count) * server_row_counts_.size() / total);
+    }
+  }
+
   /**
    * \brief for worker to push and pull data
    */
@@ -543,6 +1059,30 @@ class KVStoreDist : public KVStoreLocal {
   /// \brief send & recver buffer
   std::unordered_map<int, NDArray> comm_buf_;
   bool log_verbose_;
+  /// \brief whether small dense keys are sent in one request per server
+  bool batch_small_keys_;
+  RowPlacement row_placement_;
+  /// \brief number of rows of big row_sparse arrays sent to each server
+  std::vector<int64_t> server_row_counts_;
+  int64_t num_row_sparse_requests_ = 0;
+  /**
+   * \brief two buffers per row_sparse key to prefetch rows into, used in turn
+   */
+  struct PrefetchBufs {
+    NDArray bufs[2];
+    int next = 0;
+  };
+  std::unordered_map<int, PrefetchBufs> prefetch_bufs_;
+  /// \brief the unique row ids and the buffer of the last prefetch of each key
+  std::unordered_map<int, std::pair<NDArray, NDArray>> prefetch_;
+  /// \brief the maximum number of rows cached per row_sparse key, 0 to disable the cache
+  size_t row_cache_size_;
+  /// \brief the number of pulls a cached row is served for after it is fetched
+  int64_t row_cache_staleness_;
+  /// \brief the row cache of each row_sparse key, in async mode
+  std::unordered_map<int, std::shared_ptr<RowCache>> row_caches_;
+  /// \brief the engine variable serializing the pulls and refreshes of each row cache
+  std::unordered_map<int, Engine::VarHandle> row_cache_vars_;
 };
 
 }  // namespace kvstore
@@ -0,0 +1,203 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file kvstore_dist_row_cache.h
+ * \brief worker side cache of the hot rows of a row_sparse key
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_ROW_CACHE_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_ROW_CACHE_H_
+#include <dmlc/logging.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief a bounded cache of the rows of one row_sparse key.
+ *
+ * Every pull of the key is a step. A cached row is served in the `staleness` steps
+ * after the one it was fetched for, then it is fetched again with the rows that miss.
+ * After a push of the key the rows it updated, and the rows requested in the step
+ * that are too stale for the next one, can be fetched ahead with RowsToRefresh and
+ * Refresh, so the next step finds them fresh.
+ * Rows are admitted in the slots of a CLOCK: a slot is referenced when its row
+ * is requested, and a fetched row only replaces a row that was not requested since
+ * the hand last passed it. The hand passes each slot at most once per step, so the
+ * rows requested in every step stay cached however many rows miss.
+ * The cache is not thread safe, the pulls and refreshes of a key are serialized by the engine.
+ */
+class RowCache {
+ public:
+  RowCache(size_t capacity, size_t unit_len, int64_t staleness)
+      : capacity_(capacity), unit_len_(unit_len), staleness_(staleness) {
+    CHECK_GT(capacity_, 0U);
+    CHECK_GT(staleness_, 0);
+  }
+
+  /**
+   * \brief start a step. copy the fresh cached rows among the `num_rows` rows in
+   * `rows` into `data`, which holds num_rows * unit_len values, and return the
+   * other rows and their positions in `rows`
+   */
+  void Lookup(const int64_t* rows, const int64_t num_rows, real_t* data,
+              std::vector<int64_t>* miss_rows, std::vector<int64_t>* miss_pos) {
+    ++step_;
+    swept_ = 0;
+    miss_rows->clear();
+    miss_pos->clear();
+    for (int64_t j = 0; j < num_rows; ++j) {
+      auto it = slot_of_row_.find(rows[j]);
+      if (it != slot_of_row_.end()) {
+        Slot& slot = slots_[it->second];
+        slot.referenced = true;
+        slot.used = step_;
+        if (step_ - slot.step <= staleness_) {
+          const real_t* src = values_.data() + it->second * unit_len_;
+          std::copy(src, src + unit_len_, data + j * unit_len_);
+          continue;
+        }
+      }
+      miss_rows->push_back(rows[j]);
+      miss_pos->push_back(j);
+    }
+    num_lookups_ += num_rows;
+    num_hits_ += num_rows - static_cast<int64_t>(miss_rows->size());
+  }
+
+  /**
+   * \brief store the `num_rows` rows in `rows` fetched in this step, whose
+   * values are in `data`
+   */
+  void Insert(const int64_t* rows, const int64_t num_rows, const real_t* data) {
+    for (int64_t j = 0; j < num_rows; ++j) {
+      size_t pos;
+      auto it = slot_of_row_.find(rows[j]);
+      if (it != slot_of_row_.end()) {
+        pos = it->second;
+      } else if (!Admit(rows[j], &pos)) {
+        continue;
+      }
+      slots_[pos].step = step_;
+      const real_t* src = data + j * unit_len_;
+      std::copy(src, src + unit_len_, values_.data() + pos * unit_len_);
+    }
+  }
+
+  /**
+   * \brief the cached rows to fetch ahead of the next step: the ones among the
+   * `num_rows` sorted rows in `pushed`, which this worker just updated, and the
+   * ones requested in this step that would be too stale in the next one
+   */
+  void RowsToRefresh(const int64_t* pushed, const int64_t num_rows,
+                     std::vector<int64_t>* rows) const {
+    rows->clear();
+    for (const Slot& slot : slots_) {
+      if ((slot.used == step_ && step_ + 1 - slot.step > staleness_) ||
+          std::binary_search(pushed, pushed + num_rows, slot.row)) {
+        rows->push_back(slot.row);
+      }
+    }
+  }
+
+  /**
+   * \brief store the `num_rows` rows in `rows`, whose values in `data` were fetched
+   * after this step, for the next step. Rows evicted meanwhile are skipped
+   */
+  void Refresh(const int64_t* rows, const int64_t num_rows, const real_t* data) {
+    for (int64_t j = 0; j < num_rows; ++j) {
+      auto it = slot_of_row_.find(rows[j]);
+      if (it == slot_of_row_.end()) continue;
+      slots_[it->second].step = step_ + 1;
+      const real_t* src = data + j * unit_len_;
+      std::copy(src, src + unit_len_, values_.data() + it->second * unit_len_);
+    }
+  }
+
+  /// \brief the number of steps so far
+  int64_t num_steps() const { return step_; }
+  /// \brief the number of rows requested so far
+  int64_t num_lookups() const { return num_lookups_; }
+  /// \brief the number of rows served from the cache so far
+  int64_t num_hits() const { return num_hits_; }
+  /// \brief the number of rows cached
+  size_t size() const { return slots_.size(); }
+
+ private:
+  struct Slot {
+    int64_t row;
+    // the step the row was fetched for
+    int64_t step;
+    // the last step the row was requested in
+    int64_t used;
+    bool referenced;
+  };
+
+  /**
+   * \brief find a slot for `row`, which is not cached. return false if the hand
+   * already passed all the slots in this step
+   */
+  bool Admit(const int64_t row, size_t* pos) {
+    if (slots_.size() < capacity_) {
+      *pos = slots_.size();
+      slots_.push_back({row, step_, step_, false});
+      values_.resize(slots_.size() * unit_len_);
+      slot_of_row_[row] = *pos;
+      return true;
+    }
+    // clear the references passed
+    while (swept_ < capacity_) {
+      Slot& slot = slots_[hand_];
+      const size_t cur = hand_;
+      hand_ = (hand_ + 1) % capacity_;
+      ++swept_;
+      if (slot.referenced) {
+        slot.referenced = false;
+        continue;
+      }
+      slot_of_row_.erase(slot.row);
+      slot = {row, step_, step_, false};
+      slot_of_row_[row] = cur;
+      *pos = cur;
+      return true;
+    }
+    return false;
+  }
+
+  size_t capacity_;
+  size_t unit_len_;
+  int64_t staleness_;
+  int64_t step_ = 0;
+  size_t hand_ = 0;
+  // the number of slots the hand passed in this step
+  size_t swept_ = 0;
+  std::vector<Slot> slots_;
+  std::vector<real_t> values_;
+  std::unordered_map<int64_t, size_t> slot_of_row_;
+  int64_t num_lookups_ = 0;
+  int64_t num_hits_ = 0;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_ROW_CACHE_H_
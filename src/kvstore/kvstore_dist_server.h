@@ -25,14 +25,18 @@
 #define MXNET_KVSTORE_KVSTORE_DIST_SERVER_H_
 #include <queue>
 #include <string>
+#include <algorithm>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
 #include <functional>
 #include <future>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include "ps/ps.h"
 #include "mxnet/kvstore.h"
+#include "./kvstore_dist_server_row_store.h"
 #include "../operator/tensor/elemwise_binary_op-inl.h"
 #include "../operator/tensor/init_op.h"
 
@@ -43,6 +47,7 @@ static const int kRowSparsePushPull = 1;
 static const int kDefaultPushPull = 0;
 static const int kStopServer = -1;
 static const int kSyncMode = -2;
+static const int kSetRowOptimizer = -3;
 
 /**
  * \brief executor runs a function using the thread called \ref Start
@@ -116,6 +121,7 @@ class KVStoreDistServer {
     ps_server_->set_request_handle(
         std::bind(&KVStoreDistServer::DataHandleEx, this, _1, _2, _3));
     sync_mode_ = false;
+    use_row_store_ = false;
     log_verbose_ = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
   }
 
@@ -151,6 +157,8 @@ class KVStoreDistServer {
       exec_.Stop();
     } else if (recved.head == kSyncMode) {
       sync_mode_ = true;
+    } else if (recved.head == kSetRowOptimizer) {
+      SetRowOptimizer(recved.body);
     } else {
       // let the main thread to execute ctrl, which is necessary for python
       exec_.Exec([this, recved]() {
@@ -172,11 +180,67 @@ class KVStoreDistServer {
     return;
   }
 
+  /**
+   * \brief keep row_sparse keys in row stores and update them on the server with
+   * the given optimizer. Keys that are already initialized are moved over. A key
+   * with a sync push waiting for other workers is moved once that push is applied.
+   */
+  void SetRowOptimizer(const std::string& body) {
+    row_optimizer_.InitFromString(body);
+    use_row_store_ = true;
+    std::vector<int> keys;
+    for (const auto& kv : store_) {
+      if (!kv.second.is_none() && kv.second.storage_type() == kRowSparseStorage) {
+        keys.push_back(kv.first);
+      }
+    }
+    for (const int key : keys) {
+      auto merged = merge_buf_.find(key);
+      if (merged != merge_buf_.end() && merged->second.request.size() > 0) {
+        to_row_store_.insert(key);
+      } else {
+        MoveToRowStore(key);
+      }
+    }
+  }
+
+  /**
+   * \brief move the row_sparse key from store_ into a row store
+   */
+  void MoveToRowStore(const int key) {
+    NDArray& stored = store_[key];
+    stored.WaitToRead();
+    const TShape& shape = stored.shape();
+    auto row_store = std::make_shared<RowStore>(row_optimizer_, shape[0],
+                                                shape.ProdShape(1, shape.ndim()));
+    // only the rows kept by the array are set, e.g. the rows of the last push
+    // when there is no updater
+    if (stored.storage_initialized()) {
+      row_store->InitRows(stored.aux_data(rowsparse::kIdx).dptr<int64_t>(),
+                          stored.aux_shape(rowsparse::kIdx).Size(),
+                          stored.data().dptr<real_t>());
+    }
+    row_store_[key] = row_store;
+    to_row_store_.erase(key);
+    merge_buf_.erase(key);
+    store_.erase(key);
+  }
+
   inline void ApplyUpdates(const int key, MergeBuf *merged, NDArray *stored,
                            ps::KVServer<real_t>* server) {
     if (merged->request.size() == (size_t) ps::NumWorkers()) {
-      // let the main thread to execute updater_, which is necessary for python
-      if (updater_) {
+      auto row_store = row_store_.find(key);
+      if (row_store != row_store_.end()) {
+        // update the merged rows in place on the server
+        const NDArray& grad = merged->array;
+        grad.WaitToRead();
+        if (grad.storage_initialized()) {
+          row_store->second->Update(grad.aux_data(rowsparse::kIdx).dptr<int64_t>(),
+                                    grad.aux_shape(rowsparse::kIdx).Size(),
+                                    grad.data().dptr<real_t>());
+        }
+      } else if (updater_) {
+        // let the main thread to execute updater_, which is necessary for python
         exec_.Exec([this, key, merged, stored](){
             CHECK(updater_);
             updater_(key, merged->array, stored);
@@ -189,10 +253,12 @@ class KVStoreDistServer {
         LOG(INFO) << "sync response to " << merged->request.size() << " workers";
       }
       for (const auto& req : merged->request) {
-        server->Response(req);
+        Respond(req, server);
       }
       merged->request.clear();
       stored->WaitToRead();
+      // invalidates merged and stored, the callers return right after
+      if (to_row_store_.count(key)) MoveToRowStore(key);
     } else {
       merged->array.WaitToRead();
     }
@@ -213,6 +279,10 @@ class KVStoreDistServer {
                        ps::KVServer<real_t>* server) {
     int master_key = DecodeKey(req_data.keys[0]);
     auto num_rows = req_data.keys.size() - 1;
+    if (use_row_store_) {
+      DataHandleRowStore(req_meta, req_data, server);
+      return;
+    }
     auto& stored = store_[master_key];
     if (req_meta.push) {
       CHECK_GT(req_data.lens.size(), 0) << "req_data.lens cannot be empty";
@@ -358,68 +428,191 @@ class KVStoreDistServer {
     }
   }
 
+  /**
+   * \brief handle row_sparse requests of keys kept in row stores. Synced pushes are
+   * merged like DataHandleRowSparse and applied to the row store once all workers
+   * pushed, async pushes are applied to the received rows directly.
+   */
+  void DataHandleRowStore(const ps::KVMeta& req_meta,
+                          const ps::KVPairs<real_t>& req_data,
+                          ps::KVServer<real_t>* server) {
+    int master_key = DecodeKey(req_data.keys[0]);
+    auto num_rows = req_data.keys.size() - 1;
+    auto& row_store = row_store_[master_key];
+    std::vector<int64_t> indices(num_rows);
+    if (num_rows > 0) DecodeRowIds(req_data.keys, indices.data(), master_key, num_rows);
+    if (req_meta.push) {
+      CHECK_GT(req_data.lens.size(), 0) << "req_data.lens cannot be empty";
+      CHECK_EQ(req_data.lens[0], 0);
+      real_t* data = req_data.vals.data();
+      if (!row_store) {
+        if (log_verbose_) LOG(INFO) << "initial push to row store: " << master_key;
+        CHECK_GT(num_rows, 0) << "init with empty data is not supported";
+        auto unit_len = req_data.lens[1];
+        CHECK_GT(unit_len, 0);
+        CHECK_EQ(req_data.vals.size(), num_rows * unit_len);
+        row_store = std::make_shared<RowStore>(row_optimizer_, num_rows, unit_len);
+        row_store->InitDense(data);
+        server->Response(req_meta);
+        return;
+      }
+      if (sync_mode_) {
+        if (log_verbose_) LOG(INFO) << "sync push to row store: " << master_key;
+        auto& merged = merge_buf_[master_key];
+        size_t ds[] = {(size_t) row_store->num_rows(), (size_t) row_store->unit_len()};
+        TShape shape(ds, ds + 2);
+        if (merged.request.size() == 0) {
+          merged.array = NDArray(kRowSparseStorage, shape, Context());
+        }
+        if (num_rows > 0) {
+          size_t rs[] = {(size_t) num_rows, (size_t) row_store->unit_len()};
+          TBlob idx_blob(indices.data(), mshadow::Shape1(num_rows), cpu::kDevMask);
+          TBlob recv_blob(data, TShape(rs, rs + 2), cpu::kDevMask); // NOLINT(*)
+          NDArray recved(kRowSparseStorage, shape, recv_blob, {idx_blob}, 0);
+          if (merged.request.size() == 0) {
+            CopyFromTo(recved, &merged.array, 0);
+          } else {
+            NDArray out(kRowSparseStorage, shape, Context());
+            NDArray sum = merged.array;
+            Engine::Get()->PushSync([recved, sum, out](RunContext ctx) {
+                std::vector<NDArray> inputs = {recved, sum};
+                std::vector<NDArray> outputs = {out};
+                op::ElemwiseBinaryOp::ComputeEx<cpu, mshadow::op::plus>(
+                  {}, {}, inputs, {kWriteTo}, outputs);
+              }, recved.ctx(), {recved.var(), sum.var()}, {out.var()},
+              FnProperty::kNormal, 0, PROFILER_MESSAGE_FUNCNAME);
+            merged.array = out;
+          }
+          merged.array.WaitToRead();
+        }
+        merged.request.push_back(req_meta);
+        NDArray unused;
+        ApplyUpdates(master_key, &merged, &unused, server);
+      } else {
+        if (log_verbose_) LOG(INFO) << "async push to row store: " << master_key;
+        if (num_rows > 0) row_store->Update(indices.data(), num_rows, data);
+        server->Response(req_meta);
+      }
+    } else {
+      if (log_verbose_) LOG(INFO) << "pull from row store: " << master_key;
+      ps::KVPairs<real_t> response;
+      response.keys = req_data.keys;
+      if (num_rows == 0) {
+        std::vector<int> lens(req_data.keys.size(), 0);
+        response.lens.CopyFrom(lens.begin(), lens.end());
+        server->Response(req_meta, response);
+        return;
+      }
+      CHECK(row_store) << "init " << master_key << " first";
+      const auto unit_len = row_store->unit_len();
+      response.vals.resize(unit_len * num_rows);
+      row_store->Pull(indices.data(), num_rows, response.vals.data());
+      std::vector<int> lens(req_data.keys.size(), unit_len);
+      lens[0] = 0;
+      response.lens.CopyFrom(lens.begin(), lens.end());
+      server->Response(req_meta, response);
+    }
+  }
+
   void DataHandleDefault(const ps::KVMeta& req_meta,
                          const ps::KVPairs<real_t> &req_data,
                          ps::KVServer<real_t>* server) {
     CHECK_EQ(req_meta.cmd, kDefaultPushPull);
-    // do some check
-    CHECK_EQ(req_data.keys.size(), (size_t)1);
+    // small keys may be batched into one request
+    const size_t num_keys = req_data.keys.size();
+    CHECK_GT(num_keys, 0U);
     if (req_meta.push) {
-      CHECK_EQ(req_data.lens.size(), (size_t)1);
-      CHECK_EQ(req_data.vals.size(), (size_t)req_data.lens[0]);
+      CHECK_EQ(req_data.lens.size(), num_keys);
+      size_t total_len = 0;
+      for (size_t i = 0; i < num_keys; ++i) total_len += req_data.lens[i];
+      CHECK_EQ(req_data.vals.size(), total_len);
+      // a batched request is answered once all of its keys are done
+      if (num_keys > 1) pending_[RequestId(req_meta)] = num_keys;
+      size_t offset = 0;
+      for (size_t i = 0; i < num_keys; ++i) {
+        DataHandleDefaultPush(req_meta, DecodeKey(req_data.keys[i]),
+                              req_data.vals.data() + offset, req_data.lens[i], server);
+        offset += req_data.lens[i];
+      }
+    } else {
+      // pull
+      ps::KVPairs<real_t> response;
+      response.keys = req_data.keys;
+      size_t total_len = 0;
+      for (size_t i = 0; i < num_keys; ++i) {
+        int key = DecodeKey(req_data.keys[i]);
+        const auto& stored = store_[key];
+        CHECK(!stored.is_none()) << "init " << key << " first";
+        response.lens.push_back(stored.shape().Size());
+        total_len += stored.shape().Size();
+      }
+      response.vals.resize(total_len);
+      size_t offset = 0;
+      for (size_t i = 0; i < num_keys; ++i) {
+        const auto& stored = store_[DecodeKey(req_data.keys[i])];
+        const real_t* data = static_cast<const real_t*>(stored.data().dptr_);
+        std::copy(data, data + response.lens[i], response.vals.data() + offset);
+        offset += response.lens[i];
+      }
+      server->Response(req_meta, response);
     }
+  }
 
-    int key = DecodeKey(req_data.keys[0]);
+  void DataHandleDefaultPush(const ps::KVMeta& req_meta, const int key,
+                             real_t* data, const int len,
+                             ps::KVServer<real_t>* server) {
     auto& stored = store_[key];
-
     // there used several WaitToRead, this is because \a recved's memory
     // could be deallocated when this function returns. so we need to make sure
     // the operators with \a NDArray are actually finished
-    if (req_meta.push) {
-      size_t ds[] = {(size_t)req_data.lens[0]};
-      TShape dshape(ds, ds + 1);
-      TBlob recv_blob((real_t*)req_data.vals.data(), // NOLINT(*)
-                      dshape, cpu::kDevMask);
-      NDArray recved = NDArray(recv_blob, 0);
-      if (stored.is_none()) {
-        // initialization
-        stored = NDArray(dshape, Context());
-        CopyFromTo(recved, &stored, 0);
-        server->Response(req_meta);
-        stored.WaitToRead();
-      } else if (sync_mode_) {
-        // synced push
-        auto& merged = merge_buf_[key];
-        if (merged.array.is_none()) {
-          merged.array = NDArray(dshape, Context());
-        }
-        if (merged.request.size() == 0) {
-          CopyFromTo(recved, &merged.array, 0);
-        } else {
-          merged.array += recved;
-        }
-        merged.request.push_back(req_meta);
-        ApplyUpdates(key, &merged, &stored, server);
+    size_t ds[] = {(size_t)len};
+    TShape dshape(ds, ds + 1);
+    TBlob recv_blob(data, dshape, cpu::kDevMask);  // NOLINT(*)
+    NDArray recved = NDArray(recv_blob, 0);
+    if (stored.is_none()) {
+      // initialization
+      stored = NDArray(dshape, Context());
+      CopyFromTo(recved, &stored, 0);
+      Respond(req_meta, server);
+      stored.WaitToRead();
+    } else if (sync_mode_) {
+      // synced push
+      auto& merged = merge_buf_[key];
+      if (merged.array.is_none()) {
+        merged.array = NDArray(dshape, Context());
+      }
+      if (merged.request.size() == 0) {
+        CopyFromTo(recved, &merged.array, 0);
       } else {
-        // async push
-        exec_.Exec([this, key, &recved, &stored](){
-            CHECK(updater_);
-            updater_(key, recved, &stored);
-          });
-        server->Response(req_meta);
-        stored.WaitToRead();
+        merged.array += recved;
       }
+      merged.request.push_back(req_meta);
+      ApplyUpdates(key, &merged, &stored, server);
     } else {
-      // pull
-      ps::KVPairs<real_t> response;
-      CHECK(!stored.is_none()) << "init " << key << " first";
-      auto len = stored.shape().Size();
-      response.keys = req_data.keys;
-      response.lens = {len};
-      // TODO(mli) try to remove this CopyFrom
-      response.vals.CopyFrom(static_cast<const float*>(stored.data().dptr_), len);
-      server->Response(req_meta, response);
+      // async push
+      exec_.Exec([this, key, &recved, &stored](){
+          CHECK(updater_);
+          updater_(key, recved, &stored);
+        });
+      Respond(req_meta, server);
+      stored.WaitToRead();
+    }
+  }
+
+  static uint64_t RequestId(const ps::KVMeta& req) {
+    return (static_cast<uint64_t>(req.sender) << 32) | static_cast<uint32_t>(req.timestamp);
+  }
+
+  /**
+   * \brief respond to a push request, or count down a batched one
+   */
+  void Respond(const ps::KVMeta& req, ps::KVServer<real_t>* server) {
+    auto it = pending_.find(RequestId(req));
+    if (it != pending_.end()) {
+      if (--it->second > 0) return;
+      pending_.erase(it);
     }
+    server->Response(req);
   }
 
   int DecodeKey(ps::Key key) {
@@ -431,11 +624,22 @@ class KVStoreDistServer {
    * \brief user defined
    */
   bool sync_mode_;
+  /**
+   * \brief whether row_sparse keys are kept in row stores and updated with
+   * row_optimizer_ on the server instead of by updater_
+   */
+  bool use_row_store_;
+  RowOptimizerParam row_optimizer_;
   KVStore::Controller controller_;
   KVStore::Updater updater_;
 
   std::unordered_map<int, NDArray> store_;
   std::unordered_map<int, MergeBuf> merge_buf_;
+  /// \brief number of keys not yet done of each batched push request
+  std::unordered_map<uint64_t, size_t> pending_;
+  std::unordered_map<int, std::shared_ptr<RowStore>> row_store_;
+  /// \brief row_sparse keys to move into row stores once their sync push is applied
+  std::unordered_set<int> to_row_store_;
 
   Executor exec_;
   ps::KVServer<float>* ps_server_;
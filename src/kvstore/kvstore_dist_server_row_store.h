@@ -0,0 +1,320 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file kvstore_dist_server_row_store.h
+ * \brief row store with per-row optimizer state for row_sparse keys on the server
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_SERVER_ROW_STORE_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_SERVER_ROW_STORE_H_
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+enum RowOptimizerType {kRowSGD, kRowAdam, kRowFtrl, kRowAdaGrad};
+
+struct RowOptimizerParam : public dmlc::Parameter<RowOptimizerParam> {
+  int optimizer;
+  float lr;
+  float wd;
+  float rescale_grad;
+  float clip_gradient;
+  float momentum;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float lamda1;
+  float beta;
+  int num_partitions;
+  DMLC_DECLARE_PARAMETER(RowOptimizerParam) {
+    DMLC_DECLARE_FIELD(optimizer)
+    .add_enum("sgd", kRowSGD)
+    .add_enum("adam", kRowAdam)
+    .add_enum("ftrl", kRowFtrl)
+    .add_enum("adagrad", kRowAdaGrad)
+    .describe("The optimizer applied to the rows pushed to the server.");
+    DMLC_DECLARE_FIELD(lr)
+    .set_default(0.01f)
+    .describe("Learning rate");
+    DMLC_DECLARE_FIELD(wd)
+    .set_default(0.0f)
+    .describe("Weight decay, applied to the pushed rows only.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+    .set_default(1.0f)
+    .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+    .set_default(-1.0f)
+    .describe("Clip gradient to the range of [-clip_gradient, clip_gradient] "
+              "If clip_gradient <= 0, gradient clipping is turned off.");
+    DMLC_DECLARE_FIELD(momentum)
+    .set_default(0.0f)
+    .describe("The momentum of sgd.");
+    DMLC_DECLARE_FIELD(beta1)
+    .set_default(0.9f)
+    .describe("The decay rate for the 1st moment estimates of adam.");
+    DMLC_DECLARE_FIELD(beta2)
+    .set_default(0.999f)
+    .describe("The decay rate for the 2nd moment estimates of adam.");
+    DMLC_DECLARE_FIELD(epsilon)
+    .set_default(1e-8f)
+    .describe("A small constant for numerical stability of adam and adagrad.");
+    DMLC_DECLARE_FIELD(lamda1)
+    .set_default(0.01f)
+    .describe("The L1 regularization coefficient of ftrl.");
+    DMLC_DECLARE_FIELD(beta)
+    .set_default(1.0f)
+    .describe("Per-Coordinate Learning Rate beta of ftrl.");
+    DMLC_DECLARE_FIELD(num_partitions)
+    .set_default(0)
+    .describe("Number of hash partitions of the rows. 0 means four per omp thread.");
+  }
+
+  /*!
+   * \brief parse a command body of comma separated key=value pairs
+   */
+  void InitFromString(const std::string& body) {
+    std::map<std::string, std::string> kwargs;
+    std::istringstream is(body);
+    std::string kv;
+    while (std::getline(is, kv, ',')) {
+      if (kv.empty()) continue;
+      const size_t pos = kv.find('=');
+      CHECK_NE(pos, std::string::npos) << "expected key=value, got " << kv;
+      kwargs[kv.substr(0, pos)] = kv.substr(pos + 1);
+    }
+    Init(kwargs);
+  }
+};
+
+/**
+ * \brief rows of a row_sparse key kept in hash partitions, each row stored next to
+ * its optimizer state. Only rows that were pushed or initialized with non-zero
+ * values are materialized, the others read as zeros and start from zero state
+ * the first time a gradient for them arrives.
+ */
+class RowStore {
+ public:
+  RowStore(const RowOptimizerParam& param, const int64_t num_rows, const int64_t unit_len)
+    : param_(param), num_rows_(num_rows), unit_len_(unit_len) {
+    int num_partitions = param.num_partitions;
+    if (num_partitions <= 0) num_partitions = 4 * omp_get_max_threads();
+    parts_.resize(num_partitions);
+    switch (param.optimizer) {
+      case kRowSGD: num_states_ = param.momentum > 0.0f ? 1 : 0; break;
+      case kRowAdaGrad: num_states_ = 1; break;
+      default: num_states_ = 2; break;
+    }
+  }
+
+  int64_t num_rows() const { return num_rows_; }
+
+  int64_t unit_len() const { return unit_len_; }
+
+  /*! \brief number of rows that are materialized */
+  size_t size() const {
+    size_t total = 0;
+    for (const auto& part : parts_) total += part.offset.size();
+    return total;
+  }
+
+  /*!
+   * \brief initialize rows [0, num_rows) from a dense array, skipping all-zero rows
+   */
+  void InitDense(const real_t* data) {
+    std::vector<int64_t> row_ids;
+    for (int64_t row_id = 0; row_id < num_rows_; ++row_id) {
+      const real_t* src = data + row_id * unit_len_;
+      if (std::any_of(src, src + unit_len_, [](real_t v) { return v != 0; })) {
+        row_ids.push_back(row_id);
+      }
+    }
+    ForEachByPartition(row_ids.data(), row_ids.size(), [&](real_t* row, size_t i) {
+        const real_t* src = data + row_ids[i] * unit_len_;
+        std::copy(src, src + unit_len_, row);
+      });
+  }
+
+  /*!
+   * \brief set the weights of rows row_ids[0, n) to the rows of data, row by row
+   */
+  void InitRows(const int64_t* row_ids, const size_t n, const real_t* data) {
+    ForEachByPartition(row_ids, n, [&](real_t* row, size_t i) {
+        const real_t* src = data + i * unit_len_;
+        std::copy(src, src + unit_len_, row);
+      });
+  }
+
+  /*!
+   * \brief copy the weights of rows row_ids[0, n) to out, row by row
+   */
+  void Pull(const int64_t* row_ids, const size_t n, real_t* out) const {
+    #pragma omp parallel for
+    for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+      const Partition& part = parts_[PartitionOf(row_ids[i])];
+      auto it = part.offset.find(row_ids[i]);
+      real_t* dst = out + i * unit_len_;
+      if (it == part.offset.end()) {
+        std::fill(dst, dst + unit_len_, 0.0f);
+      } else {
+        const real_t* src = part.values.data() + it->second;
+        std::copy(src, src + unit_len_, dst);
+      }
+    }
+  }
+
+  /*!
+   * \brief apply the optimizer to rows row_ids[0, n) with gradients grad, row by row.
+   * Rows are grouped by partition so that each partition is updated by one thread.
+   */
+  void Update(const int64_t* row_ids, const size_t n, const real_t* grad) {
+    ++num_updates_;
+    // bias correction of adam uses the number of updates of this key
+    float lr = param_.lr;
+    if (param_.optimizer == kRowAdam) {
+      const double t = static_cast<double>(num_updates_);
+      lr *= std::sqrt(1.0 - std::pow(param_.beta2, t)) / (1.0 - std::pow(param_.beta1, t));
+    }
+    ForEachByPartition(row_ids, n, [&](real_t* row, size_t i) {
+        UpdateRow(row, grad + i * unit_len_, lr);
+      });
+  }
+
+ private:
+  struct Partition {
+    /*! \brief row id -> offset of the row in values */
+    std::unordered_map<int64_t, size_t> offset;
+    /*! \brief weight followed by optimizer state of each row */
+    std::vector<real_t> values;
+  };
+
+  /*!
+   * \brief call f(row, i) for the rows row_ids[0, n), materializing them if needed.
+   * The rows are grouped by partition so that each partition is visited by one thread
+   * and no locking is needed.
+   */
+  template<typename F>
+  void ForEachByPartition(const int64_t* row_ids, const size_t n, const F& f) {
+    const int num_parts = parts_.size();
+    std::vector<int> part_of(n);
+    #pragma omp parallel for
+    for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+      part_of[i] = PartitionOf(row_ids[i]);
+    }
+    std::vector<size_t> bounds(num_parts + 1, 0);
+    for (size_t i = 0; i < n; ++i) ++bounds[part_of[i] + 1];
+    for (int p = 0; p < num_parts; ++p) bounds[p + 1] += bounds[p];
+    std::vector<size_t> order(n);
+    std::vector<size_t> pos(bounds.begin(), bounds.end() - 1);
+    for (size_t i = 0; i < n; ++i) order[pos[part_of[i]]++] = i;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int p = 0; p < num_parts; ++p) {
+      for (size_t k = bounds[p]; k < bounds[p + 1]; ++k) {
+        const size_t i = order[k];
+        f(FindOrInsert(&parts_[p], row_ids[i]), i);
+      }
+    }
+  }
+
+  int PartitionOf(const int64_t row_id) const {
+    // mix the bits so that consecutive row ids spread over the partitions
+    uint64_t x = static_cast<uint64_t>(row_id) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x = x ^ (x >> 31);
+    return static_cast<int>(x % parts_.size());
+  }
+
+  real_t* FindOrInsert(Partition* part, const int64_t row_id) {
+    CHECK(row_id >= 0 && row_id < num_rows_) << "row id " << row_id << " out of range";
+    auto it = part->offset.find(row_id);
+    if (it != part->offset.end()) return part->values.data() + it->second;
+    const size_t offset = part->values.size();
+    part->values.resize(offset + (num_states_ + 1) * unit_len_, 0.0f);
+    part->offset.emplace(row_id, offset);
+    return part->values.data() + offset;
+  }
+
+  void UpdateRow(real_t* weight, const real_t* grad, const float lr) const {
+    real_t* state0 = weight + unit_len_;
+    real_t* state1 = weight + 2 * unit_len_;
+    for (int64_t j = 0; j < unit_len_; ++j) {
+      real_t g = grad[j] * param_.rescale_grad;
+      if (param_.clip_gradient >= 0.0f) {
+        g = std::max(std::min(g, param_.clip_gradient), -param_.clip_gradient);
+      }
+      real_t& w = weight[j];
+      switch (param_.optimizer) {
+        case kRowSGD:
+          if (num_states_ == 0) {
+            w -= lr * (g + param_.wd * w);
+          } else {
+            state0[j] = param_.momentum * state0[j] - lr * (g + param_.wd * w);
+            w += state0[j];
+          }
+          break;
+        case kRowAdam:
+          g += param_.wd * w;
+          state0[j] = param_.beta1 * state0[j] + (1.0f - param_.beta1) * g;
+          state1[j] = param_.beta2 * state1[j] + (1.0f - param_.beta2) * g * g;
+          w -= lr * state0[j] / (std::sqrt(state1[j]) + param_.epsilon);
+          break;
+        case kRowAdaGrad:
+          state0[j] += g * g;
+          w -= lr * (g / std::sqrt(state0[j] + param_.epsilon) + param_.wd * w);
+          break;
+        case kRowFtrl: {
+          // state0 is z, state1 is n
+          const real_t n = state1[j];
+          state0[j] += g - (std::sqrt(n + g * g) - std::sqrt(n)) * w / lr;
+          state1[j] = n + g * g;
+          const real_t z = state0[j];
+          w = std::abs(z) > param_.lamda1 ?
+              ((z > 0 ? 1.0f : -1.0f) * param_.lamda1 - z) /
+              ((param_.beta + std::sqrt(state1[j])) / lr + param_.wd) : 0.0f;
+          break;
+        }
+        default:
+          LOG(FATAL) << "unknown row optimizer " << param_.optimizer;
+      }
+    }
+  }
+
+  RowOptimizerParam param_;
+  int64_t num_rows_;
+  int64_t unit_len_;
+  int num_states_;
+  int64_t num_updates_ = 0;
+  std::vector<Partition> parts_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_SERVER_ROW_STORE_H_
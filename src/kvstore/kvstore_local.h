@@ -108,6 +108,13 @@ class KVStoreLocal : public KVStore {
     PullRowSparseImpl(keys, val_rowids, priority);
   }
 
+  void PrefetchRowSparse(const std::vector<int>& keys,
+                         const std::vector<NDArray>& row_ids,
+                         int priority = 0) override {
+    SetKeyType(kIntKey);
+    PrefetchRowSparseImpl(keys, row_ids, priority);
+  }
+
   void Push(const std::vector<std::string>& str_keys,
             const std::vector<NDArray>& values,
             int priority) override {
@@ -135,6 +142,15 @@ class KVStoreLocal : public KVStore {
     PullRowSparseImpl(keys, val_rowids, priority);
   }
 
+  void PrefetchRowSparse(const std::vector<std::string>& str_keys,
+                         const std::vector<NDArray>& row_ids,
+                         int priority = 0) override {
+    SetKeyType(kStringKey);
+    std::vector<int> keys(str_keys.size());
+    LookupKeys(str_keys, &keys);
+    PrefetchRowSparseImpl(keys, row_ids, priority);
+  }
+
  private:
   virtual void InitImpl(const std::vector<int>& keys,
                         const std::vector<NDArray>& values) {
@@ -206,6 +222,8 @@ class KVStoreLocal : public KVStore {
     std::vector<int> uniq_keys;
     std::vector<std::vector<std::pair<NDArray*, NDArray>>> grouped_val_rowids;
     GroupKVPairsPullRsp(keys, val_rowids, &uniq_keys, &grouped_val_rowids);
+    // row_ids shared by several keys or devices in this request are deduplicated once
+    std::vector<std::pair<NDArray, NDArray>> uniq_rowids;
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
       int key = uniq_keys[i];
       const NDArray& local = local_[key];
@@ -216,15 +234,20 @@ class KVStoreLocal : public KVStore {
       const size_t num_vals = target_val_rowids.size();
       for (size_t i = 0; i < num_vals; i++) {
         auto &row_id = target_val_rowids[i].second;
-        NDArray indices(row_id.shape(), pinned_ctx_, false, mshadow::kInt64);
-        CopyFromTo(row_id, &indices, 0);
-        Unique(&indices, priority);
-        target_val_rowids[i].second = indices;
+        target_val_rowids[i].second = UniqueRowIds(row_id, &uniq_rowids, priority);
       }
       comm_->BroadcastRowSparse(key, local, grouped_val_rowids[i], false, priority);
     }
   }
 
+  /**
+   * \brief rows are pulled from local memory with no latency to hide, so there
+   * is nothing to prefetch
+   */
+  virtual void PrefetchRowSparseImpl(const std::vector<int>& keys,
+                                     const std::vector<NDArray>& row_ids,
+                                     int priority = 0) { }
+
  protected:
   /**
    * \brief set the key type of the kvstore if haven't already.
@@ -354,8 +377,7 @@ class KVStoreLocal : public KVStore {
         auto out_data = output->data();
         MSHADOW_IDX_TYPE_SWITCH(out_data.type_flag_, IType, {
           auto dptr = output->data().dptr<IType>();
-          common::ParallelSort(dptr, dptr + size, omp_get_max_threads());
-          auto num_unique_idx = std::unique(dptr, dptr + size) - dptr;
+          auto num_unique_idx = common::ParallelSortUnique(dptr, size, omp_get_max_threads());
           *output = output->Reshape(mshadow::Shape1(num_unique_idx));
         });
       }, pinned_ctx_, {}, {out->var()},
@@ -363,6 +385,28 @@ class KVStoreLocal : public KVStore {
     out->WaitToRead();
   }
 
+  /**
+   * \brief copy row_id to `pinned_ctx_` and get its sorted unique values.
+   * The result is looked up in and added to `cache`, so that the same row_id
+   * array is only deduplicated once per request.
+   */
+  NDArray UniqueRowIds(const NDArray& row_id,
+                       std::vector<std::pair<NDArray, NDArray>>* cache,
+                       int priority = 0) {
+    for (const auto& entry : *cache) {
+      const NDArray& cached = entry.first;
+      if (cached.var() == row_id.var() && cached.shape() == row_id.shape()
+          && cached.data().dptr_ == row_id.data().dptr_) {
+        return entry.second;
+      }
+    }
+    NDArray indices(row_id.shape(), pinned_ctx_, false, mshadow::kInt64);
+    CopyFromTo(row_id, &indices, 0);
+    Unique(&indices, priority);
+    cache->emplace_back(row_id, indices);
+    return indices;
+  }
+
   /// reducer and broadcaster
   Comm* comm_;
   /// pinned context
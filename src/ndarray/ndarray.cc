@@ -30,6 +30,14 @@
 #include <mxnet/resource.h>
 #include <mxnet/imperative.h>
 #include <mshadow/tensor.h>
+#include <array>
+#include <unordered_map>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "./ndarray_function.h"
 #include "../common/utils.h"
 #include "../operator/tensor/matrix_op-inl.h"
@@ -1020,6 +1028,8 @@ bool NDArray::Load(dmlc::Stream *strm) {
 }
 
 const uint64_t kMXAPINDArrayListMagic = 0x112;
+/* magic number of the aligned ndarray list format */
+const uint64_t kMXAPINDArrayAlignedMagic = 0x113;
 
 void NDArray::Save(dmlc::Stream* fo,
                    const std::vector<NDArray>& data,
@@ -1039,6 +1049,8 @@ void NDArray::Load(dmlc::Stream* fi,
       << "Invalid NDArray file format";
   CHECK(fi->Read(&reserved))
       << "Invalid NDArray file format";
+  CHECK(header != kMXAPINDArrayAlignedMagic)
+      << "NDArray file is in the aligned format, load it with LoadMapped";
   CHECK(header == kMXAPINDArrayListMagic)
       << "Invalid NDArray file format";
   CHECK(fi->Read(data))
@@ -1049,6 +1061,384 @@ void NDArray::Load(dmlc::Stream* fi,
       << "Invalid NDArray file format";
 }
 
+/* alignment in bytes of the data of every array in the aligned format */
+const uint64_t kNDArrayAlignBytes = 64;
+/* flag of the aligned format, stored in the reserved header field: blobs have checksums */
+const uint64_t kNDArrayAlignedChecksum = 1;
+/* bytes covered by one crc32 in the checksum of a blob */
+const size_t kNDArrayChecksumChunk = 1 << 22;
+
+inline uint64_t NDArrayAlignUp(uint64_t offset) {
+  return (offset + kNDArrayAlignBytes - 1) / kNDArrayAlignBytes * kNDArrayAlignBytes;
+}
+
+/*! \brief crc32 (IEEE 802.3) of a buffer */
+inline uint32_t NDArrayCrc32(const void *buf, size_t size) {
+  static const std::array<uint32_t, 256> table = []() {
+    std::array<uint32_t, 256> t;
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  const uint8_t *p = static_cast<const uint8_t*>(buf);
+  uint32_t crc = 0xFFFFFFFFU;
+  for (size_t i = 0; i < size; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  return crc ^ 0xFFFFFFFFU;
+}
+
+/*!
+ * \brief copy blobs to dst, when dst is not null, and compute their checksums,
+ *  when checksums is not null, with all chunks of all blobs processed in parallel.
+ *  The checksum of a blob is the crc32 of the crc32s of its chunks.
+ */
+void NDArrayCopyChecksum(const std::vector<const char*> &src,
+                         const std::vector<char*> &dst,
+                         const std::vector<size_t> &size,
+                         std::vector<uint32_t> *checksums) {
+  std::vector<std::pair<size_t, size_t> > chunks;  // (blob, chunk begin)
+  std::vector<size_t> first_chunk(src.size() + 1, 0);
+  for (size_t i = 0; i < src.size(); ++i) {
+    for (size_t begin = 0; begin < size[i]; begin += kNDArrayChecksumChunk) {
+      chunks.emplace_back(i, begin);
+    }
+    first_chunk[i + 1] = chunks.size();
+  }
+  std::vector<uint32_t> crcs(checksums != nullptr ? chunks.size() : 0);
+  const int64_t nchunk = static_cast<int64_t>(chunks.size());
+  #pragma omp parallel for schedule(dynamic)
+  for (int64_t c = 0; c < nchunk; ++c) {
+    const size_t i = chunks[c].first, begin = chunks[c].second;
+    const size_t len = std::min(kNDArrayChecksumChunk, size[i] - begin);
+    if (dst[i] != nullptr) memcpy(dst[i] + begin, src[i] + begin, len);
+    if (checksums != nullptr) crcs[c] = NDArrayCrc32(src[i] + begin, len);
+  }
+  if (checksums == nullptr) return;
+  checksums->resize(src.size());
+  for (size_t i = 0; i < src.size(); ++i) {
+    (*checksums)[i] = NDArrayCrc32(crcs.data() + first_chunk[i],
+                                   (first_chunk[i + 1] - first_chunk[i]) * sizeof(uint32_t));
+  }
+}
+
+/*! \brief location of one blob (data or aux data) of an array in the aligned format */
+struct NDArrayAlignedBlob {
+  int32_t type_flag;
+  TShape shape;
+  uint64_t offset;
+  uint32_t checksum;
+  inline size_t nbytes() const {
+    return shape.Size() * mshadow::mshadow_sizeof(type_flag);
+  }
+};
+
+/*! \brief index entry of one array in the aligned format */
+struct NDArrayAlignedEntry {
+  int32_t stype;
+  TShape shape;
+  /*! \brief the data, then the aux data of sparse arrays */
+  std::vector<NDArrayAlignedBlob> blobs;
+
+  inline void Save(dmlc::Stream *strm) const {
+    strm->Write(&stype, sizeof(stype));
+    shape.Save(strm);
+    uint32_t nblobs = blobs.size();
+    strm->Write(&nblobs, sizeof(nblobs));
+    for (const NDArrayAlignedBlob &b : blobs) {
+      strm->Write(&b.type_flag, sizeof(b.type_flag));
+      b.shape.Save(strm);
+      strm->Write(&b.offset, sizeof(b.offset));
+      strm->Write(&b.checksum, sizeof(b.checksum));
+    }
+  }
+  inline bool Load(dmlc::Stream *strm) {
+    uint32_t nblobs;
+    if (strm->Read(&stype, sizeof(stype)) != sizeof(stype) || !shape.Load(strm) ||
+        strm->Read(&nblobs, sizeof(nblobs)) != sizeof(nblobs)) return false;
+    const size_t expected = stype == kDefaultStorage ? 1 :
+        1 + num_aux_data(static_cast<NDArrayStorageType>(stype));
+    if (nblobs != expected) return false;
+    blobs.resize(nblobs);
+    for (NDArrayAlignedBlob &b : blobs) {
+      if (strm->Read(&b.type_flag, sizeof(b.type_flag)) != sizeof(b.type_flag) ||
+          !b.shape.Load(strm) ||
+          strm->Read(&b.offset, sizeof(b.offset)) != sizeof(b.offset) ||
+          strm->Read(&b.checksum, sizeof(b.checksum)) != sizeof(b.checksum)) return false;
+    }
+    return true;
+  }
+};
+
+inline TBlob NDArrayAlignedBlobData(const NDArray &nd, size_t k) {
+  return k == 0 ? nd.data() : nd.aux_data(k - 1);
+}
+
+/*
+ * Aligned format:
+ *   header, padded to 64 bytes:
+ *     magic, flags, number of arrays, index offset, index size (uint64 each)
+ *   blobs of every array, each starting at a multiple of 64 bytes
+ *   index: for every array its storage type and shape, and for each of its blobs
+ *     the type flag, shape, offset and checksum, followed by the names
+ */
+void NDArray::SaveAligned(dmlc::Stream* fo,
+                          const std::vector<NDArray>& data,
+                          const std::vector<std::string>& names) {
+  CHECK(names.size() == 0 || names.size() == data.size())
+      << "number of names does not match number of arrays";
+  // start the copies of all arrays to cpu at once, they run in the engine
+  // while the arrays before them are checksummed and written
+  std::vector<NDArray> cpu_data(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    CHECK(!data[i].is_none()) << "SaveAligned: cannot save an empty NDArray";
+    if (data[i].ctx().dev_mask() == cpu::kDevMask) {
+      cpu_data[i] = data[i];
+    } else {
+      cpu_data[i] = data[i].Copy(Context::CPU());
+    }
+  }
+  // lay out the blobs, the storage shapes of sparse arrays are known once they are computed
+  std::vector<NDArrayAlignedEntry> entries(data.size());
+  uint64_t offset = kNDArrayAlignBytes;
+  for (size_t i = 0; i < data.size(); ++i) {
+    const NDArray &nd = cpu_data[i];
+    NDArrayAlignedEntry &e = entries[i];
+    e.stype = nd.storage_type();
+    e.shape = nd.shape();
+    if (e.stype == kDefaultStorage) {
+      e.blobs.push_back(NDArrayAlignedBlob{nd.dtype(), nd.shape(), 0, 0});
+    } else {
+      nd.WaitToRead();
+      e.blobs.push_back(NDArrayAlignedBlob{nd.dtype(), nd.storage_shape(), 0, 0});
+      for (size_t k = 0; k < num_aux_data(nd.storage_type()); ++k) {
+        e.blobs.push_back(NDArrayAlignedBlob{nd.aux_type(k), nd.aux_shape(k), 0, 0});
+      }
+    }
+    for (NDArrayAlignedBlob &b : e.blobs) {
+      b.offset = offset;
+      offset = NDArrayAlignUp(offset + b.nbytes());
+    }
+  }
+  auto save_index = [&entries, &names](std::string *index) {
+    dmlc::MemoryStringStream strm(index);
+    for (const NDArrayAlignedEntry &e : entries) e.Save(&strm);
+    strm.Write(names);
+  };
+  // the checksums are filled in while writing, they do not change the size of the index
+  std::string index;
+  save_index(&index);
+  const uint64_t index_size = index.size();
+  uint64_t header[kNDArrayAlignBytes / sizeof(uint64_t)] = {
+    kMXAPINDArrayAlignedMagic, kNDArrayAlignedChecksum, data.size(), offset, index_size};
+  fo->Write(header, sizeof(header));
+  const char padding[kNDArrayAlignBytes] = {0};
+  uint64_t pos = sizeof(header);
+  std::vector<const char*> src;
+  std::vector<char*> dst;
+  std::vector<size_t> size;
+  std::vector<uint32_t> checksums;
+  for (size_t i = 0; i < cpu_data.size(); ++i) {
+    NDArrayAlignedEntry &e = entries[i];
+    cpu_data[i].WaitToRead();
+    src.clear();
+    size.clear();
+    for (size_t k = 0; k < e.blobs.size(); ++k) {
+      const TBlob blob = NDArrayAlignedBlobData(cpu_data[i], k);
+      CHECK(blob.CheckContiguous());
+      src.push_back(static_cast<const char*>(blob.dptr_));
+      size.push_back(e.blobs[k].nbytes());
+    }
+    dst.assign(src.size(), nullptr);
+    NDArrayCopyChecksum(src, dst, size, &checksums);
+    for (size_t k = 0; k < e.blobs.size(); ++k) {
+      e.blobs[k].checksum = checksums[k];
+      fo->Write(padding, e.blobs[k].offset - pos);
+      fo->Write(src[k], size[k]);
+      pos = e.blobs[k].offset + size[k];
+    }
+    // release the cpu copy as soon as it is written
+    cpu_data[i] = NDArray();
+  }
+  fo->Write(padding, offset - pos);
+  index.clear();
+  save_index(&index);
+  CHECK_EQ(index.size(), index_size);
+  fo->Write(index.data(), index.size());
+}
+
+/*!
+ * \brief read the whole file into memory that the arrays point into, memory-mapped
+ *  copy-on-write when possible. Return false when the file is not in the aligned format.
+ */
+bool NDArrayMapAligned(const std::string& fname,
+                       std::shared_ptr<char> *mapping,
+                       uint64_t *flags,
+                       std::vector<NDArrayAlignedEntry> *entries,
+                       std::vector<std::string> *keys) {
+  uint64_t header[kNDArrayAlignBytes / sizeof(uint64_t)];
+  {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+    if (fi->Read(header, sizeof(header)) != sizeof(header) ||
+        header[0] != kMXAPINDArrayAlignedMagic) {
+      return false;
+    }
+  }
+  size_t size = 0;
+#ifndef _WIN32
+  {
+    int fd = open(fname.c_str(), O_RDONLY);
+    CHECK_NE(fd, -1) << "LoadMapped: cannot open " << fname;
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "LoadMapped: cannot stat " << fname;
+    size = st.st_size;
+    // copy-on-write, so that writes to the arrays stay private to this process
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(ptr != MAP_FAILED) << "LoadMapped: fail to mmap " << fname;
+    mapping->reset(static_cast<char*>(ptr), [size](char *p) { munmap(p, size); });
+  }
+#else
+  {
+    // no mmap, read the file into one buffer that the arrays point into
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+    std::shared_ptr<std::vector<uint64_t> > buffer = std::make_shared<std::vector<uint64_t> >();
+    const size_t kChunk = 1 << 20;
+    size_t nread;
+    do {
+      buffer->resize(buffer->size() + kChunk / sizeof(uint64_t));
+      nread = fi->Read(reinterpret_cast<char*>(buffer->data()) + size, kChunk);
+      size += nread;
+    } while (nread == kChunk);
+    *mapping = std::shared_ptr<char>(buffer, reinterpret_cast<char*>(buffer->data()));
+  }
+#endif
+  *flags = header[1];
+  const uint64_t num_arrays = header[2], index_offset = header[3], index_size = header[4];
+  CHECK_LE(index_offset + index_size, size) << "LoadMapped: " << fname << " is truncated";
+  dmlc::MemoryFixedSizeStream strm(mapping->get() + index_offset, index_size);
+  entries->resize(num_arrays);
+  for (NDArrayAlignedEntry &e : *entries) {
+    CHECK(e.Load(&strm)) << "Invalid NDArray file format";
+    for (const NDArrayAlignedBlob &b : e.blobs) {
+      CHECK_LE(b.offset + b.nbytes(), index_offset) << "Invalid NDArray file format";
+    }
+  }
+  CHECK(strm.Read(keys)) << "Invalid NDArray file format";
+  CHECK(keys->size() == 0 || keys->size() == entries->size())
+      << "Invalid NDArray file format";
+  return true;
+}
+
+bool NDArray::LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys) {
+  std::shared_ptr<char> mapping;
+  uint64_t flags;
+  std::vector<NDArrayAlignedEntry> entries;
+  if (!NDArrayMapAligned(fname, &mapping, &flags, &entries, keys)) {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+    Load(fi.get(), data, keys);
+    return false;
+  }
+  data->clear();
+  for (const NDArrayAlignedEntry &e : entries) {
+    std::vector<TBlob> blobs;
+    for (const NDArrayAlignedBlob &b : e.blobs) {
+      blobs.emplace_back(mapping.get() + b.offset, b.shape, cpu::kDevMask, b.type_flag);
+    }
+    NDArray nd;
+    if (e.stype == kDefaultStorage) {
+      nd = NDArray(blobs[0], 0);
+    } else {
+      nd = NDArray(static_cast<NDArrayStorageType>(e.stype), e.shape, blobs[0],
+                   std::vector<TBlob>(blobs.begin() + 1, blobs.end()), 0);
+    }
+    nd.KeepStaticDataAlive(mapping);
+    data->push_back(nd);
+  }
+#ifndef _WIN32
+  return true;
+#else
+  return false;
+#endif
+}
+
+void NDArray::LoadAligned(const std::string& fname,
+                          const std::vector<std::string>& select,
+                          bool verify,
+                          std::vector<NDArray>* data,
+                          std::vector<std::string>* keys) {
+  std::shared_ptr<char> mapping;
+  uint64_t flags;
+  std::vector<NDArrayAlignedEntry> entries;
+  std::vector<NDArray> all;
+  std::vector<std::string> all_keys;
+  const bool aligned = NDArrayMapAligned(fname, &mapping, &flags, &entries, &all_keys);
+  if (!aligned) {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+    Load(fi.get(), &all, &all_keys);
+  }
+  const size_t num_arrays = aligned ? entries.size() : all.size();
+  std::vector<size_t> chosen;
+  if (select.size() == 0) {
+    for (size_t i = 0; i < num_arrays; ++i) chosen.push_back(i);
+  } else {
+    CHECK_EQ(all_keys.size(), num_arrays)
+        << "LoadAligned: " << fname << " has no names to select arrays by";
+    std::unordered_map<std::string, size_t> position;
+    for (size_t i = 0; i < all_keys.size(); ++i) position[all_keys[i]] = i;
+    for (const std::string &name : select) {
+      auto it = position.find(name);
+      CHECK(it != position.end()) << "LoadAligned: no array named " << name << " in " << fname;
+      chosen.push_back(it->second);
+    }
+  }
+  data->clear();
+  keys->clear();
+  for (size_t i : chosen) {
+    if (all_keys.size() != 0) keys->push_back(all_keys[i]);
+    if (!aligned) data->push_back(all[i]);
+  }
+  if (!aligned) return;
+  // allocate all arrays, then copy and check every blob in parallel
+  const bool checksum = verify && (flags & kNDArrayAlignedChecksum);
+  std::vector<const char*> src;
+  std::vector<char*> dst;
+  std::vector<size_t> size;
+  std::vector<const NDArrayAlignedBlob*> blobs;
+  for (size_t i : chosen) {
+    const NDArrayAlignedEntry &e = entries[i];
+    NDArray nd;
+    if (e.stype == kDefaultStorage) {
+      nd = NDArray(e.shape, Context::CPU(), false, e.blobs[0].type_flag);
+    } else {
+      std::vector<int> aux_types;
+      std::vector<TShape> aux_shapes;
+      for (size_t k = 1; k < e.blobs.size(); ++k) {
+        aux_types.push_back(e.blobs[k].type_flag);
+        aux_shapes.push_back(e.blobs[k].shape);
+      }
+      nd = NDArray(static_cast<NDArrayStorageType>(e.stype), e.shape, Context::CPU(), false,
+                   e.blobs[0].type_flag, aux_types, aux_shapes, e.blobs[0].shape);
+    }
+    for (size_t k = 0; k < e.blobs.size(); ++k) {
+      src.push_back(mapping.get() + e.blobs[k].offset);
+      dst.push_back(static_cast<char*>(NDArrayAlignedBlobData(nd, k).dptr_));
+      size.push_back(e.blobs[k].nbytes());
+      blobs.push_back(&e.blobs[k]);
+    }
+    data->push_back(nd);
+  }
+  std::vector<uint32_t> checksums;
+  NDArrayCopyChecksum(src, dst, size, checksum ? &checksums : nullptr);
+  for (size_t j = 0; j < checksums.size(); ++j) {
+    CHECK_EQ(checksums[j], blobs[j]->checksum)
+        << "LoadAligned: checksum mismatch in " << fname << ", the file is corrupted";
+  }
+}
+
 NDArray NDArray::Copy(Context ctx) const {
   NDArray ret;
   if (kDefaultStorage == storage_type()) {
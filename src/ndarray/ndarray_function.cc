@@ -122,6 +122,31 @@ void GetUniqueRspRowIdx(const std::vector<NDArray>& nds,
     }
   }
 
+  // the row ids of each input are sorted and unique already, so if all inputs
+  // carry the same rows, e.g. the rows pulled for them, the union is one of them
+  const NDArray* first = nullptr;
+  bool same_rows = true;
+  for (const auto& nd : nds) {
+    if (!nd.storage_initialized()) continue;
+    if (first == nullptr) {
+      first = &nd;
+      continue;
+    }
+    const size_t num_rows = nd.aux_shape(kIdx).Size();
+    if (num_rows != first->aux_shape(kIdx).Size() ||
+        !std::equal(nd.aux_data(kIdx).dptr<IType>(),
+                    nd.aux_data(kIdx).dptr<IType>() + num_rows,
+                    first->aux_data(kIdx).dptr<IType>())) {
+      same_rows = false;
+      break;
+    }
+  }
+  if (first != nullptr && same_rows) {
+    const IType* first_row_idx = first->aux_data(kIdx).dptr<IType>();
+    uniq_row_idx->assign(first_row_idx, first_row_idx + first->aux_shape(kIdx).Size());
+    return;
+  }
+
   uniq_row_idx->resize(total_num_rows);
   int nthreads = omp_get_max_threads();
   int offset = 0;
@@ -137,9 +162,9 @@ void GetUniqueRspRowIdx(const std::vector<NDArray>& nds,
     }
   }
 
-  common::ParallelSort(uniq_row_idx->begin(), uniq_row_idx->end(), nthreads);
-  auto it = std::unique(uniq_row_idx->begin(), uniq_row_idx->end());
-  uniq_row_idx->resize(it - uniq_row_idx->begin());
+  const size_t num_unique = common::ParallelSortUnique(uniq_row_idx->data(),
+                                                      total_num_rows, nthreads);
+  uniq_row_idx->resize(num_unique);
 }
 
 void ElementwiseSumRsp(mshadow::Stream<cpu>* s,
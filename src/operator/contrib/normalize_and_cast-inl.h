@@ -0,0 +1,195 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file normalize_and_cast-inl.h
+ * \brief fused normalization of uint8 image batches on the compute device
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_NORMALIZE_AND_CAST_INL_H_
+#define MXNET_OPERATOR_CONTRIB_NORMALIZE_AND_CAST_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <algorithm>
+#include <vector>
+#include "../elemwise_op_common.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace normalize_cast {
+enum NormalizeAndCastInputs {kData, kAugParams};
+// layout of one row of the per-sample augmentation parameters,
+// as produced by ImageRecordUInt8Iter with output_aug_params=True
+enum AugParamIndex {kMirror, kContrast, kIllumination, kAugParamWidth};
+// maximum number of image channels (RGBA)
+const int kMaxChannels = 4;
+}  // namespace normalize_cast
+
+struct NormalizeAndCastParam : public dmlc::Parameter<NormalizeAndCastParam> {
+  nnvm::Tuple<float> mean;
+  nnvm::Tuple<float> std;
+  int layout;
+  int out_type;
+  DMLC_DECLARE_PARAMETER(NormalizeAndCastParam) {
+    float zeros[] = {0.0f};
+    float ones[] = {1.0f};
+    DMLC_DECLARE_FIELD(mean).set_default(nnvm::Tuple<float>(zeros, zeros + 1))
+    .describe("Per-channel mean (R, G, B, A order) subtracted from the input. "
+              "A single value is broadcast to all channels.");
+    DMLC_DECLARE_FIELD(std).set_default(nnvm::Tuple<float>(ones, ones + 1))
+    .describe("Per-channel standard deviation (R, G, B, A order) the input is divided by. "
+              "A single value is broadcast to all channels.");
+    DMLC_DECLARE_FIELD(layout)
+    .add_enum("NCHW", mshadow::kNCHW)
+    .add_enum("NHWC", mshadow::kNHWC)
+    .set_default(mshadow::kNCHW)
+    .describe("Layout of the input batch. The output is always in NCHW layout.");
+    DMLC_DECLARE_FIELD(out_type)
+    .add_enum("float32", mshadow::kFloat32)
+    .add_enum("float64", mshadow::kFloat64)
+    .add_enum("float16", mshadow::kFloat16)
+    .set_default(mshadow::kFloat32)
+    .describe("Output data type.");
+  }
+};
+
+/*! \brief per-channel statistics, passed by value so it can be used in device kernels */
+struct NormalizeChannelStat {
+  float mean[normalize_cast::kMaxChannels];
+  float inv_std[normalize_cast::kMaxChannels];
+};
+
+template<int layout>
+struct normalize_and_cast {
+  // i is the index in the NCHW output
+  template<typename DType>
+  MSHADOW_XINLINE static void Map(int i, DType *out, const uint8_t *in, const float *aug,
+                                  const NormalizeChannelStat stat,
+                                  const int channels, const int height, const int width) {
+    using namespace normalize_cast;
+    const int w = i % width;
+    const int h = (i / width) % height;
+    const int c = (i / (width * height)) % channels;
+    const int n = i / (width * height * channels);
+    const float *sample_aug = aug + n * kAugParamWidth;
+    const int src_w = sample_aug[kMirror] != 0.0f ? width - 1 - w : w;
+    int src;
+    if (layout == mshadow::kNHWC) {
+      src = ((n * height + h) * width + src_w) * channels + c;
+    } else {
+      src = ((n * channels + c) * height + h) * width + src_w;
+    }
+    // same arithmetic as ImageRecordIOParser2::ProcessImage
+    out[i] = DType((static_cast<float>(in[src]) - stat.mean[c]) * sample_aug[kContrast]
+                   * stat.inv_std[c] + sample_aug[kIllumination] * stat.inv_std[c]);
+  }
+};
+
+inline NormalizeChannelStat GetNormalizeChannelStat(const NormalizeAndCastParam& param,
+                                                    const int channels) {
+  using namespace normalize_cast;
+  CHECK(param.mean.ndim() == 1 || static_cast<int>(param.mean.ndim()) >= channels)
+    << "normalize_and_cast: mean must have 1 or " << channels << " values";
+  CHECK(param.std.ndim() == 1 || static_cast<int>(param.std.ndim()) >= channels)
+    << "normalize_and_cast: std must have 1 or " << channels << " values";
+  NormalizeChannelStat stat;
+  for (int c = 0; c < kMaxChannels; ++c) {
+    const float m = param.mean[param.mean.ndim() == 1 ? 0 : std::min<int>(c, channels - 1)];
+    const float s = param.std[param.std.ndim() == 1 ? 0 : std::min<int>(c, channels - 1)];
+    CHECK_NE(s, 0.0f) << "normalize_and_cast: std must be non-zero";
+    stat.mean[c] = m;
+    stat.inv_std[c] = 1.0f / s;
+  }
+  return stat;
+}
+
+template<typename xpu>
+void NormalizeAndCastCompute(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace normalize_cast;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(req[0], kWriteTo) << "normalize_and_cast only supports req = kWriteTo";
+  const NormalizeAndCastParam& param = nnvm::get<NormalizeAndCastParam>(attrs.parsed);
+  Stream<xpu> *s = ctx.get_stream<xpu>();
+  // output is always NCHW
+  const TShape& oshape = outputs[0].shape_;
+  const int channels = oshape[1], height = oshape[2], width = oshape[3];
+  const NormalizeChannelStat stat = GetNormalizeChannelStat(param, channels);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    if (param.layout == mshadow::kNHWC) {
+      Kernel<normalize_and_cast<mshadow::kNHWC>, xpu>::Launch(s, outputs[0].Size(),
+        outputs[0].dptr<DType>(), inputs[kData].dptr<uint8_t>(),
+        inputs[kAugParams].dptr<float>(), stat, channels, height, width);
+    } else {
+      Kernel<normalize_and_cast<mshadow::kNCHW>, xpu>::Launch(s, outputs[0].Size(),
+        outputs[0].dptr<DType>(), inputs[kData].dptr<uint8_t>(),
+        inputs[kAugParams].dptr<float>(), stat, channels, height, width);
+    }
+  });
+}
+
+inline bool NormalizeAndCastShape(const nnvm::NodeAttrs& attrs,
+                                  std::vector<TShape> *in_attrs,
+                                  std::vector<TShape> *out_attrs) {
+  using namespace normalize_cast;
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const NormalizeAndCastParam& param = nnvm::get<NormalizeAndCastParam>(attrs.parsed);
+  const TShape& dshape = in_attrs->at(kData);
+  if (shape_is_none(dshape)) return false;
+  CHECK_EQ(dshape.ndim(), 4U)
+    << "normalize_and_cast expects a 4-D image batch, got " << dshape;
+  TShape oshape = dshape;
+  if (param.layout == mshadow::kNHWC) {
+    oshape[1] = dshape[3];
+    oshape[2] = dshape[1];
+    oshape[3] = dshape[2];
+  }
+  CHECK_LE(oshape[1], static_cast<index_t>(kMaxChannels))
+    << "normalize_and_cast supports at most " << kMaxChannels << " channels";
+  SHAPE_ASSIGN_CHECK(*in_attrs, kAugParams, mshadow::Shape2(dshape[0], kAugParamWidth));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, oshape);
+  return true;
+}
+
+inline bool NormalizeAndCastType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int> *in_attrs,
+                                 std::vector<int> *out_attrs) {
+  using namespace normalize_cast;
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const NormalizeAndCastParam& param = nnvm::get<NormalizeAndCastParam>(attrs.parsed);
+  TYPE_ASSIGN_CHECK(*in_attrs, kData, mshadow::kUint8);
+  TYPE_ASSIGN_CHECK(*in_attrs, kAugParams, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, param.out_type);
+  return true;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_NORMALIZE_AND_CAST_INL_H_
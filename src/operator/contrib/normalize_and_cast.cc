@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file normalize_and_cast.cc
+ * \brief
+ */
+#include "./normalize_and_cast-inl.h"
+
+namespace mxnet {
+namespace op {
+DMLC_REGISTER_PARAMETER(NormalizeAndCastParam);
+
+NNVM_REGISTER_OP(_contrib_normalize_and_cast)
+.describe(R"code(Normalize a batch of `uint8` images and cast it to `out_type`.
+
+This operator is the device-side counterpart of ``ImageRecordUInt8Iter`` with
+``output_aug_params=True``: the iterator ships raw `uint8` pixels together with
+per-sample augmentation parameters, and the per-pixel floating point math runs
+here, on the device the network is bound to.
+
+`aug_params` has shape `(batch_size, 3)`, each row holding
+`(mirror, contrast, illumination)`. For every output element::
+
+  w'  = mirror ? width - 1 - w : w
+  out[n, c, h, w] = (data[n, c, h, w'] - mean[c]) * contrast / std[c] + illumination / std[c]
+
+The output is always in `NCHW` layout, regardless of the input `layout`.
+
+Example::
+
+  data = mx.sym.Variable('data')          # uint8, (N, 224, 224, 3)
+  aug = mx.sym.Variable('aug_params')     # float32, (N, 3)
+  x = mx.sym.contrib.normalize_and_cast(data, aug, layout='NHWC',
+                                        mean=(123.68, 116.28, 103.53),
+                                        std=(58.395, 57.12, 57.375))
+
+)code" ADD_FILELINE)
+.set_attr_parser(ParamParser<NormalizeAndCastParam>)
+.set_num_inputs(2)
+.set_num_outputs(1)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    return std::vector<std::string>{"data", "aug_params"};
+  })
+.set_attr<nnvm::FInferShape>("FInferShape", NormalizeAndCastShape)
+.set_attr<nnvm::FInferType>("FInferType", NormalizeAndCastType)
+.set_attr<FCompute>("FCompute<cpu>", NormalizeAndCastCompute<cpu>)
+.set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+.add_argument("data", "NDArray-or-Symbol", "A batch of images of type `uint8`")
+.add_argument("aug_params", "NDArray-or-Symbol", "Per-sample augmentation parameters "
+  "(mirror, contrast, illumination) of type `float32`")
+.add_arguments(NormalizeAndCastParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
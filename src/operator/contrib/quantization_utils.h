@@ -0,0 +1,179 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file quantization_utils.h
+ * \brief helpers shared by the quantized operators
+ *
+ *  Quantized operators use symmetric quantization: a tensor of a signed integer
+ *  type T with range [min, max] represents the values q * r / MaxValue<T>(),
+ *  where r = max(|min|, |max|).
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_QUANTIZATION_UTILS_H_
+#define MXNET_OPERATOR_CONTRIB_QUANTIZATION_UTILS_H_
+
+#include <mxnet/base.h>
+#include <mxnet/engine.h>
+#include <mxnet/op_attr_types.h>
+#include <nnvm/node.h>
+#include <nnvm/op.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+template<typename T>
+MSHADOW_XINLINE float MaxValue();
+
+template<>
+MSHADOW_XINLINE float MaxValue<int8_t>() {
+  return 127.0f;
+}
+
+template<>
+MSHADOW_XINLINE float MaxValue<int32_t>() {
+  return 2147483647.0f;
+}
+
+MSHADOW_XINLINE float MaxAbs(float a, float b) {
+  return fmaxf(fabsf(a), fabsf(b));
+}
+
+/*! \brief the real value of one unit of a quantized tensor with the given range */
+template<typename T>
+MSHADOW_XINLINE float QuantizedUnit(float min_range, float max_range) {
+  return MaxAbs(min_range, max_range) / MaxValue<T>();
+}
+
+/*! \brief round a float to the nearest value of T, saturating */
+template<typename T>
+MSHADOW_XINLINE T SaturateCast(float v) {
+  const float limit = MaxValue<T>();
+  v = v > limit ? limit : (v < -limit ? -limit : v);
+  return static_cast<T>(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+/*! \brief round a double to the nearest int32, saturating */
+inline int32_t SaturateInt32(double v) {
+  v = std::max(-2147483647.0, std::min(2147483647.0, v));
+  return static_cast<int32_t>(v >= 0.0 ? v + 0.5 : v - 0.5);
+}
+
+/*!
+ * \brief c += a * b for row major int8 a (m x k), int8 b (k x n) and int32 c (m x n).
+ *  c is split in tiles computed in parallel. A tile goes over k in blocks so the
+ *  block of b it reads stays in cache, and updates four rows of c with each row
+ *  of the block, in an inner loop over n which the compiler vectorizes.
+ */
+inline void QuantizedGemm(const int8_t *a, const int8_t *b, int32_t *c,
+                          const int64_t m, const int64_t n, const int64_t k) {
+  const int64_t tile_m = 32, tile_n = 256, block_k = 128;
+  const int64_t tiles_m = (m + tile_m - 1) / tile_m;
+  const int64_t tiles_n = (n + tile_n - 1) / tile_n;
+  const int omp_threads = std::max(Engine::Get()->num_omp_threads_per_worker(), 1);
+  #pragma omp parallel for num_threads(omp_threads)
+  for (int64_t t = 0; t < tiles_m * tiles_n; ++t) {
+    const int64_t i_begin = (t / tiles_n) * tile_m, i_end = std::min(i_begin + tile_m, m);
+    const int64_t j_begin = (t % tiles_n) * tile_n, nb = std::min(j_begin + tile_n, n) - j_begin;
+    for (int64_t l_begin = 0; l_begin < k; l_begin += block_k) {
+      const int64_t l_end = std::min(l_begin + block_k, k);
+      int64_t i = i_begin;
+      for (; i + 4 <= i_end; i += 4) {
+        int32_t *c0 = c + i * n + j_begin, *c1 = c0 + n, *c2 = c1 + n, *c3 = c2 + n;
+        const int8_t *a0 = a + i * k, *a1 = a0 + k, *a2 = a1 + k, *a3 = a2 + k;
+        for (int64_t l = l_begin; l < l_end; ++l) {
+          const int32_t v0 = a0[l], v1 = a1[l], v2 = a2[l], v3 = a3[l];
+          const int8_t *bl = b + l * n + j_begin;
+          for (int64_t j = 0; j < nb; ++j) {
+            const int32_t w = bl[j];
+            c0[j] += v0 * w;
+            c1[j] += v1 * w;
+            c2[j] += v2 * w;
+            c3[j] += v3 * w;
+          }
+        }
+      }
+      for (; i < i_end; ++i) {
+        int32_t *ci = c + i * n + j_begin;
+        for (int64_t l = l_begin; l < l_end; ++l) {
+          const int32_t v = a[i * k + l];
+          const int8_t *bl = b + l * n + j_begin;
+          for (int64_t j = 0; j < nb; ++j) {
+            ci[j] += v * static_cast<int32_t>(bl[j]);
+          }
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * \brief the input names of a quantized operator: its data inputs followed by
+ *  the min and the max of each of them
+ */
+inline std::vector<std::string> QuantizedInputNames(const std::vector<std::string>& names) {
+  std::vector<std::string> ret(names);
+  for (const std::string& name : names) {
+    ret.push_back("min_" + name);
+    ret.push_back("max_" + name);
+  }
+  return ret;
+}
+
+/*!
+ * \brief infer the types of a quantized operator with num_inputs int8 data inputs
+ *  and one output of type out_type, each followed by their float ranges
+ */
+inline bool QuantizedOpType(size_t num_inputs, int out_type,
+                            std::vector<int> *in_attrs,
+                            std::vector<int> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3 * num_inputs);
+  CHECK_EQ(out_attrs->size(), 3U);
+  for (size_t i = 0; i < num_inputs; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, mshadow::kInt8);
+  }
+  for (size_t i = num_inputs; i < 3 * num_inputs; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, out_type);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return true;
+}
+
+/*! \brief create a node of the quantized operator op_name with the parameters of attrs */
+inline nnvm::NodePtr CreateQuantizedNode(const std::string& op_name, const NodeAttrs& attrs) {
+  nnvm::NodePtr node = nnvm::Node::Create();
+  node->attrs.op = nnvm::Op::Get(op_name);
+  node->attrs.name = "quantized_" + attrs.name;
+  node->attrs.dict = attrs.dict;
+  if (node->op()->attr_parser != nullptr) {
+    node->op()->attr_parser(&(node->attrs));
+  }
+  return node;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_QUANTIZATION_UTILS_H_
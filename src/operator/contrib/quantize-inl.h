@@ -30,6 +30,7 @@
 #include "../elemwise_op_common.h"
 #include "../mshadow_op.h"
 #include "../mxnet_op.h"
+#include "./quantization_utils.h"
 
 namespace mxnet {
 namespace op {
@@ -39,6 +40,7 @@ struct QuantizeParam : public dmlc::Parameter<QuantizeParam> {
   DMLC_DECLARE_PARAMETER(QuantizeParam) {
     DMLC_DECLARE_FIELD(out_type)
     .add_enum("uint8", mshadow::kUint8)
+    .add_enum("int8", mshadow::kInt8)
     .set_default(mshadow::kUint8)
     .describe("Output data type.");
   }
@@ -57,6 +59,23 @@ struct quantize {
   }
 };
 
+/*!
+ * \brief symmetric quantization to a signed type, with the range
+ *  [-max(|min_range|, |max_range|), max(|min_range|, |max_range|)]
+ */
+struct quantize_symmetric {
+  template<typename DstDType, typename SrcDType>
+  MSHADOW_XINLINE static void Map(int i, DstDType *out, float *omin_range,
+                                  float *omax_range, const SrcDType *in,
+                                  const float *imin_range, const float *imax_range) {
+    const float range = MaxAbs(*imin_range, *imax_range);
+    const float scale = range > 0.0f ? MaxValue<DstDType>() / range : 0.0f;
+    out[i] = SaturateCast<DstDType>(in[i] * scale);
+    *omin_range = -range;
+    *omax_range = range;
+  }
+};
+
 template<typename xpu>
 void QuantizeCompute(const nnvm::NodeAttrs& attrs,
                      const OpContext& ctx,
@@ -66,15 +85,22 @@ void QuantizeCompute(const nnvm::NodeAttrs& attrs,
   using namespace mshadow;
   using namespace mxnet_op;
   Stream<xpu> *s = ctx.get_stream<xpu>();
+  const QuantizeParam& param = nnvm::get<QuantizeParam>(attrs.parsed);
 
-  // for now, only supports quantize from uint8 to float
+  // for now, only supports quantize from float to uint8 or int8
   // TODO(ziheng) consider add MSHADOW_INTEGER_TYPE_SWITCH
-  typedef uint8_t DstDType;
   typedef float SrcDType;
-  Kernel<quantize, xpu>::Launch(s, outputs[0].Size(),
-    outputs[0].dptr<DstDType>(), outputs[1].dptr<float>(), outputs[2].dptr<float>(),
-    inputs[0].dptr<SrcDType>(), inputs[1].dptr<float>(), inputs[2].dptr<float>(),
-    std::numeric_limits<DstDType>::min(), std::numeric_limits<DstDType>::max());
+  if (param.out_type == mshadow::kInt8) {
+    Kernel<quantize_symmetric, xpu>::Launch(s, outputs[0].Size(),
+      outputs[0].dptr<int8_t>(), outputs[1].dptr<float>(), outputs[2].dptr<float>(),
+      inputs[0].dptr<SrcDType>(), inputs[1].dptr<float>(), inputs[2].dptr<float>());
+  } else {
+    typedef uint8_t DstDType;
+    Kernel<quantize, xpu>::Launch(s, outputs[0].Size(),
+      outputs[0].dptr<DstDType>(), outputs[1].dptr<float>(), outputs[2].dptr<float>(),
+      inputs[0].dptr<SrcDType>(), inputs[1].dptr<float>(), inputs[2].dptr<float>(),
+      std::numeric_limits<DstDType>::min(), std::numeric_limits<DstDType>::max());
+  }
 }
 
 inline bool QuantizeShape(const nnvm::NodeAttrs& attrs,
@@ -105,7 +131,8 @@ inline bool QuantizeType(const nnvm::NodeAttrs& attrs,
     << "the second input of `quantize` should be a tensor with type of float";
   CHECK_EQ((*in_attrs)[2], mshadow::kFloat32)
     << "the third input of `quantize` should be a tensor with type of float";
-  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kUint8);
+  const QuantizeParam& param = nnvm::get<QuantizeParam>(attrs.parsed);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, param.out_type);
   TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
   TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
   return (*in_attrs)[0] != -1;
@@ -37,6 +37,13 @@ the input data. Each value of the tensor will undergo the following:
 `out[i] = (in[i] - min_range) * range(OUTPUT_TYPE) / (max_range - min_range)`
 
 here `range(T) = numeric_limits<T>::max() - numeric_limits<T>::min()`
+
+With `out_type` int8 the quantization is symmetric around zero, which is what the
+quantized operators take:
+
+`out[i] = round(in[i] * 127 / r)`, with `r = max(abs(min_range), abs(max_range))`
+
+and the output range is `[-r, r]`.
 )code" ADD_FILELINE)
 .set_attr_parser(ParamParser<QuantizeParam>)
 .set_num_inputs(3)
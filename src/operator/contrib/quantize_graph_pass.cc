@@ -0,0 +1,224 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file quantize_graph_pass.cc
+ * \brief passes that rewrite a float graph into its quantized form and
+ *  attach calibrated ranges to it
+ */
+#include <nnvm/graph.h>
+#include <nnvm/pass.h>
+#include <mxnet/op_attr_types.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+using nnvm::Op;
+using nnvm::Node;
+using nnvm::NodePtr;
+using nnvm::NodeEntry;
+using nnvm::Graph;
+
+inline NodePtr CreateNode(const std::string& op_name, const std::string& node_name) {
+  NodePtr node = Node::Create();
+  node->attrs.name = node_name;
+  node->attrs.op = op_name.empty() ? nullptr : Op::Get(op_name);
+  return node;
+}
+
+inline void ParseAttrs(const NodePtr& node) {
+  if (node->op() != nullptr && node->op()->attr_parser != nullptr) {
+    node->op()->attr_parser(&(node->attrs));
+  }
+}
+
+/*!
+ * \brief rewrite every quantizable node into its quantized version
+ *
+ *  The float inputs of a quantized node are quantized to int8 at runtime with
+ *  the range given by min and max of the input, except for the variables named
+ *  in "offline_params": these are replaced by the variables <name>_quantize,
+ *  <name>_quantize_min and <name>_quantize_max that hold their quantized value.
+ *  int32 outputs are converted back to int8 by requantize, and quantized outputs
+ *  consumed by float nodes or by the graph outputs are dequantized. Nodes named
+ *  in "excluded_nodes" are kept in float. Quantized operators that do not need
+ *  requantize, e.g. pooling, are only used when their data input is quantized
+ *  already, as quantizing the input would cost more than what they save.
+ */
+Graph QuantizeGraph(Graph &&src) {
+  static auto& quantized_op_map = Op::GetAttr<FQuantizedOp>("FQuantizedOp");
+  static auto& need_requantize_map = Op::GetAttr<FNeedRequantize>("FNeedRequantize");
+  const auto& excluded_nodes = src.GetAttr<std::unordered_set<std::string> >("excluded_nodes");
+  const auto& offline_params = src.GetAttr<std::unordered_set<std::string> >("offline_params");
+
+  // map from a float node to the node producing its output in the new graph
+  std::unordered_map<Node*, NodePtr> mirror_map;
+  // nodes of the new graph whose outputs 0, 1 and 2 are int8 data, min and max
+  std::unordered_set<Node*> quantized_nodes;
+  // dequantized outputs of quantized nodes, to share them among their consumers
+  std::unordered_map<Node*, NodeEntry> dequantized;
+  // quantized data, min and max of float inputs, to share them among their consumers
+  std::map<std::pair<Node*, uint32_t>, std::vector<NodeEntry> > quantized_inputs;
+
+  auto mirror = [&](const NodeEntry& e) {
+    return NodeEntry{mirror_map.at(e.node.get()), e.index, e.version};
+  };
+  auto dequantize = [&](const NodeEntry& e) {
+    auto it = dequantized.find(e.node.get());
+    if (it != dequantized.end()) return it->second;
+    NodePtr node = CreateNode("_contrib_dequantize", e.node->attrs.name + "_dequantize");
+    node->inputs = {NodeEntry{e.node, 0, 0}, NodeEntry{e.node, 1, 0}, NodeEntry{e.node, 2, 0}};
+    node->attrs.dict["out_type"] = "float32";
+    ParseAttrs(node);
+    NodeEntry ret{node, 0, 0};
+    dequantized[e.node.get()] = ret;
+    return ret;
+  };
+
+  nnvm::DFSVisit(src.outputs, [&](const NodePtr& node) {
+    NodePtr new_node;
+    bool quantize = false;
+    if (!node->is_variable() && quantized_op_map.count(node->op()) &&
+        excluded_nodes.count(node->attrs.name) == 0) {
+      new_node = quantized_op_map[node->op()](node->attrs);
+      quantize = new_node != nullptr &&
+          (need_requantize_map[node->op()](node->attrs) ||
+           quantized_nodes.count(mirror_map.at(node->inputs[0].node.get()).get()));
+    }
+    if (quantize) {
+      std::vector<NodeEntry> ranges;
+      for (const NodeEntry& e : node->inputs) {
+        NodeEntry m = mirror(e);
+        if (quantized_nodes.count(m.node.get())) {
+          new_node->inputs.push_back(m);
+          ranges.push_back(NodeEntry{m.node, 1, 0});
+          ranges.push_back(NodeEntry{m.node, 2, 0});
+          continue;
+        }
+        // a float input shared by several quantized nodes, e.g. a tied weight, is
+        // quantized once
+        auto it = quantized_inputs.find({e.node.get(), e.index});
+        if (it == quantized_inputs.end()) {
+          std::vector<NodeEntry> quantized;
+          if (e.node->is_variable() && offline_params.count(e.node->attrs.name)) {
+            const std::string name = e.node->attrs.name + "_quantize";
+            quantized = {NodeEntry{CreateNode("", name), 0, 0},
+                         NodeEntry{CreateNode("", name + "_min"), 0, 0},
+                         NodeEntry{CreateNode("", name + "_max"), 0, 0}};
+          } else {
+            const std::string name = e.node->is_variable() ? e.node->attrs.name :
+                e.node->attrs.name + "_output" + std::to_string(e.index);
+            NodePtr min_node = CreateNode("min", name + "_min");
+            min_node->inputs = {m};
+            ParseAttrs(min_node);
+            NodePtr max_node = CreateNode("max", name + "_max");
+            max_node->inputs = {m};
+            ParseAttrs(max_node);
+            NodePtr quantize_node = CreateNode("_contrib_quantize", name + "_quantize");
+            quantize_node->inputs = {m, NodeEntry{min_node, 0, 0}, NodeEntry{max_node, 0, 0}};
+            quantize_node->attrs.dict["out_type"] = "int8";
+            ParseAttrs(quantize_node);
+            quantized = {NodeEntry{quantize_node, 0, 0}, NodeEntry{quantize_node, 1, 0},
+                         NodeEntry{quantize_node, 2, 0}};
+          }
+          it = quantized_inputs.emplace(std::make_pair(e.node.get(), e.index),
+                                        std::move(quantized)).first;
+        }
+        new_node->inputs.push_back(it->second[0]);
+        ranges.push_back(it->second[1]);
+        ranges.push_back(it->second[2]);
+      }
+      new_node->inputs.insert(new_node->inputs.end(), ranges.begin(), ranges.end());
+      if (need_requantize_map[node->op()](node->attrs)) {
+        NodePtr requantize_node = CreateNode("_contrib_requantize",
+                                             new_node->attrs.name + "_requantize");
+        requantize_node->inputs = {NodeEntry{new_node, 0, 0}, NodeEntry{new_node, 1, 0},
+                                   NodeEntry{new_node, 2, 0}};
+        ParseAttrs(requantize_node);
+        new_node = requantize_node;
+      }
+      quantized_nodes.insert(new_node.get());
+    } else {
+      new_node = Node::Create();
+      *new_node = *node;
+      new_node->inputs.clear();
+      for (const NodeEntry& e : node->inputs) {
+        NodeEntry m = mirror(e);
+        new_node->inputs.push_back(quantized_nodes.count(m.node.get()) ? dequantize(m) : m);
+      }
+      new_node->control_deps.clear();
+      for (const NodePtr& dep : node->control_deps) {
+        new_node->control_deps.push_back(mirror_map.at(dep.get()));
+      }
+    }
+    mirror_map[node.get()] = new_node;
+  });
+
+  Graph ret;
+  for (const NodeEntry& e : src.outputs) {
+    NodeEntry m = mirror(e);
+    ret.outputs.push_back(quantized_nodes.count(m.node.get()) ? dequantize(m) : m);
+  }
+  return ret;
+}
+
+/*!
+ * \brief set the ranges found by calibration to the requantize nodes
+ *
+ *  "calib_table" maps the name of the output of a float node, as in
+ *  Symbol.get_internals(), to its (min, max) range. The requantize node after
+ *  quantized_<name> uses the range of <name>_output.
+ */
+Graph SetCalibTableToQuantizedGraph(Graph&& g) {
+  static const Op* requantize_op = Op::Get("_contrib_requantize");
+  const auto& calib_table =
+      g.GetAttr<std::unordered_map<std::string, std::pair<float, float> > >("calib_table");
+  const std::string prefix = "quantized_";
+  nnvm::DFSVisit(g.outputs, [&](const NodePtr& node) {
+    if (node->op() != requantize_op) return;
+    const std::string& name = node->inputs[0].node->attrs.name;
+    if (name.compare(0, prefix.size(), prefix) != 0) return;
+    auto it = calib_table.find(name.substr(prefix.size()) + "_output");
+    if (it == calib_table.end()) return;
+    node->attrs.dict["min_calib_range"] = std::to_string(it->second.first);
+    node->attrs.dict["max_calib_range"] = std::to_string(it->second.second);
+    ParseAttrs(node);
+  });
+  return g;
+}
+
+NNVM_REGISTER_PASS(QuantizeGraph)
+.describe("Return a new graph with the quantizable nodes replaced by their quantized versions")
+.set_body(QuantizeGraph)
+.set_change_graph(true);
+
+NNVM_REGISTER_PASS(SetCalibTableToQuantizedGraph)
+.describe("Set the calibrated ranges to the requantize nodes of a quantized graph")
+.set_body(SetCalibTableToQuantizedGraph)
+.set_change_graph(false);
+
+}  // namespace op
+}  // namespace mxnet
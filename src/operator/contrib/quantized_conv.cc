@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file quantized_conv.cc
+ * \brief int8 2D convolution operator with int32 accumulation
+ */
+#include <vector>
+#include "../convolution-inl.h"
+#include "../nn/im2col.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief parse ConvolutionParam and fill in the defaults of a 2D convolution */
+inline void QuantizedConvParamParser(nnvm::NodeAttrs* attrs) {
+  ConvolutionParam param;
+  param.Init(attrs->dict);
+  CHECK_EQ(param.kernel.ndim(), 2U) << "QuantizedConvolution only supports 2D convolution";
+  if (param.stride.ndim() == 0) param.stride = mshadow::Shape2(1, 1);
+  if (param.dilate.ndim() == 0) param.dilate = mshadow::Shape2(1, 1);
+  if (param.pad.ndim() == 0) param.pad = mshadow::Shape2(0, 0);
+  attrs->parsed = std::move(param);
+}
+
+inline bool QuantizedConvShape(const nnvm::NodeAttrs& attrs,
+                               std::vector<TShape> *in_shape,
+                               std::vector<TShape> *out_shape) {
+  const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  const size_t num_inputs = param.no_bias ? 2 : 3;
+  CHECK_EQ(in_shape->size(), 3 * num_inputs);
+  CHECK_EQ(out_shape->size(), 3U);
+  const TShape& dshape = in_shape->at(0);
+  if (dshape.ndim() == 0) return false;
+  CHECK_EQ(dshape.ndim(), 4U) << "QuantizedConvolution only supports NCHW input";
+  SHAPE_ASSIGN_CHECK(*in_shape, 1, mshadow::Shape4(param.num_filter, dshape[1],
+                                                   param.kernel[0], param.kernel[1]));
+  if (!param.no_bias) {
+    SHAPE_ASSIGN_CHECK(*in_shape, 2, mshadow::Shape1(param.num_filter));
+  }
+  for (size_t i = num_inputs; i < 3 * num_inputs; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_shape, i, TShape{1});
+  }
+  TShape oshape = dshape;
+  oshape[1] = param.num_filter;
+  for (int i = 0; i < 2; ++i) {
+    const index_t dilated_kernel = param.DilatedKernelSize(i);
+    CHECK_LE(dilated_kernel, dshape[i + 2] + 2 * param.pad[i])
+        << "kernel size exceeds input";
+    oshape[i + 2] = (dshape[i + 2] + 2 * param.pad[i] - dilated_kernel) / param.stride[i] + 1;
+  }
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, oshape);
+  SHAPE_ASSIGN_CHECK(*out_shape, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_shape, 2, TShape{1});
+  return true;
+}
+
+inline bool QuantizedConvType(const nnvm::NodeAttrs& attrs,
+                              std::vector<int> *in_type,
+                              std::vector<int> *out_type) {
+  const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  return QuantizedOpType(param.no_bias ? 2 : 3, mshadow::kInt32, in_type, out_type);
+}
+
+void QuantizedConvForwardCPU(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  const size_t num_inputs = param.no_bias ? 2 : 3;
+  CHECK_EQ(req[0], kWriteTo) << "QuantizedConvolution only supports req = kWriteTo";
+  Stream<cpu> *s = ctx.get_stream<cpu>();
+  const TShape& dshape = inputs[0].shape_;
+  const TShape& oshape = outputs[0].shape_;
+  const int64_t channels = dshape[1], height = dshape[2], width = dshape[3];
+  const int64_t num_filter = param.num_filter;
+  // im2col gives a (channels * kernel_h * kernel_w, out_h * out_w) matrix per image
+  const int64_t col_rows = channels * param.kernel[0] * param.kernel[1];
+  const int64_t col_cols = oshape[2] * oshape[3];
+  auto range = [&inputs, num_inputs](size_t i) {
+    return QuantizedUnit<int8_t>(*inputs[num_inputs + 2 * i].dptr<float>(),
+                                 *inputs[num_inputs + 2 * i + 1].dptr<float>());
+  };
+  const float out_unit = range(0) * range(1);
+  std::vector<int32_t> bias(num_filter, 0);
+  if (!param.no_bias) {
+    const double ratio = out_unit > 0.0f ? static_cast<double>(range(2)) / out_unit : 0.0;
+    const int8_t *bptr = inputs[2].dptr<int8_t>();
+    for (int64_t f = 0; f < num_filter; ++f) bias[f] = SaturateInt32(bptr[f] * ratio);
+  }
+  Tensor<cpu, 1, int8_t> col = ctx.requested[0].get_space_typed<cpu, 1, int8_t>(
+      Shape1(col_rows * col_cols), s);
+  const int8_t *wptr = inputs[1].dptr<int8_t>();
+  for (index_t n = 0; n < dshape[0]; ++n) {
+    im2col_cpu(inputs[0].dptr<int8_t>() + n * channels * height * width,
+               channels, height, width, param.kernel[0], param.kernel[1],
+               param.pad[0], param.pad[1], param.stride[0], param.stride[1],
+               param.dilate[0], param.dilate[1], col.dptr_);
+    int32_t *out = outputs[0].dptr<int32_t>() + n * num_filter * col_cols;
+    for (int64_t f = 0; f < num_filter; ++f) {
+      std::fill(out + f * col_cols, out + (f + 1) * col_cols, bias[f]);
+    }
+    // (num_filter, col_rows) weight times (col_rows, col_cols) columns
+    QuantizedGemm(wptr, col.dptr_, out, num_filter, col_cols, col_rows);
+  }
+  *outputs[1].dptr<float>() = -out_unit * MaxValue<int32_t>();
+  *outputs[2].dptr<float>() = out_unit * MaxValue<int32_t>();
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_conv)
+.describe(R"code(Convolution operator for int8 input data, weight and bias,
+which accumulates in int32 and outputs int32 data with its range. The inputs
+are quantized symmetrically, see `quantize` with `out_type` int8. The
+parameters are those of `Convolution`; only 2D convolution in NCHW layout
+with one group is supported.
+)code" ADD_FILELINE)
+.set_num_inputs(
+  [](const NodeAttrs& attrs) {
+    const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+    return param.no_bias ? 6 : 9;
+  })
+.set_num_outputs(3)
+.set_attr_parser(QuantizedConvParamParser)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+    if (param.no_bias) {
+      return QuantizedInputNames({"data", "weight"});
+    }
+    return QuantizedInputNames({"data", "weight", "bias"});
+  })
+.set_attr<nnvm::FListOutputNames>("FListOutputNames",
+  [](const NodeAttrs& attrs) {
+    return std::vector<std::string>{"output", "min_output", "max_output"};
+  })
+.set_attr<nnvm::FInferShape>("FInferShape", QuantizedConvShape)
+.set_attr<nnvm::FInferType>("FInferType", QuantizedConvType)
+.set_attr<FResourceRequest>("FResourceRequest",
+  [](const NodeAttrs& attrs) {
+    return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+  })
+.set_attr<FCompute>("FCompute<cpu>", QuantizedConvForwardCPU)
+.add_argument("data", "NDArray-or-Symbol", "Input data.")
+.add_argument("weight", "NDArray-or-Symbol", "weight.")
+.add_argument("bias", "NDArray-or-Symbol", "bias.")
+.add_argument("min_data", "NDArray-or-Symbol", "Minimum value of data.")
+.add_argument("max_data", "NDArray-or-Symbol", "Maximum value of data.")
+.add_argument("min_weight", "NDArray-or-Symbol", "Minimum value of weight.")
+.add_argument("max_weight", "NDArray-or-Symbol", "Maximum value of weight.")
+.add_argument("min_bias", "NDArray-or-Symbol", "Minimum value of bias.")
+.add_argument("max_bias", "NDArray-or-Symbol", "Maximum value of bias.")
+.add_arguments(ConvolutionParam::__FIELDS__());
+
+NNVM_REGISTER_OP(Convolution)
+.set_attr<FQuantizedOp>("FQuantizedOp", [](const NodeAttrs& attrs) {
+    ConvolutionParam param;
+    param.Init(attrs.dict);
+    const bool supported = param.kernel.ndim() == 2 && param.num_group == 1 &&
+        (!param.layout.has_value() || param.layout.value() == mshadow::kNCHW);
+    return supported ? CreateQuantizedNode("_contrib_quantized_conv", attrs) : nullptr;
+  })
+.set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) {
+    return true;
+  });
+
+}  // namespace op
+}  // namespace mxnet
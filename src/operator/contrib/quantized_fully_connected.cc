@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file quantized_fully_connected.cc
+ * \brief int8 fully connected operator with int32 accumulation
+ */
+#include <algorithm>
+#include <vector>
+#include "../fully_connected-inl.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+inline bool QuantizedFullyConnectedShape(const nnvm::NodeAttrs& attrs,
+                                         std::vector<TShape> *in_shape,
+                                         std::vector<TShape> *out_shape) {
+  const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
+  const size_t num_inputs = param.no_bias ? 2 : 3;
+  CHECK_EQ(in_shape->size(), 3 * num_inputs);
+  CHECK_EQ(out_shape->size(), 3U);
+  const TShape& dshape = in_shape->at(0);
+  if (dshape.ndim() == 0) return false;
+  const index_t num_input = param.flatten ? dshape.ProdShape(1, dshape.ndim())
+                                          : dshape[dshape.ndim() - 1];
+  SHAPE_ASSIGN_CHECK(*in_shape, 1, mshadow::Shape2(param.num_hidden, num_input));
+  if (!param.no_bias) {
+    SHAPE_ASSIGN_CHECK(*in_shape, 2, mshadow::Shape1(param.num_hidden));
+  }
+  for (size_t i = num_inputs; i < 3 * num_inputs; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_shape, i, TShape{1});
+  }
+  TShape oshape = dshape;
+  if (param.flatten) {
+    oshape = mshadow::Shape2(dshape[0], param.num_hidden);
+  } else {
+    oshape[dshape.ndim() - 1] = param.num_hidden;
+  }
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, oshape);
+  SHAPE_ASSIGN_CHECK(*out_shape, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_shape, 2, TShape{1});
+  return true;
+}
+
+inline bool QuantizedFullyConnectedType(const nnvm::NodeAttrs& attrs,
+                                        std::vector<int> *in_type,
+                                        std::vector<int> *out_type) {
+  const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
+  return QuantizedOpType(param.no_bias ? 2 : 3, mshadow::kInt32, in_type, out_type);
+}
+
+void QuantizedFullyConnectedForwardCPU(const nnvm::NodeAttrs& attrs,
+                                       const OpContext& ctx,
+                                       const std::vector<TBlob>& inputs,
+                                       const std::vector<OpReqType>& req,
+                                       const std::vector<TBlob>& outputs) {
+  const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
+  const size_t num_inputs = param.no_bias ? 2 : 3;
+  CHECK_EQ(req[0], kWriteTo) << "QuantizedFullyConnected only supports req = kWriteTo";
+  const TBlob& data = inputs[0];
+  const TBlob& weight = inputs[1];
+  const int64_t m = param.num_hidden;
+  const int64_t k = weight.shape_[1];
+  const int64_t n = data.Size() / k;
+  auto range = [&inputs, num_inputs](size_t i) {
+    return QuantizedUnit<int8_t>(*inputs[num_inputs + 2 * i].dptr<float>(),
+                                 *inputs[num_inputs + 2 * i + 1].dptr<float>());
+  };
+  // one unit of the int32 output is one unit of data times one unit of weight
+  const float out_unit = range(0) * range(1);
+  std::vector<int32_t> bias(m, 0);
+  if (!param.no_bias) {
+    const double ratio = out_unit > 0.0f ? static_cast<double>(range(2)) / out_unit : 0.0;
+    const int8_t *bptr = inputs[2].dptr<int8_t>();
+    for (int64_t j = 0; j < m; ++j) bias[j] = SaturateInt32(bptr[j] * ratio);
+  }
+  // the weight is transposed to (k, m) so the output is data times it
+  mshadow::Tensor<cpu, 1, int8_t> wt = ctx.requested[0].get_space_typed<cpu, 1, int8_t>(
+      mshadow::Shape1(k * m), ctx.get_stream<cpu>());
+  const int8_t *wptr = weight.dptr<int8_t>();
+  for (int64_t j = 0; j < m; ++j) {
+    for (int64_t l = 0; l < k; ++l) {
+      wt.dptr_[l * m + j] = wptr[j * k + l];
+    }
+  }
+  int32_t *out = outputs[0].dptr<int32_t>();
+  for (int64_t i = 0; i < n; ++i) {
+    std::copy(bias.begin(), bias.end(), out + i * m);
+  }
+  QuantizedGemm(data.dptr<int8_t>(), wt.dptr_, out, n, m, k);
+  *outputs[1].dptr<float>() = -out_unit * MaxValue<int32_t>();
+  *outputs[2].dptr<float>() = out_unit * MaxValue<int32_t>();
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_fully_connected)
+.describe(R"code(Fully Connected operator for int8 input data, weight and bias,
+which accumulates in int32 and outputs int32 data with its range. The inputs
+are quantized symmetrically, see `quantize` with `out_type` int8. The
+parameters are those of `FullyConnected`.
+)code" ADD_FILELINE)
+.set_num_inputs(
+  [](const NodeAttrs& attrs) {
+    const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
+    return param.no_bias ? 6 : 9;
+  })
+.set_num_outputs(3)
+.set_attr_parser(ParamParser<FullyConnectedParam>)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    const FullyConnectedParam& param = nnvm::get<FullyConnectedParam>(attrs.parsed);
+    if (param.no_bias) {
+      return QuantizedInputNames({"data", "weight"});
+    }
+    return QuantizedInputNames({"data", "weight", "bias"});
+  })
+.set_attr<nnvm::FListOutputNames>("FListOutputNames",
+  [](const NodeAttrs& attrs) {
+    return std::vector<std::string>{"output", "min_output", "max_output"};
+  })
+.set_attr<nnvm::FInferShape>("FInferShape", QuantizedFullyConnectedShape)
+.set_attr<nnvm::FInferType>("FInferType", QuantizedFullyConnectedType)
+.set_attr<FResourceRequest>("FResourceRequest",
+  [](const NodeAttrs& attrs) {
+    return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+  })
+.set_attr<FCompute>("FCompute<cpu>", QuantizedFullyConnectedForwardCPU)
+.add_argument("data", "NDArray-or-Symbol", "Input data.")
+.add_argument("weight", "NDArray-or-Symbol", "weight.")
+.add_argument("bias", "NDArray-or-Symbol", "bias.")
+.add_argument("min_data", "NDArray-or-Symbol", "Minimum value of data.")
+.add_argument("max_data", "NDArray-or-Symbol", "Maximum value of data.")
+.add_argument("min_weight", "NDArray-or-Symbol", "Minimum value of weight.")
+.add_argument("max_weight", "NDArray-or-Symbol", "Maximum value of weight.")
+.add_argument("min_bias", "NDArray-or-Symbol", "Minimum value of bias.")
+.add_argument("max_bias", "NDArray-or-Symbol", "Maximum value of bias.")
+.add_arguments(FullyConnectedParam::__FIELDS__());
+
+NNVM_REGISTER_OP(FullyConnected)
+.set_attr<FQuantizedOp>("FQuantizedOp", [](const NodeAttrs& attrs) {
+    return CreateQuantizedNode("_contrib_quantized_fully_connected", attrs);
+  })
+.set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) {
+    return true;
+  });
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file quantized_pooling.cc
+ * \brief int8 2D max and average pooling operator
+ */
+#include <algorithm>
+#include <vector>
+#include "../pooling-inl.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief parse PoolingParam and fill in the defaults of a 2D pooling */
+inline void QuantizedPoolingParamParser(nnvm::NodeAttrs* attrs) {
+  PoolingParam param;
+  param.Init(attrs->dict);
+  CHECK_EQ(param.kernel.ndim(), 2U) << "QuantizedPooling only supports 2D pooling";
+  if (param.stride.ndim() == 0) param.stride = mshadow::Shape2(1, 1);
+  if (param.pad.ndim() == 0) param.pad = mshadow::Shape2(0, 0);
+  attrs->parsed = std::move(param);
+}
+
+inline bool QuantizedPoolingShape(const nnvm::NodeAttrs& attrs,
+                                  std::vector<TShape> *in_shape,
+                                  std::vector<TShape> *out_shape) {
+  const PoolingParam& param = nnvm::get<PoolingParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 3U);
+  CHECK_EQ(out_shape->size(), 3U);
+  const TShape& dshape = in_shape->at(0);
+  if (dshape.ndim() == 0) return false;
+  CHECK_EQ(dshape.ndim(), 4U) << "QuantizedPooling only supports NCHW input";
+  SHAPE_ASSIGN_CHECK(*in_shape, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*in_shape, 2, TShape{1});
+  TShape oshape = dshape;
+  for (int i = 0; i < 2; ++i) {
+    if (param.global_pool) {
+      oshape[i + 2] = 1;
+      continue;
+    }
+    CHECK_LE(param.kernel[i], dshape[i + 2] + 2 * param.pad[i]) << "kernel size exceeds input";
+    const index_t extent = dshape[i + 2] + 2 * param.pad[i] - param.kernel[i];
+    if (param.pooling_convention == pool_enum::kValid) {
+      oshape[i + 2] = 1 + extent / param.stride[i];
+    } else {
+      oshape[i + 2] = 1 + (extent + param.stride[i] - 1) / param.stride[i];
+    }
+  }
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, oshape);
+  SHAPE_ASSIGN_CHECK(*out_shape, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_shape, 2, TShape{1});
+  return true;
+}
+
+inline bool QuantizedPoolingType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int> *in_type,
+                                 std::vector<int> *out_type) {
+  return QuantizedOpType(1, mshadow::kInt8, in_type, out_type);
+}
+
+void QuantizedPoolingForwardCPU(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  const PoolingParam& param = nnvm::get<PoolingParam>(attrs.parsed);
+  CHECK_EQ(req[0], kWriteTo) << "QuantizedPooling only supports req = kWriteTo";
+  const TShape& dshape = inputs[0].shape_;
+  const TShape& oshape = outputs[0].shape_;
+  const int height = dshape[2], width = dshape[3];
+  const int out_height = oshape[2], out_width = oshape[3];
+  const int kernel_h = param.global_pool ? height : param.kernel[0];
+  const int kernel_w = param.global_pool ? width : param.kernel[1];
+  const int pad_h = param.global_pool ? 0 : param.pad[0];
+  const int pad_w = param.global_pool ? 0 : param.pad[1];
+  const int stride_h = param.global_pool ? 1 : param.stride[0];
+  const int stride_w = param.global_pool ? 1 : param.stride[1];
+  const bool max_pool = param.pool_type == pool_enum::kMaxPooling;
+  const bool avg_pool = param.pool_type == pool_enum::kAvgPooling;
+  CHECK(max_pool || avg_pool) << "QuantizedPooling only supports max and average pooling";
+  const int8_t *in = inputs[0].dptr<int8_t>();
+  int8_t *out = outputs[0].dptr<int8_t>();
+  const int64_t planes = static_cast<int64_t>(dshape[0]) * dshape[1];
+  #pragma omp parallel for
+  for (int64_t c = 0; c < planes; ++c) {
+    const int8_t *in_plane = in + c * height * width;
+    int8_t *out_plane = out + c * out_height * out_width;
+    for (int ph = 0; ph < out_height; ++ph) {
+      for (int pw = 0; pw < out_width; ++pw) {
+        int hstart = ph * stride_h - pad_h;
+        int wstart = pw * stride_w - pad_w;
+        int hend = std::min(hstart + kernel_h, height + pad_h);
+        int wend = std::min(wstart + kernel_w, width + pad_w);
+        // average pooling counts the padding, like the float operator
+        const int pool_size = (hend - hstart) * (wend - wstart);
+        hstart = std::max(hstart, 0);
+        wstart = std::max(wstart, 0);
+        hend = std::min(hend, height);
+        wend = std::min(wend, width);
+        int32_t acc = max_pool ? -128 : 0;
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            const int32_t v = in_plane[h * width + w];
+            acc = max_pool ? std::max(acc, v) : acc + v;
+          }
+        }
+        if (avg_pool) {
+          out_plane[ph * out_width + pw] = SaturateCast<int8_t>(
+              static_cast<float>(acc) / pool_size);
+        } else {
+          out_plane[ph * out_width + pw] = SaturateCast<int8_t>(static_cast<float>(acc));
+        }
+      }
+    }
+  }
+  // pooling does not change the range
+  *outputs[1].dptr<float>() = *inputs[1].dptr<float>();
+  *outputs[2].dptr<float>() = *inputs[2].dptr<float>();
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_pooling)
+.describe(R"code(Pooling operator for int8 input data. The output has the range
+of the input. The parameters are those of `Pooling`; only 2D max and average
+pooling in NCHW layout are supported.
+)code" ADD_FILELINE)
+.set_num_inputs(3)
+.set_num_outputs(3)
+.set_attr_parser(QuantizedPoolingParamParser)
+.set_attr<nnvm::FListInputNames>("FListInputNames",
+  [](const NodeAttrs& attrs) {
+    return QuantizedInputNames({"data"});
+  })
+.set_attr<nnvm::FListOutputNames>("FListOutputNames",
+  [](const NodeAttrs& attrs) {
+    return std::vector<std::string>{"output", "min_output", "max_output"};
+  })
+.set_attr<nnvm::FInferShape>("FInferShape", QuantizedPoolingShape)
+.set_attr<nnvm::FInferType>("FInferType", QuantizedPoolingType)
+.set_attr<FCompute>("FCompute<cpu>", QuantizedPoolingForwardCPU)
+.add_argument("data", "NDArray-or-Symbol", "Input data.")
+.add_argument("min_data", "NDArray-or-Symbol", "Minimum value of data.")
+.add_argument("max_data", "NDArray-or-Symbol", "Maximum value of data.")
+.add_arguments(PoolingParam::__FIELDS__());
+
+NNVM_REGISTER_OP(Pooling)
+.set_attr<FQuantizedOp>("FQuantizedOp", [](const NodeAttrs& attrs) {
+    PoolingParam param;
+    param.Init(attrs.dict);
+    const bool supported = param.kernel.ndim() == 2 &&
+        (param.pool_type == pool_enum::kMaxPooling || param.pool_type == pool_enum::kAvgPooling);
+    return supported ? CreateQuantizedNode("_contrib_quantized_pooling", attrs) : nullptr;
+  })
+.set_attr<FNeedRequantize>("FNeedRequantize", [](const NodeAttrs& attrs) {
+    return false;
+  });
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file requantize-inl.h
+ * \brief convert the int32 output of a quantized operator to int8
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_REQUANTIZE_INL_H_
+#define MXNET_OPERATOR_CONTRIB_REQUANTIZE_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <dmlc/optional.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "../elemwise_op_common.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+struct RequantizeParam : public dmlc::Parameter<RequantizeParam> {
+  dmlc::optional<float> min_calib_range;
+  dmlc::optional<float> max_calib_range;
+  DMLC_DECLARE_PARAMETER(RequantizeParam) {
+    DMLC_DECLARE_FIELD(min_calib_range)
+    .set_default(dmlc::optional<float>())
+    .describe("The minimum scalar value in the form of float32 obtained "
+              "through calibration. If present, it will be used to requantize the "
+              "int32 data into int8.");
+    DMLC_DECLARE_FIELD(max_calib_range)
+    .set_default(dmlc::optional<float>())
+    .describe("The maximum scalar value in the form of float32 obtained "
+              "through calibration. If present, it will be used to requantize the "
+              "int32 data into int8.");
+  }
+};
+
+struct requantize {
+  MSHADOW_XINLINE static void Map(int i, int8_t *out, const int32_t *in, float scale) {
+    out[i] = SaturateCast<int8_t>(in[i] * scale);
+  }
+};
+
+/*! \brief the largest absolute value of the size values in data, scanned in parallel */
+inline int32_t MaxAbsInt32(const int32_t *data, const int64_t size) {
+  const int omp_threads = std::max(Engine::Get()->num_omp_threads_per_worker(), 1);
+  const int64_t chunk = (size + omp_threads - 1) / omp_threads;
+  std::vector<int32_t> max_abs(omp_threads, 0);
+  #pragma omp parallel for num_threads(omp_threads)
+  for (int t = 0; t < omp_threads; ++t) {
+    const int64_t end = std::min(size, (t + 1) * chunk);
+    int32_t ret = 0;
+    for (int64_t i = t * chunk; i < end; ++i) {
+      ret = std::max(ret, std::abs(data[i]));
+    }
+    max_abs[t] = ret;
+  }
+  return *std::max_element(max_abs.begin(), max_abs.end());
+}
+
+inline void RequantizeForwardCPU(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  Stream<cpu> *s = ctx.get_stream<cpu>();
+  const RequantizeParam& param = nnvm::get<RequantizeParam>(attrs.parsed);
+  const int32_t *in = inputs[0].dptr<int32_t>();
+  const int64_t size = inputs[0].Size();
+  const float in_unit = QuantizedUnit<int32_t>(*inputs[1].dptr<float>(),
+                                               *inputs[2].dptr<float>());
+  float out_range;
+  if (param.min_calib_range.has_value() && param.max_calib_range.has_value()) {
+    out_range = MaxAbs(param.min_calib_range.value(), param.max_calib_range.value());
+  } else {
+    // no calibration, use the actual range of the data
+    out_range = MaxAbsInt32(in, size) * in_unit;
+  }
+  const float scale = out_range > 0.0f ? in_unit * MaxValue<int8_t>() / out_range : 0.0f;
+  Kernel<requantize, cpu>::Launch(s, size, outputs[0].dptr<int8_t>(), in, scale);
+  *outputs[1].dptr<float>() = -out_range;
+  *outputs[2].dptr<float>() = out_range;
+}
+
+inline bool RequantizeShape(const nnvm::NodeAttrs& attrs,
+                            std::vector<TShape> *in_attrs,
+                            std::vector<TShape> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*in_attrs, 2, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_attrs, 2, TShape{1});
+  return !shape_is_none(in_attrs->at(0));
+}
+
+inline bool RequantizeType(const nnvm::NodeAttrs& attrs,
+                           std::vector<int> *in_attrs,
+                           std::vector<int> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 2, mshadow::kFloat32);
+  return true;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_REQUANTIZE_INL_H_
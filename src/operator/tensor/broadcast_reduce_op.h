@@ -467,7 +467,8 @@ template <int req>
  * an index that is equal to the first column or close to the first column,
  * it does a linear search for the rest of the indices and adds their data
  * to the intermediate sum. At the end of iteration through all
- * rows we have the sum along the axis for the subset of columns.
+ * rows we have the sum along the axis for the subset of columns,
+ * which is divided by norm before it is assigned to the output.
  */
 struct SumCsrKernel<req, 0> {
   template <typename RType, typename IType, typename DType>
@@ -478,7 +479,8 @@ struct SumCsrKernel<req, 0> {
                                   DType* residual,
                                   RType num_rows,
                                   IType num_cols,
-                                  const nnvm::dim_t seg_len) {
+                                  const nnvm::dim_t seg_len,
+                                  const DType norm) {
     const IType seg_start = j * seg_len;
     if (seg_start >= num_cols) return;
     const IType seg_end = std::min(seg_start + seg_len, num_cols);
@@ -546,7 +548,7 @@ struct SumCsrKernel<req, 0> {
     }
 
     for (IType col = seg_start; col < seg_end; col++) {
-        KERNEL_ASSIGN(out_data[col], req, sum[col]);
+        KERNEL_ASSIGN(out_data[col], req, sum[col] / norm);
     }
   }
 };
@@ -556,17 +558,18 @@ struct SumCsrKernel<req, 1> {
   template <typename RType, typename DType>
   MSHADOW_XINLINE static void Map(int i, DType* out_data,
                                   const RType* in_indptr,
-                                  const DType* in_data) {
+                                  const DType* in_data,
+                                  const DType norm) {
     DType sum, residual;
     mshadow::red::sum::SetInitValue(sum, residual);
     for (RType k = in_indptr[i]; k < in_indptr[i + 1]; k++) {
       mshadow::red::sum::Reduce(sum, in_data[k], residual);
     }
-    KERNEL_ASSIGN(out_data[i], req, sum);
+    KERNEL_ASSIGN(out_data[i], req, sum / norm);
   }
 };
 
-template <typename xpu>
+template <typename xpu, bool normalize = false>
 void SumCsrImpl(const nnvm::NodeAttrs& attrs, mshadow::Stream<xpu>* s, const OpContext& ctx,
                 const NDArray& input, const OpReqType req, NDArray* output) {
   if (req == kNullOp) return;
@@ -629,7 +632,7 @@ void SumCsrImpl(const nnvm::NodeAttrs& attrs, mshadow::Stream<xpu>* s, const OpC
             Kernel<SumCsrKernel<req_type, 0>, xpu>::Launch(
                 s, num_threads, output->data().dptr<DType>(), in_indptr, in_idx,
                 in_data, sum.dptr_, residual.dptr_, num_rows, num_cols,
-                seg_len);
+                seg_len, DType(normalize ? num_rows : 1));
           });
         });
       });
@@ -642,7 +645,7 @@ void SumCsrImpl(const nnvm::NodeAttrs& attrs, mshadow::Stream<xpu>* s, const OpC
           const DType* in_data = input.data().dptr<DType>();
           Kernel<SumCsrKernel<req_type, 1>, xpu>::Launch(
               s, out_data_size, output->data().dptr<DType>(), in_indptr,
-              in_data);
+              in_data, DType(normalize ? input.shape()[1] : 1));
         });
       });
     });
@@ -663,7 +666,7 @@ void SumOpForwardEx(const nnvm::NodeAttrs& attrs, const OpContext& ctx,
     CHECK_EQ(inputs[0].shape().ndim(), 2U)
         << "sum(csr) op only supports 2D ndarray as input";
     NDArray output = outputs[0];
-    SumCsrImpl(attrs, s, ctx, inputs[0], req[0], &output);
+    SumCsrImpl<xpu, normalize>(attrs, s, ctx, inputs[0], req[0], &output);
   } else {
     LOG(FATAL) << "Not implemented: "
                << operator_string(attrs, ctx, inputs, req, outputs);
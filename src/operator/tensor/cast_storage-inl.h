@@ -26,6 +26,7 @@
 
 #include <dmlc/timer.h>
 #include <mxnet/ndarray.h>
+#include <cstring>
 #include <vector>
 #include "../mxnet_op.h"
 #include "../operator_common.h"
@@ -37,6 +38,38 @@
 namespace mxnet {
 namespace op {
 
+/*!
+ * \brief whether dns[0, n) has a nonzero element. The row is tested in blocks
+ * without branches, so that the comparisons of a block vectorize, and the scan
+ * stops at the first block with a nonzero element.
+ */
+template<typename DType>
+MSHADOW_XINLINE bool HasNonZero(const DType* dns, const nnvm::dim_t n) {
+  using nnvm::dim_t;
+  const dim_t kBlock = 32;
+  dim_t j = 0;
+  for (; j + kBlock <= n; j += kBlock) {
+    bool nonzero = false;
+    for (dim_t k = 0; k < kBlock; ++k) nonzero |= (dns[j+k] != 0);
+    if (nonzero) return true;
+  }
+  for (; j < n; ++j) {
+    if (dns[j] != 0) return true;
+  }
+  return false;
+}
+
+/*!
+ * \brief number of nonzero elements in dns[0, n), counted without branches so
+ * that the loop vectorizes
+ */
+template<typename DType>
+MSHADOW_XINLINE nnvm::dim_t CountNonZero(const DType* dns, const nnvm::dim_t n) {
+  nnvm::dim_t count = 0;
+  for (nnvm::dim_t j = 0; j < n; ++j) count += (dns[j] != 0);
+  return count;
+}
+
 /*!
  * \brief CPU Kernel for marking row_idx of a RSP tensor per row.
  */
@@ -47,24 +80,43 @@ struct MarkRspRowIdx {
                                   RType* row_idx,
                                   const DType* data,
                                   const nnvm::dim_t row_length) {
+    // mark as one for non-zero row and zero for zero row
+    row_idx[i] = HasNonZero(data + i * row_length, row_length) ? 1 : 0;
+  }
+};
+
+/*!
+ * \brief CPU Kernel for copying the nonzero rows of a dns tensor to a RSP tensor.
+ */
+struct FillRspRowIdxAndData {
+  /*!
+   * \brief
+   * \param i           the i-th row of the dns tensor
+   * \param row_idx     row idx array of the rsp tensor
+   * \param rsp_data    data array of the rsp tensor
+   * \param row_pos     exclusive prefix sum of the nonzero row marks
+   * \param dns         the dns tensor
+   * \param row_length  number of elements per row
+   */
+  template<typename DType, typename RType>
+  MSHADOW_CINLINE static void Map(int i,
+                                  RType* row_idx,
+                                  DType* rsp_data,
+                                  const nnvm::dim_t* row_pos,
+                                  const DType* dns,
+                                  const nnvm::dim_t row_length) {
     using nnvm::dim_t;
-    dim_t j = 0;
-    dim_t offset = i * row_length;
-    for (; j < row_length; ++j) {
-      if (data[offset+j] != 0) {
-        break;
-      }
-    }
-    if (row_length == j) {
-      row_idx[i] = 0;  // mark as zero for zero row
-    } else {
-      row_idx[i] = 1;  // mark as one for non-zero row
-    }
+    const dim_t pos = row_pos[i];
+    if (row_pos[i+1] == pos) return;
+    row_idx[pos] = i;
+    std::memcpy(rsp_data + pos * row_length, dns + i * row_length, row_length * sizeof(DType));
   }
 };
 
 /*!
  * \brief CPU implementation of casting a dns tensor to rsp type.
+ * The nonzero rows are marked, their positions in rsp are computed by a parallel
+ * prefix sum and then they are copied in parallel.
  */
 inline void CastStorageDnsRspImpl(const OpContext& ctx,
                                   const cpu& cpu_dev,
@@ -87,23 +139,23 @@ inline void CastStorageDnsRspImpl(const OpContext& ctx,
       dim_t num_threads = num_rows;
       mxnet_op::Kernel<MarkRspRowIdx, cpu>::Launch(s, num_threads,
           row_idx, dns.dptr<DType>(), row_length);
-      dim_t nnr = 0;
-      nnr = common::ParallelAccumulate(row_idx, num_rows, nnr);
+      // row_pos[i] is the position of row i in rsp, row_pos[num_rows] the number of
+      // nonzero rows
+      std::vector<dim_t> row_pos(num_rows + 1);
+      #pragma omp parallel for
+      for (dim_t i = 0; i < num_rows; ++i) {
+        row_pos[i] = row_idx[i];
+      }
+      row_pos[num_rows] = 0;
+      common::ParallelExclusiveScan(row_pos.data(), num_rows + 1);
+      const dim_t nnr = row_pos[num_rows];
       rsp->set_aux_shape(kIdx, Shape1(nnr));
       if (0 == nnr) return;
       auto storage_shape = dns.shape_;
       storage_shape[0] = nnr;
       rsp->CheckAndAllocData(storage_shape);
-      auto dns_data = dns.get_with_shape<cpu, 2, DType>(Shape2(num_rows, row_length), s);
-      auto rsp_data = rsp->data().get_with_shape<cpu, 2, DType>(Shape2(nnr, row_length), s);
-      dim_t idx = 0;
-      for (dim_t i = 0; i < num_rows; ++i) {
-        if (row_idx[i] > 0) {
-          row_idx[idx] = i;
-          Copy(rsp_data[idx], dns_data[i], s);
-          ++idx;
-        }
-      }
+      mxnet_op::Kernel<FillRspRowIdxAndData, cpu>::Launch(s, num_threads,
+          row_idx, rsp->data().dptr<DType>(), row_pos.data(), dns.dptr<DType>(), row_length);
     });
   });
 }
@@ -158,13 +210,13 @@ void CastStorageRspDnsImpl(const OpContext& ctx,
 }
 
 /*!
- * \brief CPU kernel for initializing the indptr in a csr matrix.
+ * \brief CPU kernel for counting the nonzero elements per row of a dns matrix.
  */
 struct FillCsrIndPtr {
   /*!
    * \brief
    * \param i         the i-th row of the dns tensor
-   * \param indptr    the indptr of the csr tensor
+   * \param indptr    the indptr of the csr tensor, indptr[i] is set to the nnz of row i
    * \param dns       the dns tensor
    * \param num_rows  number of rows of the dns tensor
    * \param num_cols  number of columns of the dns tensor
@@ -175,14 +227,7 @@ struct FillCsrIndPtr {
                                   const DType* dns,
                                   const nnvm::dim_t num_rows,
                                   const nnvm::dim_t num_cols) {
-    using nnvm::dim_t;
-    indptr[i+1] = 0;
-    const dim_t offset = i * num_cols;
-    for (dim_t j = 0; j < num_cols; ++j) {
-      if (dns[offset+j] != 0) {
-        ++indptr[i+1];
-      }
-    }
+    indptr[i] = static_cast<IType>(CountNonZero(dns + i * num_cols, num_cols));
   }
 };
 
@@ -223,6 +268,8 @@ struct FillCsrColIdxAndVals {
 
 /*!
  * \brief CPU implementation of casting a dns matrix to csr type.
+ * The nonzeros are counted per row in parallel, turned into indptr by a parallel
+ * prefix sum, and the column indices and values are filled per row in parallel.
  */
 inline void CastStorageDnsCsrImpl(const OpContext& ctx,
                                   const cpu& cpu_dev,
@@ -246,12 +293,10 @@ inline void CastStorageDnsCsrImpl(const OpContext& ctx,
         dim_t num_threads = num_rows;
         mxnet_op::Kernel<FillCsrIndPtr, cpu>::Launch(s, num_threads,
             indptr, dns_data, num_rows, num_cols);
-        // single thread to accumulate indptr
+        // turn the row counts into row offsets,
         // indptr[num_rows] indicates the number of non-zero elements
-        indptr[0] = 0;
-        for (dim_t i = 0; i < num_rows; ++i) {
-          indptr[i+1] += indptr[i];
-        }
+        indptr[num_rows] = 0;
+        common::ParallelExclusiveScan(indptr, num_rows + 1);
         // allocate column idx array and value array
         csr->CheckAndAllocAuxData(csr::kIdx, Shape1(static_cast<index_t>(indptr[num_rows])));
         csr->CheckAndAllocData(Shape1(static_cast<index_t>(indptr[num_rows])));
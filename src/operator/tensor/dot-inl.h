@@ -284,14 +284,83 @@ inline bool DotBackwardInferStorageType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+/*!
+ * \brief out[0, num_cols) += sum of data[k] * data_r[idx[k], :] over k in [begin, end).
+ * kDotColBlock output columns are accumulated in registers over all the
+ * nonzeros of the row, so out is loaded and stored once per row and block
+ * instead of once per nonzero, and the rows of data_r are read in
+ * cache-line sized pieces.
+ */
+const int kDotColBlock = 8;
+template<typename DType, typename IType, typename CType>
+MSHADOW_CINLINE void DotSparseRowDns(DType* out, const DType* data, const CType* idx,
+                                     const IType begin, const IType end,
+                                     const DType* data_r, const nnvm::dim_t num_cols) {
+  using nnvm::dim_t;
+  for (dim_t l = 0; l < num_cols; l += kDotColBlock) {
+    DType acc[kDotColBlock] = {0};
+    const dim_t width = std::min(static_cast<dim_t>(kDotColBlock), num_cols - l);
+    if (width == kDotColBlock) {
+      for (IType k = begin; k < end; ++k) {
+        const DType val = data[k];
+        const DType* row_r = data_r + idx[k] * num_cols + l;
+        for (int b = 0; b < kDotColBlock; ++b) acc[b] += row_r[b] * val;
+      }
+    } else {
+      for (IType k = begin; k < end; ++k) {
+        const DType val = data[k];
+        const DType* row_r = data_r + idx[k] * num_cols + l;
+        for (dim_t b = 0; b < width; ++b) acc[b] += row_r[b] * val;
+      }
+    }
+    for (dim_t b = 0; b < width; ++b) out[l+b] += acc[b];
+  }
+}
+
+/*!
+ * \brief split the rows [0, num_rows) into num_threads contiguous ranges of
+ * about the same cost, where a row costs its number of nonzeros plus one.
+ * Row j starts at indptr[row_map[j]], or at indptr[j] if row_map is nullptr;
+ * row_map must be increasing and skip only empty rows of indptr.
+ * \param nnz total number of nonzeros
+ * \param bounds num_threads + 1 row boundaries
+ */
+template<typename IType, typename RType>
+inline void BalanceRowsByNnz(const IType* indptr, const RType* row_map,
+                             const nnvm::dim_t num_rows, const nnvm::dim_t nnz,
+                             const nnvm::dim_t num_threads, nnvm::dim_t* bounds) {
+  using nnvm::dim_t;
+  auto cost = [&](dim_t j) -> dim_t {
+    if (j >= num_rows) return nnz + num_rows;
+    return static_cast<dim_t>(indptr[row_map == nullptr ? j : row_map[j]]) + j;
+  };
+  const dim_t total = nnz + num_rows;
+  bounds[0] = 0;
+  for (dim_t t = 1; t < num_threads; ++t) {
+    const dim_t target = total / num_threads * t + total % num_threads * t / num_threads;
+    dim_t lo = bounds[t-1], hi = num_rows;
+    while (lo < hi) {
+      const dim_t mid = lo + (hi - lo) / 2;
+      if (cost(mid) < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    bounds[t] = lo;
+  }
+  bounds[num_threads] = num_rows;
+}
+
 /*!
  * \brief CPU Kernel of dot(csr, dns1) = dns2
- * Parallelization by row blocks
+ * Parallelization by row blocks of about the same number of nonzeros
  */
 struct DotCsrDnsDnsByRowBlocks {
   /*!
    * \brief
    * \param i the i-th thread
+   * \param row_bounds rows [row_bounds[i], row_bounds[i+1]) are computed by the i-th thread
    */
   template<typename DType, typename IType, typename CType>
   MSHADOW_CINLINE static void Map(int i,
@@ -300,23 +369,13 @@ struct DotCsrDnsDnsByRowBlocks {
                                   const IType* indptr_l,
                                   const CType* col_idx_l,
                                   const DType* data_r,
-                                  const nnvm::dim_t seg_len,
-                                  const nnvm::dim_t num_rows,
+                                  const nnvm::dim_t* row_bounds,
                                   const nnvm::dim_t num_cols) {
     using nnvm::dim_t;
-    const dim_t seg_start = i * seg_len;
-    if (seg_start >= num_rows) return;
-    const dim_t seg_end = std::min(seg_start + seg_len, num_rows);
-    for (dim_t j = seg_start; j < seg_end; ++j) {
+    for (dim_t j = row_bounds[i]; j < row_bounds[i+1]; ++j) {
       if (indptr_l[j] == indptr_l[j+1]) continue;
-      const dim_t offset_out = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j+1]; ++k) {
-        const DType val = data_l[k];
-        const dim_t offset_r = col_idx_l[k] * num_cols;
-        for (dim_t l = 0; l < num_cols; ++l) {
-          out[offset_out+l] += data_r[offset_r+l] * val;
-        }
-      }
+      DotSparseRowDns(out + j * num_cols, data_l, col_idx_l, indptr_l[j], indptr_l[j+1],
+                      data_r, num_cols);
     }
   }
 };
@@ -523,6 +582,119 @@ struct DotCsrTransRspRspByRowBlocks {
   }
 };
 
+/*!
+ * \brief CPU Kernel of dot(csr.T(), dns1) = dns2 or rsp, computed from the csc
+ * view of the csr matrix, so that each output row only reads its own column.
+ * Parallelization by row blocks of about the same number of nonzeros
+ */
+struct DotCscDnsByRowBlocks {
+  /*!
+   * \brief
+   * \param i the i-th thread
+   * \param row_idx_out column of lhs computed by every output row, nullptr for all columns
+   * \param row_bounds rows [row_bounds[i], row_bounds[i+1]) are computed by the i-th thread
+   */
+  template<typename DType, typename IType, typename CType, typename RType>
+  MSHADOW_CINLINE static void Map(int i,
+                                  DType* out,
+                                  const RType* row_idx_out,
+                                  const DType* data_l,
+                                  const IType* indptr_l,
+                                  const CType* row_idx_l,
+                                  const DType* data_r,
+                                  const nnvm::dim_t* row_bounds,
+                                  const nnvm::dim_t num_cols) {
+    using nnvm::dim_t;
+    for (dim_t j = row_bounds[i]; j < row_bounds[i+1]; ++j) {
+      const dim_t col = row_idx_out == nullptr ? j : static_cast<dim_t>(row_idx_out[j]);
+      if (indptr_l[col] == indptr_l[col+1]) continue;
+      DotSparseRowDns(out + j * num_cols, data_l, row_idx_l, indptr_l[col], indptr_l[col+1],
+                      data_r, num_cols);
+    }
+  }
+};
+
+/*!
+ * \brief build the csc view of a csr matrix with a parallel counting sort.
+ * The entries of each column are scattered with atomic cursors and then
+ * sorted by row, so the result does not depend on the thread schedule.
+ * \param csc_indptr num_cols + 1 column pointers
+ * \param csc_row_idx nnz row indices
+ * \param csc_data nnz values
+ */
+template<typename DType, typename IType, typename CType>
+inline void CsrToCscImpl(const DType* data, const IType* indptr, const CType* col_idx,
+                         const nnvm::dim_t num_rows, const nnvm::dim_t num_cols,
+                         IType* csc_indptr, IType* cursor, CType* csc_row_idx,
+                         DType* csc_data) {
+  using nnvm::dim_t;
+  const dim_t nnz = indptr[num_rows];
+  #pragma omp parallel for
+  for (dim_t c = 0; c <= num_cols; ++c) csc_indptr[c] = 0;
+  #pragma omp parallel for
+  for (dim_t k = 0; k < nnz; ++k) {
+    #pragma omp atomic
+    ++csc_indptr[col_idx[k]];
+  }
+  common::ParallelExclusiveScan(csc_indptr, num_cols + 1);
+  std::copy(csc_indptr, csc_indptr + num_cols, cursor);
+  #pragma omp parallel for
+  for (dim_t j = 0; j < num_rows; ++j) {
+    for (IType k = indptr[j]; k < indptr[j+1]; ++k) {
+      IType pos;
+      #pragma omp atomic capture
+      pos = cursor[col_idx[k]]++;
+      csc_row_idx[pos] = j;
+      csc_data[pos] = data[k];
+    }
+  }
+  #pragma omp parallel
+  {
+    std::vector<std::pair<CType, DType> > entries;
+    #pragma omp for schedule(dynamic, 256)
+    for (dim_t c = 0; c < num_cols; ++c) {
+      const IType begin = csc_indptr[c], end = csc_indptr[c+1];
+      if (std::is_sorted(csc_row_idx + begin, csc_row_idx + end)) continue;
+      entries.clear();
+      for (IType k = begin; k < end; ++k) entries.emplace_back(csc_row_idx[k], csc_data[k]);
+      std::sort(entries.begin(), entries.end(),
+                [](const std::pair<CType, DType>& a, const std::pair<CType, DType>& b) {
+                  return a.first < b.first;
+                });
+      for (IType k = begin; k < end; ++k) {
+        csc_row_idx[k] = entries[k - begin].first;
+        csc_data[k] = entries[k - begin].second;
+      }
+    }
+  }
+}
+
+/*!
+ * \brief temporary space of the csc view used by dot(csr.T, dns), aligned per array
+ */
+template<typename DType, typename IType, typename CType>
+struct CscWorkspace {
+  IType* indptr;
+  IType* cursor;
+  CType* row_idx;
+  DType* data;
+
+  static size_t Align(size_t size) { return (size + 7) / 8 * 8; }
+  static size_t Size(nnvm::dim_t nnz, nnvm::dim_t num_cols) {
+    return 2 * Align((num_cols + 1) * sizeof(IType)) + Align(nnz * sizeof(CType)) +
+           Align(nnz * sizeof(DType));
+  }
+  CscWorkspace(char* dptr, nnvm::dim_t nnz, nnvm::dim_t num_cols) {
+    indptr = reinterpret_cast<IType*>(dptr);
+    dptr += Align((num_cols + 1) * sizeof(IType));
+    cursor = reinterpret_cast<IType*>(dptr);
+    dptr += Align((num_cols + 1) * sizeof(IType));
+    row_idx = reinterpret_cast<CType*>(dptr);
+    dptr += Align(nnz * sizeof(CType));
+    data = reinterpret_cast<DType*>(dptr);
+  }
+};
+
 /*!
  * \brief CPU Impl of dot(csr, dns1) = dns2 and dot(csr.T, dns1) = dns2
  */
@@ -557,16 +729,39 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
         }
         num_threads = mxnet_op::get_num_threads<cpu>(data_out.shape_[0]);
         dim_t seg_len = (data_out.shape_[0] + num_threads - 1) / num_threads;
-        if (trans_lhs) {
+        if (trans_lhs && num_threads > 1) {
+          // every thread of the row block kernel would scan all the nonzeros,
+          // transpose once and compute out from the csc view instead
+          const dim_t nnz = data_l.Size();
+          const dim_t num_cols_l = lhs.shape()[1];
+          typedef CscWorkspace<DType, IType, CType> Workspace;
+          mshadow::Tensor<cpu, 1, char> workspace = ctx.requested[0]
+              .get_space_typed<cpu, 1, char>(mshadow::Shape1(Workspace::Size(nnz, num_cols_l)), s);
+          Workspace csc(workspace.dptr_, nnz, num_cols_l);
+          CsrToCscImpl(data_l.dptr<DType>(), indptr_l.dptr<IType>(), col_idx_l.dptr<CType>(),
+                       lhs.shape()[0], num_cols_l, csc.indptr, csc.cursor, csc.row_idx,
+                       csc.data);
+          std::vector<dim_t> row_bounds(num_threads + 1);
+          BalanceRowsByNnz(csc.indptr, static_cast<const IType*>(nullptr), num_cols_l, nnz,
+                           num_threads, row_bounds.data());
+          mxnet_op::Kernel<DotCscDnsByRowBlocks, cpu>::Launch(s, num_threads,
+              data_out.dptr<DType>(), static_cast<const IType*>(nullptr), csc.data,
+              csc.indptr, csc.row_idx, data_r.dptr<DType>(), row_bounds.data(),
+              data_out.shape_[1]);
+        } else if (trans_lhs) {
           mxnet_op::Kernel<DotCsrTransDnsDnsByRowBlocks, cpu>::Launch(s, num_threads,
               data_out.dptr<DType>(), data_l.dptr<DType>(), indptr_l.dptr<IType>(),
               col_idx_l.dptr<CType>(), data_r.dptr<DType>(), seg_len,
               lhs.shape()[0], data_out.shape_[0], data_out.shape_[1]);
         } else {
+          std::vector<dim_t> row_bounds(num_threads + 1);
+          BalanceRowsByNnz(indptr_l.dptr<IType>(), static_cast<const IType*>(nullptr),
+                           data_out.shape_[0], static_cast<dim_t>(data_l.Size()),
+                           num_threads, row_bounds.data());
           mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::Launch(s, num_threads,
               data_out.dptr<DType>(), data_l.dptr<DType>(), indptr_l.dptr<IType>(),
-              col_idx_l.dptr<CType>(), data_r.dptr<DType>(), seg_len,
-              data_out.shape_[0], data_out.shape_[1]);
+              col_idx_l.dptr<CType>(), data_r.dptr<DType>(), row_bounds.data(),
+              data_out.shape_[1]);
         }
       });
     });
@@ -598,15 +793,63 @@ inline void DotCsrDnsRspImpl(const OpContext& ctx,
   const TBlob col_idx_l = lhs.aux_data(csr::kIdx);
   const TBlob& data_r = rhs;
 
-  // pre-allocate spaces for ret using the dense dimension size
-  ret->CheckAndAlloc({mshadow::Shape1(lhs.shape()[1])});
-  const TBlob data_out = ret->data();
-  const TBlob row_idx_out = ret->aux_data(rowsparse::kIdx);
+  if (!trans_lhs) {
+    LOG(FATAL) << "DotCsrDnsRspImpl has not implemented dot(csr, dns)=rsp yet.";
+  }
+  const dim_t num_threads_max = mxnet_op::get_num_threads<cpu>(lhs.shape()[1]);
 
   MSHADOW_SGL_DBL_TYPE_SWITCH(data_l.type_flag_, DType, {  // data type
     MSHADOW_IDX_TYPE_SWITCH(indptr_l.type_flag_, IType, {  // indptr type
       MSHADOW_IDX_TYPE_SWITCH(col_idx_l.type_flag_, CType, {  // col idx type
-        MSHADOW_IDX_TYPE_SWITCH(row_idx_out.type_flag_, RType, {  // row idx type
+        MSHADOW_IDX_TYPE_SWITCH(ret->aux_type(rowsparse::kIdx), RType, {  // row idx type
+          if (num_threads_max > 1) {
+            // the nonzero rows of ret are the nonzero columns of lhs, so ret is
+            // allocated with exactly these rows and computed from the csc view
+            const dim_t nnz = data_l.Size();
+            const dim_t num_cols_l = lhs.shape()[1];
+            typedef CscWorkspace<DType, IType, CType> Workspace;
+            mshadow::Tensor<cpu, 1, char> workspace = ctx.requested[0]
+                .get_space_typed<cpu, 1, char>(mshadow::Shape1(Workspace::Size(nnz, num_cols_l)),
+                                               s);
+            Workspace csc(workspace.dptr_, nnz, num_cols_l);
+            CsrToCscImpl(data_l.dptr<DType>(), indptr_l.dptr<IType>(), col_idx_l.dptr<CType>(),
+                         lhs.shape()[0], num_cols_l, csc.indptr, csc.cursor, csc.row_idx,
+                         csc.data);
+            // cursor is free again, reuse it for the output position of every column
+            IType* out_pos = csc.cursor;
+            #pragma omp parallel for
+            for (dim_t c = 0; c < num_cols_l; ++c) {
+              out_pos[c] = csc.indptr[c+1] > csc.indptr[c] ? 1 : 0;
+            }
+            out_pos[num_cols_l] = 0;
+            common::ParallelExclusiveScan(out_pos, num_cols_l + 1);
+            const dim_t nnr = out_pos[num_cols_l];
+            if (0 == nnr) {
+              if (ret->storage_initialized()) {
+                ret->set_aux_shape(rowsparse::kIdx, mshadow::Shape1(0));
+              }
+              return;
+            }
+            ret->CheckAndAlloc({mshadow::Shape1(nnr)});
+            const TBlob data_out = ret->data();
+            RType* row_idx = ret->aux_data(rowsparse::kIdx).dptr<RType>();
+            #pragma omp parallel for
+            for (dim_t c = 0; c < num_cols_l; ++c) {
+              if (csc.indptr[c+1] > csc.indptr[c]) row_idx[out_pos[c]] = c;
+            }
+            mxnet_op::Kernel<set_zero, cpu>::Launch(s, data_out.Size(), data_out.dptr<DType>());
+            const dim_t num_threads = mxnet_op::get_num_threads<cpu>(nnr);
+            std::vector<dim_t> row_bounds(num_threads + 1);
+            BalanceRowsByNnz(csc.indptr, row_idx, nnr, nnz, num_threads, row_bounds.data());
+            mxnet_op::Kernel<DotCscDnsByRowBlocks, cpu>::Launch(s, num_threads,
+                data_out.dptr<DType>(), row_idx, csc.data, csc.indptr, csc.row_idx,
+                data_r.dptr<DType>(), row_bounds.data(), data_out.shape_[1]);
+            return;
+          }
+          // pre-allocate spaces for ret using the dense dimension size
+          ret->CheckAndAlloc({mshadow::Shape1(lhs.shape()[1])});
+          const TBlob data_out = ret->data();
+          const TBlob row_idx_out = ret->aux_data(rowsparse::kIdx);
           dim_t num_threads = data_out.Size();
           mxnet_op::Kernel<set_zero, cpu>::Launch(s, num_threads, data_out.dptr<DType>());
           RType* row_idx = row_idx_out.dptr<RType>();
@@ -614,26 +857,22 @@ inline void DotCsrDnsRspImpl(const OpContext& ctx,
           mxnet_op::Kernel<set_zero, cpu>::Launch(s, num_threads, row_idx);
           num_threads = mxnet_op::get_num_threads<cpu>(data_out.shape_[0]);
           dim_t seg_len = (data_out.shape_[0] + num_threads - 1) / num_threads;
-          if (trans_lhs) {
-            mxnet_op::Kernel<DotCsrTransDnsRspByRowBlocks, cpu>::Launch(s, num_threads,
-                data_out.dptr<DType>(), row_idx, data_l.dptr<DType>(),
-                indptr_l.dptr<IType>(), col_idx_l.dptr<CType>(), data_r.dptr<DType>(),
-                seg_len, lhs.shape()[0], data_out.shape_[0], data_out.shape_[1]);
-            dim_t nnr = 0;
-            nnr = mxnet::common::ParallelAccumulate(row_idx, ret->shape()[0], nnr);
-            ret->set_aux_shape(rowsparse::kIdx, mshadow::Shape1(nnr));
-            if (0 == nnr) return;
-            mshadow::Tensor<cpu, 2, DType> rsp_data = data_out.FlatTo2D<cpu, DType>(s);
-            dim_t idx = 0;
-            for (index_t i = 0; i < ret->shape()[0]; ++i) {
-              if (row_idx[i] > 0) {
-                row_idx[idx] = i;
-                mshadow::Copy(rsp_data[idx], rsp_data[i], s);
-                ++idx;
-              }
+          mxnet_op::Kernel<DotCsrTransDnsRspByRowBlocks, cpu>::Launch(s, num_threads,
+              data_out.dptr<DType>(), row_idx, data_l.dptr<DType>(),
+              indptr_l.dptr<IType>(), col_idx_l.dptr<CType>(), data_r.dptr<DType>(),
+              seg_len, lhs.shape()[0], data_out.shape_[0], data_out.shape_[1]);
+          dim_t nnr = 0;
+          nnr = mxnet::common::ParallelAccumulate(row_idx, ret->shape()[0], nnr);
+          ret->set_aux_shape(rowsparse::kIdx, mshadow::Shape1(nnr));
+          if (0 == nnr) return;
+          mshadow::Tensor<cpu, 2, DType> rsp_data = data_out.FlatTo2D<cpu, DType>(s);
+          dim_t idx = 0;
+          for (index_t i = 0; i < ret->shape()[0]; ++i) {
+            if (row_idx[i] > 0) {
+              row_idx[idx] = i;
+              mshadow::Copy(rsp_data[idx], rsp_data[i], s);
+              ++idx;
             }
-          } else {
-            LOG(FATAL) << "DotCsrDnsRspImpl has not implemented dot(csr, dns)=rsp yet.";
           }
         });
       });
@@ -28,11 +28,14 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
 #include "./elemwise_binary_op.h"
 #include "../operator_common.h"
+#include "./init_op.h"
+#include "./cast_storage-inl.h"
 #include "broadcast_reduce-inl.h"
 
 namespace mxnet {
@@ -75,6 +78,37 @@ inline bool BinaryBroadcastShape(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+inline bool BinaryBroadcastMulStorageType(const nnvm::NodeAttrs& attrs,
+                                          const int dev_mask,
+                                          DispatchMode* dispatch_mode,
+                                          std::vector<int>* in_attrs,
+                                          std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const int lhs_stype = in_attrs->at(0);
+  const int rhs_stype = in_attrs->at(1);
+  int& out_stype = out_attrs->at(0);
+  bool dispatched = false;
+  if (!dispatched && lhs_stype == kDefaultStorage && rhs_stype == kDefaultStorage) {
+    // dns, dns -> dns
+    dispatched = storage_type_assign(&out_stype, kDefaultStorage,
+                                     dispatch_mode, DispatchMode::kFCompute);
+  }
+  if (!dispatched && lhs_stype == kCSRStorage && rhs_stype == kDefaultStorage &&
+      dev_mask == mshadow::cpu::kDevMask) {
+    // csr, dns -> csr, the zeros of lhs stay zeros
+    dispatched = storage_type_assign(&out_stype, kCSRStorage,
+                                     dispatch_mode, DispatchMode::kFComputeEx);
+  }
+  if (!dispatched) {
+    dispatch_fallback(out_attrs, dispatch_mode);
+  }
+  if (*dispatch_mode == DispatchMode::kFComputeFallback) {
+    LogStorageFallback(attrs, dev_mask, in_attrs, out_attrs);
+  }
+  return true;
+}
+
 #define BROADCAST_NDIM_SWITCH(ndim, NDim, ...)  \
   if (ndim <= 2) {                    \
     const int NDim = 2;               \
@@ -156,6 +190,145 @@ void BinaryBroadcastCompute(const nnvm::NodeAttrs& attrs,
   }
 }
 
+/*!
+ * \brief Kernel of broadcast op(csr, dns) = csr, parallelized by rows of csr.
+ * The dns element matching csr element (i, j) is dns[i * row_stride + j * col_stride],
+ * a zero stride broadcasts dns along that axis.
+ */
+template<typename OP, int req>
+struct BinaryBroadcastCsrDnsCsrKernel {
+  template<typename DType, typename CType, typename RType>
+  MSHADOW_XINLINE static void Map(int i, DType* out, const DType* csr_data,
+                                  const CType* csr_idx, const RType* csr_indptr,
+                                  const DType* dns, const nnvm::dim_t row_stride,
+                                  const nnvm::dim_t col_stride) {
+    const DType* dns_row = dns + i * row_stride;
+    for (RType j = csr_indptr[i]; j < csr_indptr[i+1]; ++j) {
+      KERNEL_ASSIGN(out[j], req, OP::Map(csr_data[j], dns_row[csr_idx[j] * col_stride]));
+    }
+  }
+};
+
+/*!
+ * \brief CPU impl of broadcast op(csr, dns) = csr for OP with OP(0, x) = 0.
+ * The output keeps the sparsity pattern of csr, so only dns may be broadcast.
+ */
+template<typename OP>
+void BinaryBroadcastCsrDnsCsrImpl(const OpContext& ctx,
+                                  const NDArray& csr,
+                                  const TBlob& dns,
+                                  const OpReqType req,
+                                  const NDArray& output) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using nnvm::dim_t;
+  CHECK_NE(req, kAddTo) << "broadcast op(csr, dns) = csr does not support kAddTo";
+  CHECK_EQ(output.shape(), csr.shape());
+  Stream<cpu>* s = ctx.get_stream<cpu>();
+  if (!csr.storage_initialized()) {
+    FillZerosCsrImpl(s, output);
+    return;
+  }
+  const dim_t dns_rows = dns.ndim() == 2 ? dns.shape_[0] : 1;
+  const dim_t dns_cols = dns.shape_[dns.ndim() - 1];
+  const dim_t row_stride = dns_rows == 1 ? 0 : dns_cols;
+  const dim_t col_stride = dns_cols == 1 ? 0 : 1;
+  MSHADOW_IDX_TYPE_SWITCH(csr.aux_type(csr::kIdx), CType, {
+    MSHADOW_IDX_TYPE_SWITCH(csr.aux_type(csr::kIndPtr), RType, {
+      MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
+        MXNET_ASSIGN_REQ_SWITCH(req, Req, {
+          output.CheckAndAlloc({csr.aux_shape(csr::kIndPtr), csr.aux_shape(csr::kIdx)});
+          const TBlob out_indptr = output.aux_data(csr::kIndPtr);
+          const TBlob out_idx = output.aux_data(csr::kIdx);
+          const RType* indptr = csr.aux_data(csr::kIndPtr).dptr<RType>();
+          const CType* idx = csr.aux_data(csr::kIdx).dptr<CType>();
+          // no copy is needed if the op is computed in place
+          if (out_indptr.dptr<RType>() != indptr) {
+            Copy(out_indptr.FlatTo1D<cpu, RType>(s),
+                 csr.aux_data(csr::kIndPtr).FlatTo1D<cpu, RType>(s), s);
+            Copy(out_idx.FlatTo1D<cpu, CType>(s),
+                 csr.aux_data(csr::kIdx).FlatTo1D<cpu, CType>(s), s);
+          }
+          Kernel<BinaryBroadcastCsrDnsCsrKernel<OP, Req>, cpu>::Launch(
+            s, csr.shape()[0], output.data().dptr<DType>(), csr.data().dptr<DType>(),
+            idx, indptr, dns.dptr<DType>(), row_stride, col_stride);
+        });
+      });
+    });
+  });
+}
+
+/*!
+ * \brief whether the cpu blob dns has an element equal to zero
+ */
+inline bool HasZero(const TBlob& dns) {
+  bool ret = false;
+  MSHADOW_TYPE_SWITCH(dns.type_flag_, DType, {
+    const DType* data = dns.dptr<DType>();
+    ret = std::find(data, data + dns.Size(), DType(0)) != data + dns.Size();
+  });
+  return ret;
+}
+
+/*!
+ * \brief CPU impl of broadcast op(csr, dns) = csr which follows the dense result.
+ * csr is cast to dense, the dense kernel runs in temp space and its result is cast
+ * back to csr, so csr may be broadcast as well as dns.
+ */
+template<typename OP>
+void BinaryBroadcastCsrDnsCsrDenseImpl(const nnvm::NodeAttrs& attrs,
+                                       const OpContext& ctx,
+                                       const NDArray& csr,
+                                       const TBlob& dns,
+                                       const OpReqType req,
+                                       const NDArray& output) {
+  using namespace mshadow;
+  CHECK_NE(req, kAddTo) << "broadcast op(csr, dns) = csr does not support kAddTo";
+  CHECK_EQ(output.shape().ndim(), 2U)
+    << "broadcast op(csr, dns) = csr needs a 2-D output, got shapes " << csr.shape()
+    << " " << dns.shape_ << ", cast the csr operand to default storage first";
+  Stream<cpu>* s = ctx.get_stream<cpu>();
+  MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
+    const size_t lhs_size = csr.shape().Size();
+    Tensor<cpu, 1, DType> workspace = ctx.requested[0].get_space_typed<cpu, 1, DType>(
+      Shape1(lhs_size + output.shape().Size()), s);
+    TBlob lhs(workspace.dptr_, csr.shape(), cpu::kDevMask);
+    TBlob out(workspace.dptr_ + lhs_size, output.shape(), cpu::kDevMask);
+    CastStorageCsrDnsImpl<cpu>(ctx, csr, &lhs);
+    BinaryBroadcastCompute<cpu, OP>(attrs, ctx, {lhs, dns}, {kWriteTo}, {out});
+    NDArray ret = output;
+    CastStorageDnsCsrImpl(ctx, cpu(), out, &ret);
+  });
+}
+
+template<typename xpu, typename OP>
+void BinaryBroadcastComputeEx(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<NDArray>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<NDArray>& outputs) {
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(req.size(), 1U);
+  if (req[0] == kNullOp) return;
+  const auto lhs_stype = inputs[0].storage_type();
+  const auto rhs_stype = inputs[1].storage_type();
+  const auto out_stype = outputs[0].storage_type();
+  if (lhs_stype == kCSRStorage && rhs_stype == kDefaultStorage && out_stype == kCSRStorage) {
+    // csr, dns -> csr
+    if (outputs[0].shape() == inputs[0].shape() &&
+        !(std::is_same<OP, mshadow::op::div>::value && HasZero(inputs[1].data()))) {
+      BinaryBroadcastCsrDnsCsrImpl<OP>(ctx, inputs[0], inputs[1].data(), req[0], outputs[0]);
+    } else {
+      // csr is broadcast too, or some zeros of csr are divided by zero
+      BinaryBroadcastCsrDnsCsrDenseImpl<OP>(attrs, ctx, inputs[0], inputs[1].data(),
+                                            req[0], outputs[0]);
+    }
+  } else {
+    LOG(FATAL) << "Not implemented: " << operator_string(attrs, ctx, inputs, req, outputs);
+  }
+}
+
 template<typename xpu, typename LOP, typename ROP>
 void BinaryBroadcastBackwardUseNone(const nnvm::NodeAttrs& attrs,
                                     const OpContext& ctx,
@@ -24,8 +24,62 @@
 */
 
 #include "./indexing_op.h"
+#include "../../common/utils.h"
 namespace mxnet {
 namespace op {
+
+void SparseEmbeddingOpBackwardRspImpl(const OpContext& ctx,
+                                      const TBlob& ograd,
+                                      const TBlob& data,
+                                      const OpReqType req,
+                                      const NDArray& output) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using nnvm::dim_t;
+  if (req == kNullOp) return;
+  CHECK_EQ(req, kWriteTo) << "Embedding with sparse_grad only supports kWriteTo for its "
+                          << "row_sparse weight gradient";
+  Stream<cpu> *s = ctx.get_stream<cpu>();
+  const dim_t num_idx = data.Size();
+  if (num_idx == 0) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  const dim_t num_rows = output.shape()[0];
+  const dim_t row_length = output.shape()[1];
+  const int nthreads = omp_get_max_threads();
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    MSHADOW_IDX_TYPE_SWITCH(output.aux_type(rowsparse::kIdx), RType, {
+      MSHADOW_TYPE_SWITCH(ograd.type_flag_, DType, {
+        // order, segment and rows, in this order to keep each of them aligned
+        const size_t workspace_size = (2 * num_idx + 1) * sizeof(dim_t) +
+                                      num_idx * sizeof(RType);
+        Tensor<cpu, 1, char> workspace = ctx.requested[embedding::kTempSpace]
+            .get_space_typed<cpu, 1, char>(Shape1(workspace_size), s);
+        dim_t* order = reinterpret_cast<dim_t*>(workspace.dptr_);
+        dim_t* segment = order + num_idx;
+        RType* rows = reinterpret_cast<RType*>(segment + num_idx + 1);
+        Kernel<tcast_clip, cpu>::Launch(s, num_idx, rows, data.dptr<IType>(),
+                                        static_cast<RType>(num_rows));
+        Kernel<range_fwd, cpu>::Launch(s, num_idx, 1, dim_t(0), dim_t(1), kWriteTo, order);
+        // ties are broken by position so that the sum order does not depend on the sort
+        common::ParallelSort(order, order + num_idx, nthreads,
+                             [rows](const dim_t a, const dim_t b) {
+                               return rows[a] < rows[b] || (rows[a] == rows[b] && a < b);
+                             });
+        dim_t nnr = 0;
+        for (dim_t i = 0; i < num_idx; ++i) {
+          if (i == 0 || rows[order[i]] != rows[order[i - 1]]) segment[nnr++] = i;
+        }
+        segment[nnr] = num_idx;
+        output.CheckAndAlloc({Shape1(nnr)});
+        Kernel<EmbeddingRspGradKernel, cpu>::Launch(
+            s, nnr, output.data().dptr<DType>(), output.aux_data(rowsparse::kIdx).dptr<RType>(),
+            ograd.dptr<DType>(), rows, order, segment, row_length);
+      });
+    });
+  });
+}
 DMLC_REGISTER_PARAMETER(EmbeddingParam);
 DMLC_REGISTER_PARAMETER(TakeParam);
 DMLC_REGISTER_PARAMETER(OneHotParam);
@@ -71,6 +125,9 @@ Examples::
                            [[  0.,   1.,   2.,   3.,   4.],
                             [ 10.,  11.,  12.,  13.,  14.]]]
 
+If sparse_grad is set to True, the gradient of weight is a row_sparse array that holds
+only the rows looked up by the input, so its cost does not grow with input_dim.
+
 )code" ADD_FILELINE)
 .set_num_inputs(2)
 .set_num_outputs(1)
@@ -103,7 +160,9 @@ NNVM_REGISTER_OP(_backward_Embedding)
     return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
   })
 .set_attr<nnvm::TIsBackward>("TIsBackward", true)
-.set_attr<FCompute>("FCompute<cpu>", EmbeddingOpBackward<cpu>);
+.set_attr<FInferStorageType>("FInferStorageType", EmbeddingOpBackwardStorageType)
+.set_attr<FCompute>("FCompute<cpu>", EmbeddingOpBackward<cpu>)
+.set_attr<FComputeEx>("FComputeEx<cpu>", EmbeddingOpBackwardEx<cpu>);
 
 NNVM_REGISTER_OP(take)
 .describe(R"code(Takes elements from an input array along the given axis.
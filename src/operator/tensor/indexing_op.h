@@ -57,6 +57,7 @@ struct EmbeddingParam: public dmlc::Parameter<EmbeddingParam> {
   int input_dim;
   int output_dim;
   int dtype;
+  bool sparse_grad;
   DMLC_DECLARE_PARAMETER(EmbeddingParam) {
     DMLC_DECLARE_FIELD(input_dim).set_lower_bound(1)
     .describe("Vocabulary size of the input indices.");
@@ -69,6 +70,9 @@ struct EmbeddingParam: public dmlc::Parameter<EmbeddingParam> {
     .add_enum("uint8", mshadow::kUint8)
     .add_enum("int32", mshadow::kInt32)
     .describe("Data type of weight.");
+    DMLC_DECLARE_FIELD(sparse_grad).set_default(false)
+    .describe("Compute row_sparse gradient in the backward calculation. If set to True, "
+              "the grad's storage type is row_sparse and only the looked-up rows are stored.");
   }
 };
 
@@ -336,6 +340,100 @@ void EmbeddingOpBackward(const nnvm::NodeAttrs& attrs,
   });
 }
 
+inline bool EmbeddingOpBackwardStorageType(const nnvm::NodeAttrs& attrs,
+                                           const int dev_mask,
+                                           DispatchMode* dispatch_mode,
+                                           std::vector<int> *in_attrs,
+                                           std::vector<int> *out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  const EmbeddingParam& param = nnvm::get<EmbeddingParam>(attrs.parsed);
+  const auto& ograd_stype = in_attrs->at(0);
+  const auto& data_stype = in_attrs->at(1);
+  auto& data_grad_stype = out_attrs->at(embedding::kData);
+  auto& weight_grad_stype = out_attrs->at(embedding::kWeight);
+  bool dispatched = false;
+  const bool invalid_ctx = dev_mask != mshadow::cpu::kDevMask;
+  const auto dispatch_ex = invalid_ctx ? DispatchMode::kFComputeFallback :
+                           DispatchMode::kFComputeEx;
+  if (!dispatched && ograd_stype == kDefaultStorage && data_stype == kDefaultStorage &&
+      type_assign(&data_grad_stype, kDefaultStorage)) {
+    if (param.sparse_grad) {
+      // dns, dns -> dns, rsp
+      dispatched = storage_type_assign(&weight_grad_stype, kRowSparseStorage,
+                                       dispatch_mode, dispatch_ex);
+    } else {
+      // dns, dns -> dns, dns
+      dispatched = storage_type_assign(&weight_grad_stype, kDefaultStorage,
+                                       dispatch_mode, DispatchMode::kFCompute);
+    }
+  }
+  if (!dispatched) {
+    dispatch_fallback(out_attrs, dispatch_mode);
+  }
+  if (*dispatch_mode == DispatchMode::kFComputeFallback) {
+    LogStorageFallback(attrs, dev_mask, in_attrs, out_attrs);
+  }
+  return true;
+}
+
+/*!
+ * \brief sum the rows of ograd looked up by the same index into one row of
+ *  the row_sparse weight gradient. Launched with one thread per unique index.
+ * \param order positions of the indices, sorted by index
+ * \param rows clipped index of every position
+ * \param segment start of every unique index in order, followed by the number of indices
+ */
+struct EmbeddingRspGradKernel {
+  template<typename DType, typename RType>
+  MSHADOW_XINLINE static void Map(int i, DType* out_data, RType* out_idx,
+                                  const DType* ograd, const RType* rows,
+                                  const nnvm::dim_t* order, const nnvm::dim_t* segment,
+                                  const nnvm::dim_t row_length) {
+    const nnvm::dim_t begin = segment[i], end = segment[i + 1];
+    out_idx[i] = rows[order[begin]];
+    DType* dst = out_data + i * row_length;
+    const DType* src = ograd + order[begin] * row_length;
+    for (nnvm::dim_t j = 0; j < row_length; ++j) dst[j] = src[j];
+    for (nnvm::dim_t k = begin + 1; k < end; ++k) {
+      src = ograd + order[k] * row_length;
+      for (nnvm::dim_t j = 0; j < row_length; ++j) dst[j] += src[j];
+    }
+  }
+};
+
+/*!
+ * \brief row_sparse weight gradient of Embedding. Only the looked-up rows are
+ *  written: the indices are sorted in parallel, and every unique index is then
+ *  reduced by one thread, so the cost is independent of input_dim.
+ */
+void SparseEmbeddingOpBackwardRspImpl(const OpContext& ctx,
+                                      const TBlob& ograd,
+                                      const TBlob& data,
+                                      const OpReqType req,
+                                      const NDArray& output);
+
+template<typename xpu>
+void EmbeddingOpBackwardEx(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<NDArray>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<NDArray>& outputs) {
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  const NDArray& weight_grad = outputs[embedding::kWeight];
+  CHECK_EQ(req[embedding::kData], kNullOp)
+          << "Embedding layer doesn't support calculate data gradient";
+  CHECK_EQ(inputs[0].storage_type(), kDefaultStorage);
+  CHECK_EQ(inputs[1].storage_type(), kDefaultStorage);
+  if (weight_grad.storage_type() == kRowSparseStorage) {
+    SparseEmbeddingOpBackwardRspImpl(ctx, inputs[0].data(), inputs[1].data(),
+                                     req[embedding::kWeight], weight_grad);
+  } else {
+    LOG(FATAL) << "Not implemented: " << operator_string(attrs, ctx, inputs, req, outputs);
+  }
+}
+
 namespace take_ {  // to avoid name conflict
 enum TakeOpInputs {kArr, kIdx};
 enum TakeOpOutputs {kOut};
@@ -238,7 +238,7 @@ struct SparseRetainCopyIndices {
  * This kernel is only used when ctx is on GPU.
  * So it's parallelized by out_rows' elements,
  * instead of rows.
- * For CPU ctx, we simply call mshadow::Copy.
+ * For CPU ctx, use SparseRetainGatherRowsFromDns.
  */
 struct SparseRetainCopyRetainedRowsFromDns {
   template<typename DType, typename RType, typename IType>
@@ -251,6 +251,34 @@ struct SparseRetainCopyRetainedRowsFromDns {
   }
 };
 
+/*!
+ * Gather retained rows of a dense input rsp into output rows on CPU,
+ * parallelized by rows. The rows are scattered over a large table,
+ * so the source row kRetainPrefetchDist positions ahead is prefetched
+ * while the current one is copied.
+ */
+const int kRetainPrefetchDist = 8;
+struct SparseRetainGatherRowsFromDns {
+  template<typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(int i, DType* out_rows, const DType* in_rows,
+                                  const IType* idx, const size_t num_rows,
+                                  const size_t row_length) {
+#if defined(__GNUC__) && !defined(__CUDA_ARCH__)
+    if (static_cast<size_t>(i + kRetainPrefetchDist) < num_rows) {
+      const DType* next = in_rows + static_cast<size_t>(idx[i + kRetainPrefetchDist]) * row_length;
+      for (size_t k = 0; k < row_length * sizeof(DType); k += 64) {
+        __builtin_prefetch(reinterpret_cast<const char*>(next) + k, 0, 0);
+      }
+    }
+#endif
+    const DType* in_row = in_rows + static_cast<size_t>(idx[i]) * row_length;
+    DType* out_row = out_rows + static_cast<size_t>(i) * row_length;
+    for (size_t k = 0; k < row_length; ++k) {
+      out_row[k] = in_row[k];
+    }
+  }
+};
+
 template<typename xpu>
 void SparseRetainOpForwardRspImpl(mshadow::Stream<xpu> *s,
                                   const NDArray& input_nd,
@@ -281,7 +309,6 @@ void SparseRetainOpForwardRspImpl(mshadow::Stream<xpu> *s,
 
   using namespace mxnet_op;
   MSHADOW_TYPE_SWITCH(output_data.type_flag_, DType, {  // output data type
-    Kernel<set_zero, xpu>::Launch(s, output_data.Size(), output_data.dptr<DType>());
     MSHADOW_IDX_TYPE_SWITCH(output_idx.type_flag_, RType, {  // row index data type
       MSHADOW_TYPE_SWITCH(idx_data.type_flag_, IType, {  // index array data type
         if (input_idx.Size() == input_nd.shape()[0]) {  // input rsp is dense
@@ -296,22 +323,18 @@ void SparseRetainOpForwardRspImpl(mshadow::Stream<xpu> *s,
             Kernel<SparseRetainCopyIndices, xpu>::Launch(s, num_rows_retained,
                 output_idx.dptr<RType>(), idx_data.dptr<IType>());
           }
-          // copy data
-          if (std::is_same<xpu, cpu>::value) {  // For cpu, we can access output_idx_tensor[i]
-            const Tensor<xpu, 2, DType> input_tensor =
-              input_data.get_with_shape<xpu, 2, DType>(Shape2(input_data.shape_[0], row_length), s);
-            Tensor<xpu, 2, DType> output_tensor =
-              output_data.get_with_shape<xpu, 2, DType>(Shape2(output_data.shape_[0], row_length),
-                                                        s);
-            for (size_t i = 0; i < num_rows_retained; ++i) {
-              Copy(output_tensor[i], input_tensor[output_idx_tensor[i]], s);
-            }
+          // copy data, every output row is overwritten so no zeroing is needed
+          if (std::is_same<xpu, cpu>::value) {  // For cpu, gather by rows
+            Kernel<SparseRetainGatherRowsFromDns, xpu>::Launch(s, num_rows_retained,
+                output_data.dptr<DType>(), input_data.dptr<DType>(), idx_data.dptr<IType>(),
+                num_rows_retained, row_length);
           } else {  // For gpu, have to kernel launch
             Kernel<SparseRetainCopyRetainedRowsFromDns, xpu>::Launch(s, output_data.Size(),
                 output_data.dptr<DType>(), input_data.dptr<DType>(), input_idx.dptr<RType>(),
                 idx_data.dptr<IType>(), row_length);
           }
         } else {  // input rsp is not dense
+          Kernel<set_zero, xpu>::Launch(s, output_data.Size(), output_data.dptr<DType>());
           Kernel<SparseRetainRspThreadKernel, xpu>::Launch(s, idx_data.Size(),
               output_data.dptr<DType>(), output_idx.dptr<RType>(), input_data.dptr<DType>(),
               input_idx.dptr<RType>(), idx_data.dptr<IType>(), input_data.shape_[0], row_length);
@@ -31,6 +31,7 @@
 #include <limits>
 #include <atomic>
 #include "./common/lazy_alloc_array.h"
+#include "./engine/profiler.h"
 
 namespace mxnet {
 namespace resource {
@@ -262,10 +263,16 @@ class ResourceManagerImpl : public ResourceManager {
 }  // namespace resource
 
 void* Resource::get_space_internal(size_t size) const {
+#if MXNET_USE_PROFILER
+  engine::Profiler::Get()->AddTempSpaceStat(size);
+#endif
   return static_cast<resource::SpaceAllocator*>(ptr_)->GetSpace(size);
 }
 
 void* Resource::get_host_space_internal(size_t size) const {
+#if MXNET_USE_PROFILER
+  engine::Profiler::Get()->AddTempSpaceStat(size);
+#endif
   return static_cast<resource::SpaceAllocator*>(ptr_)->GetHostSpace(size);
 }
 
@@ -34,6 +34,7 @@
 #include <new>
 #include "./storage_manager.h"
 #include "../common/cuda_utils.h"
+#include "../engine/profiler.h"
 
 
 namespace mxnet {
@@ -47,8 +48,9 @@ class GPUPooledStorageManager final : public StorageManager {
  public:
   /*!
    * \brief Default constructor.
+   * \param dev_id id of the gpu the memory is allocated on
    */
-  GPUPooledStorageManager() {
+  explicit GPUPooledStorageManager(int dev_id) : dev_id_(dev_id) {
     reserve_ = dmlc::GetEnv("MXNET_GPU_MEM_POOL_RESERVE", 5);
   }
   /*!
@@ -73,6 +75,14 @@ class GPUPooledStorageManager final : public StorageManager {
 
  private:
   void ReleaseAll();
+  // report a pool lookup to the profiler
+  inline void AddPoolStat(bool hit) {
+#if MXNET_USE_PROFILER
+    engine::Profiler::Get()->AddPoolStat(Context::kGPU, dev_id_, hit, used_memory_);
+#endif
+  }
+  // id of the gpu
+  int dev_id_;
   // internal mutex
   std::mutex mutex_;
   // used memory
@@ -102,11 +112,13 @@ void* GPUPooledStorageManager::Alloc(size_t raw_size) {
       LOG(FATAL) << "cudaMalloc failed: " << cudaGetErrorString(e);
     }
     used_memory_ += size;
+    AddPoolStat(false);
     return ret;
   } else {
     auto&& reuse_pool = reuse_it->second;
     auto ret = reuse_pool.back();
     reuse_pool.pop_back();
+    AddPoolStat(true);
     return ret;
   }
 }
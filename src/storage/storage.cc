@@ -30,6 +30,7 @@
 #include "./pinned_memory_storage.h"
 #include "../common/cuda_utils.h"
 #include "../common/lazy_alloc_array.h"
+#include "../engine/profiler.h"
 
 namespace mxnet {
 
@@ -108,7 +109,7 @@ Storage::Handle StorageImpl::Alloc(size_t size, Context ctx) {
 #if MXNET_USE_CUDA
             CUDA_CALL(cudaGetDeviceCount(&num_gpu_device));
             CHECK_GT(num_gpu_device, 0) << "GPU usage requires at least 1 GPU";
-            ptr = new storage::GPUPooledStorageManager();
+            ptr = new storage::GPUPooledStorageManager(ctx.dev_id);
 #else
             LOG(FATAL) << "Compile with USE_CUDA=1 to enable GPU usage";
 #endif  // MXNET_USE_CUDA
@@ -120,6 +121,9 @@ Storage::Handle StorageImpl::Alloc(size_t size, Context ctx) {
       });
   this->ActivateDevice(ctx);
   hd.dptr = manager->Alloc(size);
+#if MXNET_USE_PROFILER
+  engine::Profiler::Get()->AddStorageStat(ctx.dev_type, ctx.dev_id, size);
+#endif
   return hd;
 }
 
@@ -133,6 +137,10 @@ void StorageImpl::Free(Storage::Handle handle) {
       });
   this->ActivateDevice(ctx);
   manager->Free(handle.dptr, handle.size);
+#if MXNET_USE_PROFILER
+  engine::Profiler::Get()->AddStorageStat(ctx.dev_type, ctx.dev_id,
+                                          -static_cast<int64_t>(handle.size));
+#endif
 }
 
 void StorageImpl::DirectFree(Storage::Handle handle) {
@@ -146,6 +154,10 @@ void StorageImpl::DirectFree(Storage::Handle handle) {
   this->ActivateDevice(ctx);
   // directly free ths data.
   manager->DirectFree(handle.dptr, handle.size);
+#if MXNET_USE_PROFILER
+  engine::Profiler::Get()->AddStorageStat(ctx.dev_type, ctx.dev_id,
+                                          -static_cast<int64_t>(handle.size));
+#endif
 }
 
 std::shared_ptr<Storage> Storage::_GetSharedRef() {
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file csr_shard_test.cc
+ * \brief round trip of csr shards through CSRShardWriter and CSRShardReader
+ */
+#include <gtest/gtest.h>
+#include <dmlc/logging.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../../src/io/csr_shard.h"
+
+using namespace mxnet;
+using namespace mxnet::io;
+
+namespace {
+// rows of 3 blocks of at most 2 rows: {0:1}, {}, {2:2, 5:3}, {1:4}, {7:5}
+const std::vector<std::vector<int64_t> > kIndptr = {{0, 1, 1}, {0, 2, 3}, {0, 1}};
+const std::vector<std::vector<int64_t> > kIndices = {{0}, {2, 5, 1}, {7}};
+const std::vector<std::vector<real_t> > kValues = {{1}, {2, 3, 4}, {5}};
+const std::vector<std::vector<real_t> > kLabels = {{0, 1}, {2, 3}, {4}};
+
+void WriteShard(const std::string &path, uint64_t num_cols) {
+  CSRShardWriter writer(path, 2);
+  for (size_t b = 0; b < kIndptr.size(); ++b) {
+    writer.WriteBlock(kIndptr[b].data(), kIndices[b].data(), kValues[b].data(),
+                      kLabels[b].data(), kLabels[b].size());
+  }
+  EXPECT_EQ(writer.max_num_cols(), 8U);
+  if (num_cols != 0) writer.SetNumCols(num_cols);
+  writer.Close();
+}
+}  // namespace
+
+TEST(CSRShard, RoundTrip) {
+  const std::string path = "csr_shard_test_0.csr";
+  WriteShard(path, 10);
+  {
+    CSRShardReader reader(path);
+    const CSRShardHeader &header = reader.header();
+    EXPECT_EQ(header.num_rows, 5U);
+    EXPECT_EQ(header.num_cols, 10U);
+    EXPECT_EQ(header.nnz, 5U);
+    EXPECT_EQ(header.block_size, 2U);
+    ASSERT_EQ(header.num_blocks, kIndptr.size());
+    for (size_t b = 0; b < header.num_blocks; ++b) {
+      const CSRShardBlock &blk = reader.block(b);
+      reader.CheckBlock(b);
+      EXPECT_EQ(blk.num_rows, kLabels[b].size());
+      EXPECT_EQ(blk.offset % kCSRShardAlign, 0U);
+      for (size_t i = 0; i < kIndptr[b].size(); ++i) {
+        EXPECT_EQ(reader.indptr(b)[i], kIndptr[b][i]);
+      }
+      for (size_t i = 0; i < kIndices[b].size(); ++i) {
+        EXPECT_EQ(reader.indices(b)[i], kIndices[b][i]);
+        EXPECT_EQ(reader.values(b)[i], kValues[b][i]);
+      }
+      for (size_t i = 0; i < kLabels[b].size(); ++i) {
+        EXPECT_EQ(reader.labels(b)[i], kLabels[b][i]);
+      }
+    }
+  }
+  std::remove(path.c_str());
+}
+
+TEST(CSRShard, InvalidBlockOffset) {
+  const std::string path = "csr_shard_test_1.csr";
+  WriteShard(path, 0);
+  uint64_t index_offset;
+  {
+    CSRShardReader reader(path);
+    EXPECT_EQ(reader.header().num_cols, 8U);
+    index_offset = reader.header().index_offset;
+  }
+  // point the second block past the index
+  std::FILE *fp = std::fopen(path.c_str(), "r+b");
+  ASSERT_TRUE(fp != nullptr);
+  const uint64_t offset = index_offset + 4096;
+  ASSERT_EQ(std::fseek(fp, index_offset + sizeof(CSRShardBlock), SEEK_SET), 0);
+  ASSERT_EQ(std::fwrite(&offset, sizeof(offset), 1, fp), 1U);
+  std::fclose(fp);
+  EXPECT_THROW(CSRShardReader reader(path), dmlc::Error);
+  std::remove(path.c_str());
+}
@@ -30,6 +30,11 @@ build/tests/cpp/storage/%.o : tests/cpp/storage/%.cc
 	$(CXX) -std=c++11 $(TEST_CFLAGS) -I$(GTEST_INC) -MM -MT tests/cpp/storage/$* $< > build/tests/cpp/storage/$*.d
 	$(CXX) -c -std=c++11 $(TEST_CFLAGS) -I$(GTEST_INC) -o build/tests/cpp/storage/$*.o $(filter %.cc %.a, $^)
 
+build/tests/cpp/io/%.o : tests/cpp/io/%.cc
+	@mkdir -p $(@D)
+	$(CXX) -std=c++11 $(TEST_CFLAGS) -I$(GTEST_INC) -MM -MT tests/cpp/io/$* $< > build/tests/cpp/io/$*.d
+	$(CXX) -c -std=c++11 $(TEST_CFLAGS) -I$(GTEST_INC) -o build/tests/cpp/io/$*.o $(filter %.cc %.a, $^)
+
 build/tests/cpp/engine/%.o : tests/cpp/engine/%.cc
 	@mkdir -p $(@D)
 	$(CXX) -std=c++11 $(TEST_CFLAGS) -I$(GTEST_INC) -MM -MT tests/cpp/engine/$* $< > build/tests/cpp/engine/$*.d
@@ -48,3 +53,4 @@ testclean:
 -include build/tests/cpp/operator/*.d
 -include build/tests/cpp/storage/*.d
 -include build/tests/cpp/engine/*.d
+-include build/tests/cpp/io/*.d
@@ -0,0 +1,62 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# pylint: skip-file
+import sys
+sys.path.insert(0, "../../python/")
+import os
+import mxnet as mx
+import numpy as np
+from mxnet.test_utils import assert_almost_equal
+
+big_shape = (1200, 1200)        # bigger than MXNET_KVSTORE_BIGARRAY_BOUND
+
+kv = mx.kv.create('dist_async')
+
+def test_async_row_sparse_pull():
+    # pulled rows are at most MXNET_KVSTORE_ROW_CACHE_STALENESS pulls behind
+    staleness = int(os.getenv('MXNET_KVSTORE_ROW_CACHE_STALENESS', '1'))
+    lr = 0.1
+    my_rank = kv.rank
+    nworker = kv.num_workers
+    kv.set_sparse_optimizer('sgd', lr=lr)
+    key = '0'
+    kv.init(key, mx.nd.ones(big_shape).tostype('row_sparse'))
+    row_ids_np = np.arange(0, big_shape[0], 3)
+    row_ids = mx.nd.array(row_ids_np)
+    val = mx.nd.zeros(big_shape, stype='row_sparse')
+    expected = np.zeros(big_shape)
+    expected[row_ids_np] = 1
+    for i in range(3):
+        kv.row_sparse_pull(key, out=val, row_ids=row_ids)
+        assert_almost_equal(val.asnumpy(), expected)
+    kv._barrier()
+    grad = mx.nd.zeros(big_shape)
+    grad[row_ids_np] = 1
+    kv.push(key, grad.tostype('row_sparse'))
+    mx.nd.waitall()
+    kv._barrier()
+    for i in range(staleness + 1):
+        kv.row_sparse_pull(key, out=val, row_ids=row_ids)
+    expected[row_ids_np] -= lr * nworker
+    assert_almost_equal(val.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+    print('worker ' + str(my_rank) + ' row_sparse pull is done')
+
+if __name__ == "__main__":
+    test_async_row_sparse_pull()
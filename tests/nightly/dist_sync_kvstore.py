@@ -24,6 +24,7 @@ import mxnet as mx
 import numpy as np
 import numpy.random as rnd
 import time
+from mxnet.test_utils import assert_almost_equal
 
 def check_diff_to_scalar(A, x, rank=None):
     """ assert A == x"""
@@ -195,6 +196,58 @@ def test_sync_init():
     my_rank = kv.rank
     print('worker ' + str(my_rank) + ' is initialized')
 
+def test_sync_sparse_optimizer():
+    # row_sparse keys are updated by sgd on the servers from now on
+    lr = 0.1
+    kv.set_sparse_optimizer('sgd', lr=lr)
+    kv._barrier()
+    my_rank = kv.rank
+    nworker = kv.num_workers
+    key = '600'
+    kv.init(key, mx.nd.ones(big_shape).tostype('row_sparse'))
+    kv._barrier()
+    row_ids_np = np.arange(0, big_shape[0], 7)
+    grad = mx.nd.zeros(big_shape)
+    grad[row_ids_np] = 1
+    kv.push(key, grad.tostype('row_sparse'))
+    val = mx.nd.zeros(big_shape, stype='row_sparse')
+    kv.row_sparse_pull(key, out=val, row_ids=mx.nd.array(np.arange(big_shape[0])))
+    expected = np.ones(big_shape)
+    expected[row_ids_np] -= lr * nworker
+    assert_almost_equal(val.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+    print('worker ' + str(my_rank) + ' sparse optimizer is done')
+
+def test_sync_row_sparse_prefetch():
+    # rows prefetched before a push are fetched again when the push updates them
+    lr = 0.1
+    my_rank = kv.rank
+    nworker = kv.num_workers
+    key = '700'
+    kv.init(key, mx.nd.ones(big_shape).tostype('row_sparse'))
+    kv._barrier()
+    all_row_ids = mx.nd.array(np.arange(big_shape[0]))
+    kv.row_sparse_prefetch(key, row_ids=all_row_ids)
+    row_ids_np = np.arange(0, big_shape[0], 5)
+    grad = mx.nd.zeros(big_shape)
+    grad[row_ids_np] = 1
+    kv.push(key, grad.tostype('row_sparse'))
+    val = mx.nd.zeros(big_shape, stype='row_sparse')
+    kv.row_sparse_pull(key, out=val, row_ids=all_row_ids)
+    expected = np.ones(big_shape)
+    expected[row_ids_np] -= lr * nworker
+    assert_almost_equal(val.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+    # a pull with other row_ids than the prefetched ones pulls them from the servers
+    kv.row_sparse_prefetch(key, row_ids=all_row_ids)
+    part_row_ids = mx.nd.array(row_ids_np)
+    val = mx.nd.zeros(big_shape, stype='row_sparse')
+    kv.row_sparse_pull(key, out=val, row_ids=part_row_ids)
+    expected = np.zeros(big_shape)
+    expected[row_ids_np] = 1 - lr * nworker
+    assert_almost_equal(val.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+    print('worker ' + str(my_rank) + ' row_sparse prefetch is done')
+
 if __name__ == "__main__":
     test_sync_init()
     test_sync_push_pull()
+    test_sync_sparse_optimizer()
+    test_sync_row_sparse_prefetch()
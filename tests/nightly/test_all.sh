@@ -53,6 +53,10 @@ juLog -name=Python.Local.KVStore -error=Error python test_kvstore.py
 
 # python: distributed kvstore
 juLog -name=Python.Distributed.KVStore -error=Error ../../tools/launch.py -n 4 python dist_sync_kvstore.py
+juLog -name=Python.Distributed.KVStore.Cyclic -error=Error env MXNET_KVSTORE_ROW_SPARSE_PLACEMENT=cyclic \
+    MXNET_KVSTORE_BATCH_SMALL_KEYS=1 ../../tools/launch.py -n 4 python dist_sync_kvstore.py
+juLog -name=Python.Distributed.KVStore.Async -error=Error env MXNET_KVSTORE_ROW_CACHE_SIZE=100 \
+    MXNET_KVSTORE_ROW_CACHE_STALENESS=2 ../../tools/launch.py -n 4 python dist_async_kvstore.py
 
 # download data
 juLog -name=DownloadData bash ./download.sh
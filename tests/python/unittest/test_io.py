@@ -27,7 +27,7 @@ try:
 except ImportError:
     h5py = None
 import sys
-from common import get_data
+from common import get_data, assertRaises
 import unittest
 
 
@@ -232,9 +232,229 @@ def test_LibSVMIter():
             assert(num_batches == int(expected_num_batches)), num_batches
             data_train.reset()
 
+    def check_libSVMIter_parallel():
+        # rows spread over several parsing threads must come out in file order
+        cwd = os.getcwd()
+        data_path = os.path.join(cwd, 'data_parallel.t')
+        num_rows, num_cols, batch_size = 1000, 50, 64
+        dense = np.zeros((num_rows, num_cols))
+        labels = np.arange(num_rows)
+        with open(data_path, 'w') as fout:
+            for i in range(num_rows):
+                cols = np.sort(np.random.choice(num_cols, np.random.randint(0, 5), replace=False))
+                dense[i, cols] = np.random.randint(1, 10, size=len(cols))
+                fout.write(' '.join([str(labels[i])] +
+                                    ['%d:%d' % (c, dense[i, c]) for c in cols]) + '\n')
+        for nthread in [1, 4]:
+            data_train = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(num_cols, ),
+                                          batch_size=batch_size, preprocess_threads=nthread)
+            # with round_batch, the next epoch continues after the wrapped-around rows
+            offset = 0
+            for epoch in range(2):
+                for batch in data_train:
+                    idx = np.arange(offset, offset + batch_size) % num_rows
+                    assert_almost_equal(batch.data[0].asnumpy(), dense[idx])
+                    assert_almost_equal(batch.label[0].asnumpy(), labels[idx])
+                    offset += batch_size
+                data_train.reset()
+
     check_libSVMIter_synthetic()
     check_libSVMIter_news_data()
+    check_libSVMIter_parallel()
     
+def test_CSRShardIter():
+    # write a shard following the layout documented in src/io/csr_shard.h
+    import struct
+    def align(x):
+        return (x + 63) // 64 * 64
+
+    def write_shard(path, blocks, block_size, num_cols):
+        header_size, entry_size = 8 * 8, 4 * 8
+        body, index = b'', []
+        offset = align(header_size)
+        row_begin = 0
+        for indptr, indices, values, labels in blocks:
+            rows, nnz = len(labels), len(values)
+            sec = [indptr.astype(np.int64).tobytes(), indices.astype(np.int64).tobytes(),
+                   values.astype(np.float32).tobytes(), labels.astype(np.float32).tobytes()]
+            blk = b''
+            for x in sec:
+                blk += x
+                blk += b'\0' * (align(len(blk)) - len(blk))
+            index.append(struct.pack('<4Q', offset, row_begin, rows, nnz))
+            body += blk
+            offset += len(blk)
+            row_begin += rows
+        nnz = sum(len(b[2]) for b in blocks)
+        header = struct.pack('<8Q', 0x4e4942525343584d, 1, row_begin, num_cols, nnz,
+                             block_size, len(blocks), offset)
+        with open(path, 'wb') as fout:
+            fout.write(header + b'\0' * (align(header_size) - header_size))
+            fout.write(body)
+            fout.write(b''.join(index))
+
+    num_rows, num_cols, block_size = 10, 6, 4
+    dense = np.random.randint(0, 3, size=(num_rows, num_cols)) * (np.random.rand(num_rows, num_cols) > 0.5)
+    labels = np.arange(num_rows, dtype=np.float32)
+    blocks = []
+    for begin in range(0, num_rows, block_size):
+        part = dense[begin:begin + block_size]
+        csr = mx.nd.array(part).tostype('csr')
+        blocks.append((csr.indptr.asnumpy(), csr.indices.asnumpy(), csr.data.asnumpy(),
+                       labels[begin:begin + block_size]))
+    path = os.path.join(os.getcwd(), 'data_0.csr')
+    write_shard(path, blocks, block_size, num_cols)
+
+    for shuffle in [False, True]:
+        data_iter = mx.io.CSRShardIter(data_shard=path, shuffle=shuffle)
+        for epoch in range(2):
+            seen = []
+            for batch in data_iter:
+                data = batch.data[0]
+                assert data.stype == 'csr'
+                assert data.shape == (block_size, num_cols)
+                valid = block_size - batch.pad
+                label = batch.label[0].asnumpy()[:valid].astype(np.int64)
+                assert_almost_equal(data.asnumpy()[:valid], dense[label])
+                assert np.sum(data.asnumpy()[valid:]) == 0
+                seen.extend(label.tolist())
+            assert sorted(seen) == list(range(num_rows))
+            data_iter.reset()
+
+def test_libsvm2csr():
+    # convert with tools/libsvm2csr, which must be built, and read the shards back
+    curr_path = os.path.dirname(os.path.abspath(os.path.expanduser(__file__)))
+    tool = os.path.join(curr_path, '../../../bin/libsvm2csr')
+    if not os.path.isfile(tool):
+        return
+    import subprocess
+    num_rows, block_size = 7, 2
+    dense = np.zeros((num_rows, 10))
+    cwd = os.getcwd()
+    data_path = os.path.join(cwd, 'libsvm2csr.t')
+    with open(data_path, 'w') as fout:
+        for i in range(num_rows):
+            # the rows of the first shard only use the first columns
+            cols = [i % 3] if (i // block_size) % 2 == 0 else [i % 3, 9 - i % 2]
+            dense[i, cols] = i + 1
+            fout.write('%d %s\n' % (i, ' '.join('%d:%d' % (c, i + 1) for c in cols)))
+    prefix = os.path.join(cwd, 'libsvm2csr')
+    subprocess.check_call([tool, data_path, prefix, 'block_size=%d' % block_size,
+                           'num_shards=2', 'nthread=2'])
+    seen = []
+    for k in range(2):
+        data_iter = mx.io.CSRShardIter(data_shard='%s_%d.csr' % (prefix, k))
+        for batch in data_iter:
+            # every shard declares the width of the whole dataset
+            assert batch.data[0].shape == (block_size, 10)
+            valid = block_size - batch.pad
+            label = batch.label[0].asnumpy()[:valid].astype(np.int64)
+            assert_almost_equal(batch.data[0].asnumpy()[:valid], dense[label])
+            seen.extend(label.tolist())
+    assert sorted(seen) == list(range(num_rows))
+    # batches stay valid after the iterator is gone
+    data_iter = mx.io.CSRShardIter(data_shard='%s_0.csr' % prefix)
+    batch = data_iter.next()
+    del data_iter
+    assert_almost_equal(batch.data[0].asnumpy(), dense[:block_size])
+
+def test_ImageRecordIter_random_access():
+    try:
+        import cv2
+    except ImportError:
+        return
+    num_images, batch_size = 20, 5
+    prefix = os.path.join(os.getcwd(), 'random_access')
+    record = mx.recordio.MXIndexedRecordIO(prefix + '.idx', prefix + '.rec', 'w')
+    for i in range(num_images):
+        img = np.full((8, 8, 3), i, dtype=np.uint8)
+        header = mx.recordio.IRHeader(0, float(i), i, 0)
+        record.write_idx(i, mx.recordio.pack_img(header, img, img_fmt='.png'))
+    record.close()
+
+    for shuffle in [False, True]:
+        data_iter = mx.io.ImageRecordIter(path_imgrec=prefix + '.rec', path_imgidx=prefix + '.idx',
+                                          random_access=True, shuffle=shuffle, data_shape=(3, 8, 8),
+                                          batch_size=batch_size, preprocess_threads=1)
+        epochs = []
+        for epoch in range(2):
+            seen = []
+            for batch in data_iter:
+                label = batch.label[0].asnumpy().astype(np.int64)
+                data = batch.data[0].asnumpy()
+                for k in range(batch_size):
+                    assert np.all(data[k] == label[k])
+                seen.extend(label.tolist())
+            assert sorted(seen) == list(range(num_images))
+            epochs.append(seen)
+            data_iter.reset()
+        if not shuffle:
+            assert epochs[0] == list(range(num_images))
+        # the same records and labels as the reader of path_imgidx
+        indexed_iter = mx.io.ImageRecordIter(path_imgrec=prefix + '.rec', path_imgidx=prefix + '.idx',
+                                             shuffle=shuffle, data_shape=(3, 8, 8),
+                                             batch_size=batch_size, preprocess_threads=1)
+        indexed = []
+        for batch in indexed_iter:
+            indexed.extend(batch.label[0].asnumpy().astype(np.int64).tolist())
+        assert sorted(indexed) == sorted(epochs[0])
+
+def test_ImageRecordUInt8Iter_layout_aug_params():
+    try:
+        import cv2
+    except ImportError:
+        return
+    num_images, batch_size = 8, 4
+    prefix = os.path.join(os.getcwd(), 'uint8_iter')
+    record = mx.recordio.MXRecordIO(prefix + '.rec', 'w')
+    images = []
+    for i in range(num_images):
+        img = np.random.randint(0, 256, size=(6, 8, 3)).astype(np.uint8)
+        header = mx.recordio.IRHeader(0, float(i), i, 0)
+        record.write(mx.recordio.pack_img(header, img, img_fmt='.png'))
+        # images are decoded as BGR and output as RGB
+        images.append(img[:, :, ::-1])
+    record.close()
+    kwargs = dict(path_imgrec=prefix + '.rec', data_shape=(3, 6, 8), batch_size=batch_size,
+                  preprocess_threads=1, shuffle=False)
+
+    # NHWC holds the same pixels as NCHW, transposed
+    nchw_iter = mx.io.ImageRecordUInt8Iter(**kwargs)
+    nhwc_iter = mx.io.ImageRecordUInt8Iter(layout='NHWC', **kwargs)
+    assert nhwc_iter.provide_data[0].shape == (batch_size, 6, 8, 3)
+    for nchw, nhwc in zip(nchw_iter, nhwc_iter):
+        label = nhwc.label[0].asnumpy().astype(np.int64)
+        data = nhwc.data[0].asnumpy()
+        assert data.dtype == np.uint8
+        for k in range(batch_size):
+            assert np.all(data[k] == images[label[k]])
+        assert np.all(nchw.data[0].asnumpy().transpose(0, 2, 3, 1) == data)
+
+    # with output_aug_params the pixels are left as decoded, and normalize_and_cast
+    # applies the augmentation the float iterator applies on the host
+    aug_kwargs = dict(mirror=True, max_random_contrast=0.3, max_random_illumination=10,
+                      scale=0.5, seed=3, **kwargs)
+    aug_iter = mx.io.ImageRecordUInt8Iter(layout='NHWC', output_aug_params=True, **aug_kwargs)
+    float_iter = mx.io.ImageRecordIter(**aug_kwargs)
+    assert [d.name for d in aug_iter.provide_data] == ['data', 'aug_params']
+    assert aug_iter.provide_data[1].shape == (batch_size, 3)
+    for batch, float_batch in zip(aug_iter, float_iter):
+        label = batch.label[0].asnumpy().astype(np.int64)
+        data, aug_params = batch.data
+        for k in range(batch_size):
+            assert np.all(data.asnumpy()[k] == images[label[k]])
+        aug = aug_params.asnumpy()
+        assert np.all(aug[:, 0] == 1)
+        assert np.all((aug[:, 1] >= 0.7 * 0.5) & (aug[:, 1] <= 1.3 * 0.5))
+        assert np.all(np.abs(aug[:, 2]) <= 10 * 0.5)
+        out = mx.nd.contrib.normalize_and_cast(data, aug_params, layout='NHWC')
+        assert_almost_equal(out.asnumpy(), float_batch.data[0].asnumpy(), rtol=1e-4, atol=1e-3)
+
+    # the uint8 pixels are never normalized on the host
+    assertRaises(mx.base.MXNetError, mx.io.ImageRecordUInt8Iter, mean_r=123.68, **kwargs)
+    assertRaises(mx.base.MXNetError, mx.io.ImageRecordUInt8Iter, max_random_contrast=0.3,
+                 **kwargs)
+
 @unittest.skip("test fails intermittently. temporarily disabled till it gets fixed. tracked at https://github.com/apache/incubator-mxnet/issues/7826")
 def test_CSVIter():
     def check_CSVIter_synthetic():
@@ -264,4 +484,6 @@ if __name__ == "__main__":
     test_Cifar10Rec()
     test_LibSVMIter()
     test_NDArrayIter_csr()
+    test_CSRShardIter()
+    test_libsvm2csr()
     test_CSVIter()
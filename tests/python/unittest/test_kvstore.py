@@ -89,6 +89,38 @@ def test_row_sparse_pull():
     check_row_sparse_pull(kv, 1)
     check_row_sparse_pull(kv, 4)
 
+def test_row_sparse_pull_shared_row_ids():
+    # several keys pull with the same row_ids, which has many duplicates
+    kv = mx.kv.create()
+    big_shape = (20000, 2)
+    keys = ['w0', 'w1', 'w2']
+    weight = np.tile(np.arange(big_shape[0]).reshape((-1, 1)), (1, big_shape[1]))
+    for i, k in enumerate(keys):
+        kv.init(k, mx.nd.array(weight + i).tostype('row_sparse'))
+    row_id = np.random.randint(big_shape[0], size=50000)
+    row_ids = mx.nd.array(row_id)
+    vals = [mx.nd.zeros(big_shape).tostype('row_sparse') for _ in keys]
+    kv.row_sparse_pull(keys, out=vals, row_ids=[row_ids] * len(keys))
+    uniq_row_id = np.unique(row_id)
+    for i, val in enumerate(vals):
+        assert_almost_equal(val.indices.asnumpy(), uniq_row_id)
+        expected = np.zeros(big_shape)
+        expected[uniq_row_id] = weight[uniq_row_id] + i
+        assert_almost_equal(val.asnumpy(), expected)
+
+def test_row_sparse_prefetch():
+    # local kvstores ignore prefetch, and pulls still return the latest rows
+    kv = init_kv_with_str('row_sparse')
+    kv.init('e', mx.nd.ones(shape).tostype('row_sparse'))
+    row_ids = mx.nd.array([0, 2, 2])
+    kv.row_sparse_prefetch('e', row_ids=row_ids)
+    kv.push('e', mx.nd.ones(shape).tostype('row_sparse') * 3)
+    val = mx.nd.zeros(shape, stype='row_sparse')
+    kv.row_sparse_pull('e', out=val, row_ids=row_ids)
+    expected = np.zeros(shape)
+    expected[[0, 2]] = 3
+    assert_almost_equal(val.asnumpy(), expected)
+
 def test_init():
     """test init"""
     def check_init(kv, key):
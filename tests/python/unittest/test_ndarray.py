@@ -267,6 +267,60 @@ def test_ndarray_saveload():
         assert np.sum(single_ndarray.asnumpy() != single_ndarray_loaded.asnumpy()) == 0
     os.remove(fname)
 
+def test_ndarray_saveload_aligned():
+    np.random.seed(0)
+    fname = 'tmp_aligned.bin'
+    data = [random_ndarray(np.random.randint(1, 5)) for i in range(10)]
+    data.append(mx.nd.arange(6, dtype='int32'))
+    mx.nd.save(fname, data, aligned=True)
+    data2 = mx.nd.load(fname, mmap=True)
+    assert len(data) == len(data2)
+    for x, y in zip(data, data2):
+        assert x.dtype == y.dtype
+        assert same(x.asnumpy(), y.asnumpy())
+    # mapped arrays can be written to without changing the file
+    data2[0][:] = 7
+    data2[1] += 1
+    assert same(data2[0].asnumpy(), np.full(data[0].shape, 7, dtype=data[0].dtype))
+    assert same(data2[1].asnumpy(), data[1].asnumpy() + 1)
+    data3 = mx.nd.load(fname, mmap=True)
+    for x, y in zip(data, data3):
+        assert same(x.asnumpy(), y.asnumpy())
+    del data2, data3
+    dmap = {'ndarray xx %s' % i : x for i, x in enumerate(data)}
+    mx.nd.save(fname, dmap, aligned=True)
+    dmap2 = mx.nd.load(fname, mmap=True)
+    assert len(dmap2) == len(dmap)
+    for k, x in dmap.items():
+        assert same(x.asnumpy(), dmap2[k].asnumpy())
+    # load some of the arrays, checking their checksums
+    keys = ['ndarray xx 3', 'ndarray xx 0']
+    dmap2 = mx.nd.load(fname, keys=keys, verify=True)
+    assert sorted(dmap2.keys()) == sorted(keys)
+    for k in keys:
+        assert same(dmap[k].asnumpy(), dmap2[k].asnumpy())
+    # sparse arrays
+    rsp = mx.nd.array(np.array([[0, 0], [1, 2], [0, 0], [3, 4]])).tostype('row_sparse')
+    csr = mx.nd.array(np.array([[0, 1, 0], [2, 0, 3]])).tostype('csr')
+    mx.nd.save(fname, {'rsp': rsp, 'csr': csr}, aligned=True)
+    for smap in [mx.nd.load(fname, mmap=True), mx.nd.load(fname, verify=True)]:
+        assert smap['rsp'].stype == 'row_sparse' and smap['csr'].stype == 'csr'
+        assert same(smap['rsp'].asnumpy(), rsp.asnumpy())
+        assert same(smap['csr'].asnumpy(), csr.asnumpy())
+    # corrupted data is detected
+    with open(fname, 'r+b') as f:
+        f.seek(64)
+        byte = f.read(1)
+        f.seek(64)
+        f.write(bytes(bytearray([ord(byte) ^ 0xff])))
+    assert_exception(mx.nd.load, mx.base.MXNetError, fname, verify=True)
+    # files in the regular format are read as usual
+    mx.nd.save(fname, data)
+    data2 = mx.nd.load(fname, mmap=True)
+    for x, y in zip(data, data2):
+        assert same(x.asnumpy(), y.asnumpy())
+    os.remove(fname)
+
 def test_ndarray_legacy_load():
     data = []
     for i in range(6):
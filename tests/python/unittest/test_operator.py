@@ -3537,6 +3537,37 @@ def test_quantization_op():
     assert same(a_.asnumpy(),  a_real.asnumpy())
 
 
+def test_normalize_and_cast_op():
+    mean = (123.68, 116.28, 103.53)
+    std = (58.395, 57.12, 57.375)
+    data = np.random.randint(0, 256, size=(4, 3, 5, 6)).astype(np.uint8)
+    aug = np.array([[0, 1.0, 0.0],
+                    [1, 1.0, 0.0],
+                    [0, 0.5, 10.0],
+                    [1, 2.0, -3.0]], dtype=np.float32)
+    expected = data.astype(np.float32)
+    for n in range(aug.shape[0]):
+        if aug[n, 0]:
+            expected[n] = expected[n, :, :, ::-1]
+        for c in range(3):
+            expected[n, c] = (expected[n, c] - mean[c]) * aug[n, 1] / std[c] + aug[n, 2] / std[c]
+    for layout in ['NCHW', 'NHWC']:
+        x = data if layout == 'NCHW' else data.transpose(0, 2, 3, 1)
+        out = mx.nd.contrib.normalize_and_cast(mx.nd.array(x, dtype=np.uint8), mx.nd.array(aug),
+                                               mean=mean, std=std, layout=layout)
+        assert out.dtype == np.float32
+        assert out.shape == data.shape
+        assert_almost_equal(out.asnumpy(), expected, rtol=1e-4, atol=1e-4)
+    # shape and type inference from the symbol
+    sym = mx.sym.contrib.normalize_and_cast(mx.sym.Variable('data'), mx.sym.Variable('aug_params'),
+                                            layout='NHWC', out_type='float16')
+    arg_shapes, out_shapes, _ = sym.infer_shape(data=(8, 32, 32, 3))
+    assert arg_shapes[1] == (8, 3)
+    assert out_shapes[0] == (8, 3, 32, 32)
+    _, out_types, _ = sym.infer_type(data=np.uint8)
+    assert out_types[0] == np.float16
+
+
 def test_reciprocal_op():
     data_tmp = np.random.rand(3, 4) * 10 - 5
     # Avoid possible division by 0 errors
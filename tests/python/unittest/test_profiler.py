@@ -60,5 +60,57 @@ def test_profiler():
     print('duration: {0}s'.format(duration))
     print('          {0}ms/operator'.format(duration*1000/iter_num))
 
+def test_aggregate_stats():
+    iter_num = 10
+    profiler.profiler_set_config(mode='symbolic', filename='test_profile.json',
+                                 aggregate_stats=True)
+
+    A = mx.sym.Variable('A')
+    B = mx.sym.Variable('B')
+    C = mx.symbol.dot(A, B)
+    executor = C.simple_bind(mx.cpu(), 'write', A=(128, 128), B=(128, 128))
+    # aggregate_stats is kept when not given
+    profiler.profiler_set_config(mode='symbolic', filename='test_profile.json')
+
+    profiler.aggregate_stats(reset=True)
+    profiler.profiler_set_state('run')
+    for i in range(iter_num):
+        executor.forward()
+        executor.outputs[0].wait_to_read()
+    profiler.profiler_set_state('stop')
+
+    stats = profiler.aggregate_stats(reset=True)
+    assert 'cpu/0' in stats
+    dot_stats = [v for k, v in stats['cpu/0'].items() if 'dot' in k]
+    assert len(dot_stats) == 1
+    s = dot_stats[0]
+    assert s['count'] == iter_num
+    assert s['min'] <= s['mean'] <= s['max']
+    assert s['min'] <= s['p99'] <= s['max']
+    assert s['total'] >= s['max']
+    assert profiler.aggregate_stats() == {}
+    profiler.profiler_set_config(mode='symbolic', filename='test_profile.json',
+                                 aggregate_stats=False)
+
+def test_memory_stats():
+    a = mx.nd.zeros((1024, 1024), ctx=mx.cpu())
+    a.wait_to_read()
+    stats = profiler.memory_stats(reset_peak=True)
+    assert 'cpu/0' in stats
+    s = stats['cpu/0']
+    assert s['num_alloc'] >= 1
+    assert s['peak'] >= s['used'] >= a.size * 4
+
+    data = mx.sym.Variable('data')
+    fc = mx.sym.FullyConnected(data, num_hidden=16, name='fc')
+    executor = fc.simple_bind(mx.cpu(), 'null', data=(8, 32))
+    report = executor.debug_str()
+    assert 'Memory per node' in report
+    line = [l for l in report.split('\n') if l.startswith('\tfc\t')]
+    assert len(line) == 1
+    assert int(line[0].split('\t')[2]) == 8 * 16 * 4
+
 if __name__ == '__main__':
     test_profiler()
+    test_aggregate_stats()
+    test_memory_stats()
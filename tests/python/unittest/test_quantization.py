@@ -0,0 +1,214 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import mxnet as mx
+import numpy as np
+from common import assertRaises
+from mxnet.test_utils import assert_almost_equal, rand_ndarray
+
+
+def quantize_int8(data):
+    return mx.nd.contrib.quantize(data=data, min_range=mx.nd.min(data),
+                                  max_range=mx.nd.max(data), out_type='int8')
+
+
+def dequantize(data, min_range, max_range):
+    return mx.nd.contrib.dequantize(data, min_range, max_range, out_type='float32')
+
+
+def test_quantize_int8():
+    a = mx.nd.array(np.random.uniform(-2, 1, size=(4, 5)))
+    qa, min_a, max_a = quantize_int8(a)
+    assert qa.dtype == np.int8
+    real_range = np.abs(a.asnumpy()).max()
+    assert_almost_equal(min_a.asnumpy(), np.array([-real_range]))
+    assert_almost_equal(max_a.asnumpy(), np.array([real_range]))
+    assert np.abs(qa.asnumpy()).max() == 127
+    a_ = dequantize(qa, min_a, max_a)
+    assert np.abs(a_.asnumpy() - a.asnumpy()).max() <= real_range / 127 / 2 + 1e-6
+
+
+def test_quantized_fully_connected():
+    def check_quantized_fully_connected(data_shape, num_hidden):
+        data = mx.nd.array(np.random.uniform(-1, 1, size=data_shape))
+        num_input = int(np.prod(data_shape[1:]))
+        weight = mx.nd.array(np.random.uniform(-1, 1, size=(num_hidden, num_input)))
+        bias = mx.nd.array(np.random.uniform(-1, 1, size=(num_hidden,)))
+        qdata, min_data, max_data = quantize_int8(data)
+        qweight, min_weight, max_weight = quantize_int8(weight)
+        qbias, min_bias, max_bias = quantize_int8(bias)
+        out, min_out, max_out = mx.nd.contrib.quantized_fully_connected(
+            data=qdata, weight=qweight, bias=qbias, min_data=min_data, max_data=max_data,
+            min_weight=min_weight, max_weight=max_weight, min_bias=min_bias,
+            max_bias=max_bias, num_hidden=num_hidden)
+        assert out.dtype == np.int32
+        expected = mx.nd.FullyConnected(dequantize(qdata, min_data, max_data),
+                                        dequantize(qweight, min_weight, max_weight),
+                                        dequantize(qbias, min_bias, max_bias),
+                                        num_hidden=num_hidden)
+        unit = max_out.asscalar() / (2 ** 31 - 1)
+        assert_almost_equal(dequantize(out, min_out, max_out).asnumpy(), expected.asnumpy(),
+                            rtol=1e-4, atol=unit)
+
+    check_quantized_fully_connected((3, 2, 4), 6)
+    # several tiles of the output and blocks of the inner dimension
+    check_quantized_fully_connected((37, 300), 261)
+
+
+def test_quantized_conv():
+    def check_quantized_conv(data_shape, kernel, stride, pad, num_filter):
+        data = mx.nd.array(np.random.uniform(-1, 1, size=data_shape))
+        weight = mx.nd.array(np.random.uniform(-1, 1, size=(num_filter, data_shape[1]) + kernel))
+        bias = mx.nd.array(np.random.uniform(-1, 1, size=(num_filter,)))
+        qdata, min_data, max_data = quantize_int8(data)
+        qweight, min_weight, max_weight = quantize_int8(weight)
+        qbias, min_bias, max_bias = quantize_int8(bias)
+        params = {'kernel': kernel, 'stride': stride, 'pad': pad, 'num_filter': num_filter}
+        out, min_out, max_out = mx.nd.contrib.quantized_conv(
+            data=qdata, weight=qweight, bias=qbias, min_data=min_data, max_data=max_data,
+            min_weight=min_weight, max_weight=max_weight, min_bias=min_bias,
+            max_bias=max_bias, **params)
+        expected = mx.nd.Convolution(dequantize(qdata, min_data, max_data),
+                                     dequantize(qweight, min_weight, max_weight),
+                                     dequantize(qbias, min_bias, max_bias), **params)
+        assert out.shape == expected.shape
+        unit = max_out.asscalar() / (2 ** 31 - 1)
+        assert_almost_equal(dequantize(out, min_out, max_out).asnumpy(), expected.asnumpy(),
+                            rtol=1e-4, atol=unit)
+
+    check_quantized_conv((2, 3, 7, 6), (3, 3), (2, 1), (1, 1), 4)
+    # several tiles of the output and blocks of the inner dimension
+    check_quantized_conv((2, 8, 18, 17), (5, 5), (1, 1), (2, 2), 37)
+
+
+def test_quantized_pooling():
+    data = mx.nd.array(np.random.uniform(-1, 1, size=(2, 3, 7, 7)))
+    qdata, min_data, max_data = quantize_int8(data)
+    fdata = dequantize(qdata, min_data, max_data)
+    unit = max_data.asscalar() / 127
+    for pool_type in ['max', 'avg']:
+        for params in [{'kernel': (3, 3), 'stride': (2, 2), 'pad': (1, 1)},
+                       {'kernel': (3, 3), 'stride': (2, 2), 'pooling_convention': 'full'},
+                       {'kernel': (1, 1), 'global_pool': True}]:
+            out, min_out, max_out = mx.nd.contrib.quantized_pooling(
+                qdata, min_data, max_data, pool_type=pool_type, **params)
+            expected = mx.nd.Pooling(fdata, pool_type=pool_type, **params)
+            assert out.shape == expected.shape
+            assert_almost_equal(dequantize(out, min_out, max_out).asnumpy(),
+                                expected.asnumpy(), rtol=0, atol=unit / 2 + 1e-6)
+
+
+def test_requantize():
+    data = mx.nd.array(np.array([[-1000, 20], [500, 3000]]), dtype='int32')
+    min_range = mx.nd.array([-2.0])
+    max_range = mx.nd.array([2.0])
+    real = data.asnumpy() * 2.0 / (2 ** 31 - 1)
+    out, min_out, max_out = mx.nd.contrib.requantize(data, min_range, max_range)
+    assert out.dtype == np.int8
+    assert_almost_equal(max_out.asnumpy(), np.array([np.abs(real).max()]), rtol=1e-5)
+    assert_almost_equal(dequantize(out, min_out, max_out).asnumpy(), real,
+                        rtol=0, atol=max_out.asscalar() / 127)
+    # a calibrated range saturates the values outside of it
+    calib = real[1, 0]
+    out, min_out, max_out = mx.nd.contrib.requantize(data, min_range, max_range,
+                                                     min_calib_range=-calib,
+                                                     max_calib_range=calib)
+    assert_almost_equal(max_out.asnumpy(), np.array([calib]), rtol=1e-5)
+    assert out.asnumpy()[1, 0] == 127 and out.asnumpy()[1, 1] == 127
+
+
+def test_quantize_model():
+    data = mx.sym.Variable('data')
+    conv = mx.sym.Convolution(data, kernel=(3, 3), num_filter=8, pad=(1, 1), name='conv0')
+    pool = mx.sym.Pooling(conv, kernel=(2, 2), stride=(2, 2), pool_type='max', name='pool0')
+    act = mx.sym.Activation(pool, act_type='relu', name='relu0')
+    fc = mx.sym.FullyConnected(act, num_hidden=10, name='fc0')
+    data_shape = (4, 3, 8, 8)
+    arg_shapes, _, _ = fc.infer_shape(data=data_shape)
+    arg_params = {name: mx.nd.array(np.random.uniform(-1, 1, size=shape))
+                  for name, shape in zip(fc.list_arguments(), arg_shapes) if name != 'data'}
+    samples = mx.nd.array(np.random.uniform(-1, 1, size=(16,) + data_shape[1:]))
+    calib_data = mx.io.NDArrayIter(data=samples, batch_size=data_shape[0])
+
+    def run(sym, args):
+        exe = sym.simple_bind(mx.cpu(), data=data_shape, grad_req='null')
+        for name, arr in args.items():
+            if name in exe.arg_dict:
+                exe.arg_dict[name][:] = arr
+        exe.arg_dict['data'][:] = samples[:data_shape[0]]
+        return exe.forward()[0].asnumpy()
+
+    expected = run(fc, arg_params)
+    for calib_mode in ['none', 'naive']:
+        qsym, qarg_params, _ = mx.contrib.quantization.quantize_model(
+            fc, arg_params, {}, calib_mode=calib_mode, calib_data=calib_data)
+        internals = qsym.get_internals().list_outputs()
+        for name in ['quantized_conv0_output', 'quantized_pool0_output',
+                     'quantized_fc0_output']:
+            assert name in internals
+        assert 'conv0_weight_quantize' in qsym.list_arguments()
+        output = run(qsym, qarg_params)
+        assert np.abs(output - expected).max() < 0.05 * np.abs(expected).max()
+    # excluded layers stay in float
+    qsym, _, _ = mx.contrib.quantization.quantize_model(fc, arg_params, {}, calib_mode='none',
+                                                        excluded_sym_names=['fc0'])
+    assert 'quantized_fc0_output' not in qsym.get_internals().list_outputs()
+    assert 'fc0_output' in qsym.get_internals().list_outputs()
+    # calibration is off by default and needs calib_data when on
+    qsym, _, _ = mx.contrib.quantization.quantize_model(fc, arg_params, {})
+    assert 'quantized_fc0_output' in qsym.get_internals().list_outputs()
+    assertRaises(ValueError, mx.contrib.quantization.quantize_model, fc, arg_params, {},
+                 calib_mode='naive')
+
+
+def test_quantize_model_shared_inputs():
+    # two layers reading the same data with a tied weight
+    data = mx.sym.Variable('data')
+    weight = mx.sym.Variable('weight')
+    bias = mx.sym.Variable('bias')
+    fc0 = mx.sym.FullyConnected(data, weight=weight, bias=bias, num_hidden=16, name='fc0')
+    fc1 = mx.sym.FullyConnected(data, weight=weight, bias=bias, num_hidden=16, name='fc1')
+    out = fc0 + fc1
+    data_shape = (4, 16)
+    arg_shapes, _, _ = out.infer_shape(data=data_shape)
+    arg_params = {name: mx.nd.array(np.random.uniform(-1, 1, size=shape))
+                  for name, shape in zip(out.list_arguments(), arg_shapes) if name != 'data'}
+    samples = mx.nd.array(np.random.uniform(-1, 1, size=data_shape))
+
+    def run(sym, args):
+        exe = sym.simple_bind(mx.cpu(), data=data_shape, grad_req='null')
+        for name, arr in args.items():
+            if name in exe.arg_dict:
+                exe.arg_dict[name][:] = arr
+        exe.arg_dict['data'][:] = samples
+        return exe.forward()[0].asnumpy()
+
+    expected = run(out, arg_params)
+    qsym, qarg_params, _ = mx.contrib.quantization.quantize_model(out, arg_params, {})
+    args = qsym.list_arguments()
+    assert len(args) == len(set(args))
+    assert 'weight_quantize' in args
+    # the data is quantized once for both layers
+    internals = qsym.get_internals().list_outputs()
+    assert internals.count('data_quantize_output') == 1
+    output = run(qsym, qarg_params)
+    assert np.abs(output - expected).max() < 0.05 * np.abs(expected).max()
+
+
+if __name__ == '__main__':
+    import nose
+    nose.runmodule()
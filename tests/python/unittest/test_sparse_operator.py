@@ -16,6 +16,7 @@
 # under the License.
 
 from mxnet.test_utils import *
+from common import assertRaises
 import random
 import warnings
 
@@ -1215,6 +1216,9 @@ def test_sparse_dot():
         for rhs_d in density:
             test_dot_csr(lhs_shape, (lhs_shape[1], rnd.randint(1, 10)), 'row_sparse', False, lhs_d, rhs_d)
             test_dot_csr(lhs_shape, (lhs_shape[0], rnd.randint(1, 10)), 'row_sparse', True, lhs_d, rhs_d)
+    # wide and very sparse lhs: most columns are empty, so most rows of the transposed product are zero
+    test_dot_csr((100, 5000), (100, rnd.randint(1, 10)), 'default', True, 0.001, 1)
+    test_dot_csr((100, 5000), (5000, rnd.randint(1, 10)), 'default', False, 0.001, 1)
 
 
 def test_sparse_slice():
@@ -1264,6 +1268,34 @@ def test_sparse_retain():
             check_sparse_retain(shape_3d, density, itype)
 
 
+def test_sparse_embedding_grad():
+    def check_sparse_embedding_grad(in_dim, out_dim, batch):
+        data = mx.sym.Variable("data")
+        embed = mx.sym.Embedding(data=data, input_dim=in_dim, output_dim=out_dim,
+                                 sparse_grad=True, name="embed")
+        exe_test = embed.simple_bind(default_context(), grad_req={'data': 'null', 'embed_weight': 'write'},
+                                     data=(batch,))
+        arg_map = dict(zip(embed.list_arguments(), exe_test.arg_arrays))
+        grad_map = dict(zip(embed.list_arguments(), exe_test.grad_arrays))
+        # repeated indices are summed into one row
+        np_data = np.random.randint(low=0, high=in_dim, size=batch)
+        np_onehot = np.zeros((batch, in_dim))
+        np_onehot[np.arange(batch), np_data] = 1.0
+        arg_map["data"][:] = np_data
+        arg_map["embed_weight"][:] = np.random.uniform(-0.01, 0.01, (in_dim, out_dim))
+        exe_test.forward(is_train=True)
+        np_grad = np.random.uniform(-1, 1, exe_test.outputs[0].shape)
+        exe_test.backward([mx.nd.array(np_grad)])
+        weight_grad = grad_map["embed_weight"]
+        assert weight_grad.stype == 'row_sparse'
+        assert same(weight_grad.indices.asnumpy(), np.unique(np_data))
+        assert_almost_equal(weight_grad.asnumpy(), np.dot(np_onehot.T, np_grad))
+
+    check_sparse_embedding_grad(10, 4, 24)
+    check_sparse_embedding_grad(1000, 8, 1)
+    check_sparse_embedding_grad(50000, 16, 3000)
+
+
 def test_sparse_unary_with_numerics():
     def check_sparse_simple(name, stype, mxnet_func, forward_numpy_call,
                             backward_numpy_call, output_grad_stype=None,
@@ -1367,10 +1399,11 @@ def test_sparse_sum_axis():
             csr_array = rand_ndarray(shape=shape, stype='csr', density=density)
             dns = csr_array.tostype('default')
             for axis in axes:
-                ret = mx.nd.sum(csr_array, axis=axis)
-                assert ret.stype == 'default'
-                ret_expected = mx.nd.sum(dns, axis=axis)
-                assert_almost_equal(ret.asnumpy(), ret_expected.asnumpy())
+                for reduce_op in [mx.nd.sum, mx.nd.mean]:
+                    ret = reduce_op(csr_array, axis=axis)
+                    assert ret.stype == 'default'
+                    ret_expected = reduce_op(dns, axis=axis)
+                    assert_almost_equal(ret.asnumpy(), ret_expected.asnumpy())
 
     def test_fallback(axis=0, keepdims=True, exclude=True):
         dim0 = 30
@@ -1383,6 +1416,52 @@ def test_sparse_sum_axis():
     test_variations()
     test_fallback(axis=0, keepdims=True, exclude=True)
 
+def test_sparse_csr_unary():
+    def check_csr_unary(shape, density):
+        csr = rand_ndarray(shape, 'csr', density=density)
+        dns = csr.tostype('default')
+        ops = [mx.nd.abs, mx.nd.sign, mx.nd.sqrt, mx.nd.floor, mx.nd.ceil, mx.nd.log1p,
+               mx.nd.expm1, mx.nd.sin, mx.nd.tanh, mx.nd.arctan, mx.nd.degrees,
+               lambda x: x / 4.0]
+        for op in ops:
+            ret = op(csr)
+            assert ret.stype == 'csr'
+            assert_almost_equal(ret.asnumpy(), op(dns).asnumpy())
+
+    for density in [0, 0.3, 1]:
+        check_csr_unary(rand_shape_2d(), density)
+
+
+def test_sparse_broadcast_csr_dns():
+    def check_broadcast_csr_dns(op, shape, rhs_shape, density, rhs=None):
+        csr = rand_ndarray(shape, 'csr', density=density)
+        if rhs is None:
+            rhs = mx.nd.random.uniform(1, 2, shape=rhs_shape)
+        ret = op(csr, rhs)
+        assert ret.stype == 'csr'
+        assert_almost_equal(ret.asnumpy(), op(csr.tostype('default'), rhs).asnumpy(),
+                            equal_nan=True)
+
+    m, n = rand_shape_2d()
+    for op in [mx.nd.broadcast_mul, mx.nd.broadcast_div]:
+        for rhs_shape in [(1, n), (m, 1), (n,), (1, 1), (m, n)]:
+            for density in [0, 0.3, 1]:
+                check_broadcast_csr_dns(op, (m, n), rhs_shape, density)
+        # csr is broadcast too
+        for shape, rhs_shape in [((1, n), (m, 1)), ((m, 1), (1, n)), ((1, 1), (m, n)),
+                                 ((1, n), (m, n))]:
+            for density in [0, 0.3, 1]:
+                check_broadcast_csr_dns(op, shape, rhs_shape, density)
+        # a rhs with more dims than csr gives an output csr cannot hold
+        csr = rand_ndarray((m, n), 'csr', density=0.3)
+        assertRaises(mx.base.MXNetError, lambda: op(csr, mx.nd.ones((2, m, n))).wait_to_read())
+    # the zeros of csr divided by zero follow the dense result
+    rhs = mx.nd.array(np.random.randint(0, 2, size=(m, n)))
+    for density in [0, 0.3, 1]:
+        check_broadcast_csr_dns(mx.nd.broadcast_div, (m, n), None, density, rhs=rhs)
+        check_broadcast_csr_dns(mx.nd.broadcast_div, (m, n), None, density, rhs=rhs[0:1])
+
+
 def test_sparse_square_sum():
     if default_context().device_type == 'cpu':
         dim0 = 30
@@ -20,6 +20,8 @@
 /*!
  * \file im2rec.cc
  * \brief convert images into image recordio format
+ *  Images are packed by a pool of threads and can be written into several
+ *  shards, each with an .idx file of "image_id\toffset" lines.
  *  Image Record Format: zeropad[64bit] imid[64bit] img-binary-content
  *  The 64bit zero pad was reserved for future purposes
  *
@@ -28,6 +30,7 @@
  */
 #include <cctype>
 #include <cstring>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <iomanip>
@@ -40,6 +43,9 @@
 #include <opencv2/opencv.hpp>
 #include "../src/io/image_recordio.h"
 #include <random>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 /*!
  *\brief get interpolation method with given inter_method, 0-CV_INTER_NN 1-CV_INTER_LINEAR 2-CV_INTER_CUBIC
  *\ 3-CV_INTER_AREA 4-CV_INTER_LANCZOS4 9-AUTO(cubic for enlarge, area for shrink, bilinear for others) 10-RAND(0-4)
@@ -60,6 +66,127 @@ int GetInterMethod(int inter_method, int old_width, int old_height, int new_widt
         return inter_method;
     }
 }
+/*!
+ *\brief output paths of each shard. A single shard keeps the given name, otherwise
+ *\ shard k of prefix.rec is written to prefix_k.rec. The index of x.rec is x.idx.
+ */
+void GetShardPaths(const std::string& output, int num_shards,
+                   std::vector<std::string>* rec_paths,
+                   std::vector<std::string>* idx_paths) {
+  const std::string ext(".rec");
+  std::string base = output;
+  bool has_ext = base.length() > ext.length() &&
+      base.compare(base.length() - ext.length(), ext.length(), ext) == 0;
+  if (has_ext) base.resize(base.length() - ext.length());
+  rec_paths->clear();
+  idx_paths->clear();
+  for (int k = 0; k < num_shards; ++k) {
+    std::string name = base;
+    if (num_shards != 1) name += "_" + std::to_string(k);
+    rec_paths->push_back(num_shards == 1 ? output : name + ext);
+    idx_paths->push_back(name + ".idx");
+  }
+}
+/*!
+ *\brief parse one line of the image list and pack the image into a record blob.
+ *\ Thread safe as long as each caller passes its own prnd. Returns false if the line is empty.
+ */
+bool PackImage(const std::string& sline, const std::string& root,
+               int label_width, int pack_label, int new_size, int center_crop,
+               int color_mode, int unchanged, int inter_method,
+               const std::string& encoding, const std::vector<int>& encode_params,
+               std::mt19937* prnd, uint64_t* image_id, std::string* blob) {
+  using dmlc::BeginPtr;
+  const static size_t kBufferSize = 1 << 20UL;
+  mxnet::io::ImageRecordIO rec;
+  std::vector<float> label_buf(label_width, 0.f);
+  std::istringstream is(sline);
+  if (!(is >> rec.header.image_id[0] >> rec.header.label)) return false;
+  *image_id = rec.header.image_id[0];
+  label_buf[0] = rec.header.label;
+  for (int k = 1; k < label_width; ++k) {
+    CHECK(is >> label_buf[k])
+        << "Invalid ImageList, did you provide the correct label_width?";
+  }
+  if (pack_label) rec.header.flag = label_width;
+  rec.SaveHeader(blob);
+  if (pack_label) {
+    size_t bsize = blob->size();
+    blob->resize(bsize + label_buf.size()*sizeof(float));
+    memcpy(BeginPtr(*blob) + bsize,
+           BeginPtr(label_buf), label_buf.size()*sizeof(float));
+  }
+  std::string fname;
+  CHECK(std::getline(is, fname));
+  // eliminate invalid chars in the end
+  while (fname.length() != 0 &&
+         (isspace(*fname.rbegin()) || !isprint(*fname.rbegin()))) {
+    fname.resize(fname.length() - 1);
+  }
+  // eliminate invalid chars in beginning.
+  const char *p = fname.c_str();
+  while (isspace(*p)) ++p;
+  std::string path = root + p;
+  // use "r" is equal to rb in dmlc::Stream
+  dmlc::Stream *fi = dmlc::Stream::Create(path.c_str(), "r");
+  std::vector<unsigned char> decode_buf;
+  size_t imsize = 0;
+  while (true) {
+    decode_buf.resize(imsize + kBufferSize);
+    size_t nread = fi->Read(BeginPtr(decode_buf) + imsize, kBufferSize);
+    imsize += nread;
+    decode_buf.resize(imsize);
+    if (nread != kBufferSize) break;
+  }
+  delete fi;
+
+  if (unchanged != 1) {
+    cv::Mat img = cv::imdecode(decode_buf, color_mode);
+    CHECK(img.data != NULL) << "OpenCV decode fail:" << path;
+    cv::Mat res = img;
+    if (new_size > 0) {
+      if (center_crop) {
+        if (img.rows > img.cols) {
+          int margin = (img.rows - img.cols)/2;
+          img = img(cv::Range(margin, margin+img.cols), cv::Range(0, img.cols));
+        } else {
+          int margin = (img.cols - img.rows)/2;
+          img = img(cv::Range(0, img.rows), cv::Range(margin, margin + img.rows));
+        }
+      }
+      int interpolation_method = 1;
+      if (img.rows > img.cols) {
+          if (img.cols != new_size) {
+              interpolation_method = GetInterMethod(inter_method, img.cols, img.rows, new_size, img.rows * new_size / img.cols, *prnd);
+              cv::resize(img, res, cv::Size(new_size, img.rows * new_size / img.cols), 0, 0, interpolation_method);
+          } else {
+              res = img.clone();
+          }
+      } else {
+          if (img.rows != new_size) {
+              interpolation_method = GetInterMethod(inter_method, img.cols, img.rows, new_size * img.cols / img.rows, new_size, *prnd);
+              cv::resize(img, res, cv::Size(new_size * img.cols / img.rows, new_size), 0, 0, interpolation_method);
+          } else {
+              res = img.clone();
+          }
+      }
+    }
+    std::vector<unsigned char> encode_buf;
+    CHECK(cv::imencode(encoding, res, encode_buf, encode_params));
+
+    // write buffer
+    size_t bsize = blob->size();
+    blob->resize(bsize + encode_buf.size());
+    memcpy(BeginPtr(*blob) + bsize,
+           BeginPtr(encode_buf), encode_buf.size());
+  } else {
+    size_t bsize = blob->size();
+    blob->resize(bsize + decode_buf.size());
+    memcpy(BeginPtr(*blob) + bsize,
+           BeginPtr(decode_buf), decode_buf.size());
+  }
+  return true;
+}
 int main(int argc, char *argv[]) {
   if (argc < 4) {
     printf("Usage: <image.lst> <image_root_dir> <output.rec> [additional parameters in form key=value]\n"\
@@ -74,7 +201,9 @@ int main(int argc, char *argv[]) {
            "\tquality=QUALITY[default=95] JPEG quality for encoding (1-100, default: 95) or PNG compression for encoding (1-9, default: 3).\n"\
            "\tencoding=ENCODING[default='.jpg'] Encoding type. Can be '.jpg' or '.png'\n"\
            "\tinter_method=INTER_METHOD[default=1] NN(0) BILINEAR(1) CUBIC(2) AREA(3) LANCZOS4(4) AUTO(9) RAND(10).\n"\
-           "\tunchanged=UNCHANGED[default=0] Keep the original image encoding, size and color. If set to 1, it will ignore the others parameters.\n");
+           "\tunchanged=UNCHANGED[default=0] Keep the original image encoding, size and color. If set to 1, it will ignore the others parameters.\n"\
+           "\tnthread=NTHREAD[default=4] number of threads used to read, decode, resize and encode images\n"\
+           "\tnum_shards=NUM_SHARDS[default=1] write records round-robin into NUM_SHARDS files output_k.rec, each with a matching output_k.idx\n");
     return 0;
   }
   int label_width = 1;
@@ -87,6 +216,8 @@ int main(int argc, char *argv[]) {
   int color_mode = CV_LOAD_IMAGE_COLOR;
   int unchanged = 0;
   int inter_method = CV_INTER_LINEAR;
+  int nthread = 4;
+  int num_shards = 1;
   std::string encoding(".jpg");
   for (int i = 4; i < argc; ++i) {
     char key[128], val[128];
@@ -110,6 +241,8 @@ int main(int argc, char *argv[]) {
       if (!strcmp(key, "encoding")) encoding = std::string(val);
       if (!strcmp(key, "unchanged")) unchanged = atoi(val);
       if (!strcmp(key, "inter_method")) inter_method = atoi(val);
+      if (!strcmp(key, "nthread")) nthread = atoi(val);
+      if (!strcmp(key, "num_shards")) num_shards = atoi(val);
     }
   }
   // Check parameters ranges
@@ -166,12 +299,14 @@ int main(int argc, char *argv[]) {
             return 0;
       }
   }
-  std::random_device rd;
-  std::mt19937 prnd(rd());
+  if (nthread < 1) nthread = 1;
+  if (num_shards < 1) {
+    LOG(FATAL) << "num_shards must be at least 1.";
+  }
+  LOG(INFO) << "Packing with " << nthread << " threads into "
+            << num_shards << " shard(s)";
   using namespace dmlc;
-  const static size_t kBufferSize = 1 << 20UL;
   std::string root = argv[2];
-  mxnet::io::ImageRecordIO rec;
   size_t imcnt = 0;
   double tstart = dmlc::GetTime();
   dmlc::InputSplit *flist = dmlc::InputSplit::
@@ -182,13 +317,17 @@ int main(int argc, char *argv[]) {
   } else {
     os << argv[3] << ".part" << std::setw(3) << std::setfill('0') << partid;
   }
-  LOG(INFO) << "Write to output: " << os.str();
-  dmlc::Stream *fo = dmlc::Stream::Create(os.str().c_str(), "w");
-  LOG(INFO) << "Output: " << os.str();
-  dmlc::RecordIOWriter writer(fo);
-  std::string fname, path, blob;
-  std::vector<unsigned char> decode_buf;
-  std::vector<unsigned char> encode_buf;
+  std::vector<std::string> rec_paths, idx_paths;
+  GetShardPaths(os.str(), num_shards, &rec_paths, &idx_paths);
+  std::vector<dmlc::Stream*> fo(num_shards);
+  std::vector<dmlc::Stream*> fidx(num_shards);
+  std::vector<dmlc::RecordIOWriter*> writers(num_shards);
+  for (int k = 0; k < num_shards; ++k) {
+    LOG(INFO) << "Write to output: " << rec_paths[k] << ", index: " << idx_paths[k];
+    fo[k] = dmlc::Stream::Create(rec_paths[k].c_str(), "w");
+    fidx[k] = dmlc::Stream::Create(idx_paths[k].c_str(), "w");
+    writers[k] = new dmlc::RecordIOWriter(fo[k]);
+  }
   std::vector<int> encode_params;
   if (encoding == std::string(".png")) {
       encode_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
@@ -199,104 +338,74 @@ int main(int argc, char *argv[]) {
       encode_params.push_back(quality);
       LOG(INFO) << "JPEG encoding quality: " << quality;
   }
-  dmlc::InputSplit::Blob line;
-  std::vector<float> label_buf(label_width, 0.f);
+  // one random engine per thread so that RAND inter_method needs no locking
+  std::random_device rd;
+  std::vector<std::mt19937> prnds;
+  for (int i = 0; i < nthread; ++i) prnds.emplace_back(rd());
 
-  while (flist->NextRecord(&line)) {
-    std::string sline(static_cast<char*>(line.dptr), line.size);
-    std::istringstream is(sline);
-    if (!(is >> rec.header.image_id[0] >> rec.header.label)) continue;
-    label_buf[0] = rec.header.label;
-    for (int k = 1; k < label_width; ++k) {
-      CHECK(is >> label_buf[k])
-          << "Invalid ImageList, did you provide the correct label_width?";
-    }
-    if (pack_label) rec.header.flag = label_width;
-    rec.SaveHeader(&blob);
-    if (pack_label) {
-      size_t bsize = blob.size();
-      blob.resize(bsize + label_buf.size()*sizeof(float));
-      memcpy(BeginPtr(blob) + bsize,
-             BeginPtr(label_buf), label_buf.size()*sizeof(float));
+  dmlc::InputSplit::Blob line;
+  // list lines are read in batches; each batch is packed in parallel and then
+  // written out in list order, so the output does not depend on nthread
+  const size_t kBatchSize = static_cast<size_t>(nthread) * 64;
+  std::vector<std::string> lines;
+  std::vector<std::string> blobs;
+  std::vector<uint64_t> image_ids;
+  std::vector<int> valid;
+  bool eof = false;
+  while (!eof) {
+    lines.clear();
+    while (lines.size() < kBatchSize) {
+      if (!flist->NextRecord(&line)) {
+        eof = true;
+        break;
+      }
+      lines.emplace_back(static_cast<char*>(line.dptr), line.size);
     }
-    CHECK(std::getline(is, fname));
-    // eliminate invalid chars in the end
-    while (fname.length() != 0 &&
-           (isspace(*fname.rbegin()) || !isprint(*fname.rbegin()))) {
-      fname.resize(fname.length() - 1);
+    const int nline = static_cast<int>(lines.size());
+    if (nline == 0) break;
+    blobs.resize(nline);
+    image_ids.resize(nline);
+    valid.assign(nline, 0);
+    #pragma omp parallel for schedule(dynamic) num_threads(nthread)
+    for (int i = 0; i < nline; ++i) {
+      int tid = 0;
+#ifdef _OPENMP
+      tid = omp_get_thread_num();
+#endif
+      valid[i] = PackImage(lines[i], root, label_width, pack_label, new_size,
+                           center_crop, color_mode, unchanged, inter_method,
+                           encoding, encode_params, &prnds[tid],
+                           &image_ids[i], &blobs[i]);
     }
-    // eliminate invalid chars in beginning.
-    const char *p = fname.c_str();
-    while (isspace(*p)) ++p;
-    path = root + p;
-    // use "r" is equal to rb in dmlc::Stream
-    dmlc::Stream *fi = dmlc::Stream::Create(path.c_str(), "r");
-    decode_buf.clear();
-    size_t imsize = 0;
-    while (true) {
-      decode_buf.resize(imsize + kBufferSize);
-      size_t nread = fi->Read(BeginPtr(decode_buf) + imsize, kBufferSize);
-      imsize += nread;
-      decode_buf.resize(imsize);
-      if (nread != kBufferSize) break;
+    // record j of the list goes to shard j % num_shards
+    std::vector<size_t> seq(nline);
+    size_t nvalid = 0;
+    for (int i = 0; i < nline; ++i) {
+      if (valid[i]) seq[i] = imcnt + nvalid++;
     }
-    delete fi;
-
-
-    if (unchanged != 1) {
-      cv::Mat img = cv::imdecode(decode_buf, color_mode);
-      CHECK(img.data != NULL) << "OpenCV decode fail:" << path;
-      cv::Mat res = img;
-      if (new_size > 0) {
-        if (center_crop) {
-          if (img.rows > img.cols) {
-            int margin = (img.rows - img.cols)/2;
-            img = img(cv::Range(margin, margin+img.cols), cv::Range(0, img.cols));
-          } else {
-            int margin = (img.cols - img.rows)/2;
-            img = img(cv::Range(0, img.rows), cv::Range(margin, margin + img.rows));
-          }
-        }
-        int interpolation_method = 1;
-        if (img.rows > img.cols) {
-            if (img.cols != new_size) {
-                interpolation_method = GetInterMethod(inter_method, img.cols, img.rows, new_size, img.rows * new_size / img.cols, prnd);
-                cv::resize(img, res, cv::Size(new_size, img.rows * new_size / img.cols), 0, 0, interpolation_method);
-            } else {
-                res = img.clone();
-            }
-        } else {
-            if (img.rows != new_size) {
-                interpolation_method = GetInterMethod(inter_method, img.cols, img.rows, new_size * img.cols / img.rows, new_size, prnd);
-                cv::resize(img, res, cv::Size(new_size * img.cols / img.rows, new_size), 0, 0, interpolation_method);
-            } else {
-                res = img.clone();
-            }
-        }
+    #pragma omp parallel for num_threads(std::min(nthread, num_shards))
+    for (int k = 0; k < num_shards; ++k) {
+      std::ostringstream idx_os;
+      for (int i = 0; i < nline; ++i) {
+        if (!valid[i] || seq[i] % num_shards != static_cast<size_t>(k)) continue;
+        idx_os << image_ids[i] << '\t' << writers[k]->Tell() << '\n';
+        writers[k]->WriteRecord(BeginPtr(blobs[i]), blobs[i].size());
       }
-      encode_buf.clear();
-      CHECK(cv::imencode(encoding, res, encode_buf, encode_params));
-
-      // write buffer
-      size_t bsize = blob.size();
-      blob.resize(bsize + encode_buf.size());
-      memcpy(BeginPtr(blob) + bsize,
-             BeginPtr(encode_buf), encode_buf.size());
-    } else {
-      size_t bsize = blob.size();
-      blob.resize(bsize + decode_buf.size());
-      memcpy(BeginPtr(blob) + bsize,
-             BeginPtr(decode_buf), decode_buf.size());
+      const std::string idx_str = idx_os.str();
+      fidx[k]->Write(idx_str.data(), idx_str.size());
     }
-    writer.WriteRecord(BeginPtr(blob), blob.size());
-    // write header
-    ++imcnt;
-    if (imcnt % 1000 == 0) {
-      LOG(INFO) << imcnt << " images processed, " << GetTime() - tstart << " sec elapsed";
+    if ((imcnt + nvalid) / 1000 != imcnt / 1000) {
+      LOG(INFO) << imcnt + nvalid << " images processed, "
+                << GetTime() - tstart << " sec elapsed";
     }
+    imcnt += nvalid;
   }
   LOG(INFO) << "Total: " << imcnt << " images processed, " << GetTime() - tstart << " sec elapsed";
-  delete fo;
+  for (int k = 0; k < num_shards; ++k) {
+    delete writers[k];
+    delete fo[k];
+    delete fidx[k];
+  }
   delete flist;
   return 0;
 }
@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file libsvm2csr.cc
+ * \brief convert LibSVM text files into binary csr shards, read by CSRShardIter
+ * \sa src/io/csr_shard.h
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <dmlc/timer.h>
+#include "../src/io/csr_shard.h"
+#include "../src/io/iter_text_block.h"
+
+int main(int argc, char *argv[]) {
+  using namespace mxnet::io;
+  if (argc < 3) {
+    printf("Usage: <input.libsvm> <output_prefix> [additional parameters in form key=value]\n"\
+           "Writes <output_prefix>_<k>.csr for k in [0, num_shards)\n"\
+           "Possible additional parameters:\n"\
+           "\tblock_size=BLOCK_SIZE[default=256] number of rows per block, "\
+           "which is the batch size of CSRShardIter.\n"\
+           "\tnum_shards=NUM_SHARDS[default=1] number of output shards, blocks are "\
+           "distributed round-robin.\n"\
+           "\tnum_cols=NUM_COLS[default=0] feature dimension, inferred from the largest "\
+           "index if 0.\n"\
+           "\tnthread=NTHREAD[default=4] number of parsing threads.\n");
+    return 0;
+  }
+  int block_size = 256;
+  int num_shards = 1;
+  uint64_t num_cols = 0;
+  int nthread = 4;
+  for (int i = 3; i < argc; ++i) {
+    char key[128], val[128];
+    int effct_len = 0;
+
+#ifdef _MSC_VER
+    effct_len = sscanf_s(argv[i], "%[^=]=%s", key, sizeof(key), val, sizeof(val));
+#else
+    effct_len = sscanf(argv[i], "%[^=]=%s", key, val);
+#endif
+
+    if (effct_len == 2) {
+      if (!strcmp(key, "block_size")) block_size = atoi(val);
+      if (!strcmp(key, "num_shards")) num_shards = atoi(val);
+      if (!strcmp(key, "num_cols")) num_cols = atoll(val);
+      if (!strcmp(key, "nthread")) nthread = atoi(val);
+    }
+  }
+  CHECK_GT(block_size, 0) << "block_size must be positive";
+  CHECK_GT(num_shards, 0) << "num_shards must be positive";
+
+  std::vector<std::unique_ptr<CSRShardWriter> > writers;
+  for (int k = 0; k < num_shards; ++k) {
+    std::ostringstream os;
+    os << argv[2] << '_' << k << ".csr";
+    writers.emplace_back(new CSRShardWriter(os.str(), block_size));
+    LOG(INFO) << "Write to output: " << os.str();
+  }
+
+  TextBlockReader reader(argv[1], 0, 1, nthread, ParseLibSVMBlock);
+  reader.BeforeFirst();
+  std::vector<TextBlockSegment> segs;
+  std::vector<int64_t> indptr, indices;
+  std::vector<mxnet::real_t> values, labels;
+  size_t num_blocks = 0, num_rows = 0;
+  double tstart = dmlc::GetTime();
+  while (true) {
+    segs.clear();
+    const size_t n = reader.Take(block_size, &segs);
+    if (n == 0) break;
+    const size_t nnz = NumEntries(segs);
+    indptr.resize(n + 1);
+    indices.resize(nnz);
+    values.resize(nnz);
+    labels.resize(n);
+    CopyCSRRows(segs, dmlc::BeginPtr(indptr), dmlc::BeginPtr(indices),
+                dmlc::BeginPtr(values), nthread);
+    CopyRowLabels(segs, dmlc::BeginPtr(labels));
+    writers[num_blocks % num_shards]->WriteBlock(dmlc::BeginPtr(indptr), dmlc::BeginPtr(indices),
+                                                 dmlc::BeginPtr(values), dmlc::BeginPtr(labels),
+                                                 n);
+    num_blocks += 1;
+    num_rows += n;
+    if (num_blocks % 1000 == 0) {
+      LOG(INFO) << num_rows << " rows converted, " << dmlc::GetTime() - tstart << " sec elapsed";
+    }
+  }
+  // all the shards of a dataset declare the same number of columns, so that
+  // every part reads batches of the same shape
+  uint64_t max_num_cols = num_cols;
+  for (auto &writer : writers) {
+    max_num_cols = std::max(max_num_cols, writer->max_num_cols());
+  }
+  if (num_cols != 0 && max_num_cols > static_cast<uint64_t>(num_cols)) {
+    LOG(FATAL) << "column index " << max_num_cols - 1 << " is out of num_cols " << num_cols;
+  }
+  for (auto &writer : writers) {
+    writer->SetNumCols(max_num_cols);
+    writer->Close();
+  }
+  LOG(INFO) << "Total: " << num_rows << " rows in " << num_blocks << " blocks, "
+            << dmlc::GetTime() - tstart << " sec elapsed";
+  return 0;
+}
@@ -0,0 +1,527 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file opbench.cc
+ * \brief time the forward and backward pass of registered operators on CPU
+ *
+ *  Every line of the config file is one case: the operator name, its inputs
+ *  as SHAPE[:DTYPE[:STYPE[:DENSITY]]], e.g. 64x128:float32:csr:0.05, and its
+ *  parameters as key=value. Operators without a case can be run on default
+ *  inputs with all=1. Results are written as tab separated values and can be
+ *  compared against the results of an earlier run.
+ * \sa tools/opbench.conf
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dmlc/logging.h>
+#include <mxnet/c_api.h>
+#include <nnvm/c_api.h>
+
+namespace {
+
+/*! \brief one input of a case */
+struct InputSpec {
+  std::vector<mx_uint> shape;
+  std::string dtype = "float32";
+  std::string stype = "default";
+  float density = 1.0f;
+};
+
+/*! \brief one benchmark case */
+struct BenchCase {
+  std::string op;
+  std::vector<InputSpec> inputs;
+  std::vector<std::pair<std::string, std::string> > params;
+  /*! \brief the case as written in the config, used as its key */
+  std::string key;
+};
+
+/*! \brief timing of one case at one thread count */
+struct BenchResult {
+  std::string op, key;
+  int threads = 1;
+  double fwd_mean = 0, fwd_median = 0, fwd_min = 0;
+  double bwd_mean = -1, bwd_median = -1, bwd_min = -1;
+  std::string status = "ok";
+};
+
+/*! \brief options given on the command line */
+struct BenchOptions {
+  std::vector<int> threads{1};
+  int warmup = 5;
+  int repeat = 20;
+  bool backward = true;
+  bool all = false;
+  std::string default_shape = "64x64";
+  std::vector<std::string> only;
+  double tolerance = 0.1;
+  double min_diff_us = 5;
+};
+
+inline std::vector<std::string> Split(const std::string &s, char sep) {
+  std::vector<std::string> ret;
+  std::istringstream is(s);
+  std::string item;
+  while (std::getline(is, item, sep)) {
+    if (!item.empty()) ret.push_back(item);
+  }
+  return ret;
+}
+
+inline int DTypeFlag(const std::string &dtype) {
+  static const std::map<std::string, int> flags = {
+    {"float32", 0}, {"float64", 1}, {"float16", 2}, {"uint8", 3},
+    {"int32", 4}, {"int8", 5}, {"int64", 6}};
+  auto it = flags.find(dtype);
+  CHECK(it != flags.end()) << "Unknown dtype " << dtype;
+  return it->second;
+}
+
+inline InputSpec ParseInput(const std::string &token) {
+  std::vector<std::string> fields = Split(token, ':');
+  CHECK(!fields.empty()) << "Bad input " << token;
+  InputSpec spec;
+  for (const std::string &dim : Split(fields[0], 'x')) {
+    spec.shape.push_back(static_cast<mx_uint>(atol(dim.c_str())));
+  }
+  if (fields.size() > 1) spec.dtype = fields[1];
+  if (fields.size() > 2) spec.stype = fields[2];
+  if (fields.size() > 3) spec.density = static_cast<float>(atof(fields[3].c_str()));
+  DTypeFlag(spec.dtype);
+  return spec;
+}
+
+inline BenchCase ParseCase(const std::string &line) {
+  std::vector<std::string> tokens = Split(line, ' ');
+  BenchCase c;
+  c.op = tokens[0];
+  for (size_t i = 1; i < tokens.size(); ++i) {
+    size_t eq = tokens[i].find('=');
+    if (eq == std::string::npos) {
+      c.inputs.push_back(ParseInput(tokens[i]));
+    } else {
+      c.params.emplace_back(tokens[i].substr(0, eq), tokens[i].substr(eq + 1));
+    }
+    c.key += (i == 1 ? "" : " ") + tokens[i];
+  }
+  return c;
+}
+
+inline std::vector<BenchCase> LoadConfig(const std::string &fname) {
+  std::ifstream is(fname);
+  CHECK(is.good()) << "Cannot open " << fname;
+  std::vector<BenchCase> cases;
+  std::string line;
+  while (std::getline(is, line)) {
+    std::replace(line.begin(), line.end(), '\t', ' ');
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(' ') == std::string::npos) continue;
+    cases.push_back(ParseCase(line));
+  }
+  return cases;
+}
+
+/*! \brief a case for an operator without one: default inputs, no parameters */
+inline bool DefaultCase(const std::string &op, const BenchOptions &opt, BenchCase *out) {
+  AtomicSymbolCreator creator;
+  if (NNGetOpHandle(op.c_str(), &creator) != 0) return false;
+  const char *name, *desc, *key_var_num_args, *return_type;
+  mx_uint num_args;
+  const char **arg_names, **arg_types, **arg_descs;
+  if (MXSymbolGetAtomicSymbolInfo(creator, &name, &desc, &num_args, &arg_names, &arg_types,
+                                  &arg_descs, &key_var_num_args, &return_type) != 0) {
+    return false;
+  }
+  out->op = op;
+  out->key = "";
+  int num_inputs = 0;
+  bool variadic = false;
+  for (mx_uint i = 0; i < num_args; ++i) {
+    std::string type = arg_types[i];
+    if (type.compare(0, 7, "NDArray") != 0 && type.compare(0, 6, "Symbol") != 0) continue;
+    if (type.find("[]") != std::string::npos) {
+      variadic = true;
+      num_inputs += 2;
+    } else {
+      num_inputs += 1;
+    }
+  }
+  if (variadic && key_var_num_args != nullptr && strlen(key_var_num_args) != 0) {
+    out->params.emplace_back(key_var_num_args, std::to_string(num_inputs));
+  }
+  for (int i = 0; i < num_inputs; ++i) {
+    out->inputs.push_back(ParseInput(opt.default_shape));
+    out->key += (i == 0 ? "" : " ") + opt.default_shape;
+  }
+  return true;
+}
+
+/*! \brief owns the NDArray handles created for one case */
+class HandleScope {
+ public:
+  ~HandleScope() {
+    for (NDArrayHandle h : handles_) MXNDArrayFree(h);
+  }
+  NDArrayHandle Add(NDArrayHandle h) {
+    handles_.push_back(h);
+    return h;
+  }
+
+ private:
+  std::vector<NDArrayHandle> handles_;
+};
+
+inline std::string LastError() {
+  std::string err = MXGetLastError();
+  err = err.substr(0, err.find('\n'));
+  std::replace(err.begin(), err.end(), '\t', ' ');
+  return err;
+}
+
+/*! \brief invoke op on inputs, outputs are created on the first call and reused */
+inline int Invoke(const std::string &op, std::vector<NDArrayHandle> inputs,
+                  const std::vector<std::pair<std::string, std::string> > &params,
+                  std::vector<NDArrayHandle> *outputs) {
+  AtomicSymbolCreator creator;
+  if (NNGetOpHandle(op.c_str(), &creator) != 0) return -1;
+  std::vector<const char*> keys, vals;
+  for (const auto &kv : params) {
+    keys.push_back(kv.first.c_str());
+    vals.push_back(kv.second.c_str());
+  }
+  int num_outputs = static_cast<int>(outputs->size());
+  NDArrayHandle *out_ptr = outputs->empty() ? nullptr : outputs->data();
+  const int *out_stypes;
+  int ret = MXImperativeInvokeEx(creator, static_cast<int>(inputs.size()), inputs.data(),
+                                 &num_outputs, &out_ptr, static_cast<int>(keys.size()),
+                                 keys.data(), vals.data(), &out_stypes);
+  if (ret == 0 && outputs->empty()) outputs->assign(out_ptr, out_ptr + num_outputs);
+  return ret;
+}
+
+/*! \brief create a random input, values are in [0.1, 1) so log, sqrt etc. are defined */
+inline int CreateInput(const InputSpec &spec, std::mt19937 *rnd, HandleScope *scope,
+                       NDArrayHandle *out) {
+  NDArrayHandle dense;
+  if (MXNDArrayCreateEx(spec.shape.data(), static_cast<mx_uint>(spec.shape.size()),
+                        1, 0, 0, 0, &dense) != 0) {
+    return -1;
+  }
+  scope->Add(dense);
+  size_t size = 1;
+  for (mx_uint s : spec.shape) size *= s;
+  std::uniform_real_distribution<float> value(0.1f, 1.0f), keep(0.0f, 1.0f);
+  std::vector<float> data(size);
+  for (float &v : data) v = keep(*rnd) < spec.density ? value(*rnd) : 0.0f;
+  if (MXNDArraySyncCopyFromCPU(dense, data.data(), size) != 0) return -1;
+  *out = dense;
+  if (spec.dtype != "float32") {
+    std::vector<NDArrayHandle> cast;
+    if (Invoke("Cast", {*out}, {{"dtype", spec.dtype}}, &cast) != 0) return -1;
+    *out = scope->Add(cast[0]);
+  }
+  if (spec.stype != "default") {
+    std::vector<NDArrayHandle> cast;
+    if (Invoke("cast_storage", {*out}, {{"stype", spec.stype}}, &cast) != 0) return -1;
+    *out = scope->Add(cast[0]);
+  }
+  return 0;
+}
+
+/*! \brief mean, median and min of samples, in microseconds */
+inline void Summarize(std::vector<double> samples, double *mean, double *median, double *min) {
+  std::sort(samples.begin(), samples.end());
+  double total = 0;
+  for (double s : samples) total += s;
+  *mean = total / samples.size();
+  *median = samples[samples.size() / 2];
+  *min = samples[0];
+}
+
+template<typename Fn>
+inline int Time(int warmup, int repeat, Fn fn, std::vector<double> *samples) {
+  for (int i = 0; i < warmup + repeat; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    if (fn() != 0 || MXNDArrayWaitAll() != 0) return -1;
+    auto end = std::chrono::steady_clock::now();
+    if (i >= warmup) {
+      samples->push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+  }
+  return 0;
+}
+
+inline BenchResult RunCase(const BenchCase &c, int threads, const BenchOptions &opt) {
+  BenchResult res;
+  res.op = c.op;
+  res.key = c.key;
+  res.threads = threads;
+  MXSetNumOMPThreads(threads);
+  HandleScope scope;
+  std::mt19937 rnd(0);
+  std::vector<NDArrayHandle> inputs(c.inputs.size());
+  for (size_t i = 0; i < c.inputs.size(); ++i) {
+    if (CreateInput(c.inputs[i], &rnd, &scope, &inputs[i]) != 0) {
+      res.status = "error: " + LastError();
+      return res;
+    }
+  }
+  // forward, not recorded
+  std::vector<NDArrayHandle> outputs;
+  std::vector<double> samples;
+  int ret = Time(opt.warmup, opt.repeat, [&]() {
+      return Invoke(c.op, inputs, c.params, &outputs);
+    }, &samples);
+  for (NDArrayHandle h : outputs) scope.Add(h);
+  if (ret != 0) {
+    res.status = "error: " + LastError();
+    return res;
+  }
+  Summarize(samples, &res.fwd_mean, &res.fwd_median, &res.fwd_min);
+  if (!opt.backward) return res;
+  // backward of one recorded forward, with respect to the dense float inputs
+  std::vector<NDArrayHandle> vars, grads;
+  std::vector<mx_uint> reqs;
+  for (size_t i = 0; i < c.inputs.size(); ++i) {
+    const InputSpec &spec = c.inputs[i];
+    if (spec.stype != "default" || spec.dtype.compare(0, 5, "float") != 0) continue;
+    NDArrayHandle grad;
+    if (MXNDArrayCreateEx(spec.shape.data(), static_cast<mx_uint>(spec.shape.size()),
+                          1, 0, 0, DTypeFlag(spec.dtype), &grad) != 0) {
+      continue;
+    }
+    vars.push_back(inputs[i]);
+    grads.push_back(scope.Add(grad));
+    reqs.push_back(1);
+  }
+  if (vars.empty()) return res;
+  int prev;
+  std::vector<NDArrayHandle> recorded;
+  MXAutogradSetIsRecording(1, &prev);
+  ret = MXAutogradMarkVariables(static_cast<mx_uint>(vars.size()), vars.data(),
+                                reqs.data(), grads.data());
+  if (ret == 0) ret = Invoke(c.op, inputs, c.params, &recorded);
+  MXAutogradSetIsRecording(prev, &prev);
+  for (NDArrayHandle h : recorded) scope.Add(h);
+  if (ret != 0) return res;
+  samples.clear();
+  ret = Time(opt.warmup, opt.repeat, [&]() {
+      return MXAutogradBackwardEx(static_cast<mx_uint>(recorded.size()), recorded.data(),
+                                  nullptr, 0, nullptr, 1, 0, 1, nullptr, nullptr);
+    }, &samples);
+  // operators without gradient only report the forward pass
+  if (ret == 0) Summarize(samples, &res.bwd_mean, &res.bwd_median, &res.bwd_min);
+  return res;
+}
+
+const char *kHeader = "op\tcase\tthreads\tfwd_mean_us\tfwd_median_us\tfwd_min_us\t"
+                      "bwd_mean_us\tbwd_median_us\tbwd_min_us\tstatus";
+
+inline void WriteResult(std::ostream &os, const BenchResult &r) {
+  os << r.op << '\t' << r.key << '\t' << r.threads << '\t'
+     << r.fwd_mean << '\t' << r.fwd_median << '\t' << r.fwd_min << '\t'
+     << r.bwd_mean << '\t' << r.bwd_median << '\t' << r.bwd_min << '\t' << r.status << '\n';
+}
+
+inline std::vector<BenchResult> LoadResults(const std::string &fname) {
+  std::ifstream is(fname);
+  CHECK(is.good()) << "Cannot open " << fname;
+  std::vector<BenchResult> results;
+  std::string line;
+  std::getline(is, line);
+  CHECK_EQ(line, kHeader) << fname << " is not written by opbench";
+  while (std::getline(is, line)) {
+    std::istringstream ls(line);
+    std::vector<std::string> f;
+    std::string item;
+    while (std::getline(ls, item, '\t')) f.push_back(item);
+    if (f.size() < 10) continue;
+    BenchResult r;
+    r.op = f[0];
+    r.key = f[1];
+    r.threads = atoi(f[2].c_str());
+    r.fwd_median = atof(f[4].c_str());
+    r.bwd_median = atof(f[7].c_str());
+    r.status = f[9];
+    results.push_back(r);
+  }
+  return results;
+}
+
+/*! \brief print the cases slower than the baseline, return their number */
+inline int Compare(const std::vector<BenchResult> &results,
+                   const std::vector<BenchResult> &baseline, const BenchOptions &opt) {
+  std::map<std::string, const BenchResult*> base;
+  for (const BenchResult &r : baseline) {
+    base[r.op + '\t' + r.key + '\t' + std::to_string(r.threads)] = &r;
+  }
+  int num_regressions = 0;
+  auto check = [&](const BenchResult &r, const char *pass, double now, double before) {
+    if (now < 0 || before < 0) return;
+    if (now > before * (1 + opt.tolerance) && now - before > opt.min_diff_us) {
+      printf("REGRESSION %s [%s] threads=%d %s: %.1f us -> %.1f us (%+.0f%%)\n",
+             r.op.c_str(), r.key.c_str(), r.threads, pass, before, now,
+             (now / before - 1) * 100);
+      ++num_regressions;
+    }
+  };
+  for (const BenchResult &r : results) {
+    auto it = base.find(r.op + '\t' + r.key + '\t' + std::to_string(r.threads));
+    if (it == base.end()) continue;
+    const BenchResult &b = *it->second;
+    if (r.status != "ok" && b.status == "ok") {
+      printf("REGRESSION %s [%s] threads=%d: %s\n",
+             r.op.c_str(), r.key.c_str(), r.threads, r.status.c_str());
+      ++num_regressions;
+      continue;
+    }
+    check(r, "forward", r.fwd_median, b.fwd_median);
+    check(r, "backward", r.bwd_median, b.bwd_median);
+  }
+  return num_regressions;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("Usage: <config> [additional parameters in form key=value]\n"\
+           "Possible additional parameters:\n"\
+           "\toutput=FILE[default=opbench.tsv] where to write the results.\n"\
+           "\tbaseline=FILE[default=] results of an earlier run, slower cases are reported "\
+           "and the exit code is 1.\n"\
+           "\ttolerance=TOL[default=0.1] relative slowdown of the median reported "\
+           "as regression.\n"\
+           "\tmin_diff_us=US[default=5] smaller slowdowns are ignored.\n"\
+           "\tthreads=N1,N2,..[default=1] OpenMP thread counts to run every case with.\n"\
+           "\twarmup=N[default=5] untimed runs before timing.\n"\
+           "\trepeat=N[default=20] timed runs.\n"\
+           "\tbackward=0|1[default=1] whether to time the backward pass.\n"\
+           "\tall=0|1[default=0] also run the registered operators without a case in "\
+           "the config, on default inputs.\n"\
+           "\tdefault_shape=SHAPE[default=64x64] shape of the default inputs.\n"\
+           "\tops=OP1,OP2,..[default=] only run these operators.\n");
+    return 0;
+  }
+  BenchOptions opt;
+  std::string output = "opbench.tsv", baseline;
+  for (int i = 2; i < argc; ++i) {
+    char key[128], val[1024];
+    int effct_len = 0;
+
+#ifdef _MSC_VER
+    effct_len = sscanf_s(argv[i], "%[^=]=%s", key, sizeof(key), val, sizeof(val));
+#else
+    effct_len = sscanf(argv[i], "%127[^=]=%1023s", key, val);
+#endif
+
+    if (effct_len == 2) {
+      if (!strcmp(key, "output")) output = val;
+      if (!strcmp(key, "baseline")) baseline = val;
+      if (!strcmp(key, "tolerance")) opt.tolerance = atof(val);
+      if (!strcmp(key, "min_diff_us")) opt.min_diff_us = atof(val);
+      if (!strcmp(key, "warmup")) opt.warmup = atoi(val);
+      if (!strcmp(key, "repeat")) opt.repeat = atoi(val);
+      if (!strcmp(key, "backward")) opt.backward = atoi(val) != 0;
+      if (!strcmp(key, "all")) opt.all = atoi(val) != 0;
+      if (!strcmp(key, "default_shape")) opt.default_shape = val;
+      if (!strcmp(key, "ops")) opt.only = Split(val, ',');
+      if (!strcmp(key, "threads")) {
+        opt.threads.clear();
+        for (const std::string &n : Split(val, ',')) opt.threads.push_back(atoi(n.c_str()));
+      }
+    }
+  }
+  CHECK_GT(opt.repeat, 0) << "repeat must be positive";
+  CHECK(!opt.threads.empty()) << "threads must not be empty";
+  // operators run on the calling thread, which the OpenMP thread count applies to
+  if (getenv("MXNET_ENGINE_TYPE") == nullptr) {
+#ifdef _MSC_VER
+    _putenv_s("MXNET_ENGINE_TYPE", "NaiveEngine");
+#else
+    setenv("MXNET_ENGINE_TYPE", "NaiveEngine", 1);
+#endif
+  }
+  int prev;
+  MXAutogradSetIsTraining(1, &prev);
+
+  std::vector<BenchCase> cases = LoadConfig(argv[1]);
+  mx_uint num_ops;
+  const char **op_names;
+  CHECK_EQ(MXListAllOpNames(&num_ops, &op_names), 0) << MXGetLastError();
+  std::vector<std::string> all_ops(op_names, op_names + num_ops);
+  std::sort(all_ops.begin(), all_ops.end());
+  std::map<std::string, int> num_cases;
+  for (const BenchCase &c : cases) num_cases[c.op] += 1;
+  size_t num_uncovered = 0;
+  for (const std::string &op : all_ops) {
+    if (num_cases.count(op) != 0) continue;
+    // backward and internal operators are covered through the public ones
+    if (op.compare(0, 1, "_") == 0) continue;
+    num_uncovered += 1;
+    BenchCase c;
+    if (opt.all && DefaultCase(op, opt, &c)) cases.push_back(c);
+  }
+  if (!opt.only.empty()) {
+    cases.erase(std::remove_if(cases.begin(), cases.end(), [&opt](const BenchCase &c) {
+        return std::find(opt.only.begin(), opt.only.end(), c.op) == opt.only.end();
+      }), cases.end());
+  }
+  LOG(INFO) << all_ops.size() << " registered operators, " << num_uncovered
+            << " public ones without a case in " << argv[1] << ", running "
+            << cases.size() << " cases";
+
+  std::ofstream os(output);
+  CHECK(os.good()) << "Cannot open " << output;
+  os << kHeader << '\n';
+  std::vector<BenchResult> results;
+  size_t num_errors = 0;
+  for (const BenchCase &c : cases) {
+    for (int threads : opt.threads) {
+      BenchResult r = RunCase(c, threads, opt);
+      WriteResult(os, r);
+      os.flush();
+      if (r.status != "ok") num_errors += 1;
+      printf("%-28s %-40s threads=%-3d fwd %10.1f us  bwd %10.1f us  %s\n",
+             r.op.c_str(), r.key.c_str(), r.threads, r.fwd_median, r.bwd_median,
+             r.status.c_str());
+      results.push_back(r);
+    }
+  }
+  LOG(INFO) << results.size() << " results written to " << output << ", "
+            << num_errors << " failed";
+  int ret = 0;
+  if (!baseline.empty()) {
+    int num_regressions = Compare(results, LoadResults(baseline), opt);
+    LOG(INFO) << num_regressions << " regressions against " << baseline;
+    ret = num_regressions != 0;
+  }
+  MXNotifyShutdown();
+  return ret;
+}